@@ -0,0 +1,32 @@
+#include <memory>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "binder/binder.h"
+#include "binder/statement/analyze_statement.h"
+#include "binder/table_ref/bound_base_table_ref.h"
+#include "common/exception.h"
+#include "common/util/string_util.h"
+
+namespace bustub {
+
+auto Binder::BindAnalyze(duckdb_libpgquery::PGVacuumStmt *stmt) -> std::unique_ptr<AnalyzeStatement> {
+  if ((stmt->options & duckdb_libpgquery::PG_VACOPT_VACUUM) != 0) {
+    throw NotImplementedException("VACUUM is not supported");
+  }
+  std::vector<std::unique_ptr<BoundBaseTableRef>> tables;
+  if (stmt->relation != nullptr) {
+    tables.push_back(BindBaseTableRef(stmt->relation->relname, std::nullopt));
+  } else {
+    // Without a table, analyze every user table. Internal tables like the mock tables are only analyzed by name.
+    for (const auto &table_name : catalog_.GetTableNames()) {
+      if (!StringUtil::StartsWith(table_name, "__")) {
+        tables.push_back(BindBaseTableRef(table_name, std::nullopt));
+      }
+    }
+  }
+  return std::make_unique<AnalyzeStatement>(std::move(tables));
+}
+
+}  // namespace bustub
@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binder/binder.h"
+#include "binder/bound_expression.h"
+#include "binder/expressions/bound_parameter.h"
+#include "binder/statement/prepare_statement.h"
+#include "common/exception.h"
+#include "fmt/format.h"
+#include "nodes/parsenodes.hpp"
+
+namespace bustub {
+
+auto Binder::BindPrepare(duckdb_libpgquery::PGPrepareStmt *stmt) -> std::unique_ptr<PrepareStatement> {
+  std::vector<TypeId> parameter_types;
+  if (stmt->argtypes != nullptr) {
+    for (auto c = stmt->argtypes->head; c != nullptr; c = lnext(c)) {
+      auto type_name = reinterpret_cast<duckdb_libpgquery::PGTypeName *>(c->data.ptr_value);
+      auto name = std::string(
+          (reinterpret_cast<duckdb_libpgquery::PGValue *>(type_name->names->tail->data.ptr_value)->val.str));
+      if (name == "int4") {
+        parameter_types.push_back(TypeId::INTEGER);
+      } else if (name == "varchar") {
+        parameter_types.push_back(TypeId::VARCHAR);
+      } else if (name == "bool") {
+        parameter_types.push_back(TypeId::BOOLEAN);
+      } else {
+        throw NotImplementedException(fmt::format("unsupported parameter type: {}", name));
+      }
+    }
+  }
+
+  parameter_cnt_ = 0;
+  auto statement = BindStatement(stmt->query);
+  switch (statement->type_) {
+    case StatementType::SELECT_STATEMENT:
+    case StatementType::INSERT_STATEMENT:
+    case StatementType::UPDATE_STATEMENT:
+    case StatementType::DELETE_STATEMENT:
+      break;
+    default:
+      throw NotImplementedException(fmt::format("cannot prepare a {} statement", statement->type_));
+  }
+  return std::make_unique<PrepareStatement>(stmt->name, std::move(parameter_types), std::move(statement));
+}
+
+auto Binder::BindExecute(duckdb_libpgquery::PGExecuteStmt *stmt) -> std::unique_ptr<ExecuteStatement> {
+  std::vector<std::unique_ptr<BoundExpression>> parameters;
+  if (stmt->params != nullptr) {
+    parameters = BindExpressionList(stmt->params);
+  }
+  for (const auto &parameter : parameters) {
+    if (parameter->type_ != ExpressionType::CONSTANT) {
+      throw NotImplementedException("only constant parameter values are supported");
+    }
+  }
+  return std::make_unique<ExecuteStatement>(stmt->name, std::move(parameters));
+}
+
+auto Binder::BindDeallocate(duckdb_libpgquery::PGDeallocateStmt *stmt) -> std::unique_ptr<DeallocateStatement> {
+  if (stmt->name == nullptr) {
+    return std::make_unique<DeallocateStatement>(std::nullopt);
+  }
+  return std::make_unique<DeallocateStatement>(stmt->name);
+}
+
+auto Binder::BindParameter(duckdb_libpgquery::PGParamRef *node) -> std::unique_ptr<BoundExpression> {
+  // `$n` names the n-th parameter, while each `?` takes the parameter after the last one seen.
+  size_t idx = node->number > 0 ? static_cast<size_t>(node->number - 1) : parameter_cnt_;
+  parameter_cnt_ = std::max(parameter_cnt_, idx + 1);
+  return std::make_unique<BoundParameter>(idx);
+}
+
+}  // namespace bustub
@@ -797,6 +797,8 @@ auto Binder::BindExpression(duckdb_libpgquery::PGNode *node) -> std::unique_ptr<
       return BindAExpr(reinterpret_cast<duckdb_libpgquery::PGAExpr *>(node));
     case duckdb_libpgquery::T_PGBoolExpr:
       return BindBoolExpr(reinterpret_cast<duckdb_libpgquery::PGBoolExpr *>(node));
+    case duckdb_libpgquery::T_PGParamRef:
+      return BindParameter(reinterpret_cast<duckdb_libpgquery::PGParamRef *>(node));
     default:
       break;
   }
@@ -830,6 +832,9 @@ auto Binder::BindExplain(duckdb_libpgquery::PGExplainStmt *stmt) -> std::unique_
       if (strcmp(temp->defname, "schema") == 0 || strcmp(temp->defname, "s") == 0) {
         explain_options |= ExplainOptions::SCHEMA;
       }
+      if (strcmp(temp->defname, "analyze") == 0 || strcmp(temp->defname, "a") == 0) {
+        explain_options |= ExplainOptions::ANALYZE;
+      }
     }
   }
   return std::make_unique<ExplainStatement>(BindStatement(stmt->query), explain_options);
@@ -39,6 +39,8 @@ BufferPoolManagerInstance::~BufferPoolManagerInstance() {
 
 auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
   std::lock_guard<std::mutex> lock(latch_);
+  auto &stats = ThreadStats();
+  stats.misses_++;
   frame_id_t frame_id = -1;
   if (!free_list_.empty()) {
     frame_id = free_list_.front();
@@ -46,6 +48,7 @@ auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
   } else {
     if (replacer_->Evict(&frame_id)) {
       if (pages_[frame_id].IsDirty()) {
+        stats.pages_written_++;
         disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
         pages_[frame_id].is_dirty_ = false;
       }
@@ -69,14 +72,17 @@ auto BufferPoolManagerInstance::NewPgImp(page_id_t *page_id) -> Page * {
 
 auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
   std::lock_guard<std::mutex> lock(latch_);
+  auto &stats = ThreadStats();
   frame_id_t frame_id = -1;
   if (page_table_->Find(page_id, frame_id)) {
+    stats.hits_++;
     replacer_->RecordAccess(frame_id);
     pages_[frame_id].pin_count_++;
     replacer_->SetEvictable(frame_id, false);
     return &pages_[frame_id];
   }
   // 模拟缺页中断
+  stats.misses_++;
   if (!free_list_.empty()) {
     frame_id = free_list_.front();
     free_list_.pop_front();
@@ -85,6 +91,7 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
       return nullptr;  // No frame available for replacement
     }
     if (pages_[frame_id].IsDirty()) {
+      stats.pages_written_++;
       disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
       pages_[frame_id].is_dirty_ = false;
     }
@@ -96,6 +103,7 @@ auto BufferPoolManagerInstance::FetchPgImp(page_id_t page_id) -> Page * {
   pages_[frame_id].is_dirty_ = false;
   pages_[frame_id].ResetMemory();
   disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
+  stats.pages_read_++;
   replacer_->RecordAccess(frame_id);
   replacer_->SetEvictable(frame_id, false);
   return &pages_[frame_id];
@@ -108,7 +116,8 @@ auto BufferPoolManagerInstance::UnpinPgImp(page_id_t page_id, bool is_dirty) ->
     return false;
   }
   pages_[frame_id].pin_count_--;
-  pages_[frame_id].is_dirty_ = is_dirty;
+  // A clean unpin must not hide the writes of an earlier pin of the same page.
+  pages_[frame_id].is_dirty_ |= is_dirty;
   if (pages_[frame_id].GetPinCount() == 0) {
     replacer_->SetEvictable(frame_id, true);
   }
@@ -122,7 +131,7 @@ auto BufferPoolManagerInstance::FlushPgImp(page_id_t page_id) -> bool {
     return false;
   }
   disk_manager_->WritePage(page_id, pages_[frame_id_t].GetData());
-  pages_->is_dirty_ = false;
+  pages_[frame_id_t].is_dirty_ = false;
   return true;
 }
 
@@ -132,7 +141,7 @@ void BufferPoolManagerInstance::FlushAllPgsImp() {
   for (size_t frame_id = 0; frame_id < pool_size_; frame_id++) {
     if (page_table_->Find(pages_[frame_id].GetPageId(), tmp)) {
       disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-      pages_->is_dirty_ = false;
+      pages_[frame_id].is_dirty_ = false;
     }
   }
 }
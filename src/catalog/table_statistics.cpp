@@ -0,0 +1,159 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_statistics.cpp
+//
+// Identification: src/catalog/table_statistics.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/table_statistics.h"
+
+#include <algorithm>
+
+#include "common/config.h"
+#include "fmt/format.h"
+#include "fmt/ranges.h"
+
+namespace bustub {
+
+auto ColumnStatistics::ToNumeric(const Value &value) -> std::optional<double> {
+  if (value.IsNull()) {
+    return std::nullopt;
+  }
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    case TypeId::BIGINT:
+      return static_cast<double>(value.GetAs<int64_t>());
+    case TypeId::DECIMAL:
+      return value.GetAs<double>();
+    case TypeId::TIMESTAMP:
+      return static_cast<double>(value.GetAs<uint64_t>());
+    default:
+      return std::nullopt;
+  }
+}
+
+auto ColumnStatistics::FractionBelow(double value) const -> double {
+  if (value <= bounds_.front()) {
+    return 0;
+  }
+  if (value > bounds_.back()) {
+    return 1;
+  }
+  // Every bucket holds the same share of the values; interpolate linearly within the bucket containing `value`.
+  auto buckets = bounds_.size() - 1;
+  auto upper = std::lower_bound(bounds_.begin() + 1, bounds_.end(), value);
+  auto bucket = static_cast<size_t>(upper - bounds_.begin()) - 1;
+  double lo = bounds_[bucket];
+  double hi = bounds_[bucket + 1];
+  double within = hi > lo ? (value - lo) / (hi - lo) : 0;
+  return (static_cast<double>(bucket) + within) / static_cast<double>(buckets);
+}
+
+auto ColumnStatistics::EstimateEqualSelectivity(const Value &value) const -> double {
+  if (value.IsNull() || distinct_count_ == 0) {
+    return 0;
+  }
+  auto numeric = ToNumeric(value);
+  if (numeric.has_value() && !bounds_.empty() && (*numeric < bounds_.front() || *numeric > bounds_.back())) {
+    return 0;
+  }
+  return (1 - null_fraction_) / static_cast<double>(distinct_count_);
+}
+
+auto ColumnStatistics::EstimateRangeSelectivity(std::optional<double> low, bool low_inclusive,
+                                                std::optional<double> high, bool high_inclusive) const -> double {
+  if (bounds_.empty() || distinct_count_ == 0) {
+    return 0;
+  }
+  double below_high = high.has_value() ? FractionBelow(*high) : 1;
+  double below_low = low.has_value() ? FractionBelow(*low) : 0;
+  // The histogram treats values as continuous; account for the bound values themselves with the average frequency.
+  double point = 1.0 / static_cast<double>(distinct_count_);
+  if (high.has_value() && high_inclusive && *high >= bounds_.front() && *high <= bounds_.back()) {
+    below_high += point;
+  }
+  if (low.has_value() && !low_inclusive && *low >= bounds_.front() && *low <= bounds_.back()) {
+    below_low += point;
+  }
+  return std::clamp(below_high - below_low, 0.0, 1.0) * (1 - null_fraction_);
+}
+
+auto ColumnStatistics::ToString() const -> std::string {
+  if (bounds_.empty()) {
+    return fmt::format("{{ distinct={}, null_fraction={} }}", distinct_count_, null_fraction_);
+  }
+  return fmt::format("{{ distinct={}, null_fraction={}, min={}, max={}, buckets={} }}", distinct_count_,
+                     null_fraction_, bounds_.front(), bounds_.back(), bounds_.size() - 1);
+}
+
+auto TableStatistics::ToString() const -> std::string {
+  std::vector<std::string> columns;
+  columns.reserve(columns_.size());
+  for (const auto &column : columns_) {
+    columns.push_back(column.ToString());
+  }
+  return fmt::format("{{ rows={}, columns=[{}] }}", row_count_, fmt::join(columns, ", "));
+}
+
+TableStatisticsCollector::TableStatisticsCollector(const Schema &schema)
+    : schema_(schema),
+      null_counts_(schema.GetColumnCount()),
+      distinct_values_(schema.GetColumnCount()),
+      distinct_strings_(schema.GetColumnCount()),
+      numeric_values_(schema.GetColumnCount()) {}
+
+void TableStatisticsCollector::Add(const Tuple &tuple) {
+  row_count_++;
+  for (uint32_t i = 0; i < schema_.GetColumnCount(); i++) {
+    auto value = tuple.GetValue(&schema_, i);
+    if (value.IsNull()) {
+      null_counts_[i]++;
+      continue;
+    }
+    if (schema_.GetColumn(i).IsInlined()) {
+      // Fixed-size values are at most 8 bytes long.
+      uint64_t bytes = 0;
+      value.SerializeTo(reinterpret_cast<char *>(&bytes));
+      distinct_values_[i].insert(bytes);
+    } else {
+      distinct_strings_[i].insert(value.ToString());
+    }
+    if (auto numeric = ColumnStatistics::ToNumeric(value); numeric.has_value()) {
+      numeric_values_[i].push_back(*numeric);
+    }
+  }
+}
+
+auto TableStatisticsCollector::Finish() -> TableStatistics {
+  TableStatistics statistics{row_count_, {}};
+  for (uint32_t i = 0; i < schema_.GetColumnCount(); i++) {
+    auto &values = numeric_values_[i];
+    std::vector<double> bounds;
+    if (!values.empty()) {
+      std::sort(values.begin(), values.end());
+      auto buckets = std::min<size_t>(STATISTICS_HISTOGRAM_BUCKETS, values.size());
+      bounds.reserve(buckets + 1);
+      for (size_t b = 0; b <= buckets; b++) {
+        bounds.push_back(values[b * (values.size() - 1) / buckets]);
+      }
+    }
+    double null_fraction =
+        row_count_ == 0 ? 0 : static_cast<double>(null_counts_[i]) / static_cast<double>(row_count_);
+    statistics.columns_.emplace_back(distinct_values_[i].size() + distinct_strings_[i].size(), null_fraction,
+                                     std::move(bounds));
+  }
+  return statistics;
+}
+
+}  // namespace bustub
@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arena.cpp
+//
+// Identification: src/common/arena.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/arena.h"
+
+#include <algorithm>
+
+namespace bustub {
+
+auto Arena::AllocateBlock(size_t size, size_t alignment) -> void * {
+  // Blocks double in size, so that a large transaction still allocates only a logarithmic number of them.
+  size_t block_size = ARENA_BLOCK_SIZE;
+  if (!blocks_.empty()) {
+    block_size = std::max(block_size, 2 * static_cast<size_t>(end_ - blocks_.back().get()));
+  }
+  block_size = std::max(block_size, size + alignment);
+  blocks_.emplace_back(new std::byte[block_size]);
+  cur_ = blocks_.back().get();
+  end_ = cur_ + block_size;
+  return Allocate(size, alignment);
+}
+
+void Arena::Reset() {
+  if (initial_block_ != nullptr) {
+    blocks_.clear();
+    cur_ = initial_block_;
+    end_ = initial_block_ + initial_size_;
+  } else if (!blocks_.empty()) {
+    // Keep the first block, which is the one every allocation goes to after the reset.
+    auto first_size = blocks_.size() == 1 ? static_cast<size_t>(end_ - blocks_.front().get()) : ARENA_BLOCK_SIZE;
+    blocks_.resize(1);
+    cur_ = blocks_.front().get();
+    end_ = cur_ + first_size;
+  }
+  allocated_size_ = 0;
+}
+
+}  // namespace bustub
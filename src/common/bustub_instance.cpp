@@ -1,3 +1,5 @@
+#include <chrono>  // NOLINT
+#include <cstdlib>
 #include <optional>
 #include <shared_mutex>
 #include <string>
@@ -6,14 +8,18 @@
 #include "binder/binder.h"
 #include "binder/bound_expression.h"
 #include "binder/bound_statement.h"
+#include "binder/expressions/bound_constant.h"
+#include "binder/statement/analyze_statement.h"
 #include "binder/statement/create_statement.h"
 #include "binder/statement/explain_statement.h"
 #include "binder/statement/index_statement.h"
+#include "binder/statement/prepare_statement.h"
 #include "binder/statement/select_statement.h"
 #include "binder/statement/set_show_statement.h"
 #include "buffer/buffer_pool_manager_instance.h"
 #include "catalog/schema.h"
 #include "catalog/table_generator.h"
+#include "catalog/table_statistics.h"
 #include "common/bustub_instance.h"
 #include "common/enums/statement_type.h"
 #include "common/exception.h"
@@ -22,12 +28,15 @@
 #include "concurrency/transaction.h"
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
+#include "execution/executor_factory.h"
 #include "execution/executors/mock_scan_executor.h"
+#include "execution/executors/profiling_executor.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "fmt/core.h"
 #include "fmt/format.h"
 #include "optimizer/optimizer.h"
+#include "planner/plan_cache.h"
 #include "planner/planner.h"
 #include "recovery/checkpoint_manager.h"
 #include "recovery/log_manager.h"
@@ -38,7 +47,13 @@
 namespace bustub {
 
 auto BustubInstance::MakeExecutorContext(Transaction *txn) -> std::unique_ptr<ExecutorContext> {
-  return std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
+  auto exec_ctx = std::make_unique<ExecutorContext>(txn, catalog_, buffer_pool_manager_, txn_manager_, lock_manager_);
+  // `set aggregation_spill_threshold=<n>` makes aggregations spill after n partial groups, e.g. to test spilling.
+  if (auto threshold = std::strtoull(GetSessionVariable("aggregation_spill_threshold").c_str(), nullptr, 10);
+      threshold != 0) {
+    exec_ctx->SetAggregationSpillThreshold(threshold);
+  }
+  return exec_ctx;
 }
 
 BustubInstance::BustubInstance(const std::string &db_file_name) {
@@ -200,6 +215,12 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
 
   bool is_successful = true;
 
+  // A statement run before skips binding, planning and optimizing, unless the catalog has changed since.
+  auto cache_key = fmt::format("{}:{}", IsForceStarterRule() ? "starter" : "", PlanCache::NormalizeSql(sql));
+  if (auto cached_plan = plan_cache_.Get(cache_key, catalog_->GetVersion()); cached_plan != nullptr) {
+    return ExecutePlan(*cached_plan, writer, txn);
+  }
+
   std::shared_lock<std::shared_mutex> l(catalog_lock_);
   bustub::Binder binder(*catalog_);
   binder.ParseAndSave(sql);
@@ -249,6 +270,36 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
         WriteOneCell(fmt::format("Index created with id = {}", info->index_oid_), writer);
         continue;
       }
+      case StatementType::ANALYZE_STATEMENT: {
+        const auto &analyze_stmt = dynamic_cast<const AnalyzeStatement &>(*statement);
+
+        for (const auto &table : analyze_stmt.tables_) {
+          std::shared_lock<std::shared_mutex> l(catalog_lock_);
+          bustub::Planner planner(*catalog_);
+          auto plan = planner.PlanTableRef(*table);
+          l.unlock();
+
+          // Collect the statistics from a full scan of the table.
+          auto exec_ctx = MakeExecutorContext(txn);
+          auto executor = ExecutorFactory::CreateExecutor(exec_ctx.get(), plan);
+          TableStatisticsCollector collector(plan->OutputSchema());
+          executor->Init();
+          Tuple tuple;
+          RID rid;
+          while (executor->Next(&tuple, &rid)) {
+            collector.Add(tuple);
+          }
+          auto statistics = collector.Finish();
+          auto rows = statistics.row_count_;
+
+          std::unique_lock<std::shared_mutex> wl(catalog_lock_);
+          catalog_->SetTableStatistics(table->oid_, std::move(statistics));
+          wl.unlock();
+
+          WriteOneCell(fmt::format("Table {} analyzed, {} rows", table->table_, rows), writer);
+        }
+        continue;
+      }
       case StatementType::VARIABLE_SHOW_STATEMENT: {
         const auto &show_stmt = dynamic_cast<const VariableShowStatement &>(*statement);
         auto content = GetSessionVariable(show_stmt.variable_);
@@ -300,56 +351,167 @@ auto BustubInstance::ExecuteSqlTxn(const std::string &sql, ResultWriter &writer,
           output += "\n";
         }
 
+        // Run the optimized plan, and print it with the runtime statistics of every plan node.
+        if ((explain_stmt.options_ & ExplainOptions::ANALYZE) != 0) {
+          auto exec_ctx = MakeExecutorContext(txn);
+          exec_ctx->EnableProfiling();
+          std::vector<Tuple> result_set{};
+          auto start = std::chrono::steady_clock::now();
+          is_successful &= execution_engine_->Execute(optimized_plan, &result_set, txn, exec_ctx.get());
+          auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+          output += "=== ANALYZE ===";
+          output += "\n";
+          output += ProfilingExecutor::ExplainAnalyze(*optimized_plan, *exec_ctx, show_schema);
+          output += "\n";
+          output += fmt::format("Execution time: {:.3f}ms, {} rows", elapsed.count(), result_set.size());
+          output += "\n";
+        }
+
         WriteOneCell(output, writer);
 
         continue;
       }
+      case StatementType::PREPARE_STATEMENT: {
+        auto entry = std::make_shared<PreparedStatementEntry>();
+        entry->statement_.reset(dynamic_cast<PrepareStatement *>(statement.release()));
+        const auto &prepare_stmt = *entry->statement_;
+        entry->force_starter_rule_ = IsForceStarterRule();
+        entry->plan_ = PlanStatement(*prepare_stmt.statement_, prepare_stmt.parameter_types_);
+
+        std::scoped_lock<std::mutex> prepared_lock(prepared_latch_);
+        if (!prepared_statements_.try_emplace(prepare_stmt.name_, entry).second) {
+          throw Exception(fmt::format("prepared statement {} already exists", prepare_stmt.name_));
+        }
+        continue;
+      }
+      case StatementType::EXECUTE_STATEMENT: {
+        const auto &execute_stmt = dynamic_cast<const ExecuteStatement &>(*statement);
+        std::vector<Value> parameters;
+        parameters.reserve(execute_stmt.parameters_.size());
+        for (const auto &parameter : execute_stmt.parameters_) {
+          parameters.push_back(dynamic_cast<const BoundConstant &>(*parameter).val_);
+        }
+        is_successful &= ExecutePrepared(execute_stmt.name_, parameters, writer, txn);
+        continue;
+      }
+      case StatementType::DEALLOCATE_STATEMENT: {
+        const auto &deallocate_stmt = dynamic_cast<const DeallocateStatement &>(*statement);
+        std::scoped_lock<std::mutex> prepared_lock(prepared_latch_);
+        if (!deallocate_stmt.name_.has_value()) {
+          prepared_statements_.clear();
+        } else if (prepared_statements_.erase(*deallocate_stmt.name_) == 0) {
+          throw Exception(fmt::format("prepared statement {} does not exist", *deallocate_stmt.name_));
+        }
+        continue;
+      }
       default:
         break;
     }
 
-    std::shared_lock<std::shared_mutex> l(catalog_lock_);
+    auto plan = PlanStatement(*statement, {});
+    if (!plan->parameter_types_.empty()) {
+      throw Exception("parameters are only allowed in prepared statements");
+    }
+    if (binder.statement_nodes_.size() == 1) {
+      plan_cache_.Put(cache_key, plan);
+    }
+    is_successful &= ExecutePlan(*plan, writer, txn);
+  }
 
-    // Plan the query.
-    bustub::Planner planner(*catalog_);
-    planner.PlanQuery(*statement);
+  return is_successful;
+}
 
-    // Optimize the query.
-    bustub::Optimizer optimizer(*catalog_, IsForceStarterRule());
-    auto optimized_plan = optimizer.Optimize(planner.plan_);
+auto BustubInstance::PlanStatement(const BoundStatement &statement, std::vector<TypeId> parameter_types)
+    -> std::shared_ptr<const CachedPlan> {
+  std::shared_lock<std::shared_mutex> l(catalog_lock_);
+  auto catalog_version = catalog_->GetVersion();
 
-    l.unlock();
+  // Plan the query.
+  bustub::Planner planner(*catalog_);
+  planner.parameter_types_ = std::move(parameter_types);
+  planner.PlanQuery(statement);
 
-    // Execute the query.
-    auto exec_ctx = MakeExecutorContext(txn);
-    std::vector<Tuple> result_set{};
-    is_successful &= execution_engine_->Execute(optimized_plan, &result_set, txn, exec_ctx.get());
+  // Optimize the query.
+  bustub::Optimizer optimizer(*catalog_, IsForceStarterRule());
+  auto optimized_plan = optimizer.Optimize(planner.plan_);
 
-    // Return the result set as a vector of string.
-    auto schema = planner.plan_->OutputSchema();
+  l.unlock();
 
-    // Generate header for the result set.
-    writer.BeginTable(false);
-    writer.BeginHeader();
-    for (const auto &column : schema.GetColumns()) {
-      writer.WriteHeaderCell(column.GetName());
-    }
-    writer.EndHeader();
+  return std::make_shared<CachedPlan>(CachedPlan{std::move(optimized_plan),
+                                                 std::make_shared<Schema>(planner.plan_->OutputSchema()),
+                                                 catalog_version, std::move(planner.parameter_types_),
+                                                 std::move(planner.parameter_values_)});
+}
 
-    // Transforming result set into strings.
-    for (const auto &tuple : result_set) {
-      writer.BeginRow();
-      for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
-        writer.WriteCell(tuple.GetValue(&schema, i).ToString());
-      }
-      writer.EndRow();
+auto BustubInstance::ExecutePlan(const CachedPlan &plan, ResultWriter &writer, Transaction *txn) -> bool {
+  // Execute the query.
+  auto exec_ctx = MakeExecutorContext(txn);
+  std::vector<Tuple> result_set{};
+  auto is_successful = execution_engine_->Execute(plan.plan_, &result_set, txn, exec_ctx.get());
+
+  // Return the result set as a vector of string.
+  const auto &schema = *plan.output_schema_;
+
+  // Generate header for the result set.
+  writer.BeginTable(false);
+  writer.BeginHeader();
+  for (const auto &column : schema.GetColumns()) {
+    writer.WriteHeaderCell(column.GetName());
+  }
+  writer.EndHeader();
+
+  // Transforming result set into strings.
+  for (const auto &tuple : result_set) {
+    writer.BeginRow();
+    for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+      writer.WriteCell(tuple.GetValue(&schema, i).ToString());
     }
-    writer.EndTable();
+    writer.EndRow();
   }
+  writer.EndTable();
 
   return is_successful;
 }
 
+auto BustubInstance::ExecutePrepared(const std::string &name, const std::vector<Value> &parameters,
+                                     ResultWriter &writer, Transaction *txn) -> bool {
+  std::unique_lock<std::mutex> prepared_lock(prepared_latch_);
+  auto it = prepared_statements_.find(name);
+  if (it == prepared_statements_.end()) {
+    throw Exception(fmt::format("prepared statement {} does not exist", name));
+  }
+  auto entry = it->second;
+  prepared_lock.unlock();
+
+  std::scoped_lock<std::mutex> entry_lock(entry->latch_);
+
+  // Like a cached plan, the plan of a prepared statement is rebuilt once the catalog changes.
+  if (entry->plan_->catalog_version_ != catalog_->GetVersion() || entry->force_starter_rule_ != IsForceStarterRule()) {
+    entry->force_starter_rule_ = IsForceStarterRule();
+    entry->plan_ = PlanStatement(*entry->statement_->statement_, entry->statement_->parameter_types_);
+  }
+
+  const auto &types = entry->plan_->parameter_types_;
+  if (parameters.size() != types.size()) {
+    throw Exception(
+        fmt::format("prepared statement {} takes {} parameters, {} given", name, types.size(), parameters.size()));
+  }
+  auto &values = *entry->plan_->parameter_values_;
+  values.clear();
+  for (size_t i = 0; i < parameters.size(); i++) {
+    if (types[i] == TypeId::INVALID || parameters[i].GetTypeId() == types[i]) {
+      // An unused parameter keeps the type of its value.
+      values.push_back(parameters[i]);
+    } else if (parameters[i].IsNull()) {
+      values.push_back(ValueFactory::GetNullValueByType(types[i]));
+    } else {
+      values.push_back(parameters[i].CastAs(types[i]));
+    }
+  }
+  return ExecutePlan(*entry->plan_, writer, txn);
+}
+
 /**
  * FOR TEST ONLY. Generate test tables in this BusTub instance.
  * It's used in the shell to predefine some tables, as we don't support
@@ -0,0 +1,108 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// rwlatch.cpp
+//
+// Identification: src/common/rwlatch.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "common/rwlatch.h"
+
+#include <climits>
+#include <thread>  // NOLINT
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace bustub {
+
+namespace {
+inline void CpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t));
+
+/** Sleep until woken up, unless the futex word is not the value expected anymore. Elsewhere than Linux, yield. */
+void FutexWait(std::atomic<uint32_t> *word, uint32_t expected) {
+#ifdef __linux__
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+#else
+  std::this_thread::yield();
+#endif
+}
+
+void FutexWakeAll(std::atomic<uint32_t> *word) {
+#ifdef __linux__
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+}
+}  // namespace
+
+template <typename Ready>
+void ReaderWriterLatch::WaitUntil(Ready ready) {
+  for (int i = 0; i < LATCH_SPIN_COUNT; i++) {
+    if (ready(state_.load(std::memory_order_relaxed))) {
+      return;
+    }
+    CpuRelax();
+  }
+  // The unlocks update the state word before they check for parked threads, while a parking thread registers before
+  // it checks the state word, so either the unlock sees it parked or it sees the unlock. A wake-up between checking
+  // and sleeping bumps the futex word, which makes the sleep return at once.
+  parked_.fetch_add(1);
+  auto seq = wake_seq_.load();
+  if (!ready(state_.load())) {
+    FutexWait(&wake_seq_, seq);
+  }
+  parked_.fetch_sub(1);
+}
+
+void ReaderWriterLatch::WLockSlow() {
+  // Announcing the writer holds back the readers that come next.
+  state_.fetch_add(WAITING_WRITER_ONE, std::memory_order_relaxed);
+  auto ready = [](uint64_t state) { return (state & (WRITER | READER_MASK)) == 0; };
+  while (true) {
+    auto state = state_.load(std::memory_order_relaxed);
+    if (!ready(state)) {
+      WaitUntil(ready);
+      continue;
+    }
+    if (state_.compare_exchange_weak(state, state - WAITING_WRITER_ONE + WRITER, std::memory_order_acquire,
+                                     std::memory_order_relaxed)) {
+      return;
+    }
+  }
+}
+
+void ReaderWriterLatch::RLockSlow() {
+  auto ready = [](uint64_t state) { return (state & (WRITER | WAITING_WRITER_MASK)) == 0; };
+  while (true) {
+    auto state = state_.load(std::memory_order_relaxed);
+    if (!ready(state)) {
+      WaitUntil(ready);
+      continue;
+    }
+    if (state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+      return;
+    }
+  }
+}
+
+void ReaderWriterLatch::WakeUpSlow() {
+  wake_seq_.fetch_add(1);
+  FutexWakeAll(&wake_seq_);
+}
+
+}  // namespace bustub
@@ -12,37 +12,701 @@
 
 #include "concurrency/lock_manager.h"
 
+#include <functional>
+#include <string_view>
+
 #include "common/config.h"
 #include "concurrency/transaction.h"
 #include "concurrency/transaction_manager.h"
 
 namespace bustub {
 
-auto LockManager::LockTable(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool { return true; }
+namespace {
+
+/** @return the set of the transaction holding the tables it has locked in `lock_mode` */
+auto TableLockSet(Transaction *txn, LockManager::LockMode lock_mode) -> FlatHashSet<table_oid_t> * {
+  switch (lock_mode) {
+    case LockManager::LockMode::SHARED:
+      return txn->GetSharedTableLockSet();
+    case LockManager::LockMode::EXCLUSIVE:
+      return txn->GetExclusiveTableLockSet();
+    case LockManager::LockMode::INTENTION_SHARED:
+      return txn->GetIntentionSharedTableLockSet();
+    case LockManager::LockMode::INTENTION_EXCLUSIVE:
+      return txn->GetIntentionExclusiveTableLockSet();
+    case LockManager::LockMode::SHARED_INTENTION_EXCLUSIVE:
+      return txn->GetSharedIntentionExclusiveTableLockSet();
+  }
+  UNREACHABLE("unknown lock mode");
+}
+
+/** @return whether the transaction holds row locks on the table */
+auto HoldsRowLocks(Transaction *txn, table_oid_t oid) -> bool {
+  for (const auto &row_lock_set : {txn->GetSharedRowLockSet(), txn->GetExclusiveRowLockSet()}) {
+    auto it = row_lock_set->find(oid);
+    if (it != row_lock_set->end() && !it->second.empty()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+auto LockManager::AreLocksCompatible(LockMode held, LockMode requested) -> bool {
+  switch (held) {
+    case LockMode::INTENTION_SHARED:
+      return requested != LockMode::EXCLUSIVE;
+    case LockMode::INTENTION_EXCLUSIVE:
+      return requested == LockMode::INTENTION_SHARED || requested == LockMode::INTENTION_EXCLUSIVE;
+    case LockMode::SHARED:
+      return requested == LockMode::INTENTION_SHARED || requested == LockMode::SHARED;
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      return requested == LockMode::INTENTION_SHARED;
+    case LockMode::EXCLUSIVE:
+      return false;
+  }
+  UNREACHABLE("unknown lock mode");
+}
+
+auto LockManager::CanUpgrade(LockMode held, LockMode requested) -> bool {
+  switch (held) {
+    case LockMode::INTENTION_SHARED:
+      return true;
+    case LockMode::SHARED:
+    case LockMode::INTENTION_EXCLUSIVE:
+      return requested == LockMode::EXCLUSIVE || requested == LockMode::SHARED_INTENTION_EXCLUSIVE;
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      return requested == LockMode::EXCLUSIVE;
+    case LockMode::EXCLUSIVE:
+      return false;
+  }
+  UNREACHABLE("unknown lock mode");
+}
+
+void LockManager::AbortTransaction(Transaction *txn, AbortReason reason) {
+  txn->SetState(TransactionState::ABORTED);
+  throw TransactionAbortException(txn->GetTransactionId(), reason);
+}
+
+void LockManager::CheckLockAllowed(Transaction *txn, LockMode lock_mode) {
+  const bool shared = lock_mode == LockMode::SHARED || lock_mode == LockMode::INTENTION_SHARED ||
+                      lock_mode == LockMode::SHARED_INTENTION_EXCLUSIVE;
+  const bool shrinking = txn->GetState() == TransactionState::SHRINKING;
+  switch (txn->GetIsolationLevel()) {
+    case IsolationLevel::READ_UNCOMMITTED:
+      if (shared) {
+        AbortTransaction(txn, AbortReason::LOCK_SHARED_ON_READ_UNCOMMITTED);
+      }
+      if (shrinking) {
+        AbortTransaction(txn, AbortReason::LOCK_ON_SHRINKING);
+      }
+      break;
+    case IsolationLevel::READ_COMMITTED:
+      if (shrinking && lock_mode != LockMode::SHARED && lock_mode != LockMode::INTENTION_SHARED) {
+        AbortTransaction(txn, AbortReason::LOCK_ON_SHRINKING);
+      }
+      break;
+    case IsolationLevel::REPEATABLE_READ:
+    case IsolationLevel::SNAPSHOT_ISOLATION:
+      if (shrinking) {
+        AbortTransaction(txn, AbortReason::LOCK_ON_SHRINKING);
+      }
+      break;
+  }
+}
+
+auto LockManager::RowShardOf(const RID &rid) -> RowLockShard & {
+  // Fibonacci hashing: the high bits of the product depend on both the page id and the slot number.
+  auto hash = static_cast<uint64_t>(rid.Get()) * 0x9E3779B97F4A7C15ULL;
+  return row_lock_shards_[(hash >> 32) % LOCK_MANAGER_ROW_SHARDS];
+}
+
+auto LockManager::IsGrantable(const LockRequestQueue &queue, const LockRequest *request) -> bool {
+  // Granted requests come first, so the requests are granted in FIFO order: a request waits for all those ahead of it.
+  for (const auto *other : queue.request_queue_) {
+    if (other == request) {
+      return true;
+    }
+    if (!other->granted_ || !AreLocksCompatible(other->lock_mode_, request->lock_mode_)) {
+      return false;
+    }
+  }
+  UNREACHABLE("the request is not in the queue");
+}
 
-auto LockManager::UnlockTable(Transaction *txn, const table_oid_t &oid) -> bool { return true; }
+auto LockManager::AcquireLock(Transaction *txn, const std::shared_ptr<LockRequestQueue> &queue,
+                              std::unique_lock<std::mutex> *queue_latch, std::unique_ptr<LockRequest> request) -> bool {
+  const auto txn_id = txn->GetTransactionId();
+  auto &requests = queue->request_queue_;
+  auto held = std::find_if(requests.begin(), requests.end(),
+                           [txn_id](const LockRequest *other) { return other->txn_id_ == txn_id; });
+  if (held != requests.end()) {
+    if ((*held)->lock_mode_ == request->lock_mode_) {
+      return true;
+    }
+    if (queue->upgrading_ != INVALID_TXN_ID) {
+      AbortTransaction(txn, AbortReason::UPGRADE_CONFLICT);
+    }
+    if (!CanUpgrade((*held)->lock_mode_, request->lock_mode_)) {
+      AbortTransaction(txn, AbortReason::INCOMPATIBLE_UPGRADE);
+    }
+    // The upgrade releases the lock held and is queued ahead of every waiting request.
+    BookKeep(txn, **held, false);
+    delete *held;
+    requests.erase(held);
+    auto first_waiting =
+        std::find_if(requests.begin(), requests.end(), [](const LockRequest *other) { return !other->granted_; });
+    requests.insert(first_waiting, request.get());
+    queue->upgrading_ = txn_id;
+    // The waiting requests now also wait for the upgrade.
+    queue->cv_.notify_all();
+  } else {
+    requests.push_back(request.get());
+  }
+  auto *queued = request.release();
+
+  bool waited = false;
+  while (txn->GetState() != TransactionState::ABORTED && !IsGrantable(*queue, queued)) {
+    waited = true;
+    auto wounded = Wait(txn, queue, queued);
+    if (!wounded.empty()) {
+      queue_latch->unlock();
+      WakeUp(wounded);
+      queue_latch->lock();
+      continue;
+    }
+    if (txn->GetState() == TransactionState::ABORTED) {
+      break;
+    }
+    queue->cv_.wait(*queue_latch);
+  }
+  // The transaction leaves the waits-for graph before its state is checked, so that it cannot be chosen as a victim
+  // once it is granted the lock.
+  if (waited) {
+    StopWaiting(txn_id);
+  }
+  if (queue->upgrading_ == txn_id) {
+    queue->upgrading_ = INVALID_TXN_ID;
+  }
+  if (txn->GetState() == TransactionState::ABORTED) {
+    requests.remove(queued);
+    delete queued;
+    queue->cv_.notify_all();
+    return false;
+  }
+  queued->granted_ = true;
+  BookKeep(txn, *queued, true);
+  txn->AddDependencyLSN(queue->release_lsn_);
+  // Compatible requests queued right behind this one can be granted along with it.
+  auto next = std::next(std::find(requests.begin(), requests.end(), queued));
+  if (next != requests.end() && !(*next)->granted_) {
+    queue->cv_.notify_all();
+  }
+  return true;
+}
+
+auto LockManager::ReleaseLock(Transaction *txn, LockRequestQueue *queue) -> std::optional<LockMode> {
+  const auto txn_id = txn->GetTransactionId();
+  auto &requests = queue->request_queue_;
+  auto held = std::find_if(requests.begin(), requests.end(), [txn_id](const LockRequest *other) {
+    return other->txn_id_ == txn_id && other->granted_;
+  });
+  if (held == requests.end()) {
+    return std::nullopt;
+  }
+  auto lock_mode = (*held)->lock_mode_;
+  BookKeep(txn, **held, false);
+  delete *held;
+  requests.erase(held);
+  if (lock_mode != LockMode::SHARED && lock_mode != LockMode::INTENTION_SHARED) {
+    queue->release_lsn_ = std::max(queue->release_lsn_, txn->GetDependencyLSN());
+  }
+  if (std::any_of(requests.begin(), requests.end(), [](const LockRequest *other) { return !other->granted_; })) {
+    {
+      // The waiting requests do not wait for this transaction anymore.
+      std::lock_guard<std::mutex> guard(waits_for_latch_);
+      for (const auto *other : requests) {
+        if (auto it = waits_for_.find(other->txn_id_); !other->granted_ && it != waits_for_.end()) {
+          it->second.erase(txn_id);
+        }
+      }
+    }
+    queue->cv_.notify_all();
+  }
+  return lock_mode;
+}
+
+auto LockManager::ReleaseRowLock(Transaction *txn, const RID &rid) -> std::optional<LockMode> {
+  auto &shard = RowShardOf(rid);
+  std::lock_guard<std::mutex> shard_latch(shard.latch_);
+  auto it = shard.row_lock_map_.find(rid);
+  if (it == shard.row_lock_map_.end()) {
+    return std::nullopt;
+  }
+  auto queue = it->second;
+  std::unique_lock<std::mutex> queue_latch(queue->latch_);
+  auto lock_mode = ReleaseLock(txn, queue.get());
+  // Drop the queues of unlocked rows, so that the row lock table only holds the rows that are locked.
+  if (queue->request_queue_.empty()) {
+    shard.dropped_release_lsn_ = std::max(shard.dropped_release_lsn_, queue->release_lsn_);
+    shard.row_lock_map_.erase(it);
+  }
+  queue_latch.unlock();
+  return lock_mode;
+}
+
+auto LockManager::IsRowLockCovered(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool {
+  return txn->IsTableExclusiveLocked(oid) ||
+         (lock_mode == LockMode::SHARED &&
+          (txn->IsTableSharedLocked(oid) || txn->IsTableSharedIntentionExclusiveLocked(oid)));
+}
+
+auto LockManager::IsEscalated(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool {
+  const auto &escalated_table_set = *txn->GetEscalatedTableSet();
+  return escalated_table_set.find(oid) != escalated_table_set.end() && IsRowLockCovered(txn, lock_mode, oid);
+}
+
+auto LockManager::TryUpgradeTableLock(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool {
+  std::unique_lock<std::mutex> map_latch(table_lock_map_latch_);
+  auto it = table_lock_map_.find(oid);
+  if (it == table_lock_map_.end()) {
+    return false;
+  }
+  auto queue = it->second;
+  std::unique_lock<std::mutex> queue_latch(queue->latch_);
+  map_latch.unlock();
+  if (queue->upgrading_ != INVALID_TXN_ID) {
+    return false;
+  }
+  LockRequest *held = nullptr;
+  for (auto *request : queue->request_queue_) {
+    if (!request->granted_) {
+      break;
+    }
+    if (request->txn_id_ == txn->GetTransactionId()) {
+      held = request;
+    } else if (!AreLocksCompatible(request->lock_mode_, lock_mode)) {
+      return false;
+    }
+  }
+  if (held == nullptr || !CanUpgrade(held->lock_mode_, lock_mode)) {
+    return false;
+  }
+  // The request stays granted in place: only the requests waiting behind it could conflict with the stronger mode.
+  BookKeep(txn, *held, false);
+  held->lock_mode_ = lock_mode;
+  BookKeep(txn, *held, true);
+  return true;
+}
+
+void LockManager::EscalateRowLocks(Transaction *txn, const table_oid_t &oid) {
+  std::vector<RID> rids;
+  bool exclusive = false;
+  txn->LockTxn();
+  for (const auto &row_lock_set : {txn->GetSharedRowLockSet(), txn->GetExclusiveRowLockSet()}) {
+    if (auto it = row_lock_set->find(oid); it != row_lock_set->end()) {
+      rids.insert(rids.end(), it->second.begin(), it->second.end());
+      exclusive = exclusive || (row_lock_set == txn->GetExclusiveRowLockSet() && !it->second.empty());
+    }
+  }
+  txn->UnlockTxn();
+
+  // X rows need an X table lock, S rows an S one, or SIX to keep the IX held for the rows to be X-locked later on.
+  if (!IsRowLockCovered(txn, exclusive ? LockMode::EXCLUSIVE : LockMode::SHARED, oid)) {
+    auto lock_mode = LockMode::SHARED;
+    if (exclusive) {
+      lock_mode = LockMode::EXCLUSIVE;
+    } else if (txn->IsTableIntentionExclusiveLocked(oid)) {
+      lock_mode = LockMode::SHARED_INTENTION_EXCLUSIVE;
+    }
+    if (!TryUpgradeTableLock(txn, lock_mode, oid)) {
+      return;
+    }
+  }
+  txn->LockTxn();
+  txn->GetEscalatedTableSet()->insert(oid);
+  txn->UnlockTxn();
+  // Releasing the row locks does not end the growing phase: the table lock still covers the rows.
+  for (const auto &rid : rids) {
+    ReleaseRowLock(txn, rid);
+  }
+}
+
+void LockManager::UpdateStateOnUnlock(Transaction *txn, LockMode lock_mode) {
+  if (txn->GetState() != TransactionState::GROWING) {
+    return;
+  }
+  if (lock_mode == LockMode::EXCLUSIVE ||
+      (lock_mode == LockMode::SHARED && (txn->GetIsolationLevel() == IsolationLevel::REPEATABLE_READ ||
+                                         txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION))) {
+    txn->SetState(TransactionState::SHRINKING);
+  }
+}
+
+void LockManager::BookKeep(Transaction *txn, const LockRequest &request, bool granted) {
+  txn->LockTxn();
+  if (request.is_key_lock_) {
+    auto key_lock_set =
+        request.lock_mode_ == LockMode::SHARED ? txn->GetSharedKeyLockSet() : txn->GetExclusiveKeyLockSet();
+    if (granted) {
+      (*key_lock_set)[request.oid_].insert(request.key_);
+    } else if (auto it = key_lock_set->find(request.oid_); it != key_lock_set->end()) {
+      it->second.erase(request.key_);
+      if (it->second.empty()) {
+        key_lock_set->erase(it);
+      }
+    }
+  } else if (request.rid_.GetPageId() == INVALID_PAGE_ID) {
+    auto lock_set = TableLockSet(txn, request.lock_mode_);
+    if (granted) {
+      lock_set->insert(request.oid_);
+    } else {
+      lock_set->erase(request.oid_);
+    }
+  } else {
+    auto row_lock_set =
+        request.lock_mode_ == LockMode::SHARED ? txn->GetSharedRowLockSet() : txn->GetExclusiveRowLockSet();
+    if (granted) {
+      (*row_lock_set)[request.oid_].insert(request.rid_);
+    } else if (auto it = row_lock_set->find(request.oid_); it != row_lock_set->end()) {
+      it->second.erase(request.rid_);
+      if (it->second.empty()) {
+        row_lock_set->erase(it);
+      }
+    }
+  }
+  txn->UnlockTxn();
+}
+
+auto LockManager::LockTable(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool {
+  if (txn->IsOptimistic()) {
+    return true;
+  }
+  CheckLockAllowed(txn, lock_mode);
+  std::unique_lock<std::mutex> map_latch(table_lock_map_latch_);
+  auto &slot = table_lock_map_[oid];
+  if (slot == nullptr) {
+    slot = std::make_shared<LockRequestQueue>();
+  }
+  auto queue = slot;
+  std::unique_lock<std::mutex> queue_latch(queue->latch_);
+  map_latch.unlock();
+  return AcquireLock(txn, queue, &queue_latch,
+                     std::make_unique<LockRequest>(txn->GetTransactionId(), lock_mode, oid));
+}
+
+auto LockManager::UnlockTable(Transaction *txn, const table_oid_t &oid) -> bool {
+  if (txn->IsOptimistic()) {
+    return true;
+  }
+  std::unique_lock<std::mutex> map_latch(table_lock_map_latch_);
+  auto it = table_lock_map_.find(oid);
+  if (it == table_lock_map_.end()) {
+    AbortTransaction(txn, AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD);
+  }
+  auto queue = it->second;
+  std::unique_lock<std::mutex> queue_latch(queue->latch_);
+  map_latch.unlock();
+  if (HoldsRowLocks(txn, oid)) {
+    AbortTransaction(txn, AbortReason::TABLE_UNLOCKED_BEFORE_UNLOCKING_ROWS);
+  }
+  auto lock_mode = ReleaseLock(txn, queue.get());
+  if (!lock_mode.has_value()) {
+    AbortTransaction(txn, AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD);
+  }
+  queue_latch.unlock();
+  txn->LockTxn();
+  txn->GetEscalatedTableSet()->erase(oid);
+  txn->UnlockTxn();
+  UpdateStateOnUnlock(txn, *lock_mode);
+  return true;
+}
 
 auto LockManager::LockRow(Transaction *txn, LockMode lock_mode, const table_oid_t &oid, const RID &rid) -> bool {
+  if (txn->IsOptimistic()) {
+    return true;
+  }
+  if (lock_mode != LockMode::SHARED && lock_mode != LockMode::EXCLUSIVE) {
+    AbortTransaction(txn, AbortReason::ATTEMPTED_INTENTION_LOCK_ON_ROW);
+  }
+  CheckLockAllowed(txn, lock_mode);
+  const bool table_locked =
+      txn->IsTableExclusiveLocked(oid) || txn->IsTableIntentionExclusiveLocked(oid) ||
+      txn->IsTableSharedIntentionExclusiveLocked(oid) ||
+      (lock_mode == LockMode::SHARED && (txn->IsTableSharedLocked(oid) || txn->IsTableIntentionSharedLocked(oid)));
+  if (!table_locked) {
+    AbortTransaction(txn, AbortReason::TABLE_LOCK_NOT_PRESENT);
+  }
+
+  if (IsEscalated(txn, lock_mode, oid)) {
+    return true;
+  }
+
+  auto &shard = RowShardOf(rid);
+  std::unique_lock<std::mutex> shard_latch(shard.latch_);
+  auto &slot = shard.row_lock_map_[rid];
+  if (slot == nullptr) {
+    slot = std::make_shared<LockRequestQueue>();
+    slot->release_lsn_ = shard.dropped_release_lsn_;
+  }
+  auto queue = slot;
+  // The queue is latched before the shard is released, so that an unlock cannot drop it from the shard meanwhile.
+  std::unique_lock<std::mutex> queue_latch(queue->latch_);
+  shard_latch.unlock();
+  if (!AcquireLock(txn, queue, &queue_latch,
+                   std::make_unique<LockRequest>(txn->GetTransactionId(), lock_mode, oid, rid))) {
+    return false;
+  }
+  queue_latch.unlock();
+
+  if (auto threshold = escalation_threshold_.load(); threshold != 0) {
+    size_t row_lock_cnt = 0;
+    txn->LockTxn();
+    for (const auto &row_lock_set : {txn->GetSharedRowLockSet(), txn->GetExclusiveRowLockSet()}) {
+      if (auto it = row_lock_set->find(oid); it != row_lock_set->end()) {
+        row_lock_cnt += it->second.size();
+      }
+    }
+    txn->UnlockTxn();
+    if (row_lock_cnt % threshold == 0) {
+      EscalateRowLocks(txn, oid);
+    }
+  }
+  return true;
+}
+
+auto LockManager::UnlockRow(Transaction *txn, const table_oid_t &oid, const RID &rid) -> bool {
+  if (txn->IsOptimistic()) {
+    return true;
+  }
+  auto lock_mode = ReleaseRowLock(txn, rid);
+  if (!lock_mode.has_value()) {
+    // The rows of an escalated table are not locked individually.
+    if (IsEscalated(txn, LockMode::SHARED, oid)) {
+      return true;
+    }
+    AbortTransaction(txn, AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD);
+  }
+  UpdateStateOnUnlock(txn, *lock_mode);
+  return true;
+}
+
+auto LockManager::KeyLockOf(const char *key, size_t size) -> uint64_t {
+  auto hash = static_cast<uint64_t>(std::hash<std::string_view>()(std::string_view(key, size)));
+  return hash == KEY_LOCK_SUPREMUM ? hash - 1 : hash;
+}
+
+auto LockManager::LockKey(Transaction *txn, LockMode lock_mode, const index_oid_t &index_oid, uint64_t key) -> bool {
+  if (txn->IsOptimistic()) {
+    return true;
+  }
+  if (lock_mode != LockMode::SHARED && lock_mode != LockMode::EXCLUSIVE) {
+    AbortTransaction(txn, AbortReason::ATTEMPTED_INTENTION_LOCK_ON_ROW);
+  }
+  if (lock_mode == LockMode::SHARED && txn->IsKeyExclusiveLocked(index_oid, key)) {
+    return true;
+  }
+  CheckLockAllowed(txn, lock_mode);
+
+  std::unique_lock<std::mutex> map_latch(key_lock_map_latch_);
+  auto &slot = key_lock_map_[KeyLockId{index_oid, key}];
+  if (slot == nullptr) {
+    slot = std::make_shared<LockRequestQueue>();
+    slot->release_lsn_ = dropped_key_release_lsn_;
+  }
+  auto queue = slot;
+  std::unique_lock<std::mutex> queue_latch(queue->latch_);
+  map_latch.unlock();
+  return AcquireLock(txn, queue, &queue_latch,
+                     std::make_unique<LockRequest>(txn->GetTransactionId(), lock_mode, index_oid, key));
+}
+
+auto LockManager::UnlockKey(Transaction *txn, const index_oid_t &index_oid, uint64_t key) -> bool {
+  if (txn->IsOptimistic()) {
+    return true;
+  }
+  std::unique_lock<std::mutex> map_latch(key_lock_map_latch_);
+  auto it = key_lock_map_.find(KeyLockId{index_oid, key});
+  if (it == key_lock_map_.end()) {
+    AbortTransaction(txn, AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD);
+  }
+  auto queue = it->second;
+  std::unique_lock<std::mutex> queue_latch(queue->latch_);
+  if (!ReleaseLock(txn, queue.get()).has_value()) {
+    AbortTransaction(txn, AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD);
+  }
+  if (queue->request_queue_.empty()) {
+    dropped_key_release_lsn_ = std::max(dropped_key_release_lsn_, queue->release_lsn_);
+    key_lock_map_.erase(it);
+  }
   return true;
 }
 
-auto LockManager::UnlockRow(Transaction *txn, const table_oid_t &oid, const RID &rid) -> bool { return true; }
+auto LockManager::Wait(Transaction *txn, const std::shared_ptr<LockRequestQueue> &queue, const LockRequest *request)
+    -> std::vector<std::shared_ptr<LockRequestQueue>> {
+  const auto txn_id = txn->GetTransactionId();
+  std::set<txn_id_t> blockers;
+  for (const auto *other : queue->request_queue_) {
+    if (other == request) {
+      break;
+    }
+    if (!other->granted_ || !AreLocksCompatible(other->lock_mode_, request->lock_mode_)) {
+      blockers.insert(other->txn_id_);
+    }
+  }
 
-void LockManager::AddEdge(txn_id_t t1, txn_id_t t2) {}
+  std::vector<std::shared_ptr<LockRequestQueue>> wounded;
+  std::lock_guard<std::mutex> guard(waits_for_latch_);
+  // The detection thread may have chosen the transaction as a victim since its state was last checked.
+  if (txn->GetState() == TransactionState::ABORTED) {
+    return wounded;
+  }
+  waiters_.insert_or_assign(txn_id, Waiter{txn, queue});
+  switch (deadlock_policy_.load()) {
+    case DeadlockPolicy::DETECTION: {
+      auto &edges = waits_for_[txn_id];
+      if (edges != blockers) {
+        edges = std::move(blockers);
+        changed_waiters_.emplace_back(txn_id, std::chrono::steady_clock::now());
+        detection_cv_.notify_one();
+      }
+      break;
+    }
+    case DeadlockPolicy::WAIT_DIE:
+      if (!blockers.empty() && *blockers.begin() < txn_id) {
+        txn->SetState(TransactionState::ABORTED);
+        deadlock_stats_.aborted_txn_cnt_++;
+      }
+      break;
+    case DeadlockPolicy::WOUND_WAIT:
+      for (auto it = blockers.upper_bound(txn_id); it != blockers.end(); ++it) {
+        auto *blocker = TransactionManager::GetTransaction(*it);
+        if (blocker->GetState() != TransactionState::GROWING && blocker->GetState() != TransactionState::SHRINKING) {
+          continue;
+        }
+        blocker->SetState(TransactionState::ABORTED);
+        deadlock_stats_.aborted_txn_cnt_++;
+        if (auto waiter = waiters_.find(*it); waiter != waiters_.end()) {
+          wounded.push_back(waiter->second.queue_);
+        }
+      }
+      break;
+  }
+  return wounded;
+}
 
-void LockManager::RemoveEdge(txn_id_t t1, txn_id_t t2) {}
+void LockManager::StopWaiting(txn_id_t txn_id) {
+  std::lock_guard<std::mutex> guard(waits_for_latch_);
+  waiters_.erase(txn_id);
+  waits_for_.erase(txn_id);
+}
 
-auto LockManager::HasCycle(txn_id_t *txn_id) -> bool { return false; }
+auto LockManager::FindCycle(txn_id_t txn_id, std::vector<txn_id_t> *cycle) -> bool {
+  std::unordered_set<txn_id_t> visited{txn_id};
+  std::function<bool(txn_id_t)> visit = [&](txn_id_t from) {
+    cycle->push_back(from);
+    if (auto it = waits_for_.find(from); it != waits_for_.end()) {
+      for (auto to : it->second) {
+        if (to == txn_id || (visited.insert(to).second && visit(to))) {
+          return true;
+        }
+      }
+    }
+    cycle->pop_back();
+    return false;
+  };
+  return visit(txn_id);
+}
+
+void LockManager::WakeUp(const std::vector<std::shared_ptr<LockRequestQueue>> &queues) {
+  for (const auto &queue : queues) {
+    std::lock_guard<std::mutex> guard(queue->latch_);
+    queue->cv_.notify_all();
+  }
+}
+
+void LockManager::AddEdge(txn_id_t t1, txn_id_t t2) {
+  std::lock_guard<std::mutex> guard(waits_for_latch_);
+  waits_for_[t1].insert(t2);
+}
+
+void LockManager::RemoveEdge(txn_id_t t1, txn_id_t t2) {
+  std::lock_guard<std::mutex> guard(waits_for_latch_);
+  if (auto it = waits_for_.find(t1); it != waits_for_.end()) {
+    it->second.erase(t2);
+  }
+}
+
+auto LockManager::HasCycle(txn_id_t *txn_id) -> bool {
+  std::lock_guard<std::mutex> guard(waits_for_latch_);
+  std::set<txn_id_t> txn_ids;
+  for (const auto &[from, edges] : waits_for_) {
+    txn_ids.insert(from);
+  }
+  // Every cycle goes through some waiting transaction, so trying them all in ascending order finds the first one.
+  for (auto from : txn_ids) {
+    std::vector<txn_id_t> cycle;
+    if (FindCycle(from, &cycle)) {
+      *txn_id = *std::max_element(cycle.begin(), cycle.end());
+      return true;
+    }
+  }
+  return false;
+}
 
 auto LockManager::GetEdgeList() -> std::vector<std::pair<txn_id_t, txn_id_t>> {
-  std::vector<std::pair<txn_id_t, txn_id_t>> edges(0);
+  std::lock_guard<std::mutex> guard(waits_for_latch_);
+  std::vector<std::pair<txn_id_t, txn_id_t>> edges;
+  for (const auto &[from, tos] : waits_for_) {
+    for (auto to : tos) {
+      edges.emplace_back(from, to);
+    }
+  }
   return edges;
 }
 
+auto LockManager::GetDeadlockStats() -> DeadlockStats {
+  std::lock_guard<std::mutex> guard(waits_for_latch_);
+  return deadlock_stats_;
+}
+
 void LockManager::RunCycleDetection() {
+  std::unique_lock<std::mutex> guard(waits_for_latch_);
   while (enable_cycle_detection_) {
-    std::this_thread::sleep_for(cycle_detection_interval);
-    {  // TODO(students): detect deadlock
+    detection_cv_.wait_for(guard, cycle_detection_interval,
+                           [&] { return !enable_cycle_detection_ || !changed_waiters_.empty(); });
+    // A cycle formed since the last pass goes through a transaction whose edges changed meanwhile, maybe several ones.
+    std::vector<std::shared_ptr<LockRequestQueue>> victims;
+    auto changed_waiters = std::move(changed_waiters_);
+    changed_waiters_.clear();
+    for (const auto &[txn_id, changed_at] : changed_waiters) {
+      std::vector<txn_id_t> cycle;
+      while (waiters_.count(txn_id) > 0 && FindCycle(txn_id, &cycle)) {
+        auto victim_id = *std::max_element(cycle.begin(), cycle.end());
+        cycle.clear();
+        waits_for_.erase(victim_id);
+        auto victim = waiters_.find(victim_id);
+        if (victim == waiters_.end()) {
+          // An edge added through AddEdge rather than by a waiting request.
+          continue;
+        }
+        victim->second.txn_->SetState(TransactionState::ABORTED);
+        victims.push_back(victim->second.queue_);
+        waiters_.erase(victim);
+
+        auto latency =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - changed_at);
+        deadlock_stats_.aborted_txn_cnt_++;
+        deadlock_stats_.cycle_cnt_++;
+        deadlock_stats_.total_detection_latency_ += latency;
+        deadlock_stats_.max_detection_latency_ = std::max(deadlock_stats_.max_detection_latency_, latency);
+      }
+    }
+    if (!victims.empty()) {
+      guard.unlock();
+      WakeUp(victims);
+      guard.lock();
     }
   }
 }
@@ -12,24 +12,53 @@
 
 #include "concurrency/transaction_manager.h"
 
+#include <algorithm>
 #include <mutex>  // NOLINT
-#include <shared_mutex>
-#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "catalog/catalog.h"
+#include "concurrency/version_latch_table.h"
+#include "concurrency/version_store.h"
 #include "storage/table/table_heap.h"
 namespace bustub {
 
-std::unordered_map<txn_id_t, Transaction *> TransactionManager::txn_map = {};
-std::shared_mutex TransactionManager::txn_map_mutex = {};
+TransactionMap TransactionManager::txn_map = {};
+std::atomic<uint64_t> TransactionManager::next_instance_id = 0;
 
-auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level) -> Transaction * {
+namespace {
+/** The transaction ids a thread took from a transaction manager and has not handed out yet. */
+struct TxnIdBatch {
+  uint64_t instance_id_{0};
+  txn_id_t next_{0};
+  txn_id_t end_{0};
+};
+thread_local TxnIdBatch txn_id_batch;
+}  // namespace
+
+auto TransactionManager::NextTxnId() -> txn_id_t {
+  if (txn_id_batch.instance_id_ != instance_id_ || txn_id_batch.next_ == txn_id_batch.end_) {
+    auto first = next_txn_id_.fetch_add(TXN_ID_BATCH_SIZE, std::memory_order_relaxed);
+    txn_id_batch = {instance_id_, first, first + TXN_ID_BATCH_SIZE};
+  }
+  return txn_id_batch.next_++;
+}
+
+auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level,
+                               ConcurrencyControl concurrency_control) -> Transaction * {
   // Acquire the global transaction latch in shared mode.
   global_txn_latch_.RLock();
 
   if (txn == nullptr) {
-    txn = new Transaction(next_txn_id_++, isolation_level);
+    txn = new Transaction(NextTxnId(), isolation_level, concurrency_control);
+  }
+  if (VersionStore::IsSnapshotRead(txn)) {
+    // The snapshot joins the watermark along with taking its timestamp, before a garbage collection can pass it.
+    std::scoped_lock l(active_read_ts_latch_);
+    txn->SetReadTs(last_commit_ts_.load());
+    active_read_ts_.insert(txn->GetReadTs());
+  } else {
+    txn->SetReadTs(last_commit_ts_.load());
   }
 
   if (enable_logging) {
@@ -38,39 +67,78 @@ auto TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level)
     txn->SetPrevLSN(lsn);
   }
 
-  std::unique_lock<std::shared_mutex> l(txn_map_mutex);
-  txn_map[txn->GetTransactionId()] = txn;
+  txn_map.Insert(txn);
   return txn;
 }
 
 void TransactionManager::Commit(Transaction *txn) {
+  // An optimistic transaction keeps the version latches of the tuples it writes until its versions are stamped, so
+  // that no optimistic transaction validates a read of a write that is not committed yet.
+  std::vector<std::pair<TableHeap *, size_t>> version_latches;
+  if (txn->IsOptimistic() && !ValidateAndInstall(txn, &version_latches)) {
+    return;
+  }
   txn->SetState(TransactionState::COMMITTED);
 
-  // Perform all deletes before we commit.
+  if (enable_logging) {
+    LogRecord record = LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+    lsn_t lsn = log_manager_->AppendLogRecord(&record);
+    txn->SetPrevLSN(lsn);
+    // A read-only transaction has nothing of its own to make durable, only the writes it saw.
+    if (!txn->GetWriteSet()->empty() || !txn->GetIndexWriteSet()->empty()) {
+      txn->AddDependencyLSN(lsn);
+    }
+  }
+
+  // Stamp the versions written. Deletes are applied by the garbage collection, once no snapshot sees the tuples.
   auto write_set = txn->GetWriteSet();
-  while (!write_set->empty()) {
-    auto &item = write_set->back();
-    auto *table = item.table_;
-    if (item.wtype_ == WType::DELETE) {
-      // Note that this also releases the lock when holding the page latch.
-      table->ApplyDelete(item.rid_, txn);
+  if (!write_set->empty()) {
+    std::scoped_lock l(commit_latch_);
+    auto commit_ts = last_commit_ts_.load() + 1;
+    txn->SetCommitTs(commit_ts);
+    {
+      std::scoped_lock garbage_latch(garbage_latch_);
+      for (const auto &item : *write_set) {
+        item.table_->GetVersionStore()->Commit(item.rid_, txn, commit_ts);
+        garbage_.push_back(GarbageRecord{commit_ts, item.table_, item.rid_});
+      }
     }
-    write_set->pop_back();
+    last_commit_ts_.store(commit_ts);
   }
   write_set->clear();
+  ReleaseVersionLatches(version_latches, true);
+  EndSnapshot(txn);
+  GarbageCollect(txn);
 
-  // Release all the locks.
-  ReleaseLocks(txn);
+  // Release all the locks, before or after the commit is durable.
+  if (early_lock_release_) {
+    ReleaseLocks(txn);
+    WaitForDependency(txn);
+  } else {
+    WaitForDependency(txn);
+    ReleaseLocks(txn);
+  }
+  txn->ResetArena();
+  txn_map.Erase(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
 
+void TransactionManager::WaitForDependency(Transaction *txn) {
+  if (enable_logging && txn->GetDependencyLSN() != INVALID_LSN) {
+    log_manager_->WaitUntilPersistent(txn->GetDependencyLSN());
+  }
+}
+
 void TransactionManager::Abort(Transaction *txn) {
   txn->SetState(TransactionState::ABORTED);
+  // The buffered writes of an optimistic transaction were never applied.
+  txn->GetBufferedWriteSet()->clear();
+  txn->GetReadSet()->clear();
   // Rollback before releasing the lock.
   auto table_write_set = txn->GetWriteSet();
-  while (!table_write_set->empty()) {
-    auto &item = table_write_set->back();
+  for (auto it = table_write_set->rbegin(); it != table_write_set->rend(); ++it) {
+    auto &item = *it;
     auto *table = item.table_;
     if (item.wtype_ == WType::DELETE) {
       table->RollbackDelete(item.rid_, txn);
@@ -80,7 +148,10 @@ void TransactionManager::Abort(Transaction *txn) {
     } else if (item.wtype_ == WType::UPDATE) {
       table->UpdateTuple(item.tuple_, item.rid_, txn);
     }
-    table_write_set->pop_back();
+  }
+  // Only drop the versions once every page is rolled back, so that no snapshot reads a version of this transaction.
+  for (const auto &item : *table_write_set) {
+    item.table_->GetVersionStore()->Rollback(item.rid_, txn);
   }
   table_write_set->clear();
   // Rollback index updates
@@ -109,12 +180,104 @@ void TransactionManager::Abort(Transaction *txn) {
   table_write_set->clear();
   index_write_set->clear();
 
+  EndSnapshot(txn);
+  GarbageCollect(txn);
+
+  if (enable_logging) {
+    LogRecord record = LogRecord(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ABORT);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&record));
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
+  txn->ResetArena();
+  txn_map.Erase(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
 
+auto TransactionManager::ValidateAndInstall(Transaction *txn, std::vector<std::pair<TableHeap *, size_t>> *latches)
+    -> bool {
+  if (txn->GetState() == TransactionState::ABORTED) {
+    Abort(txn);
+    return false;
+  }
+  auto buffered_write_set = txn->GetBufferedWriteSet();
+  for (const auto &item : *buffered_write_set) {
+    latches->emplace_back(item.table_, VersionLatchTable::SlotOf(item.rid_));
+  }
+  // Lock in a global order, so that committing transactions never wait for each other in a cycle.
+  std::sort(latches->begin(), latches->end());
+  latches->erase(std::unique(latches->begin(), latches->end()), latches->end());
+  for (const auto &[table, slot] : *latches) {
+    table->GetVersionLatches()->Lock(slot);
+  }
+
+  // A read is valid if no write was installed since, nor is being installed by another transaction.
+  for (const auto &read : *txn->GetReadSet()) {
+    auto slot = VersionLatchTable::SlotOf(read.rid_);
+    auto version = read.table_->GetVersionLatches()->GetVersion(slot);
+    if ((version & ~static_cast<uint64_t>(1)) != read.version_ ||
+        (VersionLatchTable::IsLocked(version) &&
+         !std::binary_search(latches->begin(), latches->end(), std::make_pair(read.table_, slot)))) {
+      ReleaseVersionLatches(*latches, false);
+      Abort(txn);
+      return false;
+    }
+  }
+
+  // Install the writes in place, as a committing transaction does not buffer them. The table write set gets their
+  // undo records, so that the installed writes can be rolled back if one of them fails.
+  txn->SetState(TransactionState::COMMITTED);
+  for (const auto &item : *buffered_write_set) {
+    bool installed = item.wtype_ == WType::DELETE ? item.table_->MarkDelete(item.rid_, txn)
+                                                  : item.table_->UpdateTuple(item.tuple_, item.rid_, txn);
+    if (!installed || txn->GetState() == TransactionState::ABORTED) {
+      Abort(txn);
+      ReleaseVersionLatches(*latches, true);
+      return false;
+    }
+  }
+  buffered_write_set->clear();
+  txn->GetReadSet()->clear();
+  return true;
+}
+
+void TransactionManager::ReleaseVersionLatches(const std::vector<std::pair<TableHeap *, size_t>> &latches,
+                                               bool installed) {
+  for (const auto &[table, slot] : latches) {
+    table->GetVersionLatches()->Unlock(slot, installed);
+  }
+}
+
+void TransactionManager::EndSnapshot(Transaction *txn) {
+  if (VersionStore::IsSnapshotRead(txn)) {
+    // The snapshot leaves the watermark, so garbage collection may prune the versions only it could still see.
+    std::scoped_lock l(active_read_ts_latch_);
+    active_read_ts_.erase(active_read_ts_.find(txn->GetReadTs()));
+  }
+}
+
+auto TransactionManager::GetWatermark() -> timestamp_t {
+  std::scoped_lock l(active_read_ts_latch_);
+  return active_read_ts_.empty() ? last_commit_ts_.load() : *active_read_ts_.begin();
+}
+
+void TransactionManager::GarbageCollect(Transaction *txn) {
+  auto watermark = GetWatermark();
+  std::vector<GarbageRecord> collectable;
+  {
+    std::scoped_lock l(garbage_latch_);
+    while (!garbage_.empty() && garbage_.front().ts_ <= watermark) {
+      collectable.push_back(garbage_.front());
+      garbage_.pop_front();
+    }
+  }
+  for (const auto &record : collectable) {
+    record.table_->GarbageCollect(record.rid_, watermark, txn);
+  }
+}
+
 void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
 
 void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
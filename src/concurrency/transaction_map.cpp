@@ -0,0 +1,69 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// transaction_map.cpp
+//
+// Identification: src/concurrency/transaction_map.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "concurrency/transaction_map.h"
+
+#include <mutex>  // NOLINT
+
+#include "common/macros.h"
+#include "concurrency/transaction.h"
+
+namespace bustub {
+
+void TransactionMap::Insert(Transaction *txn) {
+  const auto txn_id = txn->GetTransactionId();
+  auto &slot = slots_[SlotOf(txn_id)];
+  auto *registered = slot.txn_.load(std::memory_order_acquire);
+  // A registration with the same id is stale: it was left by a transaction that never committed nor aborted, or by
+  // another transaction manager. Overwriting it is what a map would do.
+  if ((registered == nullptr || slot.txn_id_.load(std::memory_order_relaxed) == txn_id) &&
+      slot.txn_.compare_exchange_strong(registered, txn, std::memory_order_acq_rel)) {
+    slot.txn_id_.store(txn_id, std::memory_order_release);
+    return;
+  }
+  std::unique_lock l(overflow_latch_);
+  overflow_[txn_id] = txn;
+}
+
+void TransactionMap::Erase(Transaction *txn) {
+  const auto txn_id = txn->GetTransactionId();
+  auto &slot = slots_[SlotOf(txn_id)];
+  if (slot.txn_.load(std::memory_order_relaxed) == txn && slot.txn_id_.load(std::memory_order_relaxed) == txn_id) {
+    // The id goes first, so that a lookup that read the transaction of the next registration in the slot then reads
+    // another id when it checks the id again, see Get.
+    slot.txn_id_.store(INVALID_TXN_ID, std::memory_order_relaxed);
+    slot.txn_.store(nullptr, std::memory_order_release);
+    return;
+  }
+  std::unique_lock l(overflow_latch_);
+  if (auto it = overflow_.find(txn_id); it != overflow_.end() && it->second == txn) {
+    overflow_.erase(it);
+  }
+}
+
+auto TransactionMap::Get(txn_id_t txn_id) -> Transaction * {
+  auto &slot = slots_[SlotOf(txn_id)];
+  // The slot may be erased and reused between reading the id and reading the transaction, so the id is read again:
+  // the transaction read is the one of the id if the id did not change in between.
+  while (slot.txn_id_.load(std::memory_order_acquire) == txn_id) {
+    auto *txn = slot.txn_.load(std::memory_order_acquire);
+    if (slot.txn_id_.load(std::memory_order_relaxed) == txn_id) {
+      return txn;
+    }
+  }
+  std::shared_lock l(overflow_latch_);
+  auto it = overflow_.find(txn_id);
+  BUSTUB_ASSERT(it != overflow_.end(), "the transaction is not running");
+  return it->second;
+}
+
+}  // namespace bustub
@@ -0,0 +1,43 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// version_latch_table.cpp
+//
+// Identification: src/concurrency/version_latch_table.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "concurrency/version_latch_table.h"
+
+#include <thread>  // NOLINT
+
+namespace bustub {
+
+void VersionLatchTable::Lock(size_t slot) {
+  auto &latch = latches_[slot];
+  while (true) {
+    auto version = latch.load(std::memory_order_relaxed);
+    if (!IsLocked(version) && latch.compare_exchange_weak(version, version | 1, std::memory_order_acquire)) {
+      return;
+    }
+    // The holder is installing a few writes, so it is worth spinning, but not hogging the CPU it may be waiting for.
+    std::this_thread::yield();
+  }
+}
+
+void VersionLatchTable::Unlock(size_t slot, bool installed) {
+  auto &latch = latches_[slot];
+  auto version = latch.load(std::memory_order_relaxed) & ~static_cast<uint64_t>(1);
+  latch.store(installed ? version + 2 : version, std::memory_order_release);
+}
+
+void VersionLatchTable::Bump(const RID &rid) {
+  auto slot = SlotOf(rid);
+  Lock(slot);
+  Unlock(slot, true);
+}
+
+}  // namespace bustub
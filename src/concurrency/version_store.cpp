@@ -0,0 +1,151 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// version_store.cpp
+//
+// Identification: src/concurrency/version_store.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "concurrency/version_store.h"
+
+#include <mutex>  // NOLINT
+
+namespace bustub {
+
+auto VersionStore::CanWrite(const RID &rid, const Transaction *txn) const -> bool {
+  if (chain_count_.load() == 0) {
+    return true;
+  }
+  std::shared_lock<std::shared_mutex> l(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end() || it->second.writer_ == txn->GetTransactionId()) {
+    return true;
+  }
+  if (it->second.writer_ != INVALID_TXN_ID) {
+    return false;
+  }
+  return !IsSnapshotRead(txn) || it->second.ts_ <= txn->GetReadTs();
+}
+
+void VersionStore::AddVersion(const RID &rid, const Transaction *txn, const Tuple &old_tuple, bool is_delete) {
+  std::unique_lock<std::shared_mutex> l(latch_);
+  auto [it, inserted] = chains_.try_emplace(rid);
+  if (inserted) {
+    chain_count_++;
+  }
+  auto &chain = it->second;
+  if (chain.writer_ != txn->GetTransactionId()) {
+    // A tuple without a chain has been visible to every snapshot.
+    chain.undo_.push_front(UndoRecord{inserted ? 0 : chain.ts_, false, old_tuple});
+    chain.writer_ = txn->GetTransactionId();
+  }
+  chain.is_deleted_ = is_delete;
+}
+
+void VersionStore::AddInsert(const RID &rid, const Transaction *txn) {
+  std::unique_lock<std::shared_mutex> l(latch_);
+  auto [it, inserted] = chains_.try_emplace(rid);
+  if (inserted) {
+    chain_count_++;
+  }
+  auto &chain = it->second;
+  chain.writer_ = txn->GetTransactionId();
+  chain.is_deleted_ = false;
+  chain.undo_.clear();
+  chain.undo_.push_back(UndoRecord{0, true, Tuple{}});
+}
+
+auto VersionStore::GetVisibleVersion(const RID &rid, const Transaction *txn, Tuple *tuple, bool is_deleted) const
+    -> bool {
+  if (chain_count_.load() == 0) {
+    return !is_deleted;
+  }
+  std::shared_lock<std::shared_mutex> l(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end()) {
+    return !is_deleted;
+  }
+  const auto &chain = it->second;
+  const auto read_ts = txn->GetReadTs();
+  if (chain.writer_ == txn->GetTransactionId() || (chain.writer_ == INVALID_TXN_ID && chain.ts_ <= read_ts)) {
+    return !is_deleted;
+  }
+  for (const auto &undo : chain.undo_) {
+    if (undo.ts_ <= read_ts) {
+      if (undo.is_deleted_) {
+        return false;
+      }
+      *tuple = undo.tuple_;
+      return true;
+    }
+  }
+  return false;
+}
+
+void VersionStore::Commit(const RID &rid, const Transaction *txn, timestamp_t commit_ts) {
+  std::unique_lock<std::shared_mutex> l(latch_);
+  auto it = chains_.find(rid);
+  if (it != chains_.end() && it->second.writer_ == txn->GetTransactionId()) {
+    it->second.writer_ = INVALID_TXN_ID;
+    it->second.ts_ = commit_ts;
+  }
+}
+
+void VersionStore::Rollback(const RID &rid, const Transaction *txn) {
+  std::unique_lock<std::shared_mutex> l(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end() || it->second.writer_ != txn->GetTransactionId()) {
+    return;
+  }
+  auto &chain = it->second;
+  chain.ts_ = chain.undo_.front().ts_;
+  chain.is_deleted_ = chain.undo_.front().is_deleted_;
+  chain.undo_.pop_front();
+  chain.writer_ = INVALID_TXN_ID;
+  // The oldest version kept is visible to every running snapshot, see Prune.
+  if (chain.undo_.empty()) {
+    EraseChain(it);
+  }
+}
+
+auto VersionStore::Prune(const RID &rid, timestamp_t watermark) -> bool {
+  std::unique_lock<std::shared_mutex> l(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end()) {
+    return false;
+  }
+  auto &chain = it->second;
+  if (chain.writer_ == INVALID_TXN_ID && chain.ts_ <= watermark) {
+    bool is_deleted = chain.is_deleted_;
+    EraseChain(it);
+    return is_deleted;
+  }
+  // Every snapshot reads the first version at or before its read timestamp, so none reads past the first version at
+  // or before the watermark.
+  for (auto undo = chain.undo_.begin(); undo != chain.undo_.end(); ++undo) {
+    if (undo->ts_ <= watermark) {
+      chain.undo_.erase(undo + 1, chain.undo_.end());
+      break;
+    }
+  }
+  return false;
+}
+
+void VersionStore::Erase(const RID &rid) {
+  std::unique_lock<std::shared_mutex> l(latch_);
+  auto it = chains_.find(rid);
+  if (it != chains_.end()) {
+    EraseChain(it);
+  }
+}
+
+void VersionStore::EraseChain(std::unordered_map<RID, VersionChain>::iterator it) {
+  chains_.erase(it);
+  chain_count_--;
+}
+
+}  // namespace bustub
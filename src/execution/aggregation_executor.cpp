@@ -9,20 +9,378 @@
 // Copyright (c) 2015-2021, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <exception>
 #include <memory>
+#include <thread>  // NOLINT
 #include <vector>
 
 #include "execution/executors/aggregation_executor.h"
+#include "storage/page/tmp_tuple_page.h"
 
 namespace bustub {
 
+/** A bounded multi-consumer queue of tuple batches. Pop() returns `false` once the queue is closed and drained. */
+class AggregationExecutor::BatchQueue {
+ public:
+  explicit BatchQueue(size_t capacity) : capacity_(capacity) {}
+
+  void Push(std::vector<Tuple> &&batch) {
+    std::unique_lock<std::mutex> lock(latch_);
+    not_full_.wait(lock, [&] { return batches_.size() < capacity_; });
+    batches_.push_back(std::move(batch));
+    not_empty_.notify_one();
+  }
+
+  auto Pop(std::vector<Tuple> *batch) -> bool {
+    std::unique_lock<std::mutex> lock(latch_);
+    not_empty_.wait(lock, [&] { return !batches_.empty() || closed_; });
+    if (batches_.empty()) {
+      return false;
+    }
+    *batch = std::move(batches_.front());
+    batches_.pop_front();
+    not_full_.notify_one();
+    return true;
+  }
+
+  void Close() {
+    std::lock_guard<std::mutex> lock(latch_);
+    closed_ = true;
+    not_empty_.notify_all();
+  }
+
+ private:
+  size_t capacity_;
+  std::mutex latch_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+  std::deque<std::vector<Tuple>> batches_;
+  bool closed_{false};
+};
+
+namespace {
+
+/** Finalizer of MurmurHash3, spreading HashUtil's weak hashes over all bits before they pick slots or partitions. */
+auto MixHash(hash_t hash) -> hash_t {
+  hash ^= hash >> 33;
+  hash *= 0xff51afd7ed558ccdULL;
+  hash ^= hash >> 33;
+  hash *= 0xc4ceb9fe1a85ec53ULL;
+  hash ^= hash >> 33;
+  return hash;
+}
+
+/** @return `value` stored as the given column type, so that it can be serialized into a spill tuple */
+auto ToColumnType(const Value &value, TypeId type_id) -> Value {
+  if (value.IsNull()) {
+    return ValueFactory::GetNullValueByType(type_id);
+  }
+  return value.GetTypeId() == type_id ? value : value.CastAs(type_id);
+}
+
+}  // namespace
+
 AggregationExecutor::AggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
                                          std::unique_ptr<AbstractExecutor> &&child)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_(std::move(child)) {
+  std::vector<Column> columns;
+  auto add_column = [&columns](TypeId type_id) {
+    if (type_id == TypeId::VARCHAR) {
+      columns.emplace_back("<spill>", type_id, VARCHAR_DEFAULT_LENGTH);
+    } else {
+      columns.emplace_back("<spill>", type_id);
+    }
+  };
+  for (const auto &expr : plan_->GetGroupBys()) {
+    add_column(expr->GetReturnType());
+  }
+  for (uint32_t i = 0; i < plan_->GetAggregates().size(); i++) {
+    auto agg_type = plan_->GetAggregateTypes()[i];
+    add_column(agg_type == AggregationType::CountStarAggregate || agg_type == AggregationType::CountAggregate
+                   ? TypeId::INTEGER
+                   : plan_->GetAggregateAt(i)->GetReturnType());
+  }
+  spill_schema_ = std::make_unique<Schema>(columns);
+}
+
+void AggregationExecutor::Init() {
+  child_->Init();
+  for (auto &partition : partitions_) {
+    for (auto page_id : partition.spilled_pages_) {
+      exec_ctx_->GetBufferPoolManager()->DeletePage(page_id);
+    }
+  }
+  partitions_.clear();
+  partitions_.resize(AGGREGATION_PARTITIONS);
+  next_partition_ = 0;
+  wave_tables_.clear();
+  wave_table_idx_ = 0;
+  aht_iterator_.reset();
+  emitted_ = false;
+
+  PreAggregate();
+  if (exec_ctx_->IsProfiling()) {
+    auto *profile = exec_ctx_->GetOperatorProfile(plan_);
+    for (const auto &partition : partitions_) {
+      profile->spilled_pages_ += partition.spilled_pages_.size();
+    }
+  }
+}
+
+void AggregationExecutor::PreAggregate() {
+  BatchQueue queue(AGGREGATION_THREADS * 2);
+  std::vector<std::exception_ptr> errors(AGGREGATION_THREADS);
+  std::vector<std::thread> workers;
+  for (int i = 0; i < AGGREGATION_THREADS; i++) {
+    workers.emplace_back([&, i] {
+      try {
+        PreAggregateWorker(&queue);
+      } catch (...) {
+        errors[i] = std::current_exception();
+        // Keep draining so that the producer never blocks on a full queue.
+        std::vector<Tuple> batch;
+        while (queue.Pop(&batch)) {
+        }
+      }
+    });
+  }
+
+  std::exception_ptr producer_error;
+  try {
+    std::vector<Tuple> batch;
+    batch.reserve(AGGREGATION_BATCH_SIZE);
+    Tuple tuple{};
+    RID rid{};
+    while (child_->Next(&tuple, &rid)) {
+      batch.push_back(std::move(tuple));
+      if (batch.size() == AGGREGATION_BATCH_SIZE) {
+        queue.Push(std::move(batch));
+        batch = {};
+        batch.reserve(AGGREGATION_BATCH_SIZE);
+      }
+    }
+    if (!batch.empty()) {
+      queue.Push(std::move(batch));
+    }
+  } catch (...) {
+    producer_error = std::current_exception();
+  }
+  queue.Close();
+  for (auto &worker : workers) {
+    worker.join();
+  }
+
+  if (producer_error != nullptr) {
+    std::rethrow_exception(producer_error);
+  }
+  for (const auto &error : errors) {
+    if (error != nullptr) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+void AggregationExecutor::PreAggregateWorker(BatchQueue *queue) {
+  SimpleAggregationHashTable aggregator(plan_->GetAggregates(), plan_->GetAggregateTypes());
+  // Direct-mapped: a group lives in the slot picked by the low bits of its hash until another group evicts it.
+  std::vector<std::optional<PartialAggregate>> local(AGGREGATION_LOCAL_TABLE_SIZE);
+  std::vector<std::vector<PartialAggregate>> runs(AGGREGATION_PARTITIONS);
+  size_t buffered = 0;
+  const auto spill_threshold = exec_ctx_->GetAggregationSpillThreshold();
+
+  auto evict = [&](PartialAggregate &&partial) {
+    runs[PartitionOf(partial.hash_)].push_back(std::move(partial));
+    if (++buffered >= spill_threshold) {
+      FlushRuns(&runs, true);
+      buffered = 0;
+    }
+  };
+
+  std::vector<Tuple> batch;
+  while (queue->Pop(&batch)) {
+    for (const auto &tuple : batch) {
+      auto key = MakeAggregateKey(&tuple);
+      auto hash = MixHash(std::hash<AggregateKey>{}(key));
+      auto &slot = local[hash % AGGREGATION_LOCAL_TABLE_SIZE];
+      if (!slot.has_value() || slot->hash_ != hash || !(slot->key_ == key)) {
+        if (slot.has_value()) {
+          evict(std::move(*slot));
+        }
+        slot = PartialAggregate{hash, std::move(key), aggregator.GenerateInitialAggregateValue()};
+      }
+      aggregator.CombineAggregateValues(&slot->val_, MakeAggregateValue(&tuple));
+    }
+  }
+
+  for (auto &slot : local) {
+    if (slot.has_value()) {
+      runs[PartitionOf(slot->hash_)].push_back(std::move(*slot));
+    }
+  }
+  FlushRuns(&runs, false);
+}
+
+void AggregationExecutor::FlushRuns(std::vector<std::vector<PartialAggregate>> *runs, bool spill) {
+  for (size_t i = 0; i < runs->size(); i++) {
+    auto &run = (*runs)[i];
+    if (run.empty()) {
+      continue;
+    }
+    if (spill) {
+      std::vector<page_id_t> pages;
+      SpillRun(run, &pages);
+      std::lock_guard<std::mutex> lock(partitions_latch_);
+      auto &spilled_pages = partitions_[i].spilled_pages_;
+      spilled_pages.insert(spilled_pages.end(), pages.begin(), pages.end());
+    } else {
+      std::lock_guard<std::mutex> lock(partitions_latch_);
+      partitions_[i].runs_.push_back(std::move(run));
+    }
+    run = {};
+  }
+}
+
+void AggregationExecutor::SpillRun(const std::vector<PartialAggregate> &run, std::vector<page_id_t> *pages) {
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  const auto &columns = spill_schema_->GetColumns();
+  TmpTuplePage *page = nullptr;
+  page_id_t page_id = INVALID_PAGE_ID;
+
+  for (const auto &partial : run) {
+    std::vector<Value> values;
+    values.reserve(columns.size());
+    for (const auto &value : partial.key_.group_bys_) {
+      values.push_back(ToColumnType(value, columns[values.size()].GetType()));
+    }
+    for (const auto &value : partial.val_.aggregates_) {
+      values.push_back(ToColumnType(value, columns[values.size()].GetType()));
+    }
+    Tuple tuple(values, spill_schema_.get());
+
+    TmpTuple tmp_tuple(INVALID_PAGE_ID, 0);
+    if (page == nullptr || !page->Insert(tuple, &tmp_tuple)) {
+      if (page != nullptr) {
+        bpm->UnpinPage(page_id, true);
+      }
+      page = reinterpret_cast<TmpTuplePage *>(bpm->NewPage(&page_id));
+      if (page == nullptr) {
+        throw ExecutionException("aggregation: no free frame to spill partial aggregates");
+      }
+      page->Init(page_id, BUSTUB_PAGE_SIZE);
+      pages->push_back(page_id);
+      if (!page->Insert(tuple, &tmp_tuple)) {
+        bpm->UnpinPage(page_id, true);
+        throw ExecutionException("aggregation: group does not fit into a spill page");
+      }
+    }
+  }
+  if (page != nullptr) {
+    bpm->UnpinPage(page_id, true);
+  }
+}
+
+auto AggregationExecutor::MergeNextWave() -> bool {
+  wave_tables_.clear();
+  wave_table_idx_ = 0;
+  aht_iterator_.reset();
+  if (next_partition_ >= partitions_.size()) {
+    return false;
+  }
+
+  auto wave_size = std::min<size_t>(AGGREGATION_THREADS, partitions_.size() - next_partition_);
+  for (size_t i = 0; i < wave_size; i++) {
+    wave_tables_.emplace_back(plan_->GetAggregates(), plan_->GetAggregateTypes());
+  }
+  std::vector<std::exception_ptr> errors(wave_size);
+  std::vector<std::thread> mergers;
+  for (size_t i = 0; i < wave_size; i++) {
+    mergers.emplace_back([&, i] {
+      try {
+        MergePartition(&partitions_[next_partition_ + i], &wave_tables_[i]);
+      } catch (...) {
+        errors[i] = std::current_exception();
+      }
+    });
+  }
+  for (auto &merger : mergers) {
+    merger.join();
+  }
+  next_partition_ += wave_size;
+  for (const auto &error : errors) {
+    if (error != nullptr) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  aht_iterator_ = wave_tables_[0].Begin();
+  return true;
+}
+
+void AggregationExecutor::MergePartition(Partition *partition, SimpleAggregationHashTable *table) {
+  for (auto &run : partition->runs_) {
+    for (auto &partial : run) {
+      table->InsertMerge(std::move(partial.key_), std::move(partial.val_));
+    }
+  }
+  partition->runs_.clear();
+
+  auto *bpm = exec_ctx_->GetBufferPoolManager();
+  auto group_by_count = plan_->GetGroupBys().size();
+  auto column_count = spill_schema_->GetColumnCount();
+  for (auto page_id : partition->spilled_pages_) {
+    auto *page = reinterpret_cast<TmpTuplePage *>(bpm->FetchPage(page_id));
+    if (page == nullptr) {
+      throw ExecutionException("aggregation: no free frame to read back spilled partial aggregates");
+    }
+    for (size_t offset = page->GetFreeSpacePointer(); offset < BUSTUB_PAGE_SIZE; offset = page->NextOffset(offset)) {
+      Tuple tuple{};
+      page->Get(offset, &tuple);
+      AggregateKey key;
+      AggregateValue val;
+      for (uint32_t i = 0; i < column_count; i++) {
+        (i < group_by_count ? key.group_bys_ : val.aggregates_).push_back(tuple.GetValue(spill_schema_.get(), i));
+      }
+      table->InsertMerge(std::move(key), std::move(val));
+    }
+    bpm->UnpinPage(page_id, false);
+    bpm->DeletePage(page_id);
+  }
+  partition->spilled_pages_.clear();
+}
 
-void AggregationExecutor::Init() {}
+auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  while (true) {
+    if (aht_iterator_.has_value()) {
+      if (*aht_iterator_ != wave_tables_[wave_table_idx_].End()) {
+        std::vector<Value> values(aht_iterator_->Key().group_bys_);
+        const auto &aggregates = aht_iterator_->Val().aggregates_;
+        values.insert(values.end(), aggregates.begin(), aggregates.end());
+        *tuple = Tuple(values, &GetOutputSchema());
+        ++*aht_iterator_;
+        emitted_ = true;
+        return true;
+      }
+      if (++wave_table_idx_ < wave_tables_.size()) {
+        aht_iterator_ = wave_tables_[wave_table_idx_].Begin();
+        continue;
+      }
+    }
+    if (!MergeNextWave()) {
+      break;
+    }
+  }
 
-auto AggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  // An aggregation without GROUP BY produces exactly one row, even over empty input.
+  if (!emitted_ && plan_->GetGroupBys().empty()) {
+    SimpleAggregationHashTable aggregator(plan_->GetAggregates(), plan_->GetAggregateTypes());
+    *tuple = Tuple(aggregator.GenerateInitialAggregateValue().aggregates_, &GetOutputSchema());
+    emitted_ = true;
+    return true;
+  }
+  return false;
+}
 
 auto AggregationExecutor::GetChildExecutor() const -> const AbstractExecutor * { return child_.get(); }
 
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.cpp
+//
+// Identification: src/execution/bloom_filter.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/bloom_filter.h"
+
+#include <algorithm>
+#include <functional>
+#include <string_view>
+
+namespace bustub {
+
+namespace {
+
+/** Odd multipliers that derive the bit of each word of a block from the same 32-bit hash. */
+constexpr std::array<uint32_t, 8> SALTS = {0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+                                           0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U};
+
+/** Spread every bit of a hash over both halves, which select the block and the bits in it (MurmurHash3's finalizer). */
+auto Mix(hash_t hash) -> uint64_t {
+  auto h = static_cast<uint64_t>(hash);
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+}  // namespace
+
+auto RuntimeFilter::HashKey(const Value &key) -> hash_t {
+  switch (key.GetTypeId()) {
+    case TypeId::TINYINT:
+      return static_cast<hash_t>(key.GetAs<int8_t>());
+    case TypeId::SMALLINT:
+      return static_cast<hash_t>(key.GetAs<int16_t>());
+    case TypeId::INTEGER:
+      return static_cast<hash_t>(key.GetAs<int32_t>());
+    case TypeId::BIGINT:
+      return static_cast<hash_t>(key.GetAs<int64_t>());
+    case TypeId::VARCHAR:
+      return std::hash<std::string_view>{}(std::string_view(key.GetData(), key.GetLength()));
+    default:
+      return HashUtil::HashValue(&key);
+  }
+}
+
+BlockedBloomFilter::BlockedBloomFilter(size_t key_cnt, size_t bits_per_key)
+    : blocks_(std::max<size_t>(1, (key_cnt * bits_per_key + sizeof(Block) * 8 - 1) / (sizeof(Block) * 8))) {}
+
+auto BlockedBloomFilter::BlockOf(uint64_t hash) const -> size_t {
+  // Map the high half of the hash onto [0, blocks) without a division.
+  return static_cast<size_t>(((hash >> 32) * static_cast<uint64_t>(blocks_.size())) >> 32);
+}
+
+auto BlockedBloomFilter::MaskOf(uint64_t hash) -> Block {
+  auto low = static_cast<uint32_t>(hash);
+  Block mask;
+  for (size_t i = 0; i < BLOCK_WORDS; i++) {
+    mask[i] = 1U << ((low * SALTS[i]) >> 27);
+  }
+  return mask;
+}
+
+void BlockedBloomFilter::Insert(hash_t hash) {
+  auto mixed = Mix(hash);
+  auto &block = blocks_[BlockOf(mixed)];
+  auto mask = MaskOf(mixed);
+  for (size_t i = 0; i < BLOCK_WORDS; i++) {
+    block[i] |= mask[i];
+  }
+}
+
+auto BlockedBloomFilter::MayContain(hash_t hash) const -> bool {
+  auto mixed = Mix(hash);
+  const auto &block = blocks_[BlockOf(mixed)];
+  auto mask = MaskOf(mixed);
+  for (size_t i = 0; i < BLOCK_WORDS; i++) {
+    if ((block[i] & mask[i]) != mask[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -0,0 +1,539 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// expression_compiler.cpp
+//
+// Identification: src/execution/expression_compiler.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/expression_compiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "common/exception.h"
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "type/limits.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return whether values of the type are held in integer registers */
+auto IsIntegerType(TypeId type) -> bool {
+  switch (type) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+    case TypeId::SMALLINT:
+    case TypeId::INTEGER:
+    case TypeId::BIGINT:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/** @return a non-null integer-like value widened to 64 bits */
+auto IntegerOf(const Value &value) -> int64_t {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    default:
+      return value.GetAs<int64_t>();
+  }
+}
+
+/** Decode a fixed-size column stored as T, recognizing NULL by its sentinel. */
+template <typename T>
+void DecodeColumn(const std::vector<Tuple> &batch, uint32_t offset, T null_value, int64_t *values, uint8_t *nulls) {
+  for (size_t i = 0; i < batch.size(); i++) {
+    T value;
+    memcpy(&value, batch[i].GetData() + offset, sizeof(T));
+    values[i] = value;
+    nulls[i] = static_cast<uint8_t>(value == null_value);
+  }
+}
+
+/** Decode a fixed-size column stored as T of a single tuple into every row of a register. */
+template <typename T>
+void BroadcastColumn(const Tuple &tuple, uint32_t offset, T null_value, size_t n, int64_t *values, uint8_t *nulls) {
+  T value;
+  memcpy(&value, tuple.GetData() + offset, sizeof(T));
+  std::fill(values, values + n, static_cast<int64_t>(value));
+  std::fill(nulls, nulls + n, static_cast<uint8_t>(value == null_value));
+}
+
+template <typename T, typename Cmp>
+void CompareKernel(const T *lhs, const T *rhs, int64_t *out, size_t n, Cmp cmp) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = static_cast<int64_t>(cmp(lhs[i], rhs[i]));
+  }
+}
+
+template <typename T>
+void CompareKernel(ComparisonType comp_type, const T *lhs, const T *rhs, int64_t *out, size_t n) {
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      return CompareKernel(lhs, rhs, out, n, std::equal_to<T>());
+    case ComparisonType::NotEqual:
+      return CompareKernel(lhs, rhs, out, n, std::not_equal_to<T>());
+    case ComparisonType::LessThan:
+      return CompareKernel(lhs, rhs, out, n, std::less<T>());
+    case ComparisonType::LessThanOrEqual:
+      return CompareKernel(lhs, rhs, out, n, std::less_equal<T>());
+    case ComparisonType::GreaterThan:
+      return CompareKernel(lhs, rhs, out, n, std::greater<T>());
+    case ComparisonType::GreaterThanOrEqual:
+      return CompareKernel(lhs, rhs, out, n, std::greater_equal<T>());
+  }
+}
+
+void OrNulls(const uint8_t *lhs, const uint8_t *rhs, uint8_t *out, size_t n) {
+  for (size_t i = 0; i < n; i++) {
+    out[i] = lhs[i] | rhs[i];
+  }
+}
+
+}  // namespace
+
+auto CompiledExpression::Compile(const AbstractExpression &expr, const Schema &schema)
+    -> std::unique_ptr<CompiledExpression> {
+  // The constructor is private, so make_unique cannot be used.
+  std::unique_ptr<CompiledExpression> compiled(new CompiledExpression(schema));
+  auto result = compiled->Lower(expr);
+  if (!result.has_value()) {
+    return nullptr;
+  }
+  compiled->results_.push_back(result);
+  compiled->registers_.resize(compiled->program_.size());
+  return compiled;
+}
+
+auto CompiledExpression::CompileAll(const std::vector<AbstractExpressionRef> &exprs, const Schema &schema)
+    -> std::unique_ptr<CompiledExpression> {
+  std::unique_ptr<CompiledExpression> compiled(new CompiledExpression(schema));
+  bool any_compiled = false;
+  for (const auto &expr : exprs) {
+    compiled->results_.push_back(compiled->LowerOrRollBack(*expr));
+    any_compiled = any_compiled || compiled->results_.back().has_value();
+  }
+  if (!any_compiled) {
+    return nullptr;
+  }
+  compiled->registers_.resize(compiled->program_.size());
+  return compiled;
+}
+
+auto CompiledExpression::CompileJoin(const AbstractExpression &expr, const Schema &left_schema,
+                                     const Schema &right_schema) -> std::unique_ptr<CompiledExpression> {
+  std::unique_ptr<CompiledExpression> compiled(new CompiledExpression(left_schema, &right_schema));
+  auto result = compiled->Lower(expr);
+  if (!result.has_value() || result->type_ != TypeId::BOOLEAN) {
+    return nullptr;
+  }
+  compiled->results_.push_back(result);
+  compiled->registers_.resize(compiled->program_.size());
+  return compiled;
+}
+
+auto CompiledExpression::Emit(OpCode op, RegisterKind kind, TypeId type, uint32_t lhs, uint32_t rhs, uint32_t arg)
+    -> uint32_t {
+  // Value numbering: the operands are registers, so identical instructions compute identical values. This is how a
+  // column or a sub-expression referenced more than once is evaluated only once.
+  for (const auto &instr : program_) {
+    if (instr.op_ == op && instr.kind_ == kind && instr.type_ == type && instr.lhs_ == lhs && instr.rhs_ == rhs &&
+        instr.arg_ == arg) {
+      return instr.dst_;
+    }
+  }
+  auto dst = static_cast<uint32_t>(program_.size());
+  bool block_invariant;
+  switch (op) {
+    case OpCode::LoadColumn:
+    case OpCode::LoadConstant:
+      block_invariant = true;
+      break;
+    case OpCode::LoadRightColumn:
+      block_invariant = false;
+      break;
+    case OpCode::CastToDecimal:
+      block_invariant = program_[lhs].block_invariant_;
+      break;
+    default:
+      block_invariant = program_[lhs].block_invariant_ && program_[rhs].block_invariant_;
+  }
+  program_.push_back({op, kind, type, dst, lhs, rhs, arg, block_invariant});
+  return dst;
+}
+
+auto CompiledExpression::ToDecimal(const Operand &operand) -> Operand {
+  if (operand.kind_ == RegisterKind::Decimal) {
+    return operand;
+  }
+  auto reg = Emit(OpCode::CastToDecimal, RegisterKind::Integer, TypeId::DECIMAL, operand.reg_, 0, 0);
+  return {reg, RegisterKind::Decimal, TypeId::DECIMAL};
+}
+
+auto CompiledExpression::Lower(const AbstractExpression &expr) -> std::optional<Operand> {
+  if (const auto *column_expr = dynamic_cast<const ColumnValueExpression *>(&expr); column_expr != nullptr) {
+    // Only join predicates refer to a right tuple.
+    const auto *schema = column_expr->GetTupleIdx() == 0 ? &schema_
+                         : column_expr->GetTupleIdx() == 1 ? right_schema_
+                                                           : nullptr;
+    if (schema == nullptr || column_expr->GetColIdx() >= schema->GetColumnCount()) {
+      return std::nullopt;
+    }
+    auto type = schema->GetColumn(column_expr->GetColIdx()).GetType();
+    if (!IsIntegerType(type) && type != TypeId::DECIMAL) {
+      return std::nullopt;
+    }
+    auto kind = type == TypeId::DECIMAL ? RegisterKind::Decimal : RegisterKind::Integer;
+    auto op = column_expr->GetTupleIdx() == 0 ? OpCode::LoadColumn : OpCode::LoadRightColumn;
+    return Operand{Emit(op, kind, type, 0, 0, column_expr->GetColIdx()), kind, type};
+  }
+
+  const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(&expr);
+  const auto *parameter_expr = dynamic_cast<const ParameterValueExpression *>(&expr);
+  if (constant_expr != nullptr || parameter_expr != nullptr) {
+    // Executors are built for one execution, so a parameter is a constant for the program.
+    auto val = constant_expr != nullptr ? constant_expr->val_ : parameter_expr->GetValue();
+    auto type = val.GetTypeId();
+    if (!IsIntegerType(type) && type != TypeId::DECIMAL) {
+      return std::nullopt;
+    }
+    auto kind = type == TypeId::DECIMAL ? RegisterKind::Decimal : RegisterKind::Integer;
+    // Equal constants share their index, so that their loads are merged by Emit.
+    auto it = std::find_if(constants_.begin(), constants_.end(), [&](const Value &constant) {
+      return constant.GetTypeId() == type && constant.IsNull() == val.IsNull() &&
+             (val.IsNull() || constant.CompareEquals(val) == CmpBool::CmpTrue);
+    });
+    if (it == constants_.end()) {
+      it = constants_.insert(constants_.end(), val);
+    }
+    auto reg = Emit(OpCode::LoadConstant, kind, type, 0, 0, static_cast<uint32_t>(it - constants_.begin()));
+    return Operand{reg, kind, type};
+  }
+
+  if (expr.GetChildren().size() != 2) {
+    return std::nullopt;
+  }
+  auto lhs = Lower(*expr.GetChildAt(0));
+  if (!lhs.has_value()) {
+    return std::nullopt;
+  }
+  auto rhs = Lower(*expr.GetChildAt(1));
+  if (!rhs.has_value()) {
+    return std::nullopt;
+  }
+
+  if (const auto *arith_expr = dynamic_cast<const ArithmeticExpression *>(&expr); arith_expr != nullptr) {
+    auto op = arith_expr->compute_type_ == ArithmeticType::Plus ? OpCode::Add : OpCode::Subtract;
+    auto reg = Emit(op, RegisterKind::Integer, TypeId::INTEGER, lhs->reg_, rhs->reg_, 0);
+    return Operand{reg, RegisterKind::Integer, TypeId::INTEGER};
+  }
+
+  if (const auto *comp_expr = dynamic_cast<const ComparisonExpression *>(&expr); comp_expr != nullptr) {
+    if ((lhs->type_ == TypeId::BOOLEAN) != (rhs->type_ == TypeId::BOOLEAN)) {
+      // Booleans only compare with booleans.
+      return std::nullopt;
+    }
+    auto kind = RegisterKind::Integer;
+    if (lhs->kind_ == RegisterKind::Decimal || rhs->kind_ == RegisterKind::Decimal) {
+      lhs = ToDecimal(*lhs);
+      rhs = ToDecimal(*rhs);
+      kind = RegisterKind::Decimal;
+    }
+    auto op = static_cast<OpCode>(static_cast<int>(OpCode::Equal) + static_cast<int>(comp_expr->comp_type_));
+    auto reg = Emit(op, kind, TypeId::BOOLEAN, lhs->reg_, rhs->reg_, 0);
+    return Operand{reg, RegisterKind::Integer, TypeId::BOOLEAN};
+  }
+
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(&expr); logic_expr != nullptr) {
+    auto op = logic_expr->logic_type_ == LogicType::And ? OpCode::And : OpCode::Or;
+    auto reg = Emit(op, RegisterKind::Integer, TypeId::BOOLEAN, lhs->reg_, rhs->reg_, 0);
+    return Operand{reg, RegisterKind::Integer, TypeId::BOOLEAN};
+  }
+
+  return std::nullopt;
+}
+
+auto CompiledExpression::LowerOrRollBack(const AbstractExpression &expr) -> std::optional<Operand> {
+  // The instructions appended by a failed lowering come after all those of the expressions lowered before, so nothing
+  // refers to them.
+  auto program_size = program_.size();
+  auto constants_size = constants_.size();
+  auto result = Lower(expr);
+  if (!result.has_value()) {
+    program_.resize(program_size);
+    constants_.resize(constants_size);
+  }
+  return result;
+}
+
+void CompiledExpression::LoadColumn(const Instruction &instr, const std::vector<Tuple> &batch, Register *dst) {
+  auto offset = schema_.GetColumn(instr.arg_).GetOffset();
+  auto *values = dst->integers_.data();
+  auto *nulls = dst->nulls_.data();
+  switch (instr.type_) {
+    case TypeId::BOOLEAN:
+      return DecodeColumn<int8_t>(batch, offset, BUSTUB_BOOLEAN_NULL, values, nulls);
+    case TypeId::TINYINT:
+      return DecodeColumn<int8_t>(batch, offset, BUSTUB_INT8_NULL, values, nulls);
+    case TypeId::SMALLINT:
+      return DecodeColumn<int16_t>(batch, offset, BUSTUB_INT16_NULL, values, nulls);
+    case TypeId::INTEGER:
+      return DecodeColumn<int32_t>(batch, offset, BUSTUB_INT32_NULL, values, nulls);
+    case TypeId::BIGINT:
+      return DecodeColumn<int64_t>(batch, offset, BUSTUB_INT64_NULL, values, nulls);
+    case TypeId::DECIMAL:
+      for (size_t i = 0; i < batch.size(); i++) {
+        double value;
+        memcpy(&value, batch[i].GetData() + offset, sizeof(double));
+        dst->decimals_[i] = value;
+        nulls[i] = static_cast<uint8_t>(value == BUSTUB_DECIMAL_NULL);
+      }
+      return;
+    default:
+      UNREACHABLE("column type not supported by the expression compiler");
+  }
+}
+
+void CompiledExpression::LoadRightColumn(const Instruction &instr, size_t n, Register *dst) {
+  auto offset = right_schema_->GetColumn(instr.arg_).GetOffset();
+  auto *values = dst->integers_.data();
+  auto *nulls = dst->nulls_.data();
+  switch (instr.type_) {
+    case TypeId::BOOLEAN:
+      return BroadcastColumn<int8_t>(*right_tuple_, offset, BUSTUB_BOOLEAN_NULL, n, values, nulls);
+    case TypeId::TINYINT:
+      return BroadcastColumn<int8_t>(*right_tuple_, offset, BUSTUB_INT8_NULL, n, values, nulls);
+    case TypeId::SMALLINT:
+      return BroadcastColumn<int16_t>(*right_tuple_, offset, BUSTUB_INT16_NULL, n, values, nulls);
+    case TypeId::INTEGER:
+      return BroadcastColumn<int32_t>(*right_tuple_, offset, BUSTUB_INT32_NULL, n, values, nulls);
+    case TypeId::BIGINT:
+      return BroadcastColumn<int64_t>(*right_tuple_, offset, BUSTUB_INT64_NULL, n, values, nulls);
+    case TypeId::DECIMAL: {
+      double value;
+      memcpy(&value, right_tuple_->GetData() + offset, sizeof(double));
+      std::fill(dst->decimals_.begin(), dst->decimals_.begin() + n, value);
+      std::fill(nulls, nulls + n, static_cast<uint8_t>(value == BUSTUB_DECIMAL_NULL));
+      return;
+    }
+    default:
+      UNREACHABLE("column type not supported by the expression compiler");
+  }
+}
+
+void CompiledExpression::Run(const std::vector<Tuple> &batch) {
+  for (const auto &instr : program_) {
+    Execute(instr, batch);
+  }
+}
+
+void CompiledExpression::Execute(const Instruction &instr, const std::vector<Tuple> &batch) {
+  const auto n = batch.size();
+  auto &dst = registers_[instr.dst_];
+  dst.nulls_.resize(n);
+  if (instr.type_ == TypeId::DECIMAL) {
+    dst.decimals_.resize(n);
+  } else {
+    dst.integers_.resize(n);
+  }
+  const auto &lhs = registers_[instr.lhs_];
+  const auto &rhs = registers_[instr.rhs_];
+
+  switch (instr.op_) {
+    case OpCode::LoadColumn:
+      LoadColumn(instr, batch, &dst);
+      break;
+    case OpCode::LoadRightColumn:
+      LoadRightColumn(instr, n, &dst);
+      break;
+    case OpCode::LoadConstant: {
+      const auto &constant = constants_[instr.arg_];
+      auto is_null = static_cast<uint8_t>(constant.IsNull());
+      std::fill(dst.nulls_.begin(), dst.nulls_.end(), is_null);
+      if (instr.kind_ == RegisterKind::Decimal) {
+        std::fill(dst.decimals_.begin(), dst.decimals_.end(), is_null != 0 ? 0 : constant.GetAs<double>());
+        break;
+      }
+      std::fill(dst.integers_.begin(), dst.integers_.end(), is_null != 0 ? 0 : IntegerOf(constant));
+      break;
+    }
+    case OpCode::CastToDecimal:
+      for (size_t i = 0; i < n; i++) {
+        dst.decimals_[i] = static_cast<double>(lhs.integers_[i]);
+      }
+      dst.nulls_ = lhs.nulls_;
+      break;
+    case OpCode::Add:
+    case OpCode::Subtract: {
+      // ArithmeticExpression computes on INTEGER and wraps around; INT32_MIN is the INTEGER NULL sentinel.
+      const bool add = instr.op_ == OpCode::Add;
+      for (size_t i = 0; i < n; i++) {
+        auto l = static_cast<uint32_t>(lhs.integers_[i]);
+        auto r = static_cast<uint32_t>(rhs.integers_[i]);
+        auto res = static_cast<int32_t>(add ? l + r : l - r);
+        dst.integers_[i] = res;
+        dst.nulls_[i] = lhs.nulls_[i] | rhs.nulls_[i] | static_cast<uint8_t>(res == BUSTUB_INT32_NULL);
+      }
+      break;
+    }
+    case OpCode::Equal:
+    case OpCode::NotEqual:
+    case OpCode::LessThan:
+    case OpCode::LessThanOrEqual:
+    case OpCode::GreaterThan:
+    case OpCode::GreaterThanOrEqual: {
+      auto comp_type = static_cast<ComparisonType>(static_cast<int>(instr.op_) - static_cast<int>(OpCode::Equal));
+      if (instr.kind_ == RegisterKind::Decimal) {
+        CompareKernel(comp_type, lhs.decimals_.data(), rhs.decimals_.data(), dst.integers_.data(), n);
+      } else {
+        CompareKernel(comp_type, lhs.integers_.data(), rhs.integers_.data(), dst.integers_.data(), n);
+      }
+      OrNulls(lhs.nulls_.data(), rhs.nulls_.data(), dst.nulls_.data(), n);
+      break;
+    }
+    case OpCode::And:
+      // Three-valued logic: FALSE wins over NULL.
+      for (size_t i = 0; i < n; i++) {
+        bool l_false = lhs.nulls_[i] == 0 && lhs.integers_[i] == 0;
+        bool r_false = rhs.nulls_[i] == 0 && rhs.integers_[i] == 0;
+        bool any_null = (lhs.nulls_[i] | rhs.nulls_[i]) != 0;
+        dst.nulls_[i] = static_cast<uint8_t>(!l_false && !r_false && any_null);
+        dst.integers_[i] = static_cast<int64_t>(!l_false && !r_false && !any_null);
+      }
+      break;
+    case OpCode::Or:
+      // Three-valued logic: TRUE wins over NULL.
+      for (size_t i = 0; i < n; i++) {
+        bool l_true = lhs.nulls_[i] == 0 && lhs.integers_[i] != 0;
+        bool r_true = rhs.nulls_[i] == 0 && rhs.integers_[i] != 0;
+        bool any_null = (lhs.nulls_[i] | rhs.nulls_[i]) != 0;
+        dst.nulls_[i] = static_cast<uint8_t>(!l_true && !r_true && any_null);
+        dst.integers_[i] = static_cast<int64_t>(l_true || r_true);
+      }
+      break;
+  }
+}
+
+void CompiledExpression::Select(const Register &result, size_t n, std::vector<uint32_t> *selection) {
+  for (uint32_t i = 0; i < n; i++) {
+    if (result.nulls_[i] == 0 && result.integers_[i] != 0) {
+      selection->push_back(i);
+    }
+  }
+}
+
+void CompiledExpression::Filter(const std::vector<Tuple> &batch, std::vector<uint32_t> *selection) {
+  BUSTUB_ASSERT(results_[0]->type_ == TypeId::BOOLEAN, "a filter must be a boolean expression");
+  BUSTUB_ASSERT(right_schema_ == nullptr, "a join predicate must be evaluated with FilterJoin");
+  selection->clear();
+  if (batch.empty()) {
+    return;
+  }
+  Run(batch);
+  Select(registers_[results_[0]->reg_], batch.size(), selection);
+}
+
+void CompiledExpression::SetJoinBlock(const std::vector<Tuple> &block) {
+  BUSTUB_ASSERT(right_schema_ != nullptr, "only a join predicate has a block of left tuples");
+  block_ = &block;
+  for (const auto &instr : program_) {
+    if (instr.block_invariant_) {
+      Execute(instr, block);
+    }
+  }
+}
+
+void CompiledExpression::FilterJoin(const Tuple &right, std::vector<uint32_t> *selection) {
+  BUSTUB_ASSERT(block_ != nullptr, "SetJoinBlock must be called before FilterJoin");
+  selection->clear();
+  if (block_->empty()) {
+    return;
+  }
+  right_tuple_ = &right;
+  for (const auto &instr : program_) {
+    if (!instr.block_invariant_) {
+      Execute(instr, *block_);
+    }
+  }
+  Select(registers_[results_[0]->reg_], block_->size(), selection);
+}
+
+void CompiledExpression::Evaluate(const std::vector<Tuple> &batch, std::vector<Value> *values) {
+  values->clear();
+  if (batch.empty()) {
+    return;
+  }
+  Run(batch);
+  ToValues(*results_[0], batch.size(), values);
+}
+
+void CompiledExpression::EvaluateAll(const std::vector<Tuple> &batch, std::vector<std::vector<Value>> *values) {
+  values->resize(results_.size());
+  for (auto &expr_values : *values) {
+    expr_values.clear();
+  }
+  if (batch.empty()) {
+    return;
+  }
+  Run(batch);
+  for (size_t i = 0; i < results_.size(); i++) {
+    if (results_[i].has_value()) {
+      ToValues(*results_[i], batch.size(), &(*values)[i]);
+    }
+  }
+}
+
+void CompiledExpression::ToValues(const Operand &result, size_t n, std::vector<Value> *values) const {
+  const auto &reg = registers_[result.reg_];
+  values->reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    if (reg.nulls_[i] != 0) {
+      values->push_back(ValueFactory::GetNullValueByType(result.type_));
+      continue;
+    }
+    switch (result.type_) {
+      case TypeId::BOOLEAN:
+        values->push_back(ValueFactory::GetBooleanValue(reg.integers_[i] != 0));
+        break;
+      case TypeId::TINYINT:
+        values->push_back(ValueFactory::GetTinyIntValue(static_cast<int8_t>(reg.integers_[i])));
+        break;
+      case TypeId::SMALLINT:
+        values->push_back(ValueFactory::GetSmallIntValue(static_cast<int16_t>(reg.integers_[i])));
+        break;
+      case TypeId::INTEGER:
+        values->push_back(ValueFactory::GetIntegerValue(static_cast<int32_t>(reg.integers_[i])));
+        break;
+      case TypeId::BIGINT:
+        values->push_back(ValueFactory::GetBigIntValue(reg.integers_[i]));
+        break;
+      case TypeId::DECIMAL:
+        values->push_back(ValueFactory::GetDecimalValue(reg.decimals_[i]));
+        break;
+      default:
+        UNREACHABLE("result type not supported by the expression compiler");
+    }
+  }
+}
+
+}  // namespace bustub
@@ -1,4 +1,5 @@
 #include "execution/executors/filter_executor.h"
+#include "common/config.h"
 #include "common/exception.h"
 #include "type/value_factory.h"
 
@@ -6,14 +7,48 @@ namespace bustub {
 
 FilterExecutor::FilterExecutor(ExecutorContext *exec_ctx, const FilterPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
+  compiled_predicate_ = CompiledExpression::Compile(*plan_->GetPredicate(), child_executor_->GetOutputSchema());
+}
 
 void FilterExecutor::Init() {
   // Initialize the child executor
   child_executor_->Init();
+  selection_.clear();
+  cursor_ = 0;
+  child_done_ = false;
+}
+
+auto FilterExecutor::NextBatch() -> bool {
+  if (child_done_) {
+    return false;
+  }
+  batch_.resize(EXPRESSION_BATCH_SIZE);
+  batch_rids_.resize(EXPRESSION_BATCH_SIZE);
+  size_t size = 0;
+  while (size < batch_.size() && child_executor_->Next(&batch_[size], &batch_rids_[size])) {
+    size++;
+  }
+  child_done_ = size < batch_.size();
+  batch_.resize(size);
+  compiled_predicate_->Filter(batch_, &selection_);
+  cursor_ = 0;
+  return size > 0;
 }
 
 auto FilterExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (compiled_predicate_ != nullptr) {
+    while (cursor_ == selection_.size()) {
+      if (!NextBatch()) {
+        return false;
+      }
+    }
+    auto idx = selection_[cursor_++];
+    *tuple = std::move(batch_[idx]);
+    *rid = batch_rids_[idx];
+    return true;
+  }
+
   auto filter_expr = plan_->GetPredicate();
 
   while (true) {
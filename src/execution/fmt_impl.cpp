@@ -10,10 +10,29 @@
 #include "execution/plans/limit_plan.h"
 #include "execution/plans/projection_plan.h"
 #include "execution/plans/sort_plan.h"
+#include "execution/plans/stream_aggregation_plan.h"
 #include "execution/plans/topn_plan.h"
 
 namespace bustub {
 
+auto AbstractPlanNode::ToString(bool with_schema,
+                                const std::function<std::string(const AbstractPlanNode &)> &annotate) const
+    -> std::string {
+  auto str = PlanNodeToString();
+  if (auto annotation = annotate(*this); !annotation.empty()) {
+    str = fmt::format("{} {}", str, annotation);
+  }
+  if (with_schema) {
+    str = fmt::format("{} | {}", str, output_schema_);
+  }
+  for (const auto &child : children_) {
+    for (const auto &line : StringUtil::Split(child->ToString(with_schema, annotate), '\n')) {
+      str += fmt::format("\n{}{}", StringUtil::Indent(2), line);
+    }
+  }
+  return str;
+}
+
 auto AbstractPlanNode::ChildrenToString(int indent, bool with_schema) const -> std::string {
   if (children_.empty()) {
     return "";
@@ -35,6 +54,10 @@ auto AggregationPlanNode::PlanNodeToString() const -> std::string {
   return fmt::format("Agg {{ types={}, aggregates={}, group_by={} }}", agg_types_, aggregates_, group_bys_);
 }
 
+auto StreamAggregationPlanNode::PlanNodeToString() const -> std::string {
+  return fmt::format("StreamAgg {{ types={}, aggregates={}, group_by={} }}", agg_types_, aggregates_, group_bys_);
+}
+
 auto ProjectionPlanNode::PlanNodeToString() const -> std::string {
   return fmt::format("Projection {{ exprs={} }}", expressions_);
 }
@@ -10,25 +10,283 @@
 //
 //===----------------------------------------------------------------------===//
 
-#include "execution/executors/hash_join_executor.h"
+#include <optional>
+#include <utility>
+#include <vector>
 
-// Note for 2022 Fall: You don't need to implement HashJoinExecutor to pass all tests. You ONLY need to implement it
-// if you want to get faster in leaderboard tests.
+#include "common/config.h"
+#include "execution/executors/hash_join_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
+namespace {
+
+/** @return the concatenation of `left` and `right`, or of `left` and NULLs if `right` is nullptr */
+auto JoinTuples(const Tuple &left, const Schema &left_schema, const Tuple *right, const Schema &right_schema,
+                const Schema &output_schema) -> Tuple {
+  std::vector<Value> values;
+  values.reserve(output_schema.GetColumnCount());
+  for (uint32_t i = 0; i < left_schema.GetColumnCount(); i++) {
+    values.push_back(left.GetValue(&left_schema, i));
+  }
+  for (uint32_t i = 0; i < right_schema.GetColumnCount(); i++) {
+    values.push_back(right != nullptr ? right->GetValue(&right_schema, i)
+                                      : ValueFactory::GetNullValueByType(right_schema.GetColumn(i).GetType()));
+  }
+  return {values, &output_schema};
+}
+
+/** A scan column that produces a join key, as found by `ProbeScanColumn`. */
+struct ProbeScan {
+  const AbstractPlanNode *scan_;
+  uint32_t col_idx_;
+  /** Whether another join lies between the scan and the join key, whose work a runtime filter would save */
+  bool below_join_;
+};
+
+/**
+ * @return the scan below `plan` that produces column `col_idx` of the plan output, and the position of the column in
+ * the scan output. Only plans that either pass a scanned tuple through with the column unchanged or drop it are
+ * looked through, so that dropping tuples at the scan removes exactly the output rows with the same column value.
+ */
+auto ProbeScanColumn(const AbstractPlanNode &plan, uint32_t col_idx) -> std::optional<ProbeScan> {
+  switch (plan.GetType()) {
+    case PlanType::SeqScan:
+    case PlanType::MockScan:
+      return ProbeScan{&plan, col_idx, false};
+    case PlanType::Filter:
+    case PlanType::Sort:
+      return ProbeScanColumn(*plan.GetChildAt(0), col_idx);
+    case PlanType::Projection: {
+      const auto &expr = dynamic_cast<const ProjectionPlanNode &>(plan).GetExpressions()[col_idx];
+      if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+          column_value_expr != nullptr) {
+        return ProbeScanColumn(*plan.GetChildAt(0), column_value_expr->GetColIdx());
+      }
+      return std::nullopt;
+    }
+    case PlanType::NestedLoopJoin:
+    case PlanType::HashJoin:
+    case PlanType::MergeJoin:
+    case PlanType::NestedIndexJoin: {
+      auto left_column_cnt = plan.GetChildAt(0)->OutputSchema().GetColumnCount();
+      std::optional<ProbeScan> probe_scan;
+      if (col_idx < left_column_cnt) {
+        probe_scan = ProbeScanColumn(*plan.GetChildAt(0), col_idx);
+      } else if (plan.GetType() == PlanType::NestedLoopJoin &&
+                 dynamic_cast<const NestedLoopJoinPlanNode &>(plan).GetJoinType() == JoinType::INNER) {
+        probe_scan = ProbeScanColumn(*plan.GetChildAt(1), col_idx - left_column_cnt);
+      } else if ((plan.GetType() == PlanType::HashJoin || plan.GetType() == PlanType::MergeJoin) &&
+                 dynamic_cast<const HashJoinPlanNode &>(plan).GetJoinType() == JoinType::INNER) {
+        probe_scan = ProbeScanColumn(*plan.GetChildAt(1), col_idx - left_column_cnt);
+      }
+      // Otherwise the column is padded with NULLs by a LEFT join, or comes from the index of a nested index join.
+      if (probe_scan.has_value()) {
+        probe_scan->below_join_ = true;
+      }
+      return probe_scan;
+    }
+    default:
+      // In particular, dropping tuples below a limit or a top-N would let other tuples through instead.
+      return std::nullopt;
+  }
+}
+
+}  // namespace
+
 HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
                                    std::unique_ptr<AbstractExecutor> &&left_child,
                                    std::unique_ptr<AbstractExecutor> &&right_child)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_child)),
+      right_executor_(std::move(right_child)) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
 }
 
-void HashJoinExecutor::Init() { throw NotImplementedException("HashJoinExecutor is not implemented"); }
+void HashJoinExecutor::Init() {
+  // The filter of the previous Init holds the keys of the previous build side.
+  exec_ctx_->RemoveRuntimeFilters(plan_);
+  runtime_filter_ = nullptr;
+  build_on_left_ = false;
+  build_hashed_ = false;
+  build_tuples_.clear();
+  build_keys_.clear();
+  hash_table_.clear();
+  probe_buffer_.clear();
+  probe_buffer_idx_ = 0;
+  matches_ = nullptr;
+
+  right_executor_->Init();
+  const auto &left_schema = left_executor_->GetOutputSchema();
+  const auto &right_schema = right_executor_->GetOutputSchema();
+  Tuple tuple;
+  RID rid;
+  size_t right_cnt = 0;
+  bool right_done = false;
+  while (!right_done && right_cnt < static_cast<size_t>(HASH_JOIN_SWAP_CHECK_ROWS)) {
+    right_done = !right_executor_->Next(&tuple, &rid);
+    if (!right_done) {
+      right_cnt++;
+      AddBuildTuple(std::move(tuple), plan_->RightJoinKeyExpression(), right_schema);
+    }
+  }
+
+  // Unmatched probe tuples of a LEFT join are still emitted, so only an INNER join can build over its left side.
+  bool left_initialized = false;
+  if (!right_done && plan_->GetJoinType() == JoinType::INNER) {
+    // The right side is larger than the optimizer expected: read both sides until one of them ends.
+    left_executor_->Init();
+    left_initialized = true;
+    while (true) {
+      if (!left_executor_->Next(&tuple, &rid)) {
+        build_on_left_ = true;
+        break;
+      }
+      probe_buffer_.push_back(std::move(tuple));
+      if (!right_executor_->Next(&tuple, &rid)) {
+        right_done = true;
+        break;
+      }
+      AddBuildTuple(std::move(tuple), plan_->RightJoinKeyExpression(), right_schema);
+    }
+  }
+
+  if (build_on_left_) {
+    // The right tuples read so far are probed first. Those with a NULL key were dropped, but match nothing anyway.
+    auto left_tuples = std::move(probe_buffer_);
+    probe_buffer_ = std::move(build_tuples_);
+    build_tuples_.clear();
+    build_keys_.clear();
+    for (auto &left_tuple : left_tuples) {
+      AddBuildTuple(std::move(left_tuple), plan_->LeftJoinKeyExpression(), left_schema);
+    }
+  } else {
+    while (!right_done && right_executor_->Next(&tuple, &rid)) {
+      AddBuildTuple(std::move(tuple), plan_->RightJoinKeyExpression(), right_schema);
+    }
+  }
+
+  // Scans check the filters attached to them as they go, so the probe side may already be running.
+  PushDownRuntimeFilter();
+  if (build_tuples_.size() > static_cast<size_t>(HASH_JOIN_SCAN_MAX_ROWS)) {
+    BuildHashTable();
+  }
+  if (!left_initialized) {
+    left_executor_->Init();
+  }
+}
+
+void HashJoinExecutor::AddBuildTuple(Tuple &&tuple, const AbstractExpression &key_expr, const Schema &schema) {
+  auto key = key_expr.Evaluate(&tuple, schema);
+  if (key.IsNull()) {
+    return;
+  }
+  build_keys_.push_back(std::move(key));
+  build_tuples_.push_back(std::move(tuple));
+}
+
+void HashJoinExecutor::BuildHashTable() {
+  // Every tuple may have a key of its own, so reserving a bucket per tuple means the table never rehashes.
+  hash_table_.reserve(build_tuples_.size());
+  for (size_t i = 0; i < build_tuples_.size(); i++) {
+    hash_table_[HashJoinKey{std::move(build_keys_[i])}].push_back(std::move(build_tuples_[i]));
+  }
+  build_tuples_.clear();
+  build_tuples_.shrink_to_fit();
+  build_keys_.clear();
+  build_keys_.shrink_to_fit();
+  build_hashed_ = true;
+}
+
+void HashJoinExecutor::PushDownRuntimeFilter() {
+  // Unmatched probe tuples of a LEFT join are still emitted.
+  if (plan_->GetJoinType() != JoinType::INNER || build_keys_.size() > static_cast<size_t>(RUNTIME_FILTER_MAX_KEYS)) {
+    return;
+  }
+  const auto &probe_key = build_on_left_ ? plan_->RightJoinKeyExpression() : plan_->LeftJoinKeyExpression();
+  const auto &build_key = build_on_left_ ? plan_->LeftJoinKeyExpression() : plan_->RightJoinKeyExpression();
+  // The scan hashes the raw column, which only matches the hash of the build key if both have the same type.
+  const auto *key_expr = dynamic_cast<const ColumnValueExpression *>(&probe_key);
+  if (key_expr == nullptr || key_expr->GetReturnType() != build_key.GetReturnType()) {
+    return;
+  }
+  // A probe tuple that comes straight from the scan costs no more to look up in the hash table than in the filter.
+  auto probe_scan =
+      ProbeScanColumn(*(build_on_left_ ? plan_->GetRightPlan() : plan_->GetLeftPlan()), key_expr->GetColIdx());
+  if (!probe_scan.has_value() || !probe_scan->below_join_) {
+    return;
+  }
+  BlockedBloomFilter filter(build_keys_.size(), RUNTIME_FILTER_BITS_PER_KEY);
+  for (const auto &key : build_keys_) {
+    filter.Insert(RuntimeFilter::HashKey(key));
+  }
+  runtime_filter_ = std::make_shared<RuntimeFilter>(plan_, probe_scan->col_idx_, std::move(filter));
+  exec_ctx_->AddRuntimeFilter(probe_scan->scan_, runtime_filter_);
+}
+
+auto HashJoinExecutor::NextProbeTuple() -> bool {
+  if (probe_buffer_idx_ < probe_buffer_.size()) {
+    probe_tuple_ = std::move(probe_buffer_[probe_buffer_idx_++]);
+    return true;
+  }
+  if (!probe_buffer_.empty()) {
+    probe_buffer_.clear();
+    probe_buffer_.shrink_to_fit();
+    probe_buffer_idx_ = 0;
+  }
+  RID rid;
+  return (build_on_left_ ? right_executor_ : left_executor_)->Next(&probe_tuple_, &rid);
+}
 
-auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto HashJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  static const std::vector<Tuple> NO_MATCHES;
+  const auto &left_schema = left_executor_->GetOutputSchema();
+  const auto &right_schema = right_executor_->GetOutputSchema();
+  while (true) {
+    if (matches_ == nullptr) {
+      if (!NextProbeTuple()) {
+        return false;
+      }
+      probe_key_ = build_on_left_ ? plan_->RightJoinKeyExpression().Evaluate(&probe_tuple_, right_schema)
+                                  : plan_->LeftJoinKeyExpression().Evaluate(&probe_tuple_, left_schema);
+      probe_matched_ = false;
+      match_idx_ = 0;
+      if (probe_key_.IsNull()) {
+        matches_ = &NO_MATCHES;
+      } else if (build_hashed_) {
+        auto iter = hash_table_.find(HashJoinKey{probe_key_});
+        matches_ = iter == hash_table_.end() ? &NO_MATCHES : &iter->second;
+      } else {
+        matches_ = &build_tuples_;
+      }
+    }
+    while (match_idx_ < matches_->size()) {
+      auto idx = match_idx_++;
+      // Every tuple of a hash bucket matches, but a scanned build side is compared key by key.
+      if (!build_hashed_ && build_keys_[idx].CompareEquals(probe_key_) != CmpBool::CmpTrue) {
+        continue;
+      }
+      probe_matched_ = true;
+      const auto &build_tuple = (*matches_)[idx];
+      *tuple = build_on_left_ ? JoinTuples(build_tuple, left_schema, &probe_tuple_, right_schema, GetOutputSchema())
+                              : JoinTuples(probe_tuple_, left_schema, &build_tuple, right_schema, GetOutputSchema());
+      return true;
+    }
+    matches_ = nullptr;
+    if (!probe_matched_ && plan_->GetJoinType() == JoinType::LEFT) {
+      *tuple = JoinTuples(probe_tuple_, left_schema, nullptr, right_schema, GetOutputSchema());
+      return true;
+    }
+  }
+}
 
 }  // namespace bustub
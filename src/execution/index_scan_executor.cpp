@@ -11,12 +11,80 @@
 //===----------------------------------------------------------------------===//
 #include "execution/executors/index_scan_executor.h"
 
+#include <cstring>
+
+#include "concurrency/lock_manager.h"
+
 namespace bustub {
 IndexScanExecutor::IndexScanExecutor(ExecutorContext *exec_ctx, const IndexScanPlanNode *plan)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan) {
+  auto *index_info = exec_ctx_->GetCatalog()->GetIndex(plan_->GetIndexOid());
+  table_info_ = exec_ctx_->GetCatalog()->GetTable(index_info->table_name_);
+  tree_ = dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(index_info->index_.get());
+}
+
+void IndexScanExecutor::Init() {
+  iter_.emplace(tree_->GetBeginIterator());
+  produced_ = 0;
+  last_key_.reset();
+  auto *txn = exec_ctx_->GetTransaction();
+  lock_keys_ = exec_ctx_->GetLockManager() != nullptr && !txn->IsOptimistic() &&
+               txn->GetIsolationLevel() == IsolationLevel::REPEATABLE_READ;
+}
+
+void IndexScanExecutor::LockKey(uint64_t key_lock) {
+  if (!exec_ctx_->GetLockManager()->LockKey(exec_ctx_->GetTransaction(), LockManager::LockMode::SHARED,
+                                            plan_->GetIndexOid(), key_lock)) {
+    throw ExecutionException("index scan: transaction aborted while locking an index key");
+  }
+}
 
-void IndexScanExecutor::Init() { throw NotImplementedException("IndexScanExecutor is not implemented"); }
+auto IndexScanExecutor::Reseek(const IntegerKeyType *expected) -> bool {
+  if (!last_key_.has_value()) {
+    iter_.emplace(tree_->GetBeginIterator());
+  } else {
+    iter_.emplace(tree_->GetBeginIterator(*last_key_));
+    if (!iter_->IsEnd() && memcmp((**iter_).first.data_, last_key_->data_, sizeof(last_key_->data_)) == 0) {
+      ++*iter_;
+    }
+  }
+  if (iter_->IsEnd()) {
+    return expected == nullptr;
+  }
+  return expected != nullptr && memcmp((**iter_).first.data_, expected->data_, sizeof(expected->data_)) == 0;
+}
 
-auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto IndexScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  auto limit = plan_->GetLimit();
+  while (!limit.has_value() || produced_ < *limit) {
+    if (iter_->IsEnd()) {
+      // The lock on the end of the index keeps keys from being appended; the ones appended before it are returned.
+      if (!lock_keys_) {
+        return false;
+      }
+      LockKey(LockManager::KEY_LOCK_SUPREMUM);
+      if (Reseek(nullptr)) {
+        return false;
+      }
+      continue;
+    }
+    auto [key, tuple_rid] = **iter_;
+    if (lock_keys_) {
+      // The lock on a key also covers the gap before it, which an insert may have filled before the lock was granted.
+      LockKey(LockManager::KeyLockOf(key.data_, sizeof(key.data_)));
+      if (!Reseek(&key)) {
+        continue;
+      }
+    }
+    ++*iter_;
+    last_key_ = key;
+    if (table_info_->table_->GetTuple(tuple_rid, tuple, exec_ctx_->GetTransaction())) {
+      *rid = tuple_rid;
+      produced_++;
+      return true;
+    }
+  }
+  return false;
+}
 
 }  // namespace bustub
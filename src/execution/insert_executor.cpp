@@ -11,17 +11,99 @@
 //===----------------------------------------------------------------------===//
 
 #include <memory>
+#include <vector>
 
+#include "concurrency/lock_manager.h"
 #include "execution/executors/insert_executor.h"
+#include "storage/index/b_plus_tree_index.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
 InsertExecutor::InsertExecutor(ExecutorContext *exec_ctx, const InsertPlanNode *plan,
                                std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_executor_(std::move(child_executor)),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->TableOid())),
+      indexes_(exec_ctx->GetCatalog()->GetTableIndexes(table_info_->name_)) {}
 
-void InsertExecutor::Init() { throw NotImplementedException("InsertExecutor is not implemented"); }
+void InsertExecutor::Init() {
+  child_executor_->Init();
+  done_ = false;
+}
 
-auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool { return false; }
+auto InsertExecutor::LockInsertGap(IndexInfo *index, const Tuple &key) -> std::optional<uint64_t> {
+  auto *txn = exec_ctx_->GetTransaction();
+  auto *lock_mgr = exec_ctx_->GetLockManager();
+  auto *tree = dynamic_cast<BPlusTreeIndexForOneIntegerColumn *>(index->index_.get());
+  if (tree == nullptr || lock_mgr == nullptr || txn->IsOptimistic()) {
+    return std::nullopt;
+  }
+  auto lock = [&](uint64_t key_lock) {
+    if (!lock_mgr->LockKey(txn, LockManager::LockMode::EXCLUSIVE, index->index_oid_, key_lock)) {
+      throw ExecutionException("insert: transaction aborted while locking an index key");
+    }
+  };
+  IntegerKeyType index_key;
+  index_key.SetFromKey(key);
+  lock(LockManager::KeyLockOf(index_key.data_, sizeof(index_key.data_)));
+
+  // The key after the new one is the first key not less than it, or the end of the index.
+  auto next_key_lock = [&]() {
+    if (tree->IsEmpty()) {
+      return LockManager::KEY_LOCK_SUPREMUM;
+    }
+    auto iter = tree->GetBeginIterator(index_key);
+    return iter.IsEnd() ? LockManager::KEY_LOCK_SUPREMUM
+                        : LockManager::KeyLockOf((*iter).first.data_, sizeof((*iter).first.data_));
+  };
+  while (true) {
+    auto gap_lock = next_key_lock();
+    const bool held = txn->IsKeySharedLocked(index->index_oid_, gap_lock) ||
+                      txn->IsKeyExclusiveLocked(index->index_oid_, gap_lock);
+    lock(gap_lock);
+    // Another key may have been inserted in between while the lock was waited for; it is the one to lock then.
+    if (next_key_lock() == gap_lock) {
+      return held ? std::nullopt : std::optional<uint64_t>(gap_lock);
+    }
+    if (!held) {
+      lock_mgr->UnlockKey(txn, index->index_oid_, gap_lock);
+    }
+  }
+}
+
+auto InsertExecutor::Next([[maybe_unused]] Tuple *tuple, RID *rid) -> bool {
+  if (done_) {
+    return false;
+  }
+  done_ = true;
+
+  auto *txn = exec_ctx_->GetTransaction();
+  int32_t count = 0;
+  Tuple child_tuple;
+  RID child_rid;
+  while (child_executor_->Next(&child_tuple, &child_rid)) {
+    RID inserted_rid;
+    if (!table_info_->table_->InsertTuple(child_tuple, &inserted_rid, txn)) {
+      throw ExecutionException("insert: tuple does not fit into a table page");
+    }
+    for (auto *index : indexes_) {
+      auto key = child_tuple.KeyFromTuple(table_info_->schema_, index->key_schema_, index->index_->GetKeyAttrs());
+      auto gap_lock = LockInsertGap(index, key);
+      index->index_->InsertEntry(key, inserted_rid, txn);
+      if (gap_lock.has_value()) {
+        exec_ctx_->GetLockManager()->UnlockKey(txn, index->index_oid_, *gap_lock);
+      }
+      txn->AppendIndexWriteRecord(IndexWriteRecord(inserted_rid, table_info_->oid_, WType::INSERT, child_tuple,
+                                                   index->index_oid_, exec_ctx_->GetCatalog()));
+    }
+    count++;
+  }
+
+  std::vector<Value> values{ValueFactory::GetIntegerValue(count)};
+  *tuple = Tuple(values, &GetOutputSchema());
+  return true;
+}
 
 }  // namespace bustub
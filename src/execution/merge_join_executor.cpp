@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.cpp
+//
+// Identification: src/execution/merge_join_executor.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/merge_join_executor.h"
+
+#include <utility>
+#include <vector>
+
+#include "binder/table_ref/bound_join_ref.h"
+#include "common/exception.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the concatenation of `left` and `right`, or of `left` and NULLs if `right` is nullptr */
+auto JoinTuples(const Tuple &left, const Schema &left_schema, const Tuple *right, const Schema &right_schema,
+                const Schema &output_schema) -> Tuple {
+  std::vector<Value> values;
+  values.reserve(output_schema.GetColumnCount());
+  for (uint32_t i = 0; i < left_schema.GetColumnCount(); i++) {
+    values.push_back(left.GetValue(&left_schema, i));
+  }
+  for (uint32_t i = 0; i < right_schema.GetColumnCount(); i++) {
+    values.push_back(right != nullptr ? right->GetValue(&right_schema, i)
+                                      : ValueFactory::GetNullValueByType(right_schema.GetColumn(i).GetType()));
+  }
+  return {values, &output_schema};
+}
+
+}  // namespace
+
+MergeJoinExecutor::MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                                     std::unique_ptr<AbstractExecutor> &&left_child,
+                                     std::unique_ptr<AbstractExecutor> &&right_child)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_child)),
+      right_executor_(std::move(right_child)) {
+  if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
+    throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
+  }
+}
+
+void MergeJoinExecutor::Init() {
+  left_executor_->Init();
+  right_executor_->Init();
+  run_.clear();
+  run_idx_ = 0;
+  joining_ = false;
+  AdvanceRight();
+}
+
+void MergeJoinExecutor::AdvanceRight() {
+  RID rid;
+  has_right_ = right_executor_->Next(&right_tuple_, &rid);
+  if (has_right_) {
+    right_key_ = plan_->RightJoinKeyExpression().Evaluate(&right_tuple_, right_executor_->GetOutputSchema());
+  }
+}
+
+void MergeJoinExecutor::ReadRun(const Value &key) {
+  run_.clear();
+  run_key_ = key;
+  while (has_right_ && (right_key_.IsNull() || right_key_.CompareLessThan(key) == CmpBool::CmpTrue)) {
+    AdvanceRight();
+  }
+  while (has_right_ && (right_key_.IsNull() || right_key_.CompareEquals(key) == CmpBool::CmpTrue)) {
+    if (!right_key_.IsNull()) {
+      run_.push_back(std::move(right_tuple_));
+    }
+    AdvanceRight();
+  }
+}
+
+auto MergeJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const auto &left_schema = left_executor_->GetOutputSchema();
+  const auto &right_schema = right_executor_->GetOutputSchema();
+  while (true) {
+    if (joining_ && run_idx_ < run_.size()) {
+      *tuple = JoinTuples(left_tuple_, left_schema, &run_[run_idx_++], right_schema, GetOutputSchema());
+      return true;
+    }
+    joining_ = false;
+
+    RID left_rid;
+    if (!left_executor_->Next(&left_tuple_, &left_rid)) {
+      return false;
+    }
+    auto key = plan_->LeftJoinKeyExpression().Evaluate(&left_tuple_, left_schema);
+    if (!key.IsNull()) {
+      // Left tuples with the key of the previous one join with the same run.
+      if (run_.empty() || key.CompareEquals(run_key_) != CmpBool::CmpTrue) {
+        ReadRun(key);
+      }
+      if (!run_.empty()) {
+        joining_ = true;
+        run_idx_ = 0;
+        continue;
+      }
+    }
+
+    if (plan_->GetJoinType() == JoinType::LEFT) {
+      *tuple = JoinTuples(left_tuple_, left_schema, nullptr, right_schema, GetOutputSchema());
+      return true;
+    }
+    if (!has_right_ && run_.empty()) {
+      // No right tuple is left for the rest of the left side to match.
+      return false;
+    }
+  }
+}
+
+}  // namespace bustub
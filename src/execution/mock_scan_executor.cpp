@@ -394,21 +394,26 @@ MockScanExecutor::MockScanExecutor(ExecutorContext *exec_ctx, const MockScanPlan
 void MockScanExecutor::Init() {
   // Reset the cursor
   cursor_ = 0;
+  runtime_filters_ = &exec_ctx_->GetRuntimeFilters(plan_);
 }
 
 auto MockScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
-  if (cursor_ == size_) {
-    // Scan complete
-    return EXECUTOR_EXHAUSTED;
-  }
-  if (shuffled_idx_.empty()) {
-    *tuple = func_(cursor_);
-  } else {
-    *tuple = func_(shuffled_idx_[cursor_]);
-  }
-  ++cursor_;
-  *rid = MakeDummyRID();
-  return EXECUTOR_ACTIVE;
+  while (cursor_ != size_) {
+    if (shuffled_idx_.empty()) {
+      *tuple = func_(cursor_);
+    } else {
+      *tuple = func_(shuffled_idx_[cursor_]);
+    }
+    ++cursor_;
+    if (!std::all_of(runtime_filters_->begin(), runtime_filters_->end(),
+                     [&](const auto &filter) { return filter->Check(*tuple, GetOutputSchema()); })) {
+      continue;
+    }
+    *rid = MakeDummyRID();
+    return EXECUTOR_ACTIVE;
+  }
+  // Scan complete
+  return EXECUTOR_EXHAUSTED;
 }
 
 auto MockScanExecutor::MakeDummyRID() -> RID { return RID{0}; }
@@ -11,23 +11,133 @@
 //===----------------------------------------------------------------------===//
 
 #include "execution/executors/nested_loop_join_executor.h"
+
+#include <vector>
+
 #include "binder/table_ref/bound_join_ref.h"
+#include "common/config.h"
 #include "common/exception.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
+namespace {
+
+/** @return the concatenation of `left` and `right`, or of `left` and NULLs if `right` is nullptr */
+auto JoinTuples(const Tuple &left, const Schema &left_schema, const Tuple *right, const Schema &right_schema,
+                const Schema &output_schema) -> Tuple {
+  std::vector<Value> values;
+  values.reserve(output_schema.GetColumnCount());
+  for (uint32_t i = 0; i < left_schema.GetColumnCount(); i++) {
+    values.push_back(left.GetValue(&left_schema, i));
+  }
+  for (uint32_t i = 0; i < right_schema.GetColumnCount(); i++) {
+    values.push_back(right != nullptr ? right->GetValue(&right_schema, i)
+                                      : ValueFactory::GetNullValueByType(right_schema.GetColumn(i).GetType()));
+  }
+  return {values, &output_schema};
+}
+
+}  // namespace
+
 NestedLoopJoinExecutor::NestedLoopJoinExecutor(ExecutorContext *exec_ctx, const NestedLoopJoinPlanNode *plan,
                                                std::unique_ptr<AbstractExecutor> &&left_executor,
                                                std::unique_ptr<AbstractExecutor> &&right_executor)
-    : AbstractExecutor(exec_ctx) {
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_executor)),
+      right_executor_(std::move(right_executor)) {
   if (!(plan->GetJoinType() == JoinType::LEFT || plan->GetJoinType() == JoinType::INNER)) {
     // Note for 2022 Fall: You ONLY need to implement left join and inner join.
     throw bustub::NotImplementedException(fmt::format("join type {} not supported", plan->GetJoinType()));
   }
+  compiled_predicate_ = CompiledExpression::CompileJoin(plan_->Predicate(), left_executor_->GetOutputSchema(),
+                                                        right_executor_->GetOutputSchema());
+}
+
+void NestedLoopJoinExecutor::Init() {
+  left_executor_->Init();
+  has_block_ = false;
+  left_done_ = false;
+}
+
+auto NestedLoopJoinExecutor::ReadBlock() -> bool {
+  block_.clear();
+  size_t block_bytes = 0;
+  Tuple tuple;
+  RID rid;
+  while (!left_done_ && block_bytes < static_cast<size_t>(NLJ_BLOCK_PAGES) * BUSTUB_PAGE_SIZE) {
+    left_done_ = !left_executor_->Next(&tuple, &rid);
+    if (!left_done_) {
+      block_bytes += tuple.GetLength();
+      block_.push_back(std::move(tuple));
+    }
+  }
+  return !block_.empty();
 }
 
-void NestedLoopJoinExecutor::Init() { throw NotImplementedException("NestedLoopJoinExecutor is not implemented"); }
+void NestedLoopJoinExecutor::JoinBlock() {
+  if (compiled_predicate_ != nullptr) {
+    compiled_predicate_->FilterJoin(right_tuple_, &selection_);
+    return;
+  }
+  const auto &left_schema = left_executor_->GetOutputSchema();
+  const auto &right_schema = right_executor_->GetOutputSchema();
+  selection_.clear();
+  for (uint32_t i = 0; i < block_.size(); i++) {
+    auto value = plan_->Predicate().EvaluateJoin(&block_[i], left_schema, &right_tuple_, right_schema);
+    if (!value.IsNull() && value.GetAs<bool>()) {
+      selection_.push_back(i);
+    }
+  }
+}
 
-auto NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto NestedLoopJoinExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  const auto &left_schema = left_executor_->GetOutputSchema();
+  const auto &right_schema = right_executor_->GetOutputSchema();
+  while (true) {
+    if (!has_block_) {
+      if (!ReadBlock()) {
+        return false;
+      }
+      has_block_ = true;
+      block_matched_.assign(block_.size(), false);
+      selection_.clear();
+      selection_idx_ = 0;
+      right_done_ = false;
+      pad_idx_ = 0;
+      if (compiled_predicate_ != nullptr) {
+        compiled_predicate_->SetJoinBlock(block_);
+      }
+      right_executor_->Init();
+    }
+    if (selection_idx_ < selection_.size()) {
+      auto idx = selection_[selection_idx_++];
+      block_matched_[idx] = true;
+      *tuple = JoinTuples(block_[idx], left_schema, &right_tuple_, right_schema, GetOutputSchema());
+      return true;
+    }
+    RID right_rid;
+    if (!right_done_) {
+      right_done_ = !right_executor_->Next(&right_tuple_, &right_rid);
+      if (!right_done_) {
+        JoinBlock();
+        selection_idx_ = 0;
+        continue;
+      }
+    }
+    // The inner scan of the block is done; pad the outer tuples that matched nothing.
+    if (plan_->GetJoinType() == JoinType::LEFT) {
+      while (pad_idx_ < block_.size()) {
+        auto idx = pad_idx_++;
+        if (!block_matched_[idx]) {
+          *tuple = JoinTuples(block_[idx], left_schema, nullptr, right_schema, GetOutputSchema());
+          return true;
+        }
+      }
+    }
+    has_block_ = false;
+  }
+}
 
 }  // namespace bustub
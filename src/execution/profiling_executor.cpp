@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// profiling_executor.cpp
+//
+// Identification: src/execution/profiling_executor.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/profiling_executor.h"
+
+#include <chrono>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "fmt/format.h"
+
+namespace bustub {
+
+ProfilingExecutor::ProfilingExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan,
+                                     std::unique_ptr<AbstractExecutor> &&child_executor)
+    : AbstractExecutor(exec_ctx),
+      child_executor_(std::move(child_executor)),
+      profile_(exec_ctx->GetOperatorProfile(plan)) {}
+
+template <typename F>
+auto ProfilingExecutor::Measure(F &&f) -> decltype(f()) {
+  const auto &stats = BufferPoolManager::ThreadStats();
+  auto stats_before = stats;
+  auto start = std::chrono::steady_clock::now();
+  auto result = f();
+  profile_->time_ += std::chrono::steady_clock::now() - start;
+  profile_->buffer_pool_.hits_ += stats.hits_ - stats_before.hits_;
+  profile_->buffer_pool_.misses_ += stats.misses_ - stats_before.misses_;
+  profile_->buffer_pool_.pages_read_ += stats.pages_read_ - stats_before.pages_read_;
+  profile_->buffer_pool_.pages_written_ += stats.pages_written_ - stats_before.pages_written_;
+  return result;
+}
+
+void ProfilingExecutor::Init() {
+  profile_->init_calls_++;
+  Measure([&] {
+    child_executor_->Init();
+    return true;
+  });
+}
+
+auto ProfilingExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  profile_->next_calls_++;
+  auto has_tuple = Measure([&] { return child_executor_->Next(tuple, rid); });
+  if (has_tuple) {
+    profile_->rows_++;
+  }
+  return has_tuple;
+}
+
+auto ProfilingExecutor::ExplainAnalyze(const AbstractPlanNode &plan, const ExecutorContext &exec_ctx,
+                                       bool with_schema) -> std::string {
+  return plan.ToString(with_schema, [&](const AbstractPlanNode &node) -> std::string {
+    const auto *profile = exec_ctx.FindOperatorProfile(&node);
+    if (profile == nullptr) {
+      return "(never executed)";
+    }
+    const auto &bp = profile->buffer_pool_;
+    auto annotation = fmt::format(
+        "(rows={} next={} init={} time={:.3f}ms bp_hits={} bp_misses={} pages_read={} pages_written={})",
+        profile->rows_, profile->next_calls_, profile->init_calls_,
+        std::chrono::duration<double, std::milli>(profile->time_).count(), bp.hits_, bp.misses_, bp.pages_read_,
+        bp.pages_written_);
+    if (profile->spilled_pages_ != 0) {
+      annotation += fmt::format(" (spilled_pages={})", profile->spilled_pages_);
+    }
+    if (const auto *filters = exec_ctx.FindRuntimeFilters(&node); filters != nullptr) {
+      for (const auto &filter : *filters) {
+        annotation += fmt::format(" (runtime_filter checked={} eliminated={}{})", filter->RowsChecked(),
+                                  filter->RowsEliminated(), filter->IsDisabled() ? " disabled" : "");
+      }
+    }
+    return annotation;
+  });
+}
+
+}  // namespace bustub
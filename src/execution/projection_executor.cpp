@@ -1,18 +1,77 @@
 #include "execution/executors/projection_executor.h"
+#include "common/config.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 ProjectionExecutor::ProjectionExecutor(ExecutorContext *exec_ctx, const ProjectionPlanNode *plan,
                                        std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {
+  std::vector<AbstractExpressionRef> computed_exprs;
+  for (const auto &expr : plan_->GetExpressions()) {
+    // Plain columns and constants are cheap to interpret; only computed expressions are worth compiling.
+    if (expr->GetChildren().empty()) {
+      compiled_slots_.emplace_back(std::nullopt);
+      continue;
+    }
+    compiled_slots_.emplace_back(computed_exprs.size());
+    computed_exprs.push_back(expr);
+  }
+  if (!computed_exprs.empty()) {
+    compiled_exprs_ = CompiledExpression::CompileAll(computed_exprs, child_executor_->GetOutputSchema());
+  }
+  for (auto &slot : compiled_slots_) {
+    if (slot.has_value() && (compiled_exprs_ == nullptr || !compiled_exprs_->IsCompiled(*slot))) {
+      slot = std::nullopt;
+    }
+  }
+}
 
 void ProjectionExecutor::Init() {
   // Initialize the child executor
   child_executor_->Init();
+  batch_.clear();
+  cursor_ = 0;
+  child_done_ = false;
+}
+
+auto ProjectionExecutor::NextBatch() -> bool {
+  if (child_done_) {
+    return false;
+  }
+  batch_.resize(EXPRESSION_BATCH_SIZE);
+  batch_rids_.resize(EXPRESSION_BATCH_SIZE);
+  size_t size = 0;
+  while (size < batch_.size() && child_executor_->Next(&batch_[size], &batch_rids_[size])) {
+    size++;
+  }
+  child_done_ = size < batch_.size();
+  batch_.resize(size);
+  compiled_exprs_->EvaluateAll(batch_, &batch_values_);
+  cursor_ = 0;
+  return size > 0;
 }
 
 auto ProjectionExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (compiled_exprs_ != nullptr) {
+    if (cursor_ == batch_.size() && !NextBatch()) {
+      return false;
+    }
+    const auto &exprs = plan_->GetExpressions();
+    std::vector<Value> values{};
+    values.reserve(exprs.size());
+    for (size_t i = 0; i < exprs.size(); i++) {
+      if (compiled_slots_[i].has_value()) {
+        values.push_back(batch_values_[*compiled_slots_[i]][cursor_]);
+      } else {
+        values.push_back(exprs[i]->Evaluate(&batch_[cursor_], child_executor_->GetOutputSchema()));
+      }
+    }
+    *tuple = Tuple{values, &GetOutputSchema()};
+    *rid = batch_rids_[cursor_++];
+    return true;
+  }
+
   Tuple child_tuple{};
 
   // Get the next tuple
@@ -12,12 +12,82 @@
 
 #include "execution/executors/seq_scan_executor.h"
 
+#include <algorithm>
+#include <utility>
+
+#include "common/config.h"
+
 namespace bustub {
 
-SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan) : AbstractExecutor(exec_ctx) {}
+SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->GetTableOid())) {
+  if (plan_->filter_predicate_ != nullptr) {
+    compiled_predicate_ = CompiledExpression::Compile(*plan_->filter_predicate_, GetOutputSchema());
+  }
+}
+
+void SeqScanExecutor::Init() {
+  iter_.emplace(table_info_->table_->Begin(exec_ctx_->GetTransaction()));
+  runtime_filters_ = &exec_ctx_->GetRuntimeFilters(plan_);
+  batch_.clear();
+  selection_.clear();
+  cursor_ = 0;
+}
+
+auto SeqScanExecutor::PassesRuntimeFilters(const Tuple &tuple) const -> bool {
+  return std::all_of(runtime_filters_->begin(), runtime_filters_->end(),
+                     [&](const auto &filter) { return filter->Check(tuple, GetOutputSchema()); });
+}
+
+auto SeqScanExecutor::NextBatch() -> bool {
+  const auto end = table_info_->table_->End();
+  batch_.clear();
+  while (batch_.size() < static_cast<size_t>(EXPRESSION_BATCH_SIZE) && *iter_ != end) {
+    batch_.push_back(**iter_);
+    ++*iter_;
+  }
+  compiled_predicate_->Filter(batch_, &selection_);
+  cursor_ = 0;
+  return !batch_.empty();
+}
 
-void SeqScanExecutor::Init() { throw NotImplementedException("SeqScanExecutor is not implemented"); }
+auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (compiled_predicate_ != nullptr) {
+    while (true) {
+      while (cursor_ == selection_.size()) {
+        if (!NextBatch()) {
+          return false;
+        }
+      }
+      auto &candidate = batch_[selection_[cursor_++]];
+      if (PassesRuntimeFilters(candidate)) {
+        *tuple = std::move(candidate);
+        *rid = tuple->GetRid();
+        return true;
+      }
+    }
+  }
 
-auto SeqScanExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  const auto end = table_info_->table_->End();
+  while (*iter_ != end) {
+    // The iterator reuses its tuple, so take it before advancing.
+    *tuple = **iter_;
+    ++*iter_;
+    if (plan_->filter_predicate_ != nullptr) {
+      auto value = plan_->filter_predicate_->Evaluate(tuple, GetOutputSchema());
+      if (value.IsNull() || !value.GetAs<bool>()) {
+        continue;
+      }
+    }
+    if (!PassesRuntimeFilters(*tuple)) {
+      continue;
+    }
+    *rid = tuple->GetRid();
+    return true;
+  }
+  return false;
+}
 
 }  // namespace bustub
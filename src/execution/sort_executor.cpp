@@ -4,10 +4,49 @@ namespace bustub {
 
 SortExecutor::SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan,
                            std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
 
-void SortExecutor::Init() { throw NotImplementedException("SortExecutor is not implemented"); }
+void SortExecutor::Init() {
+  child_executor_->Init();
+  tuples_.clear();
+  order_.clear();
+  cursor_ = 0;
 
-auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+  SortKeyEncoder encoder(plan_->GetOrderBy());
+  const auto &child_schema = child_executor_->GetOutputSchema();
+  // All keys live in one buffer; entries point into it once it has stopped growing.
+  std::string keys;
+  std::vector<size_t> offsets;
+  Tuple tuple{};
+  RID rid{};
+  while (child_executor_->Next(&tuple, &rid)) {
+    offsets.push_back(keys.size());
+    encoder.Encode(tuple, child_schema, &keys);
+    tuples_.push_back(std::move(tuple));
+  }
+  offsets.push_back(keys.size());
+
+  std::vector<SortEntry> entries;
+  entries.reserve(tuples_.size());
+  for (uint32_t i = 0; i < tuples_.size(); i++) {
+    entries.push_back({keys.data() + offsets[i], static_cast<uint32_t>(offsets[i + 1] - offsets[i]), i});
+  }
+  SortByNormalizedKey(&entries);
+
+  order_.reserve(entries.size());
+  for (const auto &entry : entries) {
+    order_.push_back(entry.row_);
+  }
+}
+
+auto SortExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (cursor_ >= order_.size()) {
+    return false;
+  }
+  // Every tuple is emitted once per Init, so it is handed over instead of copied.
+  *tuple = std::move(tuples_[order_[cursor_++]]);
+  *rid = tuple->GetRid();
+  return true;
+}
 
 }  // namespace bustub
@@ -0,0 +1,243 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key.cpp
+//
+// Identification: src/execution/sort_key.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/sort_key.h"
+
+#include <algorithm>
+#include <array>
+
+#include "common/exception.h"
+#include "execution/expressions/column_value_expression.h"
+
+namespace bustub {
+
+namespace {
+
+/** Buckets smaller than this are finished with a comparison sort instead of another radix pass. */
+constexpr size_t RADIX_SORT_THRESHOLD = 64;
+
+/** Number of radix buckets: one for keys ending at the current depth, plus one per byte value. */
+constexpr size_t RADIX_BUCKETS = 257;
+
+template <typename T>
+void AppendBigEndian(T bits, std::string *key) {
+  for (int shift = (sizeof(T) - 1) * 8; shift >= 0; shift -= 8) {
+    key->push_back(static_cast<char>((bits >> shift) & 0xFF));
+  }
+}
+
+template <typename Signed, typename Unsigned>
+void AppendSigned(Signed value, std::string *key) {
+  auto bits = static_cast<Unsigned>(value);
+  bits ^= static_cast<Unsigned>(Unsigned{1} << (sizeof(Unsigned) * 8 - 1));
+  AppendBigEndian<Unsigned>(bits, key);
+}
+
+/** @return the radix bucket of an entry at the given depth */
+inline auto Bucket(const SortEntry &entry, uint32_t depth) -> size_t {
+  if (entry.key_size_ <= depth) {
+    return 0;
+  }
+  return static_cast<size_t>(static_cast<uint8_t>(entry.key_[depth])) + 1;
+}
+
+/** Compare two entries sharing their first `depth` key bytes, breaking ties by row to keep the sort stable. */
+inline auto EntryLess(const SortEntry &lhs, const SortEntry &rhs, uint32_t depth) -> bool {
+  int cmp = SortKeyEncoder::Compare(lhs.key_ + depth, lhs.key_size_ - depth, rhs.key_ + depth, rhs.key_size_ - depth);
+  return cmp < 0 || (cmp == 0 && lhs.row_ < rhs.row_);
+}
+
+void MsdRadixSort(SortEntry *begin, SortEntry *end, SortEntry *buffer, uint32_t depth) {
+  while (true) {
+    auto size = static_cast<size_t>(end - begin);
+    if (size <= 1) {
+      return;
+    }
+    if (size < RADIX_SORT_THRESHOLD) {
+      std::sort(begin, end, [depth](const SortEntry &lhs, const SortEntry &rhs) { return EntryLess(lhs, rhs, depth); });
+      return;
+    }
+
+    std::array<size_t, RADIX_BUCKETS> counts{};
+    for (auto *it = begin; it != end; ++it) {
+      counts[Bucket(*it, depth)]++;
+    }
+
+    // All keys share this byte (typical for the null markers and high bytes of integers): skip the scatter.
+    auto single = std::find(counts.begin(), counts.end(), size);
+    if (single != counts.end()) {
+      if (single == counts.begin()) {
+        // Every key ended here, so they are all equal and already in row order.
+        return;
+      }
+      depth++;
+      continue;
+    }
+
+    std::array<size_t, RADIX_BUCKETS> offsets{};
+    for (size_t i = 1; i < RADIX_BUCKETS; i++) {
+      offsets[i] = offsets[i - 1] + counts[i - 1];
+    }
+    auto positions = offsets;
+    for (auto *it = begin; it != end; ++it) {
+      buffer[positions[Bucket(*it, depth)]++] = *it;
+    }
+    std::copy(buffer, buffer + size, begin);
+
+    // Bucket 0 holds keys that are equal and were scattered in row order, so only the byte buckets recurse.
+    for (size_t i = 1; i < RADIX_BUCKETS; i++) {
+      if (counts[i] > 1) {
+        MsdRadixSort(begin + offsets[i], begin + offsets[i] + counts[i], buffer + offsets[i], depth + 1);
+      }
+    }
+    return;
+  }
+}
+
+}  // namespace
+
+SortKeyEncoder::SortKeyEncoder(const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &order_bys)
+    : order_bys_(order_bys) {
+  for (const auto &[order_by_type, expr] : order_bys_) {
+    if (order_by_type == OrderByType::INVALID) {
+      throw bustub::Exception("invalid order by type");
+    }
+    fixed_size_hint_ += 1;
+    const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+    column_idxs_.emplace_back(column_value_expr != nullptr && column_value_expr->GetTupleIdx() == 0
+                                  ? std::make_optional(column_value_expr->GetColIdx())
+                                  : std::nullopt);
+    switch (expr->GetReturnType()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        fixed_size_hint_ += sizeof(int8_t);
+        break;
+      case TypeId::SMALLINT:
+        fixed_size_hint_ += sizeof(int16_t);
+        break;
+      case TypeId::INTEGER:
+        fixed_size_hint_ += sizeof(int32_t);
+        break;
+      default:
+        fixed_size_hint_ += sizeof(int64_t);
+        break;
+    }
+  }
+}
+
+void SortKeyEncoder::Encode(const Tuple &tuple, const Schema &schema, std::string *key) const {
+  for (size_t i = 0; i < order_bys_.size(); i++) {
+    EncodeColumn(i, tuple, schema, key);
+  }
+}
+
+auto SortKeyEncoder::EncodeIfBefore(const Tuple &tuple, const Schema &schema, const std::string &bound,
+                                    std::string *key) const -> bool {
+  auto begin = key->size();
+  for (size_t i = 0; i < order_bys_.size(); i++) {
+    EncodeColumn(i, tuple, schema, key);
+    // Keys compare byte by byte, so the columns encoded so far decide as soon as they differ from the bound.
+    auto size = static_cast<uint32_t>(key->size() - begin);
+    int cmp = memcmp(key->data() + begin, bound.data(), std::min<size_t>(size, bound.size()));
+    if (cmp < 0) {
+      for (i++; i < order_bys_.size(); i++) {
+        EncodeColumn(i, tuple, schema, key);
+      }
+      return true;
+    }
+    if (cmp > 0 || size >= bound.size()) {
+      // Past the bound, or the bound is a prefix of the key: either way the key does not sort before it.
+      return false;
+    }
+  }
+  return false;
+}
+
+void SortKeyEncoder::EncodeColumn(size_t i, const Tuple &tuple, const Schema &schema, std::string *key) const {
+  const auto &[order_by_type, expr] = order_bys_[i];
+  auto begin = key->size();
+  if (column_idxs_[i].has_value()) {
+    auto value = tuple.GetValueView(&schema, *column_idxs_[i]);
+    key->push_back(value.IsNull() ? '\0' : '\1');
+    if (!value.IsNull()) {
+      EncodeValue(value, key);
+    }
+  } else {
+    auto value = expr->Evaluate(&tuple, schema);
+    key->push_back(value.IsNull() ? '\0' : '\1');
+    if (!value.IsNull()) {
+      EncodeValue(value, key);
+    }
+  }
+  if (order_by_type == OrderByType::DESC) {
+    for (auto j = begin; j < key->size(); j++) {
+      (*key)[j] = static_cast<char>(~(*key)[j]);
+    }
+  }
+}
+
+template <typename ValueType>
+void SortKeyEncoder::EncodeValue(const ValueType &value, std::string *key) {
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      AppendSigned<int8_t, uint8_t>(value.template GetAs<int8_t>(), key);
+      break;
+    case TypeId::SMALLINT:
+      AppendSigned<int16_t, uint16_t>(value.template GetAs<int16_t>(), key);
+      break;
+    case TypeId::INTEGER:
+      AppendSigned<int32_t, uint32_t>(value.template GetAs<int32_t>(), key);
+      break;
+    case TypeId::BIGINT:
+      AppendSigned<int64_t, uint64_t>(value.template GetAs<int64_t>(), key);
+      break;
+    case TypeId::TIMESTAMP:
+      AppendBigEndian<uint64_t>(value.template GetAs<uint64_t>(), key);
+      break;
+    case TypeId::DECIMAL: {
+      auto decimal = value.template GetAs<double>();
+      if (decimal == 0) {
+        // Fold -0.0 into 0.0, they compare equal.
+        decimal = 0;
+      }
+      uint64_t bits;
+      memcpy(&bits, &decimal, sizeof(bits));
+      bits = (bits >> 63) != 0 ? ~bits : bits | (uint64_t{1} << 63);
+      AppendBigEndian<uint64_t>(bits, key);
+      break;
+    }
+    case TypeId::VARCHAR: {
+      // The stored length includes the trailing '\0', which does not take part in comparisons.
+      const char *data = value.GetData();
+      uint32_t len = value.GetLength() > 0 ? value.GetLength() - 1 : 0;
+      for (uint32_t i = 0; i < len; i++) {
+        key->push_back(data[i]);
+        if (data[i] == '\0') {
+          key->push_back('\xFF');
+        }
+      }
+      key->push_back('\0');
+      key->push_back('\0');
+      break;
+    }
+    default:
+      throw NotImplementedException("sort key encoding is not supported for this type");
+  }
+}
+
+void SortByNormalizedKey(std::vector<SortEntry> *entries) {
+  std::vector<SortEntry> buffer(entries->size());
+  MsdRadixSort(entries->data(), entries->data() + entries->size(), buffer.data(), 0);
+}
+
+}  // namespace bustub
@@ -0,0 +1,76 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// stream_aggregation_executor.cpp
+//
+// Identification: src/execution/stream_aggregation_executor.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/stream_aggregation_executor.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+StreamAggregationExecutor::StreamAggregationExecutor(ExecutorContext *exec_ctx,
+                                                     const StreamAggregationPlanNode *plan,
+                                                     std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractExecutor(exec_ctx),
+      plan_(plan),
+      child_(std::move(child)),
+      aggregator_(plan_->GetAggregates(), plan_->GetAggregateTypes()) {}
+
+void StreamAggregationExecutor::Init() {
+  child_->Init();
+  RID rid{};
+  has_lookahead_ = child_->Next(&lookahead_, &rid);
+  emitted_ = false;
+}
+
+auto StreamAggregationExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (!has_lookahead_) {
+    if (emitted_ || !plan_->GetGroupBys().empty()) {
+      return false;
+    }
+    // An aggregation without GROUP BY produces one row even when its input is empty.
+    EmitGroup({}, aggregator_.GenerateInitialAggregateValue(), tuple);
+    return true;
+  }
+
+  auto key = MakeAggregateKey(&lookahead_);
+  auto val = aggregator_.GenerateInitialAggregateValue();
+  aggregator_.CombineAggregateValues(&val, MakeAggregateValue(&lookahead_));
+
+  Tuple child_tuple{};
+  RID child_rid{};
+  has_lookahead_ = false;
+  while (child_->Next(&child_tuple, &child_rid)) {
+    auto child_key = MakeAggregateKey(&child_tuple);
+    if (!(child_key == key)) {
+      lookahead_ = std::move(child_tuple);
+      has_lookahead_ = true;
+      break;
+    }
+    aggregator_.CombineAggregateValues(&val, MakeAggregateValue(&child_tuple));
+  }
+
+  EmitGroup(key, val, tuple);
+  return true;
+}
+
+void StreamAggregationExecutor::EmitGroup(const AggregateKey &key, const AggregateValue &val, Tuple *tuple) {
+  std::vector<Value> values;
+  values.reserve(key.group_bys_.size() + val.aggregates_.size());
+  values.insert(values.end(), key.group_bys_.begin(), key.group_bys_.end());
+  values.insert(values.end(), val.aggregates_.begin(), val.aggregates_.end());
+  *tuple = Tuple(values, &GetOutputSchema());
+  emitted_ = true;
+}
+
+}  // namespace bustub
@@ -1,13 +1,62 @@
 #include "execution/executors/topn_executor.h"
 
+#include <algorithm>
+
 namespace bustub {
 
 TopNExecutor::TopNExecutor(ExecutorContext *exec_ctx, const TopNPlanNode *plan,
                            std::unique_ptr<AbstractExecutor> &&child_executor)
-    : AbstractExecutor(exec_ctx) {}
+    : AbstractExecutor(exec_ctx), plan_(plan), child_executor_(std::move(child_executor)) {}
+
+void TopNExecutor::Init() {
+  child_executor_->Init();
+  tuples_.clear();
+  cursor_ = 0;
+
+  const auto n = plan_->GetN();
+  SortKeyEncoder encoder(plan_->GetOrderBy());
+  const auto &child_schema = child_executor_->GetOutputSchema();
+  // Max-heap on the sort key: the front is the worst of the N tuples retained so far.
+  std::vector<HeapEntry> heap;
+  heap.reserve(n);
+  Tuple tuple{};
+  RID rid{};
+  std::string key;
+  uint64_t seq = 0;
+  while (child_executor_->Next(&tuple, &rid)) {
+    key.clear();
+    if (heap.size() < n) {
+      encoder.Encode(tuple, child_schema, &key);
+      heap.push_back({key, seq++, std::move(tuple)});
+      std::push_heap(heap.begin(), heap.end(), EntryLess);
+      continue;
+    }
+    // Ties keep the earlier tuple, so only a strictly smaller key replaces the current N-th one. Most tuples lose on
+    // their first sort column and are dropped before the rest of their key is encoded.
+    if (n == 0 || !encoder.EncodeIfBefore(tuple, child_schema, heap.front().key_, &key)) {
+      seq++;
+      continue;
+    }
+    std::pop_heap(heap.begin(), heap.end(), EntryLess);
+    heap.back() = {key, seq++, std::move(tuple)};
+    std::push_heap(heap.begin(), heap.end(), EntryLess);
+  }
 
-void TopNExecutor::Init() { throw NotImplementedException("TopNExecutor is not implemented"); }
+  std::sort_heap(heap.begin(), heap.end(), EntryLess);
+  tuples_.reserve(heap.size());
+  for (auto &entry : heap) {
+    tuples_.push_back(std::move(entry.tuple_));
+  }
+}
 
-auto TopNExecutor::Next(Tuple *tuple, RID *rid) -> bool { return false; }
+auto TopNExecutor::Next(Tuple *tuple, RID *rid) -> bool {
+  if (cursor_ >= tuples_.size()) {
+    return false;
+  }
+  // Every tuple is emitted once per Init, so it is handed over instead of copied.
+  *tuple = std::move(tuples_[cursor_++]);
+  *rid = tuple->GetRid();
+  return true;
+}
 
 }  // namespace bustub
@@ -63,6 +63,10 @@ struct PGColumnRef;
 struct PGResTarget;
 struct PGAExpr;
 struct PGJoinExpr;
+struct PGParamRef;
+struct PGPrepareStmt;
+struct PGExecuteStmt;
+struct PGDeallocateStmt;
 }  // namespace duckdb_libpgquery
 
 namespace bustub {
@@ -76,11 +80,15 @@ class BoundExpression;
 class BoundExpressionListRef;
 class BoundOrderBy;
 class BoundSubqueryRef;
+class AnalyzeStatement;
 class CreateStatement;
 class ExplainStatement;
 class IndexStatement;
 class DeleteStatement;
 class UpdateStatement;
+class PrepareStatement;
+class ExecuteStatement;
+class DeallocateStatement;
 
 /**
  * The binder is responsible for transforming the Postgres parse tree to a binder tree
@@ -204,6 +212,16 @@ class Binder {
 
   auto BindVariableShow(duckdb_libpgquery::PGVariableShowStmt *stmt) -> std::unique_ptr<VariableShowStatement>;
 
+  auto BindAnalyze(duckdb_libpgquery::PGVacuumStmt *stmt) -> std::unique_ptr<AnalyzeStatement>;
+
+  auto BindPrepare(duckdb_libpgquery::PGPrepareStmt *stmt) -> std::unique_ptr<PrepareStatement>;
+
+  auto BindExecute(duckdb_libpgquery::PGExecuteStmt *stmt) -> std::unique_ptr<ExecuteStatement>;
+
+  auto BindDeallocate(duckdb_libpgquery::PGDeallocateStmt *stmt) -> std::unique_ptr<DeallocateStatement>;
+
+  auto BindParameter(duckdb_libpgquery::PGParamRef *node) -> std::unique_ptr<BoundExpression>;
+
   class ContextGuard {
    public:
     explicit ContextGuard(const BoundTableRef **scope, const CTEList **cte_scope) {
@@ -252,6 +270,9 @@ class Binder {
   /** Sometimes we will need to assign a name to some unnamed items. This variable gives them a universal ID. */
   size_t universal_id_{0};
 
+  /** The number of parameters seen in the statement being prepared, used to number the `?` placeholders. */
+  size_t parameter_cnt_{0};
+
   duckdb::PostgresParser parser_;
 };
 
@@ -21,6 +21,7 @@ enum class ExpressionType : uint8_t {
   UNARY_OP = 8,   /**< Unary expression type. */
   BINARY_OP = 9,  /**< Binary expression type. */
   ALIAS = 10,     /**< Alias expression type. */
+  PARAMETER = 11, /**< Parameter of a prepared statement, e.g. `$1`. */
 };
 
 /**
@@ -98,6 +99,9 @@ struct fmt::formatter<bustub::ExpressionType> : formatter<string_view> {
       case bustub::ExpressionType::ALIAS:
         name = "Alias";
         break;
+      case bustub::ExpressionType::PARAMETER:
+        name = "Parameter";
+        break;
     }
     return formatter<string_view>::format(name, ctx);
   }
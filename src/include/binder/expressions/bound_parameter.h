@@ -0,0 +1,24 @@
+#pragma once
+
+#include <string>
+
+#include "binder/bound_expression.h"
+#include "fmt/format.h"
+
+namespace bustub {
+
+/**
+ * A bound parameter of a prepared statement, e.g., `$1`. Parameters are numbered from 0.
+ */
+class BoundParameter : public BoundExpression {
+ public:
+  explicit BoundParameter(size_t idx) : BoundExpression(ExpressionType::PARAMETER), idx_(idx) {}
+
+  auto ToString() const -> std::string override { return fmt::format("${}", idx_ + 1); }
+
+  auto HasAggregation() const -> bool override { return false; }
+
+  /** The index of the parameter. */
+  size_t idx_;
+};
+}  // namespace bustub
@@ -0,0 +1,42 @@
+//===----------------------------------------------------------------------===//
+//                         BusTub
+//
+// binder/analyze_statement.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binder/bound_statement.h"
+#include "binder/table_ref/bound_base_table_ref.h"
+#include "common/enums/statement_type.h"
+#include "fmt/format.h"
+#include "fmt/ranges.h"
+
+namespace bustub {
+
+/** `ANALYZE [table]` collects the statistics of a table, or of all user tables when no table is given. */
+class AnalyzeStatement : public BoundStatement {
+ public:
+  explicit AnalyzeStatement(std::vector<std::unique_ptr<BoundBaseTableRef>> tables)
+      : BoundStatement(StatementType::ANALYZE_STATEMENT), tables_(std::move(tables)) {}
+
+  /** The tables to analyze */
+  std::vector<std::unique_ptr<BoundBaseTableRef>> tables_;
+
+  auto ToString() const -> std::string override {
+    std::vector<std::string> names;
+    names.reserve(tables_.size());
+    for (const auto &table : tables_) {
+      names.push_back(table->table_);
+    }
+    return fmt::format("BoundAnalyze {{ tables=[{}] }}", fmt::join(names, ", "));
+  }
+};
+
+}  // namespace bustub
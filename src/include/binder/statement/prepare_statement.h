@@ -0,0 +1,85 @@
+//===----------------------------------------------------------------------===//
+//                         BusTub
+//
+// binder/prepare_statement.h
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binder/bound_expression.h"
+#include "binder/bound_statement.h"
+#include "common/enums/statement_type.h"
+#include "fmt/format.h"
+#include "fmt/ranges.h"
+#include "type/type_id.h"
+
+namespace bustub {
+
+/**
+ * `PREPARE name [(type, ...)] AS statement` binds a statement with parameters `$1, $2, ...` once, so that it can be
+ * planned once and executed many times with different parameter values.
+ */
+class PrepareStatement : public BoundStatement {
+ public:
+  explicit PrepareStatement(std::string name, std::vector<TypeId> parameter_types,
+                            std::unique_ptr<BoundStatement> statement)
+      : BoundStatement(StatementType::PREPARE_STATEMENT),
+        name_(std::move(name)),
+        parameter_types_(std::move(parameter_types)),
+        statement_(std::move(statement)) {}
+
+  /** The name of the prepared statement */
+  std::string name_;
+
+  /** The declared types of the parameters, which may be fewer than the parameters used */
+  std::vector<TypeId> parameter_types_;
+
+  /** The statement to prepare */
+  std::unique_ptr<BoundStatement> statement_;
+
+  auto ToString() const -> std::string override {
+    return fmt::format("BoundPrepare {{\n  name={},\n  statement={},\n}}", name_, statement_->ToString());
+  }
+};
+
+/** `EXECUTE name [(value, ...)]` runs a prepared statement with the given parameter values. */
+class ExecuteStatement : public BoundStatement {
+ public:
+  explicit ExecuteStatement(std::string name, std::vector<std::unique_ptr<BoundExpression>> parameters)
+      : BoundStatement(StatementType::EXECUTE_STATEMENT),
+        name_(std::move(name)),
+        parameters_(std::move(parameters)) {}
+
+  /** The name of the prepared statement */
+  std::string name_;
+
+  /** The parameter values, which must be constants */
+  std::vector<std::unique_ptr<BoundExpression>> parameters_;
+
+  auto ToString() const -> std::string override {
+    return fmt::format("BoundExecute {{ name={}, parameters={} }}", name_, parameters_);
+  }
+};
+
+/** `DEALLOCATE name` drops a prepared statement, and `DEALLOCATE ALL` drops all of them. */
+class DeallocateStatement : public BoundStatement {
+ public:
+  explicit DeallocateStatement(std::optional<std::string> name)
+      : BoundStatement(StatementType::DEALLOCATE_STATEMENT), name_(std::move(name)) {}
+
+  /** The name of the prepared statement, or none for all prepared statements */
+  std::optional<std::string> name_;
+
+  auto ToString() const -> std::string override {
+    return fmt::format("BoundDeallocate {{ name={} }}", name_.value_or("ALL"));
+  }
+};
+
+}  // namespace bustub
@@ -23,6 +23,20 @@
 
 namespace bustub {
 
+/**
+ * BufferPoolStats counts the buffer pool accesses of one thread, so that a query can be profiled while others run.
+ */
+struct BufferPoolStats {
+  /** Fetches of pages that were in the pool */
+  uint64_t hits_{0};
+  /** Fetches and new pages that needed a frame */
+  uint64_t misses_{0};
+  /** Pages read from disk */
+  uint64_t pages_read_{0};
+  /** Dirty pages written to disk to free their frame */
+  uint64_t pages_written_{0};
+};
+
 /**
  * BufferPoolManager reads disk pages to and from its internal buffer pool.
  */
@@ -87,6 +101,12 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   virtual auto GetPoolSize() -> size_t = 0;
 
+  /** @return the buffer pool accesses the calling thread made so far */
+  static auto ThreadStats() -> BufferPoolStats & {
+    thread_local BufferPoolStats stats;
+    return stats;
+  }
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -20,6 +20,7 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "catalog/table_statistics.h"
 #include "container/hash/hash_function.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/extendible_hash_table_index.h"
@@ -150,6 +151,7 @@ class Catalog {
     tables_.emplace(table_oid, std::move(meta));
     table_names_.emplace(table_name, table_oid);
     index_names_.emplace(table_name, std::unordered_map<std::string, index_oid_t>{});
+    version_.fetch_add(1);
 
     return tmp;
   }
@@ -246,6 +248,7 @@ class Catalog {
     // Update internal tracking
     indexes_.emplace(index_oid, std::move(index_info));
     table_indexes.emplace(index_name, index_oid);
+    version_.fetch_add(1);
 
     return tmp;
   }
@@ -298,7 +301,7 @@ class Catalog {
    * @param index_oid The OID of the index for which to query
    * @return A (non-owning) pointer to the metadata for the index
    */
-  auto GetIndex(index_oid_t index_oid) -> IndexInfo * {
+  auto GetIndex(index_oid_t index_oid) const -> IndexInfo * {
     auto index = indexes_.find(index_oid);
     if (index == indexes_.end()) {
       return NULL_INDEX_INFO;
@@ -333,7 +336,7 @@ class Catalog {
     return indexes;
   }
 
-  auto GetTableNames() -> std::vector<std::string> {
+  auto GetTableNames() const -> std::vector<std::string> {
     std::vector<std::string> result;
     for (const auto &x : table_names_) {
       result.push_back(x.first);
@@ -341,6 +344,33 @@ class Catalog {
     return result;
   }
 
+  /**
+   * Replace the statistics of a table, as collected by ANALYZE.
+   * @param table_oid The OID of the table
+   * @param statistics The statistics of the table
+   */
+  void SetTableStatistics(table_oid_t table_oid, TableStatistics statistics) {
+    statistics_[table_oid] = std::make_unique<TableStatistics>(std::move(statistics));
+    version_.fetch_add(1);
+  }
+
+  /**
+   * The version of the catalog, which changes whenever a table or an index is created or the statistics of a table
+   * are replaced. A plan built at one version may be stale at another.
+   * @return The version of the catalog
+   */
+  auto GetVersion() const -> uint64_t { return version_.load(); }
+
+  /**
+   * Query the statistics of a table.
+   * @param table_oid The OID of the table
+   * @return The statistics of the table, or nullptr if the table has not been analyzed
+   */
+  auto GetTableStatistics(table_oid_t table_oid) const -> const TableStatistics * {
+    auto statistics = statistics_.find(table_oid);
+    return statistics == statistics_.end() ? nullptr : statistics->second.get();
+  }
+
  private:
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] LockManager *lock_manager_;
@@ -371,6 +401,12 @@ class Catalog {
 
   /** The next index identifier to be used. */
   std::atomic<index_oid_t> next_index_oid_{0};
+
+  /** Map table identifier -> statistics of the table, for the tables that have been analyzed. */
+  std::unordered_map<table_oid_t, std::unique_ptr<TableStatistics>> statistics_;
+
+  /** The version of the catalog, see `GetVersion`. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
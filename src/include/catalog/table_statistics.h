@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_statistics.h
+//
+// Identification: src/include/catalog/table_statistics.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * ColumnStatistics summarizes the values of one column of a table, as collected by `ANALYZE`: the number of distinct
+ * values, the fraction of NULLs and, for numeric columns, an equi-depth histogram. The optimizer uses them to estimate
+ * the selectivity of predicates.
+ */
+class ColumnStatistics {
+ public:
+  /**
+   * @param distinct_count the number of distinct non-null values
+   * @param null_fraction the fraction of rows that are NULL
+   * @param bounds the bucket boundaries of the equi-depth histogram over the non-null values, from the minimum to the
+   * maximum; empty for non-numeric columns and columns without non-null values
+   */
+  ColumnStatistics(uint64_t distinct_count, double null_fraction, std::vector<double> bounds)
+      : distinct_count_(distinct_count), null_fraction_(null_fraction), bounds_(std::move(bounds)) {}
+
+  /** @return the number of distinct non-null values */
+  auto GetDistinctCount() const -> uint64_t { return distinct_count_; }
+
+  /** @return the fraction of rows that are NULL */
+  auto GetNullFraction() const -> double { return null_fraction_; }
+
+  /** @return the bucket boundaries of the histogram, every bucket holding the same number of values */
+  auto GetHistogramBounds() const -> const std::vector<double> & { return bounds_; }
+
+  /** @return the estimated fraction of rows equal to `value` */
+  auto EstimateEqualSelectivity(const Value &value) const -> double;
+
+  /**
+   * @return the estimated fraction of rows within a range; a missing bound leaves that side of the range open
+   */
+  auto EstimateRangeSelectivity(std::optional<double> low, bool low_inclusive, std::optional<double> high,
+                                bool high_inclusive) const -> double;
+
+  /** @return the value as a number, or `std::nullopt` if it is NULL or not numeric */
+  static auto ToNumeric(const Value &value) -> std::optional<double>;
+
+  auto ToString() const -> std::string;
+
+ private:
+  /** @return the estimated fraction of non-null values smaller than `value` */
+  auto FractionBelow(double value) const -> double;
+
+  uint64_t distinct_count_;
+  double null_fraction_;
+  std::vector<double> bounds_;
+};
+
+/** TableStatistics holds the statistics of a table, as collected by `ANALYZE`. */
+struct TableStatistics {
+  /** The number of rows of the table */
+  uint64_t row_count_;
+  /** The statistics of each column, in schema order */
+  std::vector<ColumnStatistics> columns_;
+
+  auto ToString() const -> std::string;
+};
+
+/**
+ * TableStatisticsCollector builds the statistics of a table from a full scan of it. Distinct values are counted
+ * exactly: fixed-size values by their bytes, variable-length ones by their contents.
+ */
+class TableStatisticsCollector {
+ public:
+  explicit TableStatisticsCollector(const Schema &schema);
+
+  /** Account for one row of the table. */
+  void Add(const Tuple &tuple);
+
+  /** @return the statistics of the rows added so far */
+  auto Finish() -> TableStatistics;
+
+ private:
+  const Schema &schema_;
+  uint64_t row_count_{0};
+  std::vector<uint64_t> null_counts_;
+  /** The distinct non-null values of the fixed-size columns, as their serialized bytes */
+  std::vector<std::unordered_set<uint64_t>> distinct_values_;
+  /** The distinct non-null values of the variable-length columns */
+  std::vector<std::unordered_set<std::string>> distinct_strings_;
+  /** The non-null values of the numeric columns, to build the histograms from */
+  std::vector<std::vector<double>> numeric_values_;
+};
+
+}  // namespace bustub
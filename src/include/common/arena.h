@@ -0,0 +1,127 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arena.h
+//
+// Identification: src/include/common/arena.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * Arena is a bump allocator for objects that all die at the same time, such as the records and lock sets of a
+ * transaction. An allocation advances a pointer through the current block; nothing is freed on its own, Reset frees
+ * everything at once and keeps the first block for reuse.
+ *
+ * The first block may be provided by the owner, e.g. as a member, so that an arena that never outgrows it never
+ * touches the heap. Larger blocks are allocated on demand. An arena is not thread-safe.
+ */
+class Arena {
+ public:
+  /**
+   * Create an arena.
+   * @param initial_block the first block, or nullptr to allocate it on the first allocation
+   * @param initial_size the size of the first block
+   */
+  explicit Arena(std::byte *initial_block = nullptr, size_t initial_size = 0)
+      : initial_block_(initial_block), initial_size_(initial_size), cur_(initial_block), end_(initial_block) {
+    if (initial_block != nullptr) {
+      end_ += initial_size;
+    }
+  }
+
+  ~Arena() = default;
+
+  DISALLOW_COPY_AND_MOVE(Arena);
+
+  /**
+   * Allocate memory from the arena.
+   * @param size the size of the allocation
+   * @param alignment the alignment of the allocation, a power of two
+   * @return the memory allocated, valid until the arena is reset or destroyed
+   */
+  auto Allocate(size_t size, size_t alignment = alignof(std::max_align_t)) -> void * {
+    auto addr = (reinterpret_cast<uintptr_t>(cur_) + alignment - 1) & ~(alignment - 1);
+    if (cur_ == nullptr || addr + size > reinterpret_cast<uintptr_t>(end_)) {
+      return AllocateBlock(size, alignment);
+    }
+    cur_ = reinterpret_cast<std::byte *>(addr + size);
+    allocated_size_ += size;
+    return reinterpret_cast<void *>(addr);
+  }
+
+  /** Free everything allocated from the arena, keeping the first block. */
+  void Reset();
+
+  /** @return the bytes handed out since the arena was created or last reset */
+  auto GetAllocatedSize() const -> size_t { return allocated_size_; }
+
+  /** @return the number of blocks allocated on the heap, beyond the one provided at construction */
+  auto GetHeapBlockCount() const -> size_t { return blocks_.size(); }
+
+ private:
+  /** Move on to a new block large enough for an allocation that does not fit in the current one. */
+  auto AllocateBlock(size_t size, size_t alignment) -> void *;
+
+  /** The first block, as provided at construction. */
+  std::byte *initial_block_;
+  size_t initial_size_;
+  /** The free part of the current block. */
+  std::byte *cur_;
+  std::byte *end_;
+  /** The blocks allocated on the heap, the current one last. */
+  std::vector<std::unique_ptr<std::byte[]>> blocks_;
+  size_t allocated_size_{0};
+};
+
+/**
+ * ArenaAllocator lets a standard container allocate from an Arena. Deallocation is a no-op: the memory is reclaimed
+ * when the arena is reset, which must only happen once the container is destroyed.
+ */
+template <typename T>
+class ArenaAllocator {
+ public:
+  using value_type = T;  // NOLINT
+
+  explicit ArenaAllocator(Arena *arena) : arena_(arena) {}
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U> &other) : arena_(other.GetArena()) {}  // NOLINT
+
+  auto allocate(size_t n) -> T * {  // NOLINT
+    return static_cast<T *>(arena_->Allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *ptr, size_t n) {}  // NOLINT
+
+  auto GetArena() const -> Arena * { return arena_; }
+
+  template <typename U>
+  auto operator==(const ArenaAllocator<U> &other) const -> bool {
+    return arena_ == other.GetArena();
+  }
+
+  template <typename U>
+  auto operator!=(const ArenaAllocator<U> &other) const -> bool {
+    return arena_ != other.GetArena();
+  }
+
+ private:
+  Arena *arena_;
+};
+
+}  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <iostream>
 #include <memory>
+#include <mutex>  // NOLINT
 #include <optional>
 #include <shared_mutex>
 #include <sstream>
@@ -26,6 +27,7 @@
 #include "common/config.h"
 #include "common/util/string_util.h"
 #include "libfort/lib/fort.hpp"
+#include "planner/plan_cache.h"
 #include "type/value.h"
 
 namespace bustub {
@@ -38,6 +40,8 @@ class LockManager;
 class TransactionManager;
 class LogManager;
 class CheckpointManager;
+class BoundStatement;
+class PrepareStatement;
 class Catalog;
 class ExecutionEngine;
 
@@ -271,7 +275,35 @@ class BustubInstance {
   void CmdDisplayIndices(ResultWriter &writer);
   void CmdDisplayHelp(ResultWriter &writer);
   void WriteOneCell(const std::string &cell, ResultWriter &writer);
+
+  /** A statement prepared by PREPARE. Its executions share the parameter values of its plan, so they take turns. */
+  struct PreparedStatementEntry {
+    /** The bound statement, planned again when the plan goes stale */
+    std::unique_ptr<PrepareStatement> statement_;
+    /** The plan, and whether the starter rules were forced when it was optimized */
+    std::shared_ptr<const CachedPlan> plan_;
+    bool force_starter_rule_;
+    std::mutex latch_;
+  };
+
+  /** Plan and optimize a statement at the current catalog version. */
+  auto PlanStatement(const BoundStatement &statement, std::vector<TypeId> parameter_types)
+      -> std::shared_ptr<const CachedPlan>;
+
+  /** Execute a plan and write its result set. */
+  auto ExecutePlan(const CachedPlan &plan, ResultWriter &writer, Transaction *txn) -> bool;
+
+  /** Run `EXECUTE`. */
+  auto ExecutePrepared(const std::string &name, const std::vector<Value> &parameters, ResultWriter &writer,
+                       Transaction *txn) -> bool;
+
   std::unordered_map<std::string, std::string> session_variables_;
+
+  /** The plans of recently run statements, keyed by their normalized SQL and the starter rule setting */
+  PlanCache plan_cache_{PLAN_CACHE_SIZE};
+
+  std::mutex prepared_latch_;
+  std::unordered_map<std::string, std::shared_ptr<PreparedStatementEntry>> prepared_statements_;
 };
 
 }  // namespace bustub
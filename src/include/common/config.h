@@ -36,11 +36,36 @@ static constexpr int BUFFER_POOL_SIZE = 10;
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * BUSTUB_PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                               // size of extendible hash bucket
 static constexpr int LRUK_REPLACER_K = 10;  // lookback window for lru-k replacer
+static constexpr int AGGREGATION_THREADS = 4;                // worker threads of the parallel hash aggregation
+static constexpr int AGGREGATION_PARTITIONS = 64;            // radix partitions of the parallel hash aggregation
+static constexpr int AGGREGATION_BATCH_SIZE = 1024;          // tuples handed to an aggregation worker at a time
+static constexpr int AGGREGATION_LOCAL_TABLE_SIZE = 1024;    // slots of a thread-local pre-aggregation table
+static constexpr int AGGREGATION_SPILL_THRESHOLD = 1 << 16;  // default partial groups a worker buffers before spilling
+static constexpr int EXPRESSION_BATCH_SIZE = 1024;           // tuples evaluated at a time by a compiled expression
+static constexpr int STATISTICS_HISTOGRAM_BUCKETS = 64;      // buckets of an equi-depth column histogram
+static constexpr int JOIN_ORDER_MAX_RELATIONS = 10;          // largest join the optimizer enumerates orders for
+static constexpr int RUNTIME_FILTER_BITS_PER_KEY = 16;       // size of a hash join's runtime Bloom filter per key
+static constexpr int RUNTIME_FILTER_MAX_KEYS = 1 << 22;      // largest build side a runtime filter is built for
+static constexpr int RUNTIME_FILTER_SAMPLE_SIZE = 4096;      // tuples checked before judging a runtime filter
+static constexpr int RUNTIME_FILTER_MIN_DROP_PCT = 20;       // % of sampled tuples a runtime filter must drop
+static constexpr int NLJ_BLOCK_PAGES = 16;                   // pages of outer tuples a nested loop join scans at once
+static constexpr int HASH_JOIN_SCAN_MAX_ROWS = 8;            // largest build side a hash join scans instead of hashing
+static constexpr int HASH_JOIN_SWAP_CHECK_ROWS = 4096;       // build rows after which a hash join sizes its probe side
+static constexpr int PLAN_CACHE_SIZE = 128;                  // statements whose optimized plans are cached
+static constexpr int LOCK_MANAGER_ROW_SHARDS = 64;           // independently latched partitions of the row lock table
+static constexpr int LOCK_ESCALATION_THRESHOLD = 5000;       // row locks of a txn on one table before a table lock
+static constexpr int OCC_VERSION_LATCHES = 1 << 12;          // striped version latches of a table heap for OCC
+static constexpr int ARENA_BLOCK_SIZE = 1 << 14;             // size of a block an arena allocates on the heap
+static constexpr int TXN_ARENA_INLINE_SIZE = 4096;           // bytes of a transaction arena stored in the txn itself
+static constexpr int TXN_MAP_SLOTS = 1 << 14;                // slots of the map of running transactions by id
+static constexpr int TXN_ID_BATCH_SIZE = 64;                 // transaction ids a thread takes from the counter at once
+static constexpr int LATCH_SPIN_COUNT = 64;                  // times a contended latch spins before parking
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
 using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
+using timestamp_t = int64_t;   // commit timestamp type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
 
@@ -12,40 +12,121 @@
 
 #pragma once
 
-#include <mutex>  // NOLINT
-#include <shared_mutex>
+#include <atomic>
+#include <cstdint>
 
+#include "common/config.h"
 #include "common/macros.h"
 
 namespace bustub {
 
 /**
- * Reader-Writer latch backed by std::mutex.
+ * Reader-Writer latch built for the short critical sections of page latches.
+ *
+ * The whole latch is one atomic state word: the number of readers, the number of waiting writers, a write bit and a
+ * version that every write unlock bumps. Uncontended latching is a single compare-and-swap. A contended thread spins
+ * LATCH_SPIN_COUNT times before parking on a futex, which the unlocks only wake up when some thread is parked.
+ *
+ * Writers are preferred: once a writer waits, new readers wait behind it, so a stream of readers never starves a
+ * writer. A thread must therefore not read-latch a latch it already read-latched.
+ *
+ * Optimistic reads take no latch at all: OptimisticRead returns the version, the data is read, and Validate tells
+ * whether a writer latched it meanwhile, in which case what was read may be torn and the read must be retried. This
+ * is how a B+ tree can be traversed without writing to the latches of the inner pages.
  */
 class ReaderWriterLatch {
  public:
+  ReaderWriterLatch() = default;
+  ~ReaderWriterLatch() = default;
+
+  DISALLOW_COPY_AND_MOVE(ReaderWriterLatch);
+
   /**
    * Acquire a write latch.
    */
-  void WLock() { mutex_.lock(); }
+  void WLock() {
+    auto state = state_.load(std::memory_order_relaxed);
+    if ((state & (WRITER | READER_MASK)) != 0 ||
+        !state_.compare_exchange_weak(state, state | WRITER, std::memory_order_acquire, std::memory_order_relaxed)) {
+      WLockSlow();
+    }
+  }
 
   /**
    * Release a write latch.
    */
-  void WUnlock() { mutex_.unlock(); }
+  void WUnlock() {
+    state_.fetch_add(VERSION_ONE - WRITER);
+    WakeUp();
+  }
 
   /**
    * Acquire a read latch.
    */
-  void RLock() { mutex_.lock_shared(); }
+  void RLock() {
+    auto state = state_.load(std::memory_order_relaxed);
+    if ((state & (WRITER | WAITING_WRITER_MASK)) != 0 ||
+        !state_.compare_exchange_weak(state, state + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+      RLockSlow();
+    }
+  }
 
   /**
    * Release a read latch.
    */
-  void RUnlock() { mutex_.unlock_shared(); }
+  void RUnlock() {
+    auto state = state_.fetch_sub(1) - 1;
+    // Readers only ever keep writers waiting.
+    if ((state & READER_MASK) == 0 && (state & WAITING_WRITER_MASK) != 0) {
+      WakeUp();
+    }
+  }
+
+  /**
+   * Begin an optimistic read, without latching.
+   * @return the version to validate the read with, which never validates if the latch is write-latched now
+   */
+  auto OptimisticRead() const -> uint64_t { return state_.load(std::memory_order_acquire) & (VERSION_MASK | WRITER); }
+
+  /**
+   * End an optimistic read.
+   * @param version the version returned by OptimisticRead
+   * @return whether nothing was written under the latch since, so that the data read is consistent
+   */
+  auto Validate(uint64_t version) const -> bool {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (version & WRITER) == 0 && (state_.load(std::memory_order_relaxed) & (VERSION_MASK | WRITER)) == version;
+  }
 
  private:
-  std::shared_mutex mutex_;
+  /** The state word: readers in the low 20 bits, then waiting writers, the write bit and the version. */
+  static constexpr uint64_t READER_MASK = (1ULL << 20) - 1;
+  static constexpr uint64_t WAITING_WRITER_ONE = 1ULL << 20;
+  static constexpr uint64_t WAITING_WRITER_MASK = ((1ULL << 31) - 1) & ~READER_MASK;
+  static constexpr uint64_t WRITER = 1ULL << 31;
+  static constexpr uint64_t VERSION_ONE = 1ULL << 32;
+  static constexpr uint64_t VERSION_MASK = ~(VERSION_ONE - 1);
+
+  void WLockSlow();
+  void RLockSlow();
+
+  /** Spin, then park until the state word seems to allow the latch. */
+  template <typename Ready>
+  void WaitUntil(Ready ready);
+
+  /** Wake up the parked threads, if any. The state word must be updated before. */
+  void WakeUp() {
+    if (parked_.load() != 0) {
+      WakeUpSlow();
+    }
+  }
+  void WakeUpSlow();
+
+  std::atomic<uint64_t> state_{0};
+  /** The number of threads parked, or about to park, on the latch. */
+  std::atomic<uint32_t> parked_{0};
+  /** The futex word, bumped on every wake-up so that a thread about to park does not miss it. */
+  std::atomic<uint32_t> wake_seq_{0};
 };
 
 }  // namespace bustub
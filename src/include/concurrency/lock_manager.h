@@ -13,16 +13,21 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <chrono>  // NOLINT
 #include <condition_variable>  // NOLINT
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
+#include <optional>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "common/config.h"
+#include "common/macros.h"
 #include "common/rid.h"
 #include "concurrency/transaction.h"
 
@@ -32,15 +37,55 @@ class TransactionManager;
 
 /**
  * LockManager handles transactions asking for locks on records.
+ *
+ * Tables and rows are locked with multi-granularity two-phase locking: a transaction takes an intention lock on a
+ * table before taking S or X locks on its rows. Every locked resource has its own request queue, with its own latch
+ * and condition variable, so that only the requests on the same resource wait on each other. The row lock table is
+ * split into LOCK_MANAGER_ROW_SHARDS shards by RID hash, each with its own latch, so that looking up the queues of
+ * different rows does not serialize on a single latch.
+ *
+ * Once a transaction holds more than a threshold of row locks on one table, they are escalated to a lock on the whole
+ * table, see SetLockEscalationThreshold.
+ *
+ * Deadlocks are either detected or prevented, see DeadlockPolicy. The waits-for graph is maintained as requests block
+ * and unblock rather than rebuilt from the lock table, and the detection thread only searches for cycles through the
+ * transactions whose edges changed since its last pass.
+ *
+ * Index keys are locked too, so that range scans are serializable without an S lock on the whole table: a scan S-locks
+ * every key it returns and the key right after its range, and an insert X-locks the key it inserts along with the key
+ * right after it, which covers the gap the new key lands in. This is next-key locking; see LockKey.
+ *
+ * Optimistic transactions take no locks: their lock and unlock requests succeed without touching the lock tables.
  */
 class LockManager {
  public:
   enum class LockMode { SHARED, EXCLUSIVE, INTENTION_SHARED, INTENTION_EXCLUSIVE, SHARED_INTENTION_EXCLUSIVE };
 
+  /** How deadlocks are dealt with. A transaction is older than another one if it has a lower id. */
+  enum class DeadlockPolicy {
+    /** Transactions wait for each other, and the detection thread aborts the newest transaction of every cycle. */
+    DETECTION,
+    /** A transaction waits for newer transactions only, and is aborted rather than wait for an older one. */
+    WAIT_DIE,
+    /** A transaction waits for older transactions only, and aborts the newer ones it would wait for. */
+    WOUND_WAIT,
+  };
+
+  /** Counters of the deadlock handling */
+  struct DeadlockStats {
+    /** Transactions aborted to break or prevent deadlocks */
+    uint64_t aborted_txn_cnt_{0};
+    /** Waits-for cycles found by the detection thread */
+    uint64_t cycle_cnt_{0};
+    /** Total and longest time between the wait closing a cycle and the abort of its victim */
+    std::chrono::microseconds total_detection_latency_{0};
+    std::chrono::microseconds max_detection_latency_{0};
+  };
+
   /**
    * Structure to hold a lock request.
-   * This could be a lock request on a table OR a row.
-   * For table lock requests, the rid_ attribute would be unused.
+   * This could be a lock request on a table OR a row OR an index key.
+   * For table and key lock requests, the rid_ attribute would be unused.
    */
   class LockRequest {
    public:
@@ -48,27 +93,48 @@ class LockManager {
         : txn_id_(txn_id), lock_mode_(lock_mode), oid_(oid) {}
     LockRequest(txn_id_t txn_id, LockMode lock_mode, table_oid_t oid, RID rid) /** Row lock request */
         : txn_id_(txn_id), lock_mode_(lock_mode), oid_(oid), rid_(rid) {}
+    LockRequest(txn_id_t txn_id, LockMode lock_mode, index_oid_t index_oid, uint64_t key) /** Key lock request */
+        : txn_id_(txn_id), lock_mode_(lock_mode), oid_(index_oid), is_key_lock_(true), key_(key) {}
 
     /** Txn_id of the txn requesting the lock */
     txn_id_t txn_id_;
     /** Locking mode of the requested lock */
     LockMode lock_mode_;
-    /** Oid of the table for a table lock; oid of the table the row belong to for a row lock */
+    /** Oid of the table for a table lock; oid of the table the row belong to for a row lock; oid of the index for a
+     * key lock */
     table_oid_t oid_;
-    /** Rid of the row for a row lock; unused for table locks */
+    /** Rid of the row for a row lock; unused for table and key locks */
     RID rid_;
+    /** Whether this is a key lock */
+    bool is_key_lock_{false};
+    /** The locked key, see KeyLockOf, for a key lock */
+    uint64_t key_{0};
     /** Whether the lock has been granted or not */
     bool granted_{false};
   };
 
   class LockRequestQueue {
    public:
-    /** List of lock requests for the same resource (table or row) */
+    LockRequestQueue() = default;
+    ~LockRequestQueue() {
+      for (auto *request : request_queue_) {
+        delete request;
+      }
+    }
+    DISALLOW_COPY_AND_MOVE(LockRequestQueue);
+
+    /** List of lock requests for the same resource (table or row), the granted ones first */
     std::list<LockRequest *> request_queue_;
     /** For notifying blocked transactions on this rid */
     std::condition_variable cv_;
     /** txn_id of an upgrading transaction (if any) */
     txn_id_t upgrading_ = INVALID_TXN_ID;
+    /**
+     * The highest dependency LSN of the transactions that released a write lock on the resource. A transaction granted
+     * the lock may see their writes, so its commit waits for that LSN too: with early lock release, their commit
+     * records may not be persistent yet.
+     */
+    lsn_t release_lsn_ = INVALID_LSN;
     /** coordination */
     std::mutex latch_;
   };
@@ -82,7 +148,11 @@ class LockManager {
   }
 
   ~LockManager() {
-    enable_cycle_detection_ = false;
+    {
+      std::lock_guard<std::mutex> guard(waits_for_latch_);
+      enable_cycle_detection_ = false;
+    }
+    detection_cv_.notify_all();
     cycle_detection_thread_->join();
     delete cycle_detection_thread_;
   }
@@ -264,6 +334,62 @@ class LockManager {
    */
   auto UnlockRow(Transaction *txn, const table_oid_t &oid, const RID &rid) -> bool;
 
+  /** The key lock that stands for the end of an index, past its greatest key. */
+  static constexpr uint64_t KEY_LOCK_SUPREMUM = ~0ULL;
+
+  /**
+   * Map an index key to the key lock that stands for it. Keys are locked by hash, never as KEY_LOCK_SUPREMUM: two keys
+   * with the same hash share a lock, which makes locking stricter but never lets a phantom through.
+   * @param key the bytes of the key
+   * @param size the size of the key
+   * @return the key lock
+   */
+  static auto KeyLockOf(const char *key, size_t size) -> uint64_t;
+
+  /**
+   * Acquire a lock on an index key, or on the gap before it: locks on keys guard the keys and the gaps right before
+   * them together, so that S-locking the keys of a range and the key right after it, or KEY_LOCK_SUPREMUM at the end of
+   * the index, keeps other transactions from inserting into the range. An inserting transaction X-locks the key it
+   * inserts, and the key right after it for the duration of the insert.
+   *
+   * Key locks are S or X. They do not need a table lock, and the isolation level and state of the transaction are
+   * checked as for row locks. An X lock covers an S request; an S lock is upgraded by an X request.
+   *
+   * @param txn the transaction requesting the lock
+   * @param lock_mode SHARED or EXCLUSIVE
+   * @param index_oid the index_oid_t of the index the key belongs to
+   * @param key the key lock, see KeyLockOf
+   * @return true if the lock is granted, false if the transaction was aborted while waiting
+   */
+  auto LockKey(Transaction *txn, LockMode lock_mode, const index_oid_t &index_oid, uint64_t key) -> bool;
+
+  /**
+   * Release the lock held on an index key by the transaction. Unlike the other unlocks, releasing a key lock never ends
+   * the growing phase of the transaction: inserts release the gap locks they take as soon as the key is inserted.
+   *
+   * @param txn the transaction releasing the lock
+   * @param index_oid the index_oid_t of the index the key belongs to
+   * @param key the key lock, see KeyLockOf
+   * @return true if the unlock is successful
+   */
+  auto UnlockKey(Transaction *txn, const index_oid_t &index_oid, uint64_t key) -> bool;
+
+  /**
+   * Set how many row locks a transaction can hold on one table before the lock manager tries to escalate them to a
+   * table lock: the table lock is upgraded to S, SIX or X, so as to cover all the rows, and the row locks are released.
+   * Escalation never waits: if other transactions hold conflicting table locks it is retried after as many row locks
+   * again. Once escalated, the rows of the table are not locked individually anymore.
+   * @param threshold the number of row locks, 0 to disable escalation
+   */
+  void SetLockEscalationThreshold(size_t threshold) { escalation_threshold_ = threshold; }
+
+  /**
+   * Set how deadlocks are dealt with. Under WAIT_DIE and WOUND_WAIT, the transactions aborted are set ABORTED, so that
+   * their pending lock request returns false. A transaction wounded while it is not waiting for a lock only notices
+   * at its next lock request.
+   */
+  void SetDeadlockPolicy(DeadlockPolicy policy) { deadlock_policy_ = policy; }
+
   /*** Graph API ***/
 
   /**
@@ -292,28 +418,166 @@ class LockManager {
    */
   auto GetEdgeList() -> std::vector<std::pair<txn_id_t, txn_id_t>>;
 
+  /** @return the counters of the deadlock handling */
+  auto GetDeadlockStats() -> DeadlockStats;
+
   /**
-   * Runs cycle detection in the background.
+   * Runs cycle detection in the background: whenever requests start waiting or every cycle_detection_interval, look
+   * for the cycles through the transactions whose waits-for edges changed, and abort the newest transaction of each.
    */
   auto RunCycleDetection() -> void;
 
  private:
+  /** A partition of the row lock table */
+  struct RowLockShard {
+    /** Structure that holds lock requests for the RIDs of the shard */
+    std::unordered_map<RID, std::shared_ptr<LockRequestQueue>> row_lock_map_;
+    /** The highest release LSN of the queues dropped from the shard, which the queues created in their place inherit */
+    lsn_t dropped_release_lsn_ = INVALID_LSN;
+    /** Coordination */
+    std::mutex latch_;
+  };
+
+  /** The identity of a key lock */
+  struct KeyLockId {
+    index_oid_t index_oid_;
+    uint64_t key_;
+
+    auto operator==(const KeyLockId &other) const -> bool {
+      return index_oid_ == other.index_oid_ && key_ == other.key_;
+    }
+  };
+
+  struct KeyLockIdHash {
+    auto operator()(const KeyLockId &id) const -> size_t {
+      return std::hash<uint64_t>()(id.key_ ^ (static_cast<uint64_t>(id.index_oid_) * 0x9E3779B97F4A7C15ULL));
+    }
+  };
+
+  /** A transaction waiting for a lock */
+  struct Waiter {
+    Transaction *txn_;
+    /** The queue the transaction waits in, kept alive so that the transaction can be woken up if it gets aborted */
+    std::shared_ptr<LockRequestQueue> queue_;
+  };
+
+  /** @return whether a lock in mode `requested` can be granted next to a lock in mode `held` */
+  static auto AreLocksCompatible(LockMode held, LockMode requested) -> bool;
+
+  /** @return whether a lock held in mode `held` can be upgraded to mode `requested` */
+  static auto CanUpgrade(LockMode held, LockMode requested) -> bool;
+
+  /** Set the transaction ABORTED and throw a TransactionAbortException. */
+  [[noreturn]] static void AbortTransaction(Transaction *txn, AbortReason reason);
+
+  /** Abort the transaction if its isolation level and state do not allow taking a lock in `lock_mode`. */
+  static void CheckLockAllowed(Transaction *txn, LockMode lock_mode);
+
+  /** @return the shard of the row lock table that holds the queue of `rid` */
+  auto RowShardOf(const RID &rid) -> RowLockShard &;
+
+  /**
+   * Queue a request of the transaction on a resource and wait until it is granted, upgrading the lock the transaction
+   * already holds on the resource if any. `queue_latch` holds the latch of `queue`.
+   * @return false if the transaction was aborted while waiting
+   */
+  auto AcquireLock(Transaction *txn, const std::shared_ptr<LockRequestQueue> &queue,
+                   std::unique_lock<std::mutex> *queue_latch, std::unique_ptr<LockRequest> request) -> bool;
+
+  /**
+   * Record that a request waits for the requests ahead of it that it conflicts with, replacing what it waited for
+   * before, and apply the deadlock policy. The latch of the queue must be held.
+   * @return the queues the transactions wounded under WOUND_WAIT wait in, to wake up once the latch is released
+   */
+  auto Wait(Transaction *txn, const std::shared_ptr<LockRequestQueue> &queue, const LockRequest *request)
+      -> std::vector<std::shared_ptr<LockRequestQueue>>;
+
+  /** Forget a transaction that stopped waiting, along with its waits-for edges. */
+  void StopWaiting(txn_id_t txn_id);
+
+  /**
+   * Look for a cycle of the waits-for graph through a transaction, visiting the transactions in ascending id order.
+   * The waits-for latch must be held.
+   * @param[out] cycle the transactions of the cycle found
+   * @return whether a cycle was found
+   */
+  auto FindCycle(txn_id_t txn_id, std::vector<txn_id_t> *cycle) -> bool;
+
+  /** Wake up the transactions waiting in `queues`, some of which were aborted by another thread. */
+  static void WakeUp(const std::vector<std::shared_ptr<LockRequestQueue>> &queues);
+
+  /** @return whether `request` is compatible with all the requests ahead of it, which are all granted */
+  static auto IsGrantable(const LockRequestQueue &queue, const LockRequest *request) -> bool;
+
+  /**
+   * Remove the request of the transaction from a queue and wake up the requests waiting behind it, which stop waiting
+   * for the transaction in the waits-for graph.
+   * @return the mode of the removed request, or std::nullopt if the transaction has no granted request in the queue
+   */
+  auto ReleaseLock(Transaction *txn, LockRequestQueue *queue) -> std::optional<LockMode>;
+
+  /**
+   * Remove the lock of the transaction on a row from the row lock table, without updating the state of the
+   * transaction.
+   * @return the mode of the released lock, or std::nullopt if the transaction holds no lock on the row
+   */
+  auto ReleaseRowLock(Transaction *txn, const RID &rid) -> std::optional<LockMode>;
+
+  /** @return whether the table lock held by the transaction, if any, also covers a lock in `lock_mode` on its rows */
+  static auto IsRowLockCovered(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool;
+
+  /** @return whether the transaction escalated its row locks on the table to a table lock covering `lock_mode` */
+  static auto IsEscalated(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool;
+
+  /**
+   * Upgrade the table lock held by the transaction to `lock_mode` if that can be done without waiting.
+   * @return whether the transaction now holds the table lock in `lock_mode`
+   */
+  auto TryUpgradeTableLock(Transaction *txn, LockMode lock_mode, const table_oid_t &oid) -> bool;
+
+  /** Replace the row locks of the transaction on a table with a table lock covering them, if it can be granted. */
+  void EscalateRowLocks(Transaction *txn, const table_oid_t &oid);
+
+  /** Move the transaction to SHRINKING if releasing a lock in `lock_mode` ends its growing phase. */
+  static void UpdateStateOnUnlock(Transaction *txn, LockMode lock_mode);
+
+  /** Add a granted lock to, or remove a released lock from, the lock sets of the transaction. */
+  static void BookKeep(Transaction *txn, const LockRequest &request, bool granted);
+
   /** Fall 2022 */
   /** Structure that holds lock requests for a given table oid */
   std::unordered_map<table_oid_t, std::shared_ptr<LockRequestQueue>> table_lock_map_;
   /** Coordination */
   std::mutex table_lock_map_latch_;
 
-  /** Structure that holds lock requests for a given RID */
-  std::unordered_map<RID, std::shared_ptr<LockRequestQueue>> row_lock_map_;
+  /** Structure that holds lock requests for the locked index keys */
+  std::unordered_map<KeyLockId, std::shared_ptr<LockRequestQueue>, KeyLockIdHash> key_lock_map_;
+  /** The highest release LSN of the queues dropped from the key lock table */
+  lsn_t dropped_key_release_lsn_ = INVALID_LSN;
   /** Coordination */
-  std::mutex row_lock_map_latch_;
+  std::mutex key_lock_map_latch_;
+
+  /** The row lock table, partitioned by RID hash */
+  std::array<RowLockShard, LOCK_MANAGER_ROW_SHARDS> row_lock_shards_;
+  /** Row locks a transaction can hold on one table before they are escalated, 0 if escalation is disabled */
+  std::atomic<size_t> escalation_threshold_{LOCK_ESCALATION_THRESHOLD};
+
+  /** How deadlocks are dealt with */
+  std::atomic<DeadlockPolicy> deadlock_policy_{DeadlockPolicy::DETECTION};
+  /** The waits-for graph: the transactions each waiting transaction waits for, in ascending id order */
+  std::unordered_map<txn_id_t, std::set<txn_id_t>> waits_for_;
+  /** The transactions waiting for a lock */
+  std::unordered_map<txn_id_t, Waiter> waiters_;
+  /** The transactions whose waits-for edges changed since the last detection pass, and when they did */
+  std::vector<std::pair<txn_id_t, std::chrono::steady_clock::time_point>> changed_waiters_;
+  DeadlockStats deadlock_stats_;
+  /** Coordination of the waits-for graph and the deadlock counters */
+  std::mutex waits_for_latch_;
+  /** For waking up the detection thread when transactions start waiting */
+  std::condition_variable detection_cv_;
 
   std::atomic<bool> enable_cycle_detection_;
   std::thread *cycle_detection_thread_;
-  /** Waits-for graph representation. */
-  std::unordered_map<txn_id_t, std::vector<txn_id_t>> waits_for_;
-  std::mutex waits_for_latch_;
 };
 
 }  // namespace bustub
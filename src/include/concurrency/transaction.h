@@ -12,16 +12,21 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
 #include <atomic>
-#include <deque>
-#include <memory>
+#include <cstddef>
+#include <cstring>
+#include <mutex>  // NOLINT
+#include <optional>
 #include <string>
 #include <thread>  // NOLINT
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
+#include "common/arena.h"
 #include "common/config.h"
 #include "common/logger.h"
+#include "container/hash/flat_hash_table.h"
 #include "storage/page/page.h"
 #include "storage/table/tuple.h"
 
@@ -45,9 +50,24 @@ namespace bustub {
 enum class TransactionState { GROWING, SHRINKING, COMMITTED, ABORTED };
 
 /**
- * Transaction isolation level.
+ * Transaction isolation level. Under SNAPSHOT_ISOLATION, a transaction reads the versions committed before it began
+ * (see VersionStore) and locks only what it writes, like under REPEATABLE_READ.
  */
-enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED };
+enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED, SNAPSHOT_ISOLATION };
+
+/**
+ * How a transaction is kept from conflicting with the others.
+ */
+enum class ConcurrencyControl {
+  /** Two-phase locking, through the LockManager. */
+  LOCKING,
+  /**
+   * Optimistic concurrency control: the transaction takes no locks, records the versions of the tuples it reads and
+   * buffers its updates and deletes, which TransactionManager::Commit validates and installs. It reads the newest
+   * versions, whatever its isolation level.
+   */
+  OPTIMISTIC
+};
 
 /**
  * Type of write operation.
@@ -69,12 +89,25 @@ class TableWriteRecord {
 
   RID rid_;
   WType wtype_;
-  /** The tuple is only used for the update operation. */
+  /** The tuple is only used for the update operation: the old tuple, or the new one for a buffered write. */
   Tuple tuple_;
   /** The table heap specifies which table this write record is for. */
   TableHeap *table_;
 };
 
+/**
+ * ReadRecord tracks a tuple read by an optimistic transaction.
+ */
+class TableReadRecord {
+ public:
+  TableReadRecord(RID rid, uint64_t version, TableHeap *table) : rid_(rid), version_(version), table_(table) {}
+
+  RID rid_;
+  /** The word of the version latch of the tuple before it was read, see VersionLatchTable. */
+  uint64_t version_;
+  TableHeap *table_;
+};
+
 /**
  * WriteRecord tracks information related to a write.
  */
@@ -153,30 +186,34 @@ class TransactionAbortException : public std::exception {
   }
 };
 
+/** A vector allocated in the arena of a transaction. */
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+/** The row locks of a transaction, by table. */
+using RowLockSet = FlatHashMap<table_oid_t, FlatHashSet<RID>>;
+
+/** The index key locks of a transaction, by index, see LockManager::LockKey. */
+using KeyLockSet = FlatHashMap<index_oid_t, FlatHashSet<uint64_t>>;
+
 /**
  * Transaction tracks information related to a transaction.
+ *
+ * The records and lock sets of a transaction are allocated in its arena, whose first block is part of the
+ * transaction itself, so that a short transaction does not allocate for its bookkeeping. The arena is reset when the
+ * transaction commits or aborts, which empties them all at once.
  */
 class Transaction {
  public:
-  explicit Transaction(txn_id_t txn_id, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ)
+  explicit Transaction(txn_id_t txn_id, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ,
+                       ConcurrencyControl concurrency_control = ConcurrencyControl::LOCKING)
       : isolation_level_(isolation_level),
+        concurrency_control_(concurrency_control),
         thread_id_(std::this_thread::get_id()),
         txn_id_(txn_id),
-        prev_lsn_(INVALID_LSN),
-        shared_lock_set_{new std::unordered_set<RID>},
-        exclusive_lock_set_{new std::unordered_set<RID>},
-        s_table_lock_set_{new std::unordered_set<table_oid_t>},
-        x_table_lock_set_{new std::unordered_set<table_oid_t>},
-        is_table_lock_set_{new std::unordered_set<table_oid_t>},
-        ix_table_lock_set_{new std::unordered_set<table_oid_t>},
-        six_table_lock_set_{new std::unordered_set<table_oid_t>},
-        s_row_lock_set_{new std::unordered_map<table_oid_t, std::unordered_set<RID>>},
-        x_row_lock_set_{new std::unordered_map<table_oid_t, std::unordered_set<RID>>} {
+        prev_lsn_(INVALID_LSN) {
     // Initialize the sets that will be tracked.
-    table_write_set_ = std::make_shared<std::deque<TableWriteRecord>>();
-    index_write_set_ = std::make_shared<std::deque<IndexWriteRecord>>();
-    page_set_ = std::make_shared<std::deque<bustub::Page *>>();
-    deleted_page_set_ = std::make_shared<std::unordered_set<page_id_t>>();
+    sets_.emplace(&arena_);
   }
 
   ~Transaction() = default;
@@ -192,21 +229,33 @@ class Transaction {
   /** @return the isolation level of this transaction */
   inline auto GetIsolationLevel() const -> IsolationLevel { return isolation_level_; }
 
+  /** @return the concurrency control of this transaction */
+  inline auto GetConcurrencyControl() const -> ConcurrencyControl { return concurrency_control_; }
+
+  /** @return whether this transaction runs under optimistic concurrency control */
+  inline auto IsOptimistic() const -> bool { return concurrency_control_ == ConcurrencyControl::OPTIMISTIC; }
+
   /** @return the list of table write records of this transaction */
-  inline auto GetWriteSet() -> std::shared_ptr<std::deque<TableWriteRecord>> { return table_write_set_; }
+  inline auto GetWriteSet() -> ArenaVector<TableWriteRecord> * { return &sets_->table_write_set_; }
+
+  /** @return the tuples read by this transaction, if optimistic */
+  inline auto GetReadSet() -> ArenaVector<TableReadRecord> * { return &sets_->table_read_set_; }
+
+  /** @return the updates and deletes buffered by this transaction until it commits, if optimistic */
+  inline auto GetBufferedWriteSet() -> ArenaVector<TableWriteRecord> * { return &sets_->buffered_write_set_; }
 
   /** @return the list of index write records of this transaction */
-  inline auto GetIndexWriteSet() -> std::shared_ptr<std::deque<IndexWriteRecord>> { return index_write_set_; }
+  inline auto GetIndexWriteSet() -> ArenaVector<IndexWriteRecord> * { return &sets_->index_write_set_; }
 
   /** @return the page set */
-  inline auto GetPageSet() -> std::shared_ptr<std::deque<Page *>> { return page_set_; }
+  inline auto GetPageSet() -> ArenaVector<Page *> * { return &sets_->page_set_; }
 
   /**
    * Adds a tuple write record into the table write set.
    * @param write_record write record to be added
    */
   inline void AppendTableWriteRecord(const TableWriteRecord &write_record) {
-    table_write_set_->push_back(write_record);
+    sets_->table_write_set_.push_back(write_record);
   }
 
   /**
@@ -214,95 +263,130 @@ class Transaction {
    * @param write_record write record to be added
    */
   inline void AppendIndexWriteRecord(const IndexWriteRecord &write_record) {
-    index_write_set_->push_back(write_record);
+    sets_->index_write_set_.push_back(write_record);
   }
 
   /**
    * Adds a page into the page set.
    * @param page page to be added
    */
-  inline void AddIntoPageSet(Page *page) { page_set_->push_back(page); }
+  inline void AddIntoPageSet(Page *page) { sets_->page_set_.push_back(page); }
 
   /** @return the deleted page set */
-  inline auto GetDeletedPageSet() -> std::shared_ptr<std::unordered_set<page_id_t>> { return deleted_page_set_; }
+  inline auto GetDeletedPageSet() -> FlatHashSet<page_id_t> * { return &sets_->deleted_page_set_; }
 
   /**
    * Adds a page to the deleted page set.
    * @param page_id id of the page to be marked as deleted
    */
-  inline void AddIntoDeletedPageSet(page_id_t page_id) { deleted_page_set_->insert(page_id); }
+  inline void AddIntoDeletedPageSet(page_id_t page_id) { sets_->deleted_page_set_.insert(page_id); }
 
   /** @return the set of resources under a shared lock */
-  inline auto GetSharedLockSet() -> std::shared_ptr<std::unordered_set<RID>> { return shared_lock_set_; }
+  inline auto GetSharedLockSet() -> FlatHashSet<RID> * { return &sets_->shared_lock_set_; }
 
   /** @return the set of rows under a shared lock */
-  inline auto GetSharedRowLockSet() -> std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_set<RID>>> {
-    return s_row_lock_set_;
-  }
+  inline auto GetSharedRowLockSet() -> RowLockSet * { return &sets_->s_row_lock_set_; }
 
   /** @return the set of resources under an exclusive lock */
-  inline auto GetExclusiveLockSet() -> std::shared_ptr<std::unordered_set<RID>> { return exclusive_lock_set_; }
+  inline auto GetExclusiveLockSet() -> FlatHashSet<RID> * { return &sets_->exclusive_lock_set_; }
 
   /** @return the set of rows in under an exclusive lock */
-  inline auto GetExclusiveRowLockSet() -> std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_set<RID>>> {
-    return x_row_lock_set_;
-  }
+  inline auto GetExclusiveRowLockSet() -> RowLockSet * { return &sets_->x_row_lock_set_; }
+
+  /** @return the set of index keys under a shared lock */
+  inline auto GetSharedKeyLockSet() -> KeyLockSet * { return &sets_->s_key_lock_set_; }
+
+  /** @return the set of index keys under an exclusive lock */
+  inline auto GetExclusiveKeyLockSet() -> KeyLockSet * { return &sets_->x_key_lock_set_; }
 
   /** @return the set of resources under a shared lock */
-  inline auto GetSharedTableLockSet() -> std::shared_ptr<std::unordered_set<table_oid_t>> { return s_table_lock_set_; }
-  inline auto GetExclusiveTableLockSet() -> std::shared_ptr<std::unordered_set<table_oid_t>> {
-    return x_table_lock_set_;
-  }
-  inline auto GetIntentionSharedTableLockSet() -> std::shared_ptr<std::unordered_set<table_oid_t>> {
-    return is_table_lock_set_;
+  inline auto GetSharedTableLockSet() -> FlatHashSet<table_oid_t> * { return &sets_->s_table_lock_set_; }
+  inline auto GetExclusiveTableLockSet() -> FlatHashSet<table_oid_t> * { return &sets_->x_table_lock_set_; }
+  inline auto GetIntentionSharedTableLockSet() -> FlatHashSet<table_oid_t> * { return &sets_->is_table_lock_set_; }
+  inline auto GetIntentionExclusiveTableLockSet() -> FlatHashSet<table_oid_t> * {
+    return &sets_->ix_table_lock_set_;
   }
-  inline auto GetIntentionExclusiveTableLockSet() -> std::shared_ptr<std::unordered_set<table_oid_t>> {
-    return ix_table_lock_set_;
-  }
-  inline auto GetSharedIntentionExclusiveTableLockSet() -> std::shared_ptr<std::unordered_set<table_oid_t>> {
-    return six_table_lock_set_;
+  inline auto GetSharedIntentionExclusiveTableLockSet() -> FlatHashSet<table_oid_t> * {
+    return &sets_->six_table_lock_set_;
   }
 
+  /** @return the set of tables whose row locks were escalated to the table lock */
+  inline auto GetEscalatedTableSet() -> FlatHashSet<table_oid_t> * { return &sets_->escalated_table_set_; }
+
   /** @return true if rid (belong to table oid) is shared locked by this transaction */
   auto IsRowSharedLocked(const table_oid_t &oid, const RID &rid) -> bool {
-    auto row_lock_set = s_row_lock_set_->find(oid);
-    if (row_lock_set == s_row_lock_set_->end()) {
+    auto row_lock_set = sets_->s_row_lock_set_.find(oid);
+    if (row_lock_set == sets_->s_row_lock_set_.end()) {
       return false;
     }
-    return row_lock_set->second.find(rid) != row_lock_set->second.end();
+    return row_lock_set->second.count(rid) > 0;
   }
 
   /** @return true if rid (belong to table oid) is exclusive locked by this transaction */
   auto IsRowExclusiveLocked(const table_oid_t &oid, const RID &rid) -> bool {
-    auto row_lock_set = x_row_lock_set_->find(oid);
-    if (row_lock_set == x_row_lock_set_->end()) {
+    auto row_lock_set = sets_->x_row_lock_set_.find(oid);
+    if (row_lock_set == sets_->x_row_lock_set_.end()) {
       return false;
     }
-    return row_lock_set->second.find(rid) != row_lock_set->second.end();
+    return row_lock_set->second.count(rid) > 0;
   }
 
-  auto IsTableIntentionSharedLocked(const table_oid_t &oid) -> bool {
-    return is_table_lock_set_->find(oid) != is_table_lock_set_->end();
+  /** @return true if the key lock of an index is shared locked by this transaction */
+  auto IsKeySharedLocked(const index_oid_t &index_oid, uint64_t key) -> bool {
+    auto key_lock_set = sets_->s_key_lock_set_.find(index_oid);
+    return key_lock_set != sets_->s_key_lock_set_.end() && key_lock_set->second.count(key) > 0;
   }
 
-  auto IsTableSharedLocked(const table_oid_t &oid) -> bool {
-    return s_table_lock_set_->find(oid) != s_table_lock_set_->end();
+  /** @return true if the key lock of an index is exclusive locked by this transaction */
+  auto IsKeyExclusiveLocked(const index_oid_t &index_oid, uint64_t key) -> bool {
+    auto key_lock_set = sets_->x_key_lock_set_.find(index_oid);
+    return key_lock_set != sets_->x_key_lock_set_.end() && key_lock_set->second.count(key) > 0;
   }
 
+  auto IsTableIntentionSharedLocked(const table_oid_t &oid) -> bool { return sets_->is_table_lock_set_.count(oid) > 0; }
+
+  auto IsTableSharedLocked(const table_oid_t &oid) -> bool { return sets_->s_table_lock_set_.count(oid) > 0; }
+
   auto IsTableIntentionExclusiveLocked(const table_oid_t &oid) -> bool {
-    return ix_table_lock_set_->find(oid) != ix_table_lock_set_->end();
+    return sets_->ix_table_lock_set_.count(oid) > 0;
   }
 
-  auto IsTableExclusiveLocked(const table_oid_t &oid) -> bool {
-    return x_table_lock_set_->find(oid) != x_table_lock_set_->end();
-  }
+  auto IsTableExclusiveLocked(const table_oid_t &oid) -> bool { return sets_->x_table_lock_set_.count(oid) > 0; }
 
   auto IsTableSharedIntentionExclusiveLocked(const table_oid_t &oid) -> bool {
-    return six_table_lock_set_->find(oid) != six_table_lock_set_->end();
+    return sets_->six_table_lock_set_.count(oid) > 0;
   }
 
+  /**
+   * Copy a tuple into the arena, e.g. for a write record.
+   * @param tuple the tuple to copy
+   * @return a tuple borrowing the copy, valid until the transaction commits or aborts
+   */
+  auto CopyToArena(const Tuple &tuple) -> Tuple {
+    auto *data = static_cast<char *>(arena_.Allocate(tuple.GetLength(), 1));
+    if (tuple.GetLength() > 0) {
+      memcpy(data, tuple.GetData(), tuple.GetLength());
+    }
+    return {tuple.GetRid(), data, tuple.GetLength()};
+  }
+
+  /**
+   * Drop the records and lock sets of the transaction and reclaim the arena, once it committed or aborted and no
+   * longer needs them.
+   */
+  void ResetArena() {
+    std::scoped_lock latch(latch_);
+    // The containers let go of their memory before the arena can hand it out again.
+    sets_.reset();
+    arena_.Reset();
+    sets_.emplace(&arena_);
+  }
+
+  /** @return the arena of the transaction */
+  inline auto GetArena() -> Arena * { return &arena_; }
+
   /** @return the current state of the transaction */
-  inline auto GetState() -> TransactionState { return state_; }
+  inline auto GetState() const -> TransactionState { return state_; }
 
   inline auto LockTxn() -> void { latch_.lock(); }
 
@@ -314,6 +398,18 @@ class Transaction {
    */
   inline void SetState(TransactionState state) { state_ = state; }
 
+  /** @return the timestamp of the last commit when this transaction began, i.e. of its snapshot */
+  inline auto GetReadTs() const -> timestamp_t { return read_ts_; }
+
+  /** @param read_ts the read timestamp */
+  inline void SetReadTs(timestamp_t read_ts) { read_ts_ = read_ts; }
+
+  /** @return the commit timestamp, valid once the transaction committed writes */
+  inline auto GetCommitTs() const -> timestamp_t { return commit_ts_; }
+
+  /** @param commit_ts the commit timestamp */
+  inline void SetCommitTs(timestamp_t commit_ts) { commit_ts_ = commit_ts; }
+
   /** @return the previous LSN */
   inline auto GetPrevLSN() -> lsn_t { return prev_lsn_; }
 
@@ -323,45 +419,103 @@ class Transaction {
    */
   inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
 
+  /** @return the LSN that must be persistent before the commit of the transaction is acknowledged */
+  inline auto GetDependencyLSN() const -> lsn_t { return dependency_lsn_; }
+
+  /**
+   * Hold back the commit of the transaction until an LSN is persistent, such as the commit record of a transaction
+   * whose writes it saw through a lock released early.
+   * @param lsn the LSN, INVALID_LSN for none
+   */
+  inline void AddDependencyLSN(lsn_t lsn) { dependency_lsn_ = std::max(dependency_lsn_, lsn); }
+
  private:
   /** The current transaction state. */
   TransactionState state_{TransactionState::GROWING};
   /** The isolation level of the transaction. */
   IsolationLevel isolation_level_;
+  /** The concurrency control of the transaction. */
+  ConcurrencyControl concurrency_control_;
   /** The thread ID, used in single-threaded transactions. */
   std::thread::id thread_id_;
   /** The ID of this transaction. */
   txn_id_t txn_id_;
+  /** The read timestamp: versions committed at or before it are visible to a snapshot read. */
+  timestamp_t read_ts_{0};
+  /** The commit timestamp. */
+  timestamp_t commit_ts_{0};
 
-  /** The undo set of table tuples. */
-  std::shared_ptr<std::deque<TableWriteRecord>> table_write_set_;
-  /** The undo set of indexes. */
-  std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
   /** The LSN of the last record written by the transaction. */
   lsn_t prev_lsn_;
+  /** The LSN the commit of the transaction waits for. */
+  lsn_t dependency_lsn_{INVALID_LSN};
 
   std::mutex latch_;
 
-  /** Concurrent index: the pages that were latched during index operation. */
-  std::shared_ptr<std::deque<Page *>> page_set_;
-  /** Concurrent index: the page IDs that were deleted during index operation.*/
-  std::shared_ptr<std::unordered_set<page_id_t>> deleted_page_set_;
-
-  /** LockManager: the set of shared-locked tuples held by this transaction. */
-  std::shared_ptr<std::unordered_set<RID>> shared_lock_set_;
-  /** LockManager: the set of exclusive-locked tuples held by this transaction. */
-  std::shared_ptr<std::unordered_set<RID>> exclusive_lock_set_;
-
-  /** LockManager: the set of table locks held by this transaction. */
-  std::shared_ptr<std::unordered_set<table_oid_t>> s_table_lock_set_;
-  std::shared_ptr<std::unordered_set<table_oid_t>> x_table_lock_set_;
-  std::shared_ptr<std::unordered_set<table_oid_t>> is_table_lock_set_;
-  std::shared_ptr<std::unordered_set<table_oid_t>> ix_table_lock_set_;
-  std::shared_ptr<std::unordered_set<table_oid_t>> six_table_lock_set_;
-
-  /** LockManager: the set of row locks held by this transaction. */
-  std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_set<RID>>> s_row_lock_set_;
-  std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_set<RID>>> x_row_lock_set_;
+  /** The sets tracked by the transaction, all allocated in its arena. */
+  struct Sets {
+    explicit Sets(Arena *arena)
+        : table_write_set_(ArenaAllocator<TableWriteRecord>(arena)),
+          table_read_set_(ArenaAllocator<TableReadRecord>(arena)),
+          buffered_write_set_(ArenaAllocator<TableWriteRecord>(arena)),
+          index_write_set_(ArenaAllocator<IndexWriteRecord>(arena)),
+          page_set_(ArenaAllocator<Page *>(arena)),
+          deleted_page_set_(arena),
+          shared_lock_set_(arena),
+          exclusive_lock_set_(arena),
+          s_table_lock_set_(arena),
+          x_table_lock_set_(arena),
+          is_table_lock_set_(arena),
+          ix_table_lock_set_(arena),
+          six_table_lock_set_(arena),
+          escalated_table_set_(arena),
+          s_row_lock_set_(arena),
+          x_row_lock_set_(arena),
+          s_key_lock_set_(arena),
+          x_key_lock_set_(arena) {}
+
+    /** The undo set of table tuples. */
+    ArenaVector<TableWriteRecord> table_write_set_;
+    /** OCC: the tuples read, to validate at commit. */
+    ArenaVector<TableReadRecord> table_read_set_;
+    /** OCC: the redo set of the updates and deletes, installed at commit. */
+    ArenaVector<TableWriteRecord> buffered_write_set_;
+    /** The undo set of indexes. */
+    ArenaVector<IndexWriteRecord> index_write_set_;
+
+    /** Concurrent index: the pages that were latched during index operation. */
+    ArenaVector<Page *> page_set_;
+    /** Concurrent index: the page IDs that were deleted during index operation.*/
+    FlatHashSet<page_id_t> deleted_page_set_;
+
+    /** LockManager: the set of shared-locked tuples held by this transaction. */
+    FlatHashSet<RID> shared_lock_set_;
+    /** LockManager: the set of exclusive-locked tuples held by this transaction. */
+    FlatHashSet<RID> exclusive_lock_set_;
+
+    /** LockManager: the set of table locks held by this transaction. */
+    FlatHashSet<table_oid_t> s_table_lock_set_;
+    FlatHashSet<table_oid_t> x_table_lock_set_;
+    FlatHashSet<table_oid_t> is_table_lock_set_;
+    FlatHashSet<table_oid_t> ix_table_lock_set_;
+    FlatHashSet<table_oid_t> six_table_lock_set_;
+    /** LockManager: the tables whose row locks were escalated, so that the table lock covers all their rows. */
+    FlatHashSet<table_oid_t> escalated_table_set_;
+
+    /** LockManager: the set of row locks held by this transaction. */
+    RowLockSet s_row_lock_set_;
+    RowLockSet x_row_lock_set_;
+
+    /** LockManager: the set of index key locks held by this transaction. */
+    KeyLockSet s_key_lock_set_;
+    KeyLockSet x_key_lock_set_;
+  };
+
+  /** The first block of the arena. */
+  alignas(std::max_align_t) std::array<std::byte, TXN_ARENA_INLINE_SIZE> arena_block_;
+  Arena arena_{arena_block_.data(), arena_block_.size()};
+  /** Always engaged, but recreated when the arena is reset. */
+  std::optional<Sets> sets_;
 };
 
 }  // namespace bustub
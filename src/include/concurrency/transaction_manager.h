@@ -13,13 +13,16 @@
 #pragma once
 
 #include <atomic>
-#include <shared_mutex>
-#include <unordered_map>
-#include <unordered_set>
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction.h"
+#include "concurrency/transaction_map.h"
 #include "recovery/log_manager.h"
 
 namespace bustub {
@@ -27,6 +30,23 @@ class LockManager;
 
 /**
  * TransactionManager keeps track of all the transactions running in the system.
+ *
+ * It also hands out the timestamps of MVCC: a transaction reads the snapshot of the last commit before it began, and
+ * the versions it writes are stamped with a new commit timestamp when it commits. The versions older than the snapshot
+ * of the oldest running SNAPSHOT_ISOLATION transaction, the watermark, are garbage collected on every commit and abort.
+ *
+ * Optimistic transactions are validated when they commit, Silo-style: the version latches of the tuples they write are
+ * locked, the versions of the tuples they read are checked, then the buffered writes are installed and the latches
+ * unlocked with a new version. Validation fails the transaction, which is aborted instead of committed.
+ *
+ * Transaction ids are handed out to each thread in batches of TXN_ID_BATCH_SIZE, so that beginning a transaction
+ * rarely touches the shared counter. Ids remain unique and follow the order of Begin within a thread, but only
+ * roughly across threads, which is all the deadlock policies need from them as ages.
+ *
+ * With logging enabled, a commit is acknowledged once its commit record, and those of the transactions whose writes it
+ * saw, are persistent. Under strict two-phase locking the locks are held until then. With early lock release they are
+ * released as soon as the commit record is appended, and the transactions granted them inherit the LSN to wait for
+ * through the lock queues, see LockManager::LockRequestQueue.
  */
 class TransactionManager {
  public:
@@ -39,13 +59,15 @@ class TransactionManager {
    * Begins a new transaction.
    * @param txn an optional transaction object to be initialized, otherwise a new transaction is created.
    * @param isolation_level an optional isolation level of the transaction.
+   * @param concurrency_control an optional concurrency control of the transaction.
    * @return an initialized transaction
    */
-  auto Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ)
-      -> Transaction *;
+  auto Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ,
+             ConcurrencyControl concurrency_control = ConcurrencyControl::LOCKING) -> Transaction *;
 
   /**
-   * Commits a transaction.
+   * Commits a transaction. An optimistic transaction that fails validation, or was aborted meanwhile, is aborted
+   * instead, which the caller sees from its state.
    * @param txn the transaction to commit
    */
   void Commit(Transaction *txn);
@@ -57,25 +79,30 @@ class TransactionManager {
   void Abort(Transaction *txn);
 
   /**
-   * Global list of running transactions
+   * Release the locks of a committing transaction when its commit record is appended to the log buffer, rather than
+   * once the record is persistent. It only makes a difference with logging enabled.
+   * @param early_lock_release whether to release the locks early
    */
+  void SetEarlyLockRelease(bool early_lock_release) { early_lock_release_ = early_lock_release; }
 
   /** The transaction map is a global list of all the running transactions in the system. */
-  static std::unordered_map<txn_id_t, Transaction *> txn_map;
-  static std::shared_mutex txn_map_mutex;
+  static TransactionMap txn_map;
 
   /**
    * Locates and returns the transaction with the given transaction ID.
-   * @param txn_id the id of the transaction to be found, it must exist!
+   * @param txn_id the id of the transaction to be found, it must be running!
    * @return the transaction with the given transaction id
    */
-  static auto GetTransaction(txn_id_t txn_id) -> Transaction * {
-    std::shared_lock<std::shared_mutex> l(TransactionManager::txn_map_mutex);
-    assert(TransactionManager::txn_map.find(txn_id) != TransactionManager::txn_map.end());
-    auto *res = TransactionManager::txn_map[txn_id];
-    assert(res != nullptr);
-    return res;
-  }
+  static auto GetTransaction(txn_id_t txn_id) -> Transaction * { return txn_map.Get(txn_id); }
+
+  /** @return the read timestamp of the oldest running snapshot, or the last commit timestamp if there is none */
+  auto GetWatermark() -> timestamp_t;
+
+  /**
+   * Drop the versions no snapshot can see anymore.
+   * @param txn the transaction performing the garbage collection
+   */
+  void GarbageCollect(Transaction *txn);
 
   /** Prevents all transactions from performing operations, used for checkpointing. */
   void BlockAllTransactions();
@@ -89,44 +116,56 @@ class TransactionManager {
    * @param txn the transaction whose locks should be released
    */
   void ReleaseLocks(Transaction *txn) {
-    /** Drop all row locks */
+    /** Drop all row locks. A row or table is locked in one mode at a time, so the sets are disjoint. */
     txn->LockTxn();
-    std::unordered_map<table_oid_t, std::unordered_set<RID>> row_lock_set;
+    ArenaVector<std::pair<table_oid_t, RID>> row_lock_set(ArenaAllocator<std::pair<table_oid_t, RID>>(txn->GetArena()));
     for (const auto &s_row_lock_set : *txn->GetSharedRowLockSet()) {
       for (auto rid : s_row_lock_set.second) {
-        row_lock_set[s_row_lock_set.first].emplace(rid);
+        row_lock_set.emplace_back(s_row_lock_set.first, rid);
       }
     }
     for (const auto &x_row_lock_set : *txn->GetExclusiveRowLockSet()) {
       for (auto rid : x_row_lock_set.second) {
-        row_lock_set[x_row_lock_set.first].emplace(rid);
+        row_lock_set.emplace_back(x_row_lock_set.first, rid);
+      }
+    }
+
+    /** Drop all index key locks */
+    ArenaVector<std::pair<index_oid_t, uint64_t>> key_lock_set(
+        ArenaAllocator<std::pair<index_oid_t, uint64_t>>(txn->GetArena()));
+    for (const auto &key_lock_sets : {txn->GetSharedKeyLockSet(), txn->GetExclusiveKeyLockSet()}) {
+      for (const auto &[index_oid, keys] : *key_lock_sets) {
+        for (auto key : keys) {
+          key_lock_set.emplace_back(index_oid, key);
+        }
       }
     }
 
     /** Drop all table locks */
-    std::unordered_set<table_oid_t> table_lock_set;
+    ArenaVector<table_oid_t> table_lock_set(ArenaAllocator<table_oid_t>(txn->GetArena()));
     for (auto oid : *txn->GetSharedTableLockSet()) {
-      table_lock_set.emplace(oid);
+      table_lock_set.push_back(oid);
     }
     for (table_oid_t oid : *(txn->GetIntentionSharedTableLockSet())) {
-      table_lock_set.emplace(oid);
+      table_lock_set.push_back(oid);
     }
     for (auto oid : *txn->GetExclusiveTableLockSet()) {
-      table_lock_set.emplace(oid);
+      table_lock_set.push_back(oid);
     }
     for (auto oid : *txn->GetIntentionExclusiveTableLockSet()) {
-      table_lock_set.emplace(oid);
+      table_lock_set.push_back(oid);
     }
     for (auto oid : *txn->GetSharedIntentionExclusiveTableLockSet()) {
-      table_lock_set.emplace(oid);
+      table_lock_set.push_back(oid);
     }
     txn->UnlockTxn();
 
-    for (const auto &locked_table_row_set : row_lock_set) {
-      table_oid_t oid = locked_table_row_set.first;
-      for (auto rid : locked_table_row_set.second) {
-        lock_manager_->UnlockRow(txn, oid, rid);
-      }
+    for (const auto &[oid, rid] : row_lock_set) {
+      lock_manager_->UnlockRow(txn, oid, rid);
+    }
+
+    for (const auto &[index_oid, key] : key_lock_set) {
+      lock_manager_->UnlockKey(txn, index_oid, key);
     }
 
     for (auto oid : table_lock_set) {
@@ -134,7 +173,50 @@ class TransactionManager {
     }
   }
 
+  /** A tuple written by a commit, whose older versions can be dropped once the watermark reaches that commit */
+  struct GarbageRecord {
+    timestamp_t ts_;
+    TableHeap *table_;
+    RID rid_;
+  };
+
+  /**
+   * Validate the reads of an optimistic transaction and install its writes, aborting it on failure.
+   * @param txn the committing transaction
+   * @param[out] latches the version latches locked, sorted, to release once the writes are committed
+   * @return whether the transaction can go on committing
+   */
+  auto ValidateAndInstall(Transaction *txn, std::vector<std::pair<TableHeap *, size_t>> *latches) -> bool;
+
+  /** Unlock version latches, with a new version if writes were installed under them. */
+  void ReleaseVersionLatches(const std::vector<std::pair<TableHeap *, size_t>> &latches, bool installed);
+
+  /** Stop counting the snapshot of a transaction in the watermark. */
+  void EndSnapshot(Transaction *txn);
+
+  /** Block until the commit of a transaction can be acknowledged, i.e. the log is persistent up to its dependency. */
+  void WaitForDependency(Transaction *txn);
+
+  /** @return a new transaction id, from the batch of the calling thread */
+  auto NextTxnId() -> txn_id_t;
+
+  /** Tells apart the transaction managers, whose ids the batches of a thread are taken from. */
+  static std::atomic<uint64_t> next_instance_id;
+  const uint64_t instance_id_{next_instance_id++};
   std::atomic<txn_id_t> next_txn_id_{0};
+
+  /** The timestamp of the last commit, the snapshot of the transactions beginning now */
+  std::atomic<timestamp_t> last_commit_ts_{0};
+  /** Serializes the commits that stamp versions, so that a snapshot never sees a commit half-stamped */
+  std::mutex commit_latch_;
+  /** The read timestamps of the running SNAPSHOT_ISOLATION transactions */
+  std::multiset<timestamp_t> active_read_ts_;
+  std::mutex active_read_ts_latch_;
+  /** The versions to collect, in commit order */
+  std::deque<GarbageRecord> garbage_;
+  std::mutex garbage_latch_;
+  /** Whether the locks are released before the commit record is persistent */
+  std::atomic<bool> early_lock_release_{false};
   LockManager *lock_manager_ __attribute__((__unused__));
   LogManager *log_manager_ __attribute__((__unused__));
 
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// transaction_map.h
+//
+// Identification: src/include/concurrency/transaction_map.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+class Transaction;
+
+/**
+ * TransactionMap finds the running transactions by id, without taking a latch in the common case.
+ *
+ * A transaction is registered in the slot of its id modulo TXN_MAP_SLOTS, and only goes to a latched overflow map
+ * when a transaction still running holds the slot, i.e. when more than TXN_MAP_SLOTS transactions separate the oldest
+ * running transaction from the newest. Since ids are handed out to each thread in batches, the transactions of
+ * different threads also register in slots far apart rather than on the same cache lines.
+ */
+class TransactionMap {
+ public:
+  /** Register a transaction. */
+  void Insert(Transaction *txn);
+
+  /** Unregister a transaction, once it committed or aborted. */
+  void Erase(Transaction *txn);
+
+  /**
+   * Find a transaction. The caller must keep it from committing or aborting until the call returns, as the lock
+   * manager does by holding the latch of a queue the transaction has a request in.
+   * @param txn_id the id of a registered transaction
+   * @return the transaction
+   */
+  auto Get(txn_id_t txn_id) -> Transaction *;
+
+ private:
+  struct Slot {
+    /** The id of the transaction, published after the transaction itself. */
+    std::atomic<txn_id_t> txn_id_{INVALID_TXN_ID};
+    std::atomic<Transaction *> txn_{nullptr};
+  };
+
+  static auto SlotOf(txn_id_t txn_id) -> size_t { return static_cast<uint32_t>(txn_id) % TXN_MAP_SLOTS; }
+
+  std::array<Slot, TXN_MAP_SLOTS> slots_;
+  std::unordered_map<txn_id_t, Transaction *> overflow_;
+  std::shared_mutex overflow_latch_;
+};
+
+}  // namespace bustub
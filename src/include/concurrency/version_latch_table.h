@@ -0,0 +1,70 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// version_latch_table.h
+//
+// Identification: src/include/concurrency/version_latch_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "common/config.h"
+#include "common/rid.h"
+
+namespace bustub {
+
+/**
+ * VersionLatchTable holds the version latches that optimistic transactions validate their reads against.
+ *
+ * A version latch is a word whose lowest bit is a lock bit and whose other bits count the writes installed under it.
+ * A read records the word of the tuple before reading it; a committing optimistic transaction locks the words of the
+ * tuples it writes, checks that the words of the tuples it read have not changed, installs its writes and unlocks the
+ * words with a higher version. The words are striped over OCC_VERSION_LATCHES slots by RID hash rather than kept per
+ * tuple, so tuples sharing a slot only cause spurious validation failures, never missed ones.
+ */
+class VersionLatchTable {
+ public:
+  /** @return the slot of the version latch covering a tuple */
+  static auto SlotOf(const RID &rid) -> size_t {
+    // Fibonacci hashing, as for the row lock shards of the lock manager.
+    auto hash = static_cast<uint64_t>(rid.Get()) * 0x9E3779B97F4A7C15ULL;
+    return (hash >> 32) % OCC_VERSION_LATCHES;
+  }
+
+  /** @return whether a version word has its lock bit set */
+  static auto IsLocked(uint64_t version) -> bool { return (version & 1) != 0; }
+
+  /** @return the version word of a slot, locked or not */
+  auto GetVersion(size_t slot) const -> uint64_t { return latches_[slot].load(std::memory_order_acquire); }
+
+  /**
+   * Lock a slot, waiting while another transaction holds it.
+   * @param slot the slot to lock
+   */
+  void Lock(size_t slot);
+
+  /**
+   * Unlock a slot locked by Lock.
+   * @param slot the slot to unlock
+   * @param installed whether writes were installed under the lock, in which case the version is bumped
+   */
+  void Unlock(size_t slot, bool installed);
+
+  /**
+   * Bump the version of a tuple written in place, by a transaction that does not lock the slot beforehand.
+   * @param rid the tuple written
+   */
+  void Bump(const RID &rid);
+
+ private:
+  std::array<std::atomic<uint64_t>, OCC_VERSION_LATCHES> latches_{};
+};
+
+}  // namespace bustub
@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// version_store.h
+//
+// Identification: src/include/concurrency/version_store.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <shared_mutex>
+#include <unordered_map>
+
+#include "common/config.h"
+#include "common/rid.h"
+#include "concurrency/transaction.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * VersionStore keeps the older versions of the tuples of one table heap, so that snapshot reads do not block on, nor
+ * see, the writes made after their snapshot.
+ *
+ * The table page always holds the newest version of a tuple, committed or not, marked deleted if that version is a
+ * deletion. The version store maps the RID of every tuple written since the oldest running snapshot to a version
+ * chain: the writer of the newest version if it has not committed yet, or the timestamp it committed at, followed by
+ * undo records of the versions it replaced, newest first. A tuple without a chain is visible to every transaction.
+ *
+ * A chain is created and extended while holding the write latch of the page of its tuple, and read while holding the
+ * read latch, so a reader always finds the chain matching the version on the page. Only the transactions that write
+ * keep the chains up to date; only those running under SNAPSHOT_ISOLATION read older versions.
+ */
+class VersionStore {
+ public:
+  /** @return whether `txn` reads a snapshot rather than the newest versions */
+  static auto IsSnapshotRead(const Transaction *txn) -> bool {
+    return txn != nullptr && txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION;
+  }
+
+  /**
+   * Check whether a transaction may overwrite or delete a tuple: not if another transaction wrote it and has not
+   * committed yet, nor, under snapshot isolation, if it was written after the transaction's snapshot, so that the first
+   * updater wins.
+   * @param rid the tuple to write
+   * @param txn the writing transaction
+   * @return whether the write is allowed
+   */
+  auto CanWrite(const RID &rid, const Transaction *txn) const -> bool;
+
+  /**
+   * Record that a transaction is replacing the newest version of a tuple. Only the first version it replaces is kept.
+   * @param rid the tuple written
+   * @param txn the writing transaction
+   * @param old_tuple the version replaced
+   * @param is_delete whether the new version is a deletion
+   */
+  void AddVersion(const RID &rid, const Transaction *txn, const Tuple &old_tuple, bool is_delete);
+
+  /**
+   * Record that a transaction inserted a tuple, which no snapshot taken before its commit sees.
+   * @param rid the tuple inserted
+   * @param txn the inserting transaction
+   */
+  void AddInsert(const RID &rid, const Transaction *txn);
+
+  /**
+   * Find the version of a tuple visible to a snapshot read.
+   * @param rid the tuple to read
+   * @param txn the reading transaction
+   * @param[in,out] tuple the newest version of the tuple, replaced by the visible version
+   * @param is_deleted whether the newest version is a deletion
+   * @return whether a version is visible and is not a deletion
+   */
+  auto GetVisibleVersion(const RID &rid, const Transaction *txn, Tuple *tuple, bool is_deleted) const -> bool;
+
+  /**
+   * Stamp the version a transaction wrote with its commit timestamp.
+   * @param rid the tuple written
+   * @param txn the committing transaction
+   * @param commit_ts the commit timestamp
+   */
+  void Commit(const RID &rid, const Transaction *txn, timestamp_t commit_ts);
+
+  /**
+   * Drop the version an aborted transaction wrote. The page must have been rolled back already.
+   * @param rid the tuple written
+   * @param txn the aborting transaction
+   */
+  void Rollback(const RID &rid, const Transaction *txn);
+
+  /**
+   * Drop the versions of a tuple that no snapshot can see anymore.
+   * @param rid the tuple
+   * @param watermark the read timestamp of the oldest running snapshot
+   * @return whether the tuple is a deletion that every snapshot sees, so that it can be removed from its page
+   */
+  auto Prune(const RID &rid, timestamp_t watermark) -> bool;
+
+  /**
+   * Drop the chain of a tuple removed from its page.
+   * @param rid the tuple
+   */
+  void Erase(const RID &rid);
+
+  /** @return the number of tuples with older versions */
+  auto GetChainCount() const -> size_t { return chain_count_.load(); }
+
+ private:
+  /** A version replaced by a newer one */
+  struct UndoRecord {
+    /** The commit timestamp of the version */
+    timestamp_t ts_;
+    /** Whether the version is a deletion, or the absence of the tuple before it was inserted */
+    bool is_deleted_;
+    Tuple tuple_;
+  };
+
+  struct VersionChain {
+    /** The transaction that wrote the newest version, or INVALID_TXN_ID once it committed */
+    txn_id_t writer_{INVALID_TXN_ID};
+    /** The commit timestamp of the newest version, if committed */
+    timestamp_t ts_{0};
+    /** Whether the newest version is a deletion */
+    bool is_deleted_{false};
+    /** The older versions, newest first */
+    std::deque<UndoRecord> undo_;
+  };
+
+  /** Remove a chain, the latch being held. */
+  void EraseChain(std::unordered_map<RID, VersionChain>::iterator it);
+
+  mutable std::shared_mutex latch_;
+  std::unordered_map<RID, VersionChain> chains_;
+  /** The size of `chains_`, read without the latch so that tables without older versions are read at no cost */
+  std::atomic<size_t> chain_count_{0};
+};
+
+}  // namespace bustub
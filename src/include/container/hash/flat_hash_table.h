@@ -0,0 +1,281 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// flat_hash_table.h
+//
+// Identification: src/include/container/hash/flat_hash_table.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "common/arena.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * FlatHashTable is an open-addressing hash table with linear probing whose slots are allocated from an Arena. It
+ * backs FlatHashSet and FlatHashMap, which cover the part of the std::unordered_set and std::unordered_map interfaces
+ * the transaction bookkeeping needs.
+ *
+ * Erasing shifts the following slots of the probe sequence back rather than leaving tombstones, so a table that sees
+ * many inserts and erases, as a lock set does, never degrades. Growing leaves the old slots in the arena. The slots
+ * must be trivially destructible, as the arena reclaims them wholesale, and erasing invalidates the iterators.
+ */
+template <typename Key, typename Slot, typename KeyOf, typename Hash = std::hash<Key>>
+class FlatHashTable {
+  static_assert(std::is_trivially_destructible_v<Slot>, "the arena never runs the destructors of the slots");
+
+  template <bool Const>
+  class BasicIterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;                // NOLINT
+    using value_type = Slot;                                            // NOLINT
+    using difference_type = std::ptrdiff_t;                             // NOLINT
+    using pointer = std::conditional_t<Const, const Slot *, Slot *>;    // NOLINT
+    using reference = std::conditional_t<Const, const Slot &, Slot &>;  // NOLINT
+    using Table = std::conditional_t<Const, const FlatHashTable, FlatHashTable>;
+
+    BasicIterator(Table *table, size_t index) : table_(table), index_(index) { SkipFree(); }
+
+    template <bool OtherConst, typename = std::enable_if_t<Const && !OtherConst>>
+    BasicIterator(const BasicIterator<OtherConst> &other)  // NOLINT
+        : table_(other.table_), index_(other.index_) {}
+
+    auto operator*() const -> reference { return table_->slots_[index_]; }
+    auto operator->() const -> pointer { return &table_->slots_[index_]; }
+
+    auto operator++() -> BasicIterator & {
+      index_++;
+      SkipFree();
+      return *this;
+    }
+
+    auto operator++(int) -> BasicIterator {
+      auto copy = *this;
+      ++*this;
+      return copy;
+    }
+
+    auto operator==(const BasicIterator &other) const -> bool { return index_ == other.index_; }
+    auto operator!=(const BasicIterator &other) const -> bool { return index_ != other.index_; }
+
+   private:
+    friend class FlatHashTable;
+    template <bool>
+    friend class BasicIterator;
+
+    void SkipFree() {
+      while (index_ < table_->capacity_ && table_->used_[index_] == 0) {
+        index_++;
+      }
+    }
+
+    Table *table_;
+    size_t index_;
+  };
+
+ public:
+  using iterator = BasicIterator<false>;       // NOLINT
+  using const_iterator = BasicIterator<true>;  // NOLINT
+
+  explicit FlatHashTable(Arena *arena) : arena_(arena) {}
+
+  DISALLOW_COPY(FlatHashTable);
+
+  FlatHashTable(FlatHashTable &&other) noexcept
+      : arena_(other.arena_),
+        slots_(other.slots_),
+        used_(other.used_),
+        capacity_(other.capacity_),
+        shift_(other.shift_),
+        size_(other.size_) {
+    other.slots_ = nullptr;
+    other.used_ = nullptr;
+    other.capacity_ = 0;
+    other.size_ = 0;
+  }
+
+  auto operator=(FlatHashTable &&other) noexcept -> FlatHashTable & = delete;
+
+  auto begin() -> iterator { return {this, 0}; }                    // NOLINT
+  auto end() -> iterator { return {this, capacity_}; }              // NOLINT
+  auto begin() const -> const_iterator { return {this, 0}; }        // NOLINT
+  auto end() const -> const_iterator { return {this, capacity_}; }  // NOLINT
+
+  auto size() const -> size_t { return size_; }      // NOLINT
+  auto empty() const -> bool { return size_ == 0; }  // NOLINT
+
+  auto find(const Key &key) -> iterator { return {this, FindIndex(key)}; }                    // NOLINT
+  auto find(const Key &key) const -> const_iterator { return {this, FindIndex(key)}; }        // NOLINT
+  auto count(const Key &key) const -> size_t { return FindIndex(key) == capacity_ ? 0 : 1; }  // NOLINT
+
+  /** Erase the slot of a key, if any. @return the number of slots erased */
+  auto erase(const Key &key) -> size_t {  // NOLINT
+    auto index = FindIndex(key);
+    if (index == capacity_) {
+      return 0;
+    }
+    EraseIndex(index);
+    return 1;
+  }
+
+  /** Erase the slot an iterator points to. */
+  void erase(const_iterator it) { EraseIndex(it.index_); }  // NOLINT
+
+  /** Erase every slot, keeping the capacity. */
+  void clear() {  // NOLINT
+    if (used_ != nullptr) {
+      memset(used_, 0, capacity_);
+    }
+    size_ = 0;
+  }
+
+ protected:
+  /**
+   * Find the slot of a key, constructing it from `args` if there is none.
+   * @return the slot and whether it was constructed
+   */
+  template <typename... Args>
+  auto Emplace(const Key &key, Args &&...args) -> std::pair<iterator, bool> {
+    if ((size_ + 1) * 4 > capacity_ * 3) {
+      Grow();
+    }
+    auto index = HomeOf(key);
+    while (used_[index] != 0) {
+      if (KeyOf()(slots_[index]) == key) {
+        return {iterator(this, index), false};
+      }
+      index = (index + 1) & (capacity_ - 1);
+    }
+    new (&slots_[index]) Slot(std::forward<Args>(args)...);
+    used_[index] = 1;
+    size_++;
+    return {iterator(this, index), true};
+  }
+
+  Arena *arena_;
+
+ private:
+  /** The first slot of the probe sequence of a key. Fibonacci hashing spreads the identity hash of integers. */
+  auto HomeOf(const Key &key) const -> size_t {
+    return static_cast<size_t>((static_cast<uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ULL) >> shift_);
+  }
+
+  /** @return the slot of a key, or the capacity if there is none */
+  auto FindIndex(const Key &key) const -> size_t {
+    if (size_ == 0) {
+      return capacity_;
+    }
+    for (auto index = HomeOf(key); used_[index] != 0; index = (index + 1) & (capacity_ - 1)) {
+      if (KeyOf()(slots_[index]) == key) {
+        return index;
+      }
+    }
+    return capacity_;
+  }
+
+  void EraseIndex(size_t index) {
+    const auto mask = capacity_ - 1;
+    // Shift back every following slot of the run that could not be placed at or before the one freed.
+    for (auto next = (index + 1) & mask; used_[next] != 0; next = (next + 1) & mask) {
+      auto home = HomeOf(KeyOf()(slots_[next]));
+      if (((next - home) & mask) >= ((next - index) & mask)) {
+        new (&slots_[index]) Slot(std::move(slots_[next]));
+        index = next;
+      }
+    }
+    used_[index] = 0;
+    size_--;
+  }
+
+  void Grow() {
+    auto *old_slots = slots_;
+    auto *old_used = used_;
+    auto old_capacity = capacity_;
+    capacity_ = capacity_ == 0 ? 8 : 2 * capacity_;
+    shift_ = 64;
+    for (auto capacity = capacity_; capacity > 1; capacity >>= 1) {
+      shift_--;
+    }
+    slots_ = static_cast<Slot *>(arena_->Allocate(capacity_ * sizeof(Slot), alignof(Slot)));
+    used_ = static_cast<uint8_t *>(arena_->Allocate(capacity_, 1));
+    memset(used_, 0, capacity_);
+    for (size_t index = 0; index < old_capacity; index++) {
+      if (old_used[index] != 0) {
+        auto new_index = HomeOf(KeyOf()(old_slots[index]));
+        while (used_[new_index] != 0) {
+          new_index = (new_index + 1) & (capacity_ - 1);
+        }
+        new (&slots_[new_index]) Slot(std::move(old_slots[index]));
+        used_[new_index] = 1;
+      }
+    }
+  }
+
+  Slot *slots_{nullptr};
+  uint8_t *used_{nullptr};
+  /** The number of slots, a power of two. */
+  size_t capacity_{0};
+  /** 64 - log2(capacity), to map a hash to a slot. */
+  int shift_{64};
+  size_t size_{0};
+};
+
+namespace detail {
+struct IdentityKeyOf {
+  template <typename T>
+  auto operator()(const T &slot) const -> const T & {
+    return slot;
+  }
+};
+
+struct FirstKeyOf {
+  template <typename T>
+  auto operator()(const T &slot) const -> const typename T::first_type & {
+    return slot.first;
+  }
+};
+}  // namespace detail
+
+/** FlatHashSet is a set of keys in an Arena, see FlatHashTable. */
+template <typename Key, typename Hash = std::hash<Key>>
+class FlatHashSet : public FlatHashTable<Key, Key, detail::IdentityKeyOf, Hash> {
+ public:
+  using FlatHashTable<Key, Key, detail::IdentityKeyOf, Hash>::FlatHashTable;
+
+  auto insert(const Key &key) { return this->Emplace(key, key); }  // NOLINT
+};
+
+/**
+ * FlatHashMap maps keys to values in an Arena, see FlatHashTable. A value constructible from an arena, such as a
+ * FlatHashSet, is constructed from the arena of the map.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class FlatHashMap : public FlatHashTable<Key, std::pair<const Key, Value>, detail::FirstKeyOf, Hash> {
+ public:
+  using FlatHashTable<Key, std::pair<const Key, Value>, detail::FirstKeyOf, Hash>::FlatHashTable;
+
+  auto operator[](const Key &key) -> Value & {
+    if constexpr (std::is_constructible_v<Value, Arena *>) {
+      return this->Emplace(key, key, Value(this->arena_)).first->second;
+    } else {
+      return this->Emplace(key, key, Value{}).first->second;
+    }
+  }
+};
+
+}  // namespace bustub
@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter.h
+//
+// Identification: src/include/execution/bloom_filter.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/util/hash_util.h"
+#include "execution/plans/abstract_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * BlockedBloomFilter is a Bloom filter whose bits for one key all lie in a single 32-byte block, so that an insert or
+ * a lookup touches one cache line. A key selects its block with the high half of its hash and sets one bit in each of
+ * the eight 32-bit words of the block with the low half, so lookups never return false negatives and return false
+ * positives for about 0.5% of absent keys at 16 bits per key.
+ */
+class BlockedBloomFilter {
+ public:
+  /**
+   * Create an empty filter.
+   * @param key_cnt the number of distinct keys the filter is sized for
+   * @param bits_per_key the number of bits to allocate per key
+   */
+  explicit BlockedBloomFilter(size_t key_cnt, size_t bits_per_key);
+
+  /** Add a key, given by its hash. */
+  void Insert(hash_t hash);
+
+  /** @return false if the key with this hash was definitely not inserted */
+  auto MayContain(hash_t hash) const -> bool;
+
+  /** @return the size of the filter in bytes */
+  auto SizeInBytes() const -> size_t { return blocks_.size() * sizeof(Block); }
+
+ private:
+  static constexpr size_t BLOCK_WORDS = 8;
+  using Block = std::array<uint32_t, BLOCK_WORDS>;
+
+  /** @return the block of a (mixed) hash */
+  auto BlockOf(uint64_t hash) const -> size_t;
+
+  /** @return the bits a (mixed) hash sets in its block */
+  static auto MaskOf(uint64_t hash) -> Block;
+
+  std::vector<Block> blocks_;
+};
+
+/**
+ * RuntimeFilter is a Bloom filter over the build-side keys of a hash join, pushed down to a scan on its probe side
+ * through the `ExecutorContext`. The scan drops the tuples whose key column cannot find a match before they flow up
+ * through the rest of the probe side. A filter that drops too few of the first tuples it checks stops checking, as
+ * it then costs more than it saves.
+ */
+class RuntimeFilter {
+ public:
+  /**
+   * @param source the hash join that built the filter
+   * @param col_idx the column of the scan output the filter applies to
+   * @param filter the filter over the hashes of the build-side keys
+   */
+  RuntimeFilter(const AbstractPlanNode *source, uint32_t col_idx, BlockedBloomFilter filter)
+      : source_(source), col_idx_(col_idx), filter_(std::move(filter)) {}
+
+  /**
+   * @return the hash a key is inserted into and looked up in the filter with. `HashUtil::HashValue` maps many small
+   * integers to the same hash, which would make most lookups false positives.
+   */
+  static auto HashKey(const Value &key) -> hash_t;
+
+  /** @return whether a scanned tuple may find a match on the build side; NULL keys never do */
+  auto Check(const Tuple &tuple, const Schema &schema) -> bool {
+    if (disabled_) {
+      return true;
+    }
+    if (++rows_checked_ == RUNTIME_FILTER_SAMPLE_SIZE) {
+      disabled_ = rows_eliminated_ * 100 < rows_checked_ * RUNTIME_FILTER_MIN_DROP_PCT;
+    }
+    auto value = tuple.GetValue(&schema, col_idx_);
+    if (value.IsNull() || !filter_.MayContain(HashKey(value))) {
+      rows_eliminated_++;
+      return false;
+    }
+    return true;
+  }
+
+  /** @return the hash join that built the filter */
+  auto GetSource() const -> const AbstractPlanNode * { return source_; }
+
+  /** @return the number of tuples checked against the filter */
+  auto RowsChecked() const -> uint64_t { return rows_checked_; }
+
+  /** @return the number of tuples the filter dropped */
+  auto RowsEliminated() const -> uint64_t { return rows_eliminated_; }
+
+  /** @return whether the filter stopped checking tuples because it dropped too few */
+  auto IsDisabled() const -> bool { return disabled_; }
+
+ private:
+  const AbstractPlanNode *source_;
+  uint32_t col_idx_;
+  BlockedBloomFilter filter_;
+  uint64_t rows_checked_{0};
+  uint64_t rows_eliminated_{0};
+  bool disabled_{false};
+};
+
+}  // namespace bustub
@@ -12,15 +12,42 @@
 
 #pragma once
 
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <memory>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
 
 #include "catalog/catalog.h"
+#include "common/config.h"
 #include "concurrency/transaction.h"
+#include "execution/bloom_filter.h"
+#include "execution/plans/abstract_plan.h"
 #include "storage/page/tmp_tuple_page.h"
 
 namespace bustub {
+
+/**
+ * OperatorProfile holds the runtime statistics EXPLAIN ANALYZE collects for one plan node. The time and the buffer
+ * pool accesses include those of the node's children.
+ */
+struct OperatorProfile {
+  /** The number of calls to `Init` */
+  uint64_t init_calls_{0};
+  /** The number of calls to `Next` */
+  uint64_t next_calls_{0};
+  /** The number of tuples produced */
+  uint64_t rows_{0};
+  /** The wall time spent in `Init` and `Next` */
+  std::chrono::nanoseconds time_{0};
+  /** The buffer pool accesses made in `Init` and `Next` */
+  BufferPoolStats buffer_pool_;
+  /** The temporary pages written to spill intermediate results */
+  uint64_t spilled_pages_{0};
+};
+
 /**
  * ExecutorContext stores all the context necessary to run an executor.
  */
@@ -60,6 +87,67 @@ class ExecutorContext {
   /** @return the transaction manager */
   auto GetTransactionManager() -> TransactionManager * { return txn_mgr_; }
 
+  /**
+   * Attach a runtime filter to a scan, replacing the filter its join attached before. Scans check the filters attached
+   * to them as they produce each tuple, so a filter attached while the scan runs applies to the tuples after it.
+   * @param scan the scan plan node the filter applies to
+   * @param filter the filter
+   */
+  void AddRuntimeFilter(const AbstractPlanNode *scan, std::shared_ptr<RuntimeFilter> filter) {
+    auto &filters = runtime_filters_[scan];
+    auto it = std::find_if(filters.begin(), filters.end(),
+                           [&](const auto &other) { return other->GetSource() == filter->GetSource(); });
+    if (it != filters.end()) {
+      *it = std::move(filter);
+    } else {
+      filters.push_back(std::move(filter));
+    }
+  }
+
+  /** Detach the runtime filters a join attached, which hold the keys of its previous build side. */
+  void RemoveRuntimeFilters(const AbstractPlanNode *source) {
+    for (auto &[scan, filters] : runtime_filters_) {
+      filters.erase(std::remove_if(filters.begin(), filters.end(),
+                                   [&](const auto &filter) { return filter->GetSource() == source; }),
+                    filters.end());
+    }
+  }
+
+  /** @return the runtime filters attached to a scan, which stay valid as filters are attached and detached */
+  auto GetRuntimeFilters(const AbstractPlanNode *scan) -> const std::vector<std::shared_ptr<RuntimeFilter>> & {
+    return runtime_filters_[scan];
+  }
+
+  /** @return the runtime filters attached to a scan, or nullptr if none ever were */
+  auto FindRuntimeFilters(const AbstractPlanNode *scan) const -> const std::vector<std::shared_ptr<RuntimeFilter>> * {
+    auto it = runtime_filters_.find(scan);
+    return it == runtime_filters_.end() ? nullptr : &it->second;
+  }
+
+  /**
+   * Set how many partial groups an aggregation worker buffers before it spills them to temporary pages.
+   * @param threshold the number of partial groups, at least 1
+   */
+  void SetAggregationSpillThreshold(size_t threshold) { aggregation_spill_threshold_ = threshold; }
+
+  /** @return how many partial groups an aggregation worker buffers before it spills them */
+  auto GetAggregationSpillThreshold() const -> size_t { return aggregation_spill_threshold_; }
+
+  /** Wrap every executor created from now on in a `ProfilingExecutor`, which collects its runtime statistics. */
+  void EnableProfiling() { profiling_ = true; }
+
+  /** @return whether executors collect their runtime statistics */
+  auto IsProfiling() const -> bool { return profiling_; }
+
+  /** @return the runtime statistics of a plan node, which the executors of the node add to */
+  auto GetOperatorProfile(const AbstractPlanNode *plan) -> OperatorProfile * { return &profiles_[plan]; }
+
+  /** @return the runtime statistics of a plan node, or nullptr if the node was not profiled */
+  auto FindOperatorProfile(const AbstractPlanNode *plan) const -> const OperatorProfile * {
+    auto it = profiles_.find(plan);
+    return it == profiles_.end() ? nullptr : &it->second;
+  }
+
  private:
   /** The transaction context associated with this executor context */
   Transaction *transaction_;
@@ -71,6 +159,14 @@ class ExecutorContext {
   TransactionManager *txn_mgr_;
   /** The lock manager associated with this executor context */
   LockManager *lock_mgr_;
+  /** The runtime filters hash joins pushed down to the scans on their probe side */
+  std::unordered_map<const AbstractPlanNode *, std::vector<std::shared_ptr<RuntimeFilter>>> runtime_filters_;
+  /** Partial groups an aggregation worker buffers before spilling them */
+  size_t aggregation_spill_threshold_{AGGREGATION_SPILL_THRESHOLD};
+  /** Whether executors collect their runtime statistics, for EXPLAIN ANALYZE */
+  bool profiling_{false};
+  /** The runtime statistics of the profiled plan nodes */
+  std::unordered_map<const AbstractPlanNode *, OperatorProfile> profiles_;
 };
 
 }  // namespace bustub
@@ -31,5 +31,10 @@ class ExecutorFactory {
    */
   static auto CreateExecutor(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan)
       -> std::unique_ptr<AbstractExecutor>;
+
+ private:
+  /** Creates the executor of a plan node, whose children are created by `CreateExecutor`. */
+  static auto CreatePlanExecutor(ExecutorContext *exec_ctx, const AbstractPlanNodeRef &plan)
+      -> std::unique_ptr<AbstractExecutor>;
 };
 }  // namespace bustub
@@ -13,10 +13,13 @@
 #pragma once
 
 #include <memory>
+#include <mutex>  // NOLINT
+#include <optional>
 #include <unordered_map>
 #include <utility>
 #include <vector>
 
+#include "common/config.h"
 #include "common/util/hash_util.h"
 #include "container/hash/hash_function.h"
 #include "execution/executor_context.h"
@@ -64,25 +67,43 @@ class SimpleAggregationHashTable {
   }
 
   /**
-   * TODO(Student)
-   *
    * Combines the input into the aggregation result.
    * @param[out] result The output aggregate value
    * @param input The input value
    */
   void CombineAggregateValues(AggregateValue *result, const AggregateValue &input) {
     for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+      auto &acc = result->aggregates_[i];
+      const auto &val = input.aggregates_[i];
       switch (agg_types_[i]) {
         case AggregationType::CountStarAggregate:
+          acc = acc.Add(ValueFactory::GetIntegerValue(1));
+          break;
         case AggregationType::CountAggregate:
+          if (!val.IsNull()) {
+            acc = acc.IsNull() ? ValueFactory::GetIntegerValue(1) : acc.Add(ValueFactory::GetIntegerValue(1));
+          }
+          break;
         case AggregationType::SumAggregate:
         case AggregationType::MinAggregate:
         case AggregationType::MaxAggregate:
+          MergeAggregate(agg_types_[i], &acc, val);
           break;
       }
     }
   }
 
+  /**
+   * Merges a partial aggregate, produced by combining some of the input, into the aggregation result.
+   * @param[out] result The output aggregate value
+   * @param partial The partial aggregate value
+   */
+  void MergeAggregateValues(AggregateValue *result, const AggregateValue &partial) {
+    for (uint32_t i = 0; i < agg_exprs_.size(); i++) {
+      MergeAggregate(agg_types_[i], &result->aggregates_[i], partial.aggregates_[i]);
+    }
+  }
+
   /**
    * Inserts a value into the hash table and then combines it with the current aggregation.
    * @param agg_key the key to be inserted
@@ -95,6 +116,23 @@ class SimpleAggregationHashTable {
     CombineAggregateValues(&ht_[agg_key], agg_val);
   }
 
+  /**
+   * Inserts a partial aggregate into the hash table and then merges it with the current aggregation.
+   * @param agg_key the key to be inserted
+   * @param partial the partial aggregate to be inserted
+   */
+  void InsertMerge(AggregateKey &&agg_key, AggregateValue &&partial) {
+    auto iter = ht_.find(agg_key);
+    if (iter == ht_.end()) {
+      ht_.emplace(std::move(agg_key), std::move(partial));
+      return;
+    }
+    MergeAggregateValues(&iter->second, partial);
+  }
+
+  /** @return The number of groups in the hash table */
+  auto Size() const -> size_t { return ht_.size(); }
+
   /**
    * Clear the hash table
    */
@@ -136,6 +174,34 @@ class SimpleAggregationHashTable {
   auto End() -> Iterator { return Iterator{ht_.cend()}; }
 
  private:
+  /** Fold one partial SUM/MIN/MAX/COUNT/COUNT(*) value into the running aggregate. */
+  static void MergeAggregate(AggregationType agg_type, Value *acc, const Value &val) {
+    if (val.IsNull()) {
+      return;
+    }
+    if (acc->IsNull()) {
+      *acc = val;
+      return;
+    }
+    switch (agg_type) {
+      case AggregationType::CountStarAggregate:
+      case AggregationType::CountAggregate:
+      case AggregationType::SumAggregate:
+        *acc = acc->Add(val);
+        break;
+      case AggregationType::MinAggregate:
+        if (val.CompareLessThan(*acc) == CmpBool::CmpTrue) {
+          *acc = val;
+        }
+        break;
+      case AggregationType::MaxAggregate:
+        if (val.CompareGreaterThan(*acc) == CmpBool::CmpTrue) {
+          *acc = val;
+        }
+        break;
+    }
+  }
+
   /** The hash table is just a map from aggregate keys to aggregate values */
   std::unordered_map<AggregateKey, AggregateValue> ht_{};
   /** The aggregate expressions that we have */
@@ -147,6 +213,14 @@ class SimpleAggregationHashTable {
 /**
  * AggregationExecutor executes an aggregation operation (e.g. COUNT, SUM, MIN, MAX)
  * over the tuples produced by a child executor.
+ *
+ * The aggregation runs in two phases. In the first phase, the child is drained in batches that are handed to
+ * AGGREGATION_THREADS workers. Each worker pre-aggregates into a small thread-local table of fixed size; on a slot
+ * collision the resident group is evicted into one of AGGREGATION_PARTITIONS radix partitions chosen by the group's
+ * hash. A worker that buffers more partial groups than the spill threshold of the executor context (by default
+ * AGGREGATION_SPILL_THRESHOLD) writes them to temporary pages through the buffer pool. In the second phase, the
+ * partitions are merged in waves of AGGREGATION_THREADS, one partition per thread, so that at most one wave of final
+ * groups is held in memory at a time.
  */
 class AggregationExecutor : public AbstractExecutor {
  public:
@@ -177,6 +251,27 @@ class AggregationExecutor : public AbstractExecutor {
   auto GetChildExecutor() const -> const AbstractExecutor *;
 
  private:
+  /** A group partially aggregated by one of the pre-aggregation workers */
+  struct PartialAggregate {
+    /** The hash of the group key */
+    hash_t hash_;
+    /** The group key */
+    AggregateKey key_;
+    /** The aggregates of the rows seen by one worker */
+    AggregateValue val_;
+  };
+
+  /** The partial aggregates of one radix partition */
+  struct Partition {
+    /** Runs of partial aggregates still in memory, one per flush of a worker */
+    std::vector<std::vector<PartialAggregate>> runs_;
+    /** Temporary pages holding spilled partial aggregates */
+    std::vector<page_id_t> spilled_pages_;
+  };
+
+  /** Bounded queue of tuple batches between the producer and the pre-aggregation workers */
+  class BatchQueue;
+
   /** @return The tuple as an AggregateKey */
   auto MakeAggregateKey(const Tuple *tuple) -> AggregateKey {
     std::vector<Value> keys;
@@ -195,14 +290,47 @@ class AggregationExecutor : public AbstractExecutor {
     return {vals};
   }
 
+  /** @return The radix partition of a group hash */
+  static auto PartitionOf(hash_t hash) -> size_t { return (hash >> 32) % AGGREGATION_PARTITIONS; }
+
+  /** Phase one: drain the child into the pre-aggregation workers. */
+  void PreAggregate();
+
+  /** Body of a pre-aggregation worker. */
+  void PreAggregateWorker(BatchQueue *queue);
+
+  /** Hand a worker's buffered partial aggregates over to the partitions, spilling them if requested. */
+  void FlushRuns(std::vector<std::vector<PartialAggregate>> *runs, bool spill);
+
+  /** Write a run of partial aggregates to temporary pages. */
+  void SpillRun(const std::vector<PartialAggregate> &run, std::vector<page_id_t> *pages);
+
+  /** Phase two: merge the next wave of partitions into `wave_tables_`. @return `false` if none is left */
+  auto MergeNextWave() -> bool;
+
+  /** Merge all partial aggregates of one partition into `table`. */
+  void MergePartition(Partition *partition, SimpleAggregationHashTable *table);
+
  private:
   /** The aggregation plan node */
   const AggregationPlanNode *plan_;
   /** The child executor that produces tuples over which the aggregation is computed */
   std::unique_ptr<AbstractExecutor> child_;
-  /** Simple aggregation hash table */
-  // TODO(Student): Uncomment SimpleAggregationHashTable aht_;
-  /** Simple aggregation hash table iterator */
-  // TODO(Student): Uncomment SimpleAggregationHashTable::Iterator aht_iterator_;
+  /** Layout of spilled partial aggregates: the group-by columns followed by the aggregate columns */
+  std::unique_ptr<Schema> spill_schema_;
+  /** The radix partitions filled by phase one */
+  std::vector<Partition> partitions_;
+  /** Protects `partitions_` while the workers flush into it */
+  std::mutex partitions_latch_;
+  /** The first partition not yet merged by phase two */
+  size_t next_partition_{0};
+  /** The merged groups of the current wave of partitions, one table per partition */
+  std::vector<SimpleAggregationHashTable> wave_tables_;
+  /** The wave table currently being emitted */
+  size_t wave_table_idx_{0};
+  /** Simple aggregation hash table iterator over the current wave table */
+  std::optional<SimpleAggregationHashTable::Iterator> aht_iterator_;
+  /** Whether any group has been emitted, to produce the single row of an aggregation over empty input */
+  bool emitted_{false};
 };
 }  // namespace bustub
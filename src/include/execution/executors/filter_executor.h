@@ -17,6 +17,7 @@
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expression_compiler.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "storage/table/tuple.h"
@@ -24,7 +25,8 @@
 namespace bustub {
 
 /**
- * The FilterExecutor executor executes a filter.
+ * The FilterExecutor executor executes a filter. When the predicate can be compiled, the child is pulled in batches
+ * of EXPRESSION_BATCH_SIZE tuples and the compiled predicate selects the qualifying tuples of a whole batch at once.
  */
 class FilterExecutor : public AbstractExecutor {
  public:
@@ -57,5 +59,21 @@ class FilterExecutor : public AbstractExecutor {
 
   /** The child executor from which tuples are obtained */
   std::unique_ptr<AbstractExecutor> child_executor_;
+
+  /** Pull the next batch from the child and select its qualifying tuples. @return `false` if the child is drained */
+  auto NextBatch() -> bool;
+
+  /** The compiled predicate, or `nullptr` if it is interpreted */
+  std::unique_ptr<CompiledExpression> compiled_predicate_;
+  /** The current batch of child tuples */
+  std::vector<Tuple> batch_;
+  /** The RIDs of the current batch */
+  std::vector<RID> batch_rids_;
+  /** The indexes of the qualifying tuples of the current batch */
+  std::vector<uint32_t> selection_;
+  /** The next entry of `selection_` to emit */
+  size_t cursor_{0};
+  /** Whether the child has been drained */
+  bool child_done_{false};
 };
 }  // namespace bustub
@@ -13,8 +13,11 @@
 #pragma once
 
 #include <memory>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "execution/bloom_filter.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/hash_join_plan.h"
@@ -23,7 +26,20 @@
 namespace bustub {
 
 /**
- * HashJoinExecutor executes a nested-loop JOIN on two tables.
+ * HashJoinExecutor executes an equi-JOIN on two tables with a hash table. The hash table is built over the right
+ * child, the left child is probed against it, so a LEFT join pads the unmatched left tuples.
+ *
+ * The build side is buffered before its hash table is built, so that the table is sized for the number of tuples
+ * actually read instead of being rehashed as it grows, and so that the join adapts to the sizes it observes when the
+ * optimizer's estimates were wrong:
+ * - A build side of at most `HASH_JOIN_SCAN_MAX_ROWS` tuples is not hashed; every probe tuple is compared with each
+ *   of them, as a nested loop join over a single block would.
+ * - Once an INNER join reads more than `HASH_JOIN_SWAP_CHECK_ROWS` build tuples, it reads the probe side along with
+ *   the build side, one tuple of each at a time, and builds over whichever side ends first. The tuples read from the
+ *   other side are probed before the rest of it.
+ *
+ * For an INNER join, a Bloom filter over the build-side keys is pushed down to the scan that produces the probe key,
+ * so that tuples without a match are dropped as they are scanned.
  */
 class HashJoinExecutor : public AbstractExecutor {
  public:
@@ -51,9 +67,60 @@ class HashJoinExecutor : public AbstractExecutor {
   /** @return The output schema for the join */
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
+  /** @return the Bloom filter pushed down to the probe side by the last Init, or nullptr if there is none */
+  auto GetRuntimeFilter() const -> const RuntimeFilter * { return runtime_filter_.get(); }
+
+  /** @return whether the last Init built over the left child, because it turned out smaller than the right one */
+  auto IsBuildOnLeft() const -> bool { return build_on_left_; }
+
+  /** @return whether the last Init hashed the build side, rather than keeping it to be scanned */
+  auto IsBuildHashed() const -> bool { return build_hashed_; }
+
  private:
-  /** The NestedLoopJoin plan node to be executed. */
+  /** Buffer a build tuple and its join key, unless the key is NULL and so matches nothing. */
+  void AddBuildTuple(Tuple &&tuple, const AbstractExpression &key_expr, const Schema &schema);
+
+  /** Build a Bloom filter over `build_keys_` and attach it to the scan the probe key comes from. */
+  void PushDownRuntimeFilter();
+
+  /** Move the buffered build side into `hash_table_`, sized for the number of tuples buffered. */
+  void BuildHashTable();
+
+  /** Take the next probe tuple into `probe_tuple_`, from the tuples buffered by Init first. */
+  auto NextProbeTuple() -> bool;
+
+  /** The HashJoin plan node to be executed. */
   const HashJoinPlanNode *plan_;
+  /** The child executor producing the left side */
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  /** The child executor producing the right side */
+  std::unique_ptr<AbstractExecutor> right_executor_;
+  /** Whether the left child is the build side and the right child the probe side */
+  bool build_on_left_{false};
+  /** Whether the build side is in `hash_table_` rather than in `build_tuples_` */
+  bool build_hashed_{false};
+  /** The build side in the order it was read, before it is hashed */
+  std::vector<Tuple> build_tuples_;
+  /** The join keys of `build_tuples_` */
+  std::vector<Value> build_keys_;
+  /** The build side, by join key */
+  std::unordered_map<HashJoinKey, std::vector<Tuple>> hash_table_;
+  /** The probe tuples Init read while sizing up the build side */
+  std::vector<Tuple> probe_buffer_;
+  /** The next tuple of `probe_buffer_` to probe */
+  size_t probe_buffer_idx_{0};
+  /** The probe tuple being joined */
+  Tuple probe_tuple_;
+  /** The join key of `probe_tuple_` */
+  Value probe_key_;
+  /** The build tuples that may match `probe_tuple_`, or nullptr when there is no probe tuple */
+  const std::vector<Tuple> *matches_{nullptr};
+  /** The next build tuple of `matches_` to check */
+  size_t match_idx_{0};
+  /** Whether `probe_tuple_` has matched a build tuple */
+  bool probe_matched_{false};
+  /** The Bloom filter pushed down to the probe side */
+  std::shared_ptr<RuntimeFilter> runtime_filter_;
 };
 
 }  // namespace bustub
@@ -12,18 +12,26 @@
 
 #pragma once
 
+#include <optional>
 #include <vector>
 
 #include "common/rid.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/index_scan_plan.h"
+#include "storage/index/b_plus_tree_index.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * IndexScanExecutor executes an index scan over a table.
+ * IndexScanExecutor executes an index scan over a table: it walks the B+ tree index in key order and fetches the
+ * tuple of every RID from the table. A scan with a limit stops walking the index once it has produced that many tuples.
+ *
+ * Under REPEATABLE_READ, the scan S-locks every key it returns, and the end of the index once it reaches it, so that
+ * no other transaction can insert a key into the range scanned before it commits: running the scan again returns the
+ * same tuples. A scan that stops at its limit locks nothing past its last key, as the keys inserted after it are not
+ * part of its result. See LockManager::LockKey.
  */
 
 class IndexScanExecutor : public AbstractExecutor {
@@ -42,7 +50,30 @@ class IndexScanExecutor : public AbstractExecutor {
   auto Next(Tuple *tuple, RID *rid) -> bool override;
 
  private:
+  /** S-lock a key of the index, or the end of the index. Throws an ExecutionException if the transaction is aborted. */
+  void LockKey(uint64_t key_lock);
+
+  /**
+   * Position the iterator on the first key after the last key returned, to see the keys inserted before a key lock was
+   * granted.
+   * @param expected the key the iterator was on before, nullptr if it was at the end of the index
+   * @return whether the iterator is positioned as it was, that is no key was inserted in between
+   */
+  auto Reseek(const IntegerKeyType *expected) -> bool;
+
   /** The index scan plan node to be executed. */
   const IndexScanPlanNode *plan_;
+  /** The table the index is built on */
+  TableInfo *table_info_;
+  /** The index being scanned */
+  BPlusTreeIndexForOneIntegerColumn *tree_;
+  /** The current position in the index, set by Init */
+  std::optional<BPlusTreeIndexIteratorForOneIntegerColumn> iter_;
+  /** The number of tuples produced since Init */
+  size_t produced_{0};
+  /** Whether the scan takes key locks */
+  bool lock_keys_{false};
+  /** The last key returned, if any */
+  std::optional<IntegerKeyType> last_key_;
 };
 }  // namespace bustub
@@ -13,7 +13,9 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
@@ -25,6 +27,9 @@ namespace bustub {
 /**
  * InsertExecutor executes an insert on a table.
  * Inserted values are always pulled from a child executor.
+ *
+ * A key inserted into a B+ tree index is X-locked until the transaction ends, and the key after it while it is
+ * inserted, so that the insert waits for the range scans that read past the new key. See LockManager::LockKey.
  */
 class InsertExecutor : public AbstractExecutor {
  public:
@@ -55,8 +60,23 @@ class InsertExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
  private:
+  /**
+   * X-lock the key about to be inserted into an index, and the key after it, which guards the gap the key lands in.
+   * Throws an ExecutionException if the transaction is aborted.
+   * @return the lock on the key after, to release once the key is inserted, if it was taken for the insert only
+   */
+  auto LockInsertGap(IndexInfo *index, const Tuple &key) -> std::optional<uint64_t>;
+
   /** The insert plan node to be executed*/
   const InsertPlanNode *plan_;
+  /** The child executor from which inserted tuples are pulled */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The table being inserted into */
+  TableInfo *table_info_;
+  /** The indexes of the table, all of which are maintained */
+  std::vector<IndexInfo *> indexes_;
+  /** Whether the count of inserted rows has been produced */
+  bool done_{false};
 };
 
 }  // namespace bustub
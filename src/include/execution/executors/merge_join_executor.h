@@ -0,0 +1,90 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.h
+//
+// Identification: src/include/execution/executors/merge_join_executor.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/merge_join_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * MergeJoinExecutor executes an equi-JOIN on two children that both produce their tuples in ascending order of their
+ * join key. Both children are read once, side by side: the right child is advanced past the keys smaller than the key
+ * of the current left tuple, and the run of right tuples with an equal key is joined with every left tuple of that
+ * key. Only that run is kept in memory, so that the join streams with no hash table. Tuples with a NULL key match
+ * nothing, wherever their child orders them; a LEFT join pads the unmatched left tuples.
+ */
+class MergeJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new MergeJoinExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The merge join plan to be executed
+   * @param left_child The child executor that produces the left side of the join, ordered on the left key
+   * @param right_child The child executor that produces the right side of the join, ordered on the right key
+   */
+  MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                    std::unique_ptr<AbstractExecutor> &&left_child, std::unique_ptr<AbstractExecutor> &&right_child);
+
+  /** Initialize the join */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the join.
+   * @param[out] tuple The next tuple produced by the join
+   * @param[out] rid The next tuple RID, not used by merge join
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** @return The output schema for the join */
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
+
+ private:
+  /** Read the next right tuple into `right_tuple_` and its key into `right_key_`. */
+  void AdvanceRight();
+
+  /** Skip the right tuples with a key smaller than `key`, and collect those with an equal key into `run_`. */
+  void ReadRun(const Value &key);
+
+  /** The merge join plan node to be executed */
+  const MergeJoinPlanNode *plan_;
+  /** The child executor producing the left side */
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  /** The child executor producing the right side */
+  std::unique_ptr<AbstractExecutor> right_executor_;
+  /** The left tuple being joined */
+  Tuple left_tuple_;
+  /** The first right tuple not read into `run_` yet */
+  Tuple right_tuple_;
+  /** The join key of `right_tuple_` */
+  Value right_key_;
+  /** Whether `right_tuple_` holds a tuple, i.e. the right child is not exhausted */
+  bool has_right_{false};
+  /** The right tuples whose key equals `run_key_` */
+  std::vector<Tuple> run_;
+  /** The join key of the tuples in `run_` */
+  Value run_key_;
+  /** The next tuple of `run_` to join with `left_tuple_` */
+  size_t run_idx_{0};
+  /** Whether `left_tuple_` is being joined with `run_` */
+  bool joining_{false};
+};
+
+}  // namespace bustub
@@ -13,9 +13,11 @@
 #pragma once
 
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "execution/bloom_filter.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/mock_scan_plan.h"
@@ -79,6 +81,9 @@ class MockScanExecutor : public AbstractExecutor {
 
   /** The shuffled output */
   std::vector<size_t> shuffled_idx_;
+
+  /** The runtime filters hash joins above push down to this scan, owned by the executor context and set by Init */
+  const std::vector<std::shared_ptr<RuntimeFilter>> *runtime_filters_{nullptr};
 };
 
 }  // namespace bustub
@@ -14,9 +14,11 @@
 
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expression_compiler.h"
 #include "execution/plans/nested_loop_join_plan.h"
 #include "storage/table/tuple.h"
 
@@ -24,6 +26,11 @@ namespace bustub {
 
 /**
  * NestedLoopJoinExecutor executes a nested-loop JOIN on two tables.
+ *
+ * The join is a block nested loop: it buffers a block of up to `NLJ_BLOCK_PAGES` pages of left tuples and scans the
+ * right child once per block rather than once per left tuple. Each right tuple is joined with the whole block at once,
+ * with the predicate compiled into a `CompiledExpression` where possible. Within a block, the output is ordered by the
+ * right tuple first.
  */
 class NestedLoopJoinExecutor : public AbstractExecutor {
  public:
@@ -53,8 +60,38 @@ class NestedLoopJoinExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
 
  private:
+  /** Read the next block of left tuples. @return false if the left child has no tuples left */
+  auto ReadBlock() -> bool;
+
+  /** Find the tuples of the block that join with `right_tuple_` and put their indexes in `selection_`. */
+  void JoinBlock();
+
   /** The NestedLoopJoin plan node to be executed. */
   const NestedLoopJoinPlanNode *plan_;
+  /** The child executor producing the outer side */
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  /** The child executor producing the inner side, rescanned for every block of outer tuples */
+  std::unique_ptr<AbstractExecutor> right_executor_;
+  /** The join predicate compiled for blocks of outer tuples, or nullptr if it cannot be compiled */
+  std::unique_ptr<CompiledExpression> compiled_predicate_;
+  /** The block of outer tuples being joined */
+  std::vector<Tuple> block_;
+  /** Whether the tuples of `block_` have matched an inner tuple */
+  std::vector<bool> block_matched_;
+  /** Whether the inner scan of `block_` is in progress */
+  bool has_block_{false};
+  /** Whether the outer child has no tuples left */
+  bool left_done_{false};
+  /** Whether the inner scan of `block_` has no tuples left */
+  bool right_done_{false};
+  /** The inner tuple being joined with the block */
+  Tuple right_tuple_;
+  /** The indexes of the tuples of `block_` that join with `right_tuple_` */
+  std::vector<uint32_t> selection_;
+  /** The next index of `selection_` to emit */
+  size_t selection_idx_{0};
+  /** The next tuple of `block_` to check for padding once the inner scan is done, for LEFT joins */
+  size_t pad_idx_{0};
 };
 
 }  // namespace bustub
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// profiling_executor.h
+//
+// Identification: src/include/execution/executors/profiling_executor.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/plans/abstract_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * ProfilingExecutor wraps the executor of a plan node for EXPLAIN ANALYZE, and adds the calls, the produced tuples,
+ * the wall time and the buffer pool accesses of the wrapped executor to the `OperatorProfile` of the node.
+ */
+class ProfilingExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new ProfilingExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The plan node the wrapped executor runs
+   * @param child_executor The wrapped executor
+   */
+  ProfilingExecutor(ExecutorContext *exec_ctx, const AbstractPlanNode *plan,
+                    std::unique_ptr<AbstractExecutor> &&child_executor);
+
+  /** Initialize the wrapped executor */
+  void Init() override;
+
+  /**
+   * Yield the next tuple from the wrapped executor.
+   * @param[out] tuple The next tuple produced by the wrapped executor
+   * @param[out] rid The next tuple RID produced by the wrapped executor
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** @return The output schema of the wrapped executor */
+  auto GetOutputSchema() const -> const Schema & override { return child_executor_->GetOutputSchema(); }
+
+  /**
+   * @return the plan annotated with the runtime statistics its executors collected, and with the tuples dropped by
+   * the runtime filters of its scans
+   */
+  static auto ExplainAnalyze(const AbstractPlanNode &plan, const ExecutorContext &exec_ctx, bool with_schema)
+      -> std::string;
+
+ private:
+  /** Run `f` and add its wall time and buffer pool accesses to the profile. */
+  template <typename F>
+  auto Measure(F &&f) -> decltype(f());
+
+  /** The wrapped executor */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+
+  /** The runtime statistics of the plan node */
+  OperatorProfile *profile_;
+};
+}  // namespace bustub
@@ -13,10 +13,12 @@
 #pragma once
 
 #include <memory>
+#include <optional>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expression_compiler.h"
 #include "execution/plans/projection_plan.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "storage/table/tuple.h"
@@ -24,7 +26,10 @@
 namespace bustub {
 
 /**
- * The ProjectionExecutor executor executes a projection.
+ * The ProjectionExecutor executor executes a projection. When some of the expressions are computed (not plain
+ * columns or constants) and can be compiled, the child is pulled in batches of EXPRESSION_BATCH_SIZE tuples and the
+ * compiled expressions are evaluated over a whole batch at once. They are compiled into one program, so that a
+ * sub-expression shared by several output columns is computed once.
  */
 class ProjectionExecutor : public AbstractExecutor {
  public:
@@ -56,5 +61,23 @@ class ProjectionExecutor : public AbstractExecutor {
 
   /** The child executor from which tuples are obtained */
   std::unique_ptr<AbstractExecutor> child_executor_;
+
+  /** Pull the next batch from the child and evaluate the compiled expressions over it. */
+  auto NextBatch() -> bool;
+
+  /** The compiled computed expressions, or `nullptr` if none is compiled and the projection does not work in batches */
+  std::unique_ptr<CompiledExpression> compiled_exprs_;
+  /** For every expression, its index among the compiled ones, or std::nullopt if it is interpreted */
+  std::vector<std::optional<size_t>> compiled_slots_;
+  /** The current batch of child tuples */
+  std::vector<Tuple> batch_;
+  /** The RIDs of the current batch */
+  std::vector<RID> batch_rids_;
+  /** The values of the compiled expressions over the current batch, indexed by their slot */
+  std::vector<std::vector<Value>> batch_values_;
+  /** The next tuple of the batch to emit */
+  size_t cursor_{0};
+  /** Whether the child has been drained */
+  bool child_done_{false};
 };
 }  // namespace bustub
@@ -12,17 +12,23 @@
 
 #pragma once
 
+#include <memory>
+#include <optional>
 #include <vector>
 
+#include "execution/bloom_filter.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
+#include "execution/expression_compiler.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * The SeqScanExecutor executor executes a sequential table scan.
+ * The SeqScanExecutor executor executes a sequential table scan. When the filter predicate can be compiled, the table
+ * is read in batches of EXPRESSION_BATCH_SIZE tuples and the predicate is evaluated over a whole batch at once.
  */
 class SeqScanExecutor : public AbstractExecutor {
  public:
@@ -50,5 +56,26 @@ class SeqScanExecutor : public AbstractExecutor {
  private:
   /** The sequential scan plan node to be executed */
   const SeqScanPlanNode *plan_;
+  /** The table being scanned */
+  TableInfo *table_info_;
+  /** The current position of the scan, set by Init */
+  std::optional<TableIterator> iter_;
+  /** The runtime filters hash joins above push down to this scan, owned by the executor context and set by Init */
+  const std::vector<std::shared_ptr<RuntimeFilter>> *runtime_filters_{nullptr};
+
+  /** @return whether a tuple passes every runtime filter */
+  auto PassesRuntimeFilters(const Tuple &tuple) const -> bool;
+
+  /** Read the next batch of the table and select the tuples satisfying the predicate. @return `false` at the end */
+  auto NextBatch() -> bool;
+
+  /** The compiled filter predicate, or `nullptr` if there is none or it is interpreted */
+  std::unique_ptr<CompiledExpression> compiled_predicate_;
+  /** The current batch of tuples */
+  std::vector<Tuple> batch_;
+  /** The indexes of the tuples of the current batch that satisfy the predicate */
+  std::vector<uint32_t> selection_;
+  /** The next entry of `selection_` to emit */
+  size_t cursor_{0};
 };
 }  // namespace bustub
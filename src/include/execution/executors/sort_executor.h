@@ -19,12 +19,14 @@
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/sort_plan.h"
+#include "execution/sort_key.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * The SortExecutor executor executes a sort.
+ * The SortExecutor executor executes a sort. It materializes its input, encodes the ORDER BY expressions of
+ * every tuple into a normalized key (see SortKeyEncoder) and radix sorts the keys.
  */
 class SortExecutor : public AbstractExecutor {
  public:
@@ -52,5 +54,13 @@ class SortExecutor : public AbstractExecutor {
  private:
   /** The sort plan node to be executed */
   const SortPlanNode *plan_;
+  /** The child executor from which tuples are obtained */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The materialized input tuples, in the order they were produced by the child */
+  std::vector<Tuple> tuples_;
+  /** Indexes into `tuples_` in sorted order */
+  std::vector<uint32_t> order_;
+  /** The position of the next tuple to emit in `order_` */
+  size_t cursor_{0};
 };
 }  // namespace bustub
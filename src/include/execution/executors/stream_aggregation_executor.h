@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// stream_aggregation_executor.h
+//
+// Identification: src/include/execution/executors/stream_aggregation_executor.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/executors/aggregation_executor.h"
+#include "execution/plans/stream_aggregation_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * StreamAggregationExecutor aggregates a child whose rows arrive grouped on the group-by keys. It folds rows into a
+ * single running aggregate and emits the group as soon as the key changes, so it keeps one group and one look-ahead
+ * tuple in memory instead of a hash table of all groups.
+ */
+class StreamAggregationExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Construct a new StreamAggregationExecutor instance.
+   * @param exec_ctx The executor context
+   * @param plan The stream aggregation plan to be executed
+   * @param child The child executor, which must produce the rows of each group consecutively
+   */
+  StreamAggregationExecutor(ExecutorContext *exec_ctx, const StreamAggregationPlanNode *plan,
+                            std::unique_ptr<AbstractExecutor> &&child);
+
+  /** Initialize the aggregation */
+  void Init() override;
+
+  /**
+   * Yield the next group from the aggregation.
+   * @param[out] tuple The next tuple produced by the aggregation
+   * @param[out] rid The next tuple RID produced by the aggregation
+   * @return `true` if a tuple was produced, `false` if there are no more tuples
+   */
+  auto Next(Tuple *tuple, RID *rid) -> bool override;
+
+  /** @return The output schema for the aggregation */
+  auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); };
+
+ private:
+  /** @return The tuple as an AggregateKey */
+  auto MakeAggregateKey(const Tuple *tuple) -> AggregateKey {
+    std::vector<Value> keys;
+    for (const auto &expr : plan_->GetGroupBys()) {
+      keys.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
+    }
+    return {keys};
+  }
+
+  /** @return The tuple as an AggregateValue */
+  auto MakeAggregateValue(const Tuple *tuple) -> AggregateValue {
+    std::vector<Value> vals;
+    for (const auto &expr : plan_->GetAggregates()) {
+      vals.emplace_back(expr->Evaluate(tuple, child_->GetOutputSchema()));
+    }
+    return {vals};
+  }
+
+  /** Build the output tuple of a finished group. */
+  void EmitGroup(const AggregateKey &key, const AggregateValue &val, Tuple *tuple);
+
+  /** The stream aggregation plan node */
+  const StreamAggregationPlanNode *plan_;
+  /** The child executor that produces grouped tuples */
+  std::unique_ptr<AbstractExecutor> child_;
+  /** Never holds any group: only used for its initial and combine functions */
+  SimpleAggregationHashTable aggregator_;
+  /** The first tuple of the next group, already pulled from the child */
+  Tuple lookahead_;
+  /** Whether `lookahead_` holds a tuple */
+  bool has_lookahead_{false};
+  /** Whether any group has been emitted, to produce the single row of an aggregation over empty input */
+  bool emitted_{false};
+};
+
+}  // namespace bustub
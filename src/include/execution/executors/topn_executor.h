@@ -13,18 +13,21 @@
 #pragma once
 
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
 #include "execution/plans/topn_plan.h"
+#include "execution/sort_key.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 
 /**
- * The TopNExecutor executor executes a topn.
+ * The TopNExecutor executor executes a topn. It keeps the best N tuples seen so far in a max-heap ordered by
+ * their normalized sort key, so a tuple that does not beat the current N-th key is dropped without being copied.
  */
 class TopNExecutor : public AbstractExecutor {
  public:
@@ -50,7 +53,29 @@ class TopNExecutor : public AbstractExecutor {
   auto GetOutputSchema() const -> const Schema & override { return plan_->OutputSchema(); }
 
  private:
+  /** A tuple retained by the heap, together with its normalized sort key */
+  struct HeapEntry {
+    /** The normalized sort key */
+    std::string key_;
+    /** Arrival order, used to break ties so that earlier tuples win */
+    uint64_t seq_;
+    /** The retained tuple */
+    Tuple tuple_;
+  };
+
+  /** @return `true` if `lhs` sorts before `rhs` */
+  static auto EntryLess(const HeapEntry &lhs, const HeapEntry &rhs) -> bool {
+    int cmp = SortKeyEncoder::Compare(lhs.key_, rhs.key_);
+    return cmp < 0 || (cmp == 0 && lhs.seq_ < rhs.seq_);
+  }
+
   /** The topn plan node to be executed */
   const TopNPlanNode *plan_;
+  /** The child executor from which tuples are obtained */
+  std::unique_ptr<AbstractExecutor> child_executor_;
+  /** The top N tuples in sorted order, filled by Init() */
+  std::vector<Tuple> tuples_;
+  /** The position of the next tuple to emit in `tuples_` */
+  size_t cursor_{0};
 };
 }  // namespace bustub
@@ -0,0 +1,224 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// expression_compiler.h
+//
+// Identification: src/include/execution/expression_compiler.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * CompiledExpression is an expression tree lowered into a flat program of vector instructions. Instead of calling
+ * `Evaluate` on every node for every tuple and materializing a `Value` per intermediate result, each instruction
+ * runs a tight typed loop over a whole batch of tuples and writes into a register, i.e. a column vector with a null
+ * flag per row.
+ *
+ * Integer-like values (BOOLEAN, TINYINT, SMALLINT, INTEGER, BIGINT) live in `int64_t` registers and DECIMAL values in
+ * `double` registers. Columns are decoded straight from the tuple data, recognizing NULLs by the type's sentinel. The
+ * results, including NULL handling and the INTEGER wrap-around of `ArithmeticExpression`, are identical to those of
+ * `AbstractExpression::Evaluate`.
+ *
+ * Identical sub-expressions are lowered into a single instruction, so that `a + 1 > 5 AND a + 1 < 10` computes `a + 1`
+ * once per batch. Several expressions can share one program, see `CompileAll`.
+ *
+ * A CompiledExpression keeps its registers across batches and is not thread-safe.
+ */
+class CompiledExpression {
+ public:
+  /**
+   * Compile an expression evaluated against tuples of `schema`.
+   * @param expr the expression to compile
+   * @param schema the schema of the input tuples
+   * @return the compiled expression, or `nullptr` if the expression uses a type or node the compiler does not support
+   */
+  static auto Compile(const AbstractExpression &expr, const Schema &schema) -> std::unique_ptr<CompiledExpression>;
+
+  /**
+   * Compile several expressions evaluated against tuples of `schema` into one program, so that the sub-expressions they
+   * share are evaluated once for all of them.
+   * @param exprs the expressions to compile
+   * @param schema the schema of the input tuples
+   * @return the compiled expressions, or `nullptr` if none of them can be compiled. Those that cannot are skipped, see
+   * `IsCompiled`.
+   */
+  static auto CompileAll(const std::vector<AbstractExpressionRef> &exprs, const Schema &schema)
+      -> std::unique_ptr<CompiledExpression>;
+
+  /**
+   * Compile a join predicate evaluated against a left and a right tuple: `#0.i` refers to column i of the left tuple and
+   * `#1.j` to column j of the right one. The predicate is evaluated for a block of left tuples with one right tuple at
+   * a time, see `SetJoinBlock` and `FilterJoin`.
+   * @param expr the predicate to compile
+   * @param left_schema the schema of the left tuples
+   * @param right_schema the schema of the right tuples
+   * @return the compiled predicate, or `nullptr` if the predicate uses a type or node the compiler does not support
+   */
+  static auto CompileJoin(const AbstractExpression &expr, const Schema &left_schema, const Schema &right_schema)
+      -> std::unique_ptr<CompiledExpression>;
+
+  /**
+   * Start evaluating a join predicate for a block of left tuples. The instructions that only depend on the left tuples
+   * run here, once for the whole block, rather than once per right tuple.
+   * @param block the left tuples, which must stay unchanged while `FilterJoin` is called on them
+   */
+  void SetJoinBlock(const std::vector<Tuple> &block);
+
+  /**
+   * Evaluate a join predicate for every left tuple of the current block with one right tuple.
+   * @param right the right tuple
+   * @param[out] selection the indexes of the left tuples that join with `right`, in ascending order
+   */
+  void FilterJoin(const Tuple &right, std::vector<uint32_t> *selection);
+
+  /**
+   * Evaluate a boolean expression as a predicate over a batch of tuples.
+   * @param batch the tuples to evaluate
+   * @param[out] selection the indexes of the tuples for which the predicate is true, in ascending order
+   */
+  void Filter(const std::vector<Tuple> &batch, std::vector<uint32_t> *selection);
+
+  /**
+   * Evaluate the expression over a batch of tuples.
+   * @param batch the tuples to evaluate
+   * @param[out] values the value of the expression for every tuple of the batch
+   */
+  void Evaluate(const std::vector<Tuple> &batch, std::vector<Value> *values);
+
+  /**
+   * Evaluate the expressions given to `CompileAll` over a batch of tuples, running their shared program once.
+   * @param batch the tuples to evaluate
+   * @param[out] values the values of expression i for every tuple of the batch in `(*values)[i]`, left empty for the
+   * expressions that are not compiled
+   */
+  void EvaluateAll(const std::vector<Tuple> &batch, std::vector<std::vector<Value>> *values);
+
+  /** @return whether expression i given to `CompileAll` is compiled */
+  auto IsCompiled(size_t i) const -> bool { return results_[i].has_value(); }
+
+  /** @return the number of instructions of the program, for testing */
+  auto GetProgramSize() const -> size_t { return program_.size(); }
+
+ private:
+  /** The instructions of the program */
+  enum class OpCode : uint8_t {
+    LoadColumn,
+    LoadRightColumn,
+    LoadConstant,
+    CastToDecimal,
+    Add,
+    Subtract,
+    Equal,
+    NotEqual,
+    LessThan,
+    LessThanOrEqual,
+    GreaterThan,
+    GreaterThanOrEqual,
+    And,
+    Or,
+  };
+
+  /** How the values of a register are represented */
+  enum class RegisterKind : uint8_t { Integer, Decimal };
+
+  /** One vector instruction: `dst = op(lhs, rhs)` over every row of the batch */
+  struct Instruction {
+    OpCode op_;
+    /** Kind of the operands: selects the integer or the decimal kernel */
+    RegisterKind kind_;
+    /** Type of the loaded column or constant, for loads */
+    TypeId type_;
+    uint32_t dst_;
+    uint32_t lhs_;
+    uint32_t rhs_;
+    /** Column index or constant index, for loads */
+    uint32_t arg_;
+    /** Whether the instruction does not depend on the right tuple of a join, so runs once per block */
+    bool block_invariant_;
+  };
+
+  /** A column vector */
+  struct Register {
+    std::vector<int64_t> integers_;
+    std::vector<double> decimals_;
+    std::vector<uint8_t> nulls_;
+  };
+
+  /** A register holding the result of a lowered sub-expression */
+  struct Operand {
+    uint32_t reg_;
+    RegisterKind kind_;
+    TypeId type_;
+  };
+
+  explicit CompiledExpression(const Schema &schema, const Schema *right_schema = nullptr)
+      : schema_(schema), right_schema_(right_schema) {}
+
+  /** Lower a sub-expression, appending its instructions to the program. */
+  auto Lower(const AbstractExpression &expr) -> std::optional<Operand>;
+
+  /** Make sure an operand lives in a decimal register, converting it if needed. */
+  auto ToDecimal(const Operand &operand) -> Operand;
+
+  /**
+   * Append an instruction writing a fresh register, unless the program already has an identical one.
+   * @return the register
+   */
+  auto Emit(OpCode op, RegisterKind kind, TypeId type, uint32_t lhs, uint32_t rhs, uint32_t arg) -> uint32_t;
+
+  /** Lower an expression, dropping the instructions it appended if it cannot be compiled. */
+  auto LowerOrRollBack(const AbstractExpression &expr) -> std::optional<Operand>;
+
+  /** Run the program over a batch. */
+  void Run(const std::vector<Tuple> &batch);
+
+  /** Convert the first `n` rows of a result register into values. */
+  void ToValues(const Operand &result, size_t n, std::vector<Value> *values) const;
+
+  /** Run one instruction over a batch. */
+  void Execute(const Instruction &instr, const std::vector<Tuple> &batch);
+
+  /** Append the rows for which a boolean register is true to `selection`. */
+  static void Select(const Register &result, size_t n, std::vector<uint32_t> *selection);
+
+  /** Decode one column of every tuple of the batch into a register. */
+  void LoadColumn(const Instruction &instr, const std::vector<Tuple> &batch, Register *dst);
+
+  /** Decode one column of the right tuple of a join into every row of a register. */
+  void LoadRightColumn(const Instruction &instr, size_t n, Register *dst);
+
+  /** The schema of the input tuples, or of the left tuples of a join */
+  const Schema &schema_;
+  /** The schema of the right tuples of a join, or nullptr if the expression is not a join predicate */
+  const Schema *right_schema_;
+  /** The block of left tuples set by `SetJoinBlock` */
+  const std::vector<Tuple> *block_{nullptr};
+  /** The right tuple `FilterJoin` is evaluating */
+  const Tuple *right_tuple_{nullptr};
+  /** The instructions, in evaluation order */
+  std::vector<Instruction> program_;
+  /** The constants referenced by LoadConstant */
+  std::vector<Value> constants_;
+  /** The registers, one per instruction */
+  std::vector<Register> registers_;
+  /** The result of every compiled expression, std::nullopt for those `CompileAll` skipped */
+  std::vector<std::optional<Operand>> results_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parameter_value_expression.h
+//
+// Identification: src/include/execution/expressions/parameter_value_expression.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "execution/expressions/abstract_expression.h"
+#include "fmt/format.h"
+
+namespace bustub {
+/**
+ * ParameterValueExpression represents a parameter `$n` of a prepared statement. The plan of a prepared statement is
+ * built once, and every execution stores its parameter values in the vector shared by all the parameters of the plan.
+ */
+class ParameterValueExpression : public AbstractExpression {
+ public:
+  /**
+   * @param idx the index of the parameter
+   * @param ret_type the type the parameter values are cast to
+   * @param values the parameter values of the current execution
+   */
+  ParameterValueExpression(size_t idx, TypeId ret_type, std::shared_ptr<const std::vector<Value>> values)
+      : AbstractExpression({}, ret_type), idx_(idx), values_(std::move(values)) {}
+
+  auto Evaluate(const Tuple *tuple, const Schema &schema) const -> Value override { return GetValue(); }
+
+  auto EvaluateJoin(const Tuple *left_tuple, const Schema &left_schema, const Tuple *right_tuple,
+                    const Schema &right_schema) const -> Value override {
+    return GetValue();
+  }
+
+  /** @return the value of the parameter in the current execution */
+  auto GetValue() const -> Value {
+    BUSTUB_ASSERT(idx_ < values_->size(), "parameter value not set");
+    return (*values_)[idx_];
+  }
+
+  /** @return the index of the parameter */
+  auto GetParameterIdx() const -> size_t { return idx_; }
+
+  /** @return the string representation of the plan node and its children */
+  auto ToString() const -> std::string override { return fmt::format("${}", idx_ + 1); }
+
+  BUSTUB_EXPR_CLONE_WITH_CHILDREN(ParameterValueExpression);
+
+ private:
+  size_t idx_;
+  std::shared_ptr<const std::vector<Value>> values_;
+};
+}  // namespace bustub
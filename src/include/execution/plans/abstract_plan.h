@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <utility>
@@ -47,7 +48,9 @@ enum class PlanType {
   Projection,
   Sort,
   TopN,
-  MockScan
+  MockScan,
+  StreamAggregation,
+  MergeJoin
 };
 
 class AbstractPlanNode;
@@ -92,6 +95,13 @@ class AbstractPlanNode {
     return fmt::format("{}{}", PlanNodeToString(), ChildrenToString(2, with_schema));
   }
 
+  /**
+   * @return the string representation of the plan node and its children, with the line of every node followed by
+   * what `annotate` returns for it, e.g. the runtime statistics of EXPLAIN ANALYZE
+   */
+  auto ToString(bool with_schema, const std::function<std::string(const AbstractPlanNode &)> &annotate) const
+      -> std::string;
+
   /** @return the cloned plan node with new children */
   virtual auto CloneWithChildren(std::vector<AbstractPlanNodeRef> children) const
       -> std::unique_ptr<AbstractPlanNode> = 0;
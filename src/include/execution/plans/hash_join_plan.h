@@ -17,8 +17,10 @@
 #include <vector>
 
 #include "binder/table_ref/bound_join_ref.h"
+#include "common/util/hash_util.h"
 #include "execution/expressions/abstract_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "type/value.h"
 
 namespace bustub {
 
@@ -83,4 +85,29 @@ class HashJoinPlanNode : public AbstractPlanNode {
   }
 };
 
+/** HashJoinKey represents the join key of a tuple in the hash table of a hash join */
+struct HashJoinKey {
+  /** The value of the join key, never NULL: a NULL key matches nothing and is not looked up */
+  Value key_;
+
+  /**
+   * Compares two join keys for equality.
+   * @param other the other join key to be compared with
+   * @return `true` if both join keys are equal, `false` otherwise
+   */
+  auto operator==(const HashJoinKey &other) const -> bool { return key_.CompareEquals(other.key_) == CmpBool::CmpTrue; }
+};
+
 }  // namespace bustub
+
+namespace std {
+
+/** Implements std::hash on HashJoinKey */
+template <>
+struct hash<bustub::HashJoinKey> {
+  auto operator()(const bustub::HashJoinKey &join_key) const -> std::size_t {
+    return bustub::HashUtil::HashValue(&join_key.key_);
+  }
+};
+
+}  // namespace std
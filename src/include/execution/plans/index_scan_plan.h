@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <optional>
 #include <string>
 #include <utility>
 
@@ -29,24 +30,32 @@ class IndexScanPlanNode : public AbstractPlanNode {
    * Creates a new index scan plan node.
    * @param output the output format of this scan plan node
    * @param table_oid the identifier of table to be scanned
+   * @param limit the number of tuples after which the scan stops, if any
    */
-  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid)
-      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid) {}
+  IndexScanPlanNode(SchemaRef output, index_oid_t index_oid, std::optional<size_t> limit = std::nullopt)
+      : AbstractPlanNode(std::move(output), {}), index_oid_(index_oid), limit_(limit) {}
 
   auto GetType() const -> PlanType override { return PlanType::IndexScan; }
 
   /** @return the identifier of the table that should be scanned */
   auto GetIndexOid() const -> index_oid_t { return index_oid_; }
 
+  /** @return the number of tuples after which the scan stops, or nullopt if it scans the whole index */
+  auto GetLimit() const -> std::optional<size_t> { return limit_; }
+
   BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(IndexScanPlanNode);
 
   /** The table whose tuples should be scanned. */
   index_oid_t index_oid_;
 
-  // Add anything you want here for index lookup
+  /** The number of tuples after which the scan stops, set when a LIMIT is folded into the scan */
+  std::optional<size_t> limit_;
 
  protected:
   auto PlanNodeToString() const -> std::string override {
+    if (limit_.has_value()) {
+      return fmt::format("IndexScan {{ index_oid={}, limit={} }}", index_oid_, *limit_);
+    }
     return fmt::format("IndexScan {{ index_oid={} }}", index_oid_);
   }
 };
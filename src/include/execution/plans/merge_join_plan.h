@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_plan.h
+//
+// Identification: src/include/execution/plans/merge_join_plan.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include "execution/plans/hash_join_plan.h"
+
+namespace bustub {
+
+/**
+ * MergeJoinPlanNode is an equi-join whose children both produce their tuples in ascending order of their join key, so
+ * that the join merges the two inputs instead of building a hash table. It has the same shape as HashJoinPlanNode and
+ * is only created by the optimizer.
+ */
+class MergeJoinPlanNode : public HashJoinPlanNode {
+ public:
+  /**
+   * Construct a new MergeJoinPlanNode from a hash join whose inputs are ordered on the join keys.
+   * @param hash_join_plan The hash join plan node to convert
+   */
+  explicit MergeJoinPlanNode(const HashJoinPlanNode &hash_join_plan) : HashJoinPlanNode(hash_join_plan) {}
+
+  /** @return The type of the plan node */
+  auto GetType() const -> PlanType override { return PlanType::MergeJoin; }
+
+  BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(MergeJoinPlanNode);
+
+ protected:
+  auto PlanNodeToString() const -> std::string override {
+    return fmt::format("MergeJoin {{ type={}, left_key={}, right_key={} }}", join_type_, left_key_expression_,
+                       right_key_expression_);
+  }
+};
+
+}  // namespace bustub
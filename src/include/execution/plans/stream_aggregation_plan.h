@@ -0,0 +1,44 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// stream_aggregation_plan.h
+//
+// Identification: src/include/execution/plans/stream_aggregation_plan.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <utility>
+
+#include "execution/plans/aggregation_plan.h"
+
+namespace bustub {
+
+/**
+ * StreamAggregationPlanNode is an aggregation whose child produces the rows of each group next to each other, e.g.
+ * because the child is ordered on the group-by columns. It has the same shape as AggregationPlanNode and is only
+ * created by the optimizer.
+ */
+class StreamAggregationPlanNode : public AggregationPlanNode {
+ public:
+  /**
+   * Construct a new StreamAggregationPlanNode from an aggregation whose input is grouped.
+   * @param agg_plan The aggregation plan node to convert
+   */
+  explicit StreamAggregationPlanNode(const AggregationPlanNode &agg_plan) : AggregationPlanNode(agg_plan) {}
+
+  /** @return The type of the plan node */
+  auto GetType() const -> PlanType override { return PlanType::StreamAggregation; }
+
+  BUSTUB_PLAN_NODE_CLONE_WITH_CHILDREN(StreamAggregationPlanNode);
+
+ protected:
+  auto PlanNodeToString() const -> std::string override;
+};
+
+}  // namespace bustub
@@ -0,0 +1,128 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key.h
+//
+// Identification: src/include/execution/sort_key.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "binder/bound_order_by.h"
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * SortKeyEncoder turns the ORDER BY expressions of a tuple into a normalized binary key. Two keys compare with
+ * `memcmp` (shorter key first on a common prefix) exactly as the tuples compare under the ORDER BY clause, so
+ * sorting never has to dispatch through `Type::CompareLessThan`.
+ *
+ * Every sort column is encoded as a null marker byte (0x00 for NULL, 0x01 otherwise) followed by the value:
+ * - integers: big-endian with the sign bit flipped, at the width of the expression's return type
+ * - decimals: IEEE-754 bits, all inverted for negative numbers and sign bit flipped for the others
+ * - varchars: the bytes with 0x00 escaped as 0x00 0xFF, terminated by 0x00 0x00
+ * DESC columns have every byte of their encoding inverted. NULL therefore sorts first for ASC and last for DESC,
+ * which matches the sentinel representation of NULL (the type's minimum value) used by the type system.
+ */
+class SortKeyEncoder {
+ public:
+  /**
+   * Create a new encoder for the given ORDER BY clause.
+   * @param order_bys the sort expressions and their order by types
+   */
+  explicit SortKeyEncoder(const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &order_bys);
+
+  /**
+   * Append the normalized key of a tuple to `key`.
+   * @param tuple the tuple to encode
+   * @param schema the schema of the tuple
+   * @param[out] key the buffer the key is appended to
+   */
+  void Encode(const Tuple &tuple, const Schema &schema, std::string *key) const;
+
+  /**
+   * Append the normalized key of a tuple to `key` if it sorts strictly before `bound`, another normalized key. The
+   * columns are encoded one at a time and encoding stops at the first one that puts the key at or after `bound`, so
+   * that rejecting a tuple usually costs a single column.
+   * @param tuple the tuple to encode
+   * @param schema the schema of the tuple
+   * @param bound the key to compare with
+   * @param[out] key the buffer the key is appended to; holds a partial key when the tuple is rejected
+   * @return whether the key sorts before `bound`
+   */
+  auto EncodeIfBefore(const Tuple &tuple, const Schema &schema, const std::string &bound, std::string *key) const
+      -> bool;
+
+  /** @return the normalized key of a tuple */
+  auto Encode(const Tuple &tuple, const Schema &schema) const -> std::string {
+    std::string key;
+    key.reserve(fixed_size_hint_);
+    Encode(tuple, schema, &key);
+    return key;
+  }
+
+  /** Compare two normalized keys, returning <0, 0 or >0 like `memcmp`. */
+  static auto Compare(const char *lhs, uint32_t lhs_size, const char *rhs, uint32_t rhs_size) -> int {
+    int ret = memcmp(lhs, rhs, std::min(lhs_size, rhs_size));
+    if (ret == 0) {
+      return lhs_size < rhs_size ? -1 : (lhs_size > rhs_size ? 1 : 0);
+    }
+    return ret;
+  }
+
+  /** Compare two normalized keys, returning <0, 0 or >0 like `memcmp`. */
+  static auto Compare(const std::string &lhs, const std::string &rhs) -> int {
+    return Compare(lhs.data(), lhs.size(), rhs.data(), rhs.size());
+  }
+
+ private:
+  /** Append the encoding of the i-th ORDER BY expression of a tuple. */
+  void EncodeColumn(size_t i, const Tuple &tuple, const Schema &schema, std::string *key) const;
+
+  /** Append the ascending encoding of one non-null `Value` or `ValueView`. */
+  template <typename ValueType>
+  static void EncodeValue(const ValueType &value, std::string *key);
+
+  /** The ORDER BY clause being encoded */
+  const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &order_bys_;
+  /** For each ORDER BY expression that is a plain column, its index: read through a ValueView without a `Value` */
+  std::vector<std::optional<uint32_t>> column_idxs_;
+  /** Key size of the fixed-width columns, used to size the key buffer up front */
+  size_t fixed_size_hint_{0};
+};
+
+/**
+ * A normalized key together with the index of the row it belongs to. The key bytes are owned by the caller.
+ */
+struct SortEntry {
+  /** Start of the normalized key */
+  const char *key_;
+  /** Size of the normalized key in bytes */
+  uint32_t key_size_;
+  /** Index of the row in the caller's row buffer */
+  uint32_t row_;
+};
+
+/**
+ * Sort entries by their normalized key with an MSD radix sort, falling back to a comparison sort on small buckets.
+ * Rows with equal keys keep their original relative order.
+ * @param entries the entries to sort
+ */
+void SortByNormalizedKey(std::vector<SortEntry> *entries);
+
+}  // namespace bustub
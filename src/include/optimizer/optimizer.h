@@ -60,6 +60,12 @@ class Optimizer {
    */
   auto OptimizeEliminateTrueFilter(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
+  /**
+   * @brief fold constant expressions, so that they are computed once at planning rather than once per tuple, and
+   * simplify AND and OR with a constant operand. A filter that is never true is replaced by an empty values node.
+   */
+  auto OptimizeFoldExpressions(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
   /**
    * @brief merge filter into filter_predicate of seq scan plan node
    */
@@ -81,7 +87,8 @@ class Optimizer {
   auto IsPredicateTrue(const AbstractExpression &expr) -> bool;
 
   /**
-   * @brief optimize order by as index scan if there's an index on a table
+   * @brief optimize order by as index scan if there's an index on a table. A limit right above the index scan is folded
+   * into it, so that the scan stops after the tuples the limit lets through.
    */
   auto OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
@@ -95,8 +102,73 @@ class Optimizer {
   auto OptimizeSortLimitAsTopN(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
 
   /**
-   * @brief get the estimated cardinality for a table based on the table name. Useful when join reordering. BusTub
-   * doesn't support statistics for now, so it's the only way for you to get the table size :(
+   * @brief execute aggregations whose input is already ordered on the group-by columns as stream aggregations, which
+   * emit each group as soon as its key changes instead of building a hash table.
+   */
+  auto OptimizeAggregationAsStreamAggregation(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief get the output columns a plan is known to be ordered on, most significant first. The direction of each
+   * column is not returned: with `ascending` set, only the leading columns known to be in ascending order are.
+   */
+  auto OrderedOutputColumns(const AbstractPlanNodeRef &plan, bool ascending = false) -> std::vector<uint32_t>;
+
+  /**
+   * @brief execute hash joins whose children are both in ascending order of their join keys as merge joins, which
+   * merge the two inputs with no hash table. Such orders come from sorts, index scans, and other merge joins.
+   */
+  auto OptimizeHashJoinAsMergeJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief reorder trees of inner joins by cost. The joins are flattened into their relations and the conjuncts of
+   * their predicates, and the cheapest left-deep or bushy order is searched by dynamic programming over the subsets of
+   * relations, estimating intermediate sizes with `EstimateCardinality`. Equi-joins are planned as hash joins, and
+   * conjuncts over a single relation are applied right above it.
+   */
+  auto OptimizeJoinOrder(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /**
+   * @brief push predicates down the plan tree. Filters and join predicates are split into their conjuncts, and each
+   * conjunct is moved to the lowest node that has all the columns it refers to: through projections, sorts, group-by
+   * columns of aggregations and the sides of joins, down into the filter predicate of sequential scans. Conjuncts that
+   * refer to both sides of a nested loop join become its join condition, where `OptimizeNLJAsHashJoin` picks up the
+   * equi-conditions as hash keys.
+   */
+  auto OptimizePredicatePushdown(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef;
+
+  /** @brief push `conjuncts`, which are evaluated against the output of `plan`, as far down `plan` as possible */
+  auto PushDownConjuncts(const AbstractPlanNodeRef &plan, std::vector<AbstractExpressionRef> conjuncts)
+      -> AbstractPlanNodeRef;
+
+  /** @brief append the operands of the top-level ANDs of a predicate to `conjuncts`, dropping always true ones */
+  void SplitConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts);
+
+  /** @brief AND conjuncts together, or return true::boolean if there are none */
+  auto CombineConjuncts(const std::vector<AbstractExpressionRef> &conjuncts) -> AbstractExpressionRef;
+
+  /**
+   * @brief estimate the number of rows a plan produces, from the statistics collected by `ANALYZE` where available.
+   */
+  auto EstimateCardinality(const AbstractPlanNode &plan) -> double;
+
+  /**
+   * @brief estimate the fraction of rows for which a predicate holds.
+   *
+   * @param expr the predicate
+   * @param inputs the plans the predicate is evaluated against: `#i.j` refers to column j of inputs[i]
+   */
+  auto EstimateSelectivity(const AbstractExpression &expr, const std::vector<const AbstractPlanNode *> &inputs)
+      -> double;
+
+  /** @brief get the statistics of an output column of a plan, or nullptr if it doesn't come from an analyzed table */
+  auto ColumnStatisticsOf(const AbstractPlanNode &plan, uint32_t col_idx) -> const ColumnStatistics *;
+
+  /** @brief get the table a scan plan reads, or nullptr if the plan is not a scan */
+  auto ScannedTable(const AbstractPlanNode &plan) -> const TableInfo *;
+
+  /**
+   * @brief get the estimated cardinality for a table based on the table name. Used as a fallback for tables that have
+   * not been analyzed.
    *
    * @param table_name
    * @return std::optional<size_t>
@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// plan_cache.h
+//
+// Identification: src/include/planner/plan_cache.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/plans/abstract_plan.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * CachedPlan is an optimized plan together with what is needed to run it again without binding, planning or
+ * optimizing its statement.
+ */
+struct CachedPlan {
+  /** The optimized plan */
+  AbstractPlanNodeRef plan_;
+  /** The schema of the result, whose column names come from the statement rather than the optimized plan */
+  SchemaRef output_schema_;
+  /** The catalog version the plan was built at */
+  uint64_t catalog_version_;
+  /** The types of the parameters of a prepared statement */
+  std::vector<TypeId> parameter_types_;
+  /** The values the parameters of the plan evaluate to, set before each execution */
+  std::shared_ptr<std::vector<Value>> parameter_values_;
+};
+
+/**
+ * PlanCache keeps the plans of the most recently run statements, keyed by their normalized SQL text. A plan built at
+ * an older catalog version than the current one is stale: it may scan a table that now has an index, or be ordered
+ * by outdated statistics, so it is dropped on lookup.
+ */
+class PlanCache {
+ public:
+  /** @param capacity the number of plans to keep */
+  explicit PlanCache(size_t capacity) : capacity_(capacity) {}
+
+  /**
+   * Normalize a SQL statement into a cache key. Outside of quotes, letters are lowercased and runs of whitespace
+   * are collapsed into one space; leading and trailing whitespace and semicolons are dropped.
+   */
+  static auto NormalizeSql(const std::string &sql) -> std::string;
+
+  /**
+   * @param key the normalized statement
+   * @param catalog_version the current catalog version
+   * @return the plan cached for the statement, or nullptr if there is none or it is stale
+   */
+  auto Get(const std::string &key, uint64_t catalog_version) -> std::shared_ptr<const CachedPlan>;
+
+  /** Cache the plan of a statement, evicting the least recently used plan when full. */
+  void Put(const std::string &key, std::shared_ptr<const CachedPlan> plan);
+
+  /** @return the number of cached plans */
+  auto Size() -> size_t;
+
+ private:
+  using Entry = std::pair<std::string, std::shared_ptr<const CachedPlan>>;
+
+  std::mutex latch_;
+  size_t capacity_;
+  /** The cached plans, the most recently used first */
+  std::list<Entry> entries_;
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_;
+};
+
+}  // namespace bustub
@@ -26,6 +26,7 @@ class BoundExpression;
 class BoundTableRef;
 class BoundBinaryOp;
 class BoundConstant;
+class BoundParameter;
 class BoundColumnRef;
 class BoundUnaryOp;
 class BoundBaseTableRef;
@@ -44,7 +45,7 @@ class PlannerContext {
  public:
   PlannerContext() = default;
 
-  void AddAggregation(std::unique_ptr<BoundExpression> expr);
+  void AddAggregation(const BoundExpression *expr);
 
   /** Indicates whether aggregation is allowed in this context. */
   bool allow_aggregation_{false};
@@ -55,9 +56,10 @@ class PlannerContext {
   /**
    * In the first phase of aggregation planning, we put all agg calls expressions into this vector.
    * The expressions in this vector should be used over the output of the original filter / table
-   * scan plan node.
+   * scan plan node. They point into the bound statement, which planning leaves intact so that a prepared statement
+   * can be planned again.
    */
-  std::vector<std::unique_ptr<BoundExpression>> aggregations_;
+  std::vector<const BoundExpression *> aggregations_;
 
   /**
    * In the second phase of aggregation planning, we plan agg calls from `aggregations_`, and generate
@@ -110,7 +112,7 @@ class Planner {
 
   auto PlanExpressionListRef(const BoundExpressionListRef &table_ref) -> AbstractPlanNodeRef;
 
-  void AddAggCallToContext(BoundExpression &expr);
+  void AddAggCallToContext(const BoundExpression &expr);
 
   auto PlanExpression(const BoundExpression &expr, const std::vector<AbstractPlanNodeRef> &children)
       -> std::tuple<std::string, AbstractExpressionRef>;
@@ -124,6 +126,13 @@ class Planner {
   auto PlanConstant(const BoundConstant &expr, const std::vector<AbstractPlanNodeRef> &children)
       -> AbstractExpressionRef;
 
+  /**
+   * Plan a parameter of a prepared statement. A parameter whose type was not declared takes the type of the other
+   * operand of the operator it appears in, or INTEGER when there is none.
+   * @param type_hint the type of the other operand, or INVALID
+   */
+  auto PlanParameter(const BoundParameter &expr, TypeId type_hint) -> AbstractExpressionRef;
+
   auto PlanSelectAgg(const SelectStatement &statement, AbstractPlanNodeRef child) -> AbstractPlanNodeRef;
 
   auto PlanAggCall(const BoundAggCall &agg_call, const std::vector<AbstractPlanNodeRef> &children)
@@ -144,6 +153,12 @@ class Planner {
   /** the root plan node of the plan tree */
   AbstractPlanNodeRef plan_;
 
+  /** the types of the parameters `$1, $2, ...` of a prepared statement, INVALID until declared or inferred */
+  std::vector<TypeId> parameter_types_;
+
+  /** the values the parameters of the plan evaluate to, set before each execution of a prepared statement */
+  std::shared_ptr<std::vector<Value>> parameter_values_{std::make_shared<std::vector<Value>>()};
+
  private:
   PlannerContext ctx_;
 
@@ -16,6 +16,7 @@
 #include <condition_variable>  // NOLINT
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -25,6 +26,11 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * The log buffer and the flush buffer are swapped on every flush, so that records keep being appended while the
+ * previous ones are written. A transaction waiting for its commit record to be persistent wakes the thread up too;
+ * every record appended by then is written by the same flush, which makes commits that wait together share one write
+ * (group commit).
  */
 class LogManager {
  public:
@@ -35,6 +41,7 @@ class LogManager {
   }
 
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
     delete[] flush_buffer_;
     log_buffer_ = nullptr;
@@ -46,13 +53,21 @@ class LogManager {
 
   auto AppendLogRecord(LogRecord *log_record) -> lsn_t;
 
+  /**
+   * Block until the log is persistent up to an LSN, waking the flush thread up rather than waiting for the timeout.
+   * The flush thread must be running.
+   * @param lsn the LSN to wait for, INVALID_LSN to not wait
+   */
+  void WaitUntilPersistent(lsn_t lsn);
+
   inline auto GetNextLSN() -> lsn_t { return next_lsn_; }
   inline auto GetPersistentLSN() -> lsn_t { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
   inline auto GetLogBuffer() -> char * { return log_buffer_; }
 
  private:
-  // TODO(students): you may add your own member variables
+  /** Write the log buffer to disk whenever a flush is requested or the timeout expires, until stopped. */
+  void FlushLoop();
 
   /** The atomic counter which records the next log sequence number. */
   std::atomic<lsn_t> next_lsn_;
@@ -62,13 +77,23 @@ class LogManager {
   char *log_buffer_;
   char *flush_buffer_;
 
+  /** The end of the records in the log buffer. */
+  int offset_{0};
+  /** Whether the flush thread is asked to flush before the timeout. */
+  bool flush_requested_{false};
+  /** Whether the flush thread is asked to flush what is left and exit. */
+  bool stop_{false};
+
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread *flush_thread_{nullptr};
 
+  /** Wakes up the flush thread. */
   std::condition_variable cv_;
+  /** Signalled when the log buffer is swapped out and when a flush completes. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
@@ -60,6 +60,12 @@ class Page {
   /** Release the page read latch. */
   inline void RUnlatch() { rwlatch_.RUnlock(); }
 
+  /** Begin reading the page optimistically, without latching it. @return the version to validate the read with */
+  inline auto OptimisticRLatch() const -> uint64_t { return rwlatch_.OptimisticRead(); }
+
+  /** @return whether the page was not write-latched since the optimistic read of a version began */
+  inline auto ValidateRLatch(uint64_t version) const -> bool { return rwlatch_.Validate(version); }
+
   /** @return the page LSN. */
   inline auto GetLSN() -> lsn_t { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
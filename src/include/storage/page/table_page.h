@@ -123,20 +123,40 @@ class TablePage : public Page {
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager) -> bool;
 
+  /**
+   * Read a tuple from a table without copying it. The view points into this page: it is only valid while the page
+   * stays pinned and read-latched by the caller (see TupleView).
+   * @param rid rid of the tuple to read
+   * @param[out] view the view of the tuple that was read
+   * @return true if the read is successful (i.e. the tuple exists)
+   */
+  auto GetTupleView(const RID &rid, TupleView *view) -> bool;
+
+  /**
+   * Read a tuple from a table even if it is marked deleted, for snapshot reads that may still see it.
+   * @param rid rid of the tuple to read
+   * @param[out] tuple the tuple that was read
+   * @param[out] is_deleted whether the tuple is marked deleted
+   * @return true if the slot holds a tuple
+   */
+  auto GetTupleVersion(const RID &rid, Tuple *tuple, bool *is_deleted) -> bool;
+
   /** @return the rid of the first tuple in this page */
 
   /**
    * @param[out] first_rid the RID of the first tuple in this page
+   * @param include_deleted whether tuples marked deleted count, for snapshot reads
    * @return true if the first tuple exists, false otherwise
    */
-  auto GetFirstTupleRid(RID *first_rid) -> bool;
+  auto GetFirstTupleRid(RID *first_rid, bool include_deleted = false) -> bool;
 
   /**
    * @param cur_rid the RID of the current tuple
    * @param[out] next_rid the RID of the tuple following the current tuple
+   * @param include_deleted whether tuples marked deleted count, for snapshot reads
    * @return true if the next tuple exists, false otherwise
    */
-  auto GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool;
+  auto GetNextTupleRid(const RID &cur_rid, RID *next_rid, bool include_deleted = false) -> bool;
 
  private:
   static_assert(sizeof(page_id_t) == 4);
@@ -205,5 +225,10 @@ class TablePage : public Page {
   static auto UnsetDeletedFlag(uint32_t tuple_size) -> uint32_t {
     return static_cast<uint32_t>(tuple_size & (~DELETE_MASK));
   }
+
+  /** @return whether a slot holds a tuple, marked deleted or not, when `include_deleted` */
+  static auto HoldsTuple(uint32_t tuple_size, bool include_deleted) -> bool {
+    return include_deleted ? UnsetDeletedFlag(tuple_size) != 0 : !IsDeleted(tuple_size);
+  }
 };
 }  // namespace bustub
@@ -13,6 +13,8 @@
 #pragma once
 
 #include "buffer/buffer_pool_manager.h"
+#include "concurrency/version_latch_table.h"
+#include "concurrency/version_store.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_iterator.h"
@@ -23,6 +25,13 @@ namespace bustub {
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * The pages hold the newest version of every tuple, and the version store the older ones that running snapshots may
+ * still read. Under MVCC a committed delete leaves the tuple marked deleted until no snapshot sees it anymore, at which
+ * point the garbage collection applies it.
+ *
+ * Optimistic transactions buffer their updates and deletes in their transaction until they commit, and validate their
+ * reads against the version latches, which every write made in place bumps.
  */
 class TableHeap {
   friend class TableIterator;
@@ -63,7 +72,9 @@ class TableHeap {
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is called.
    * @param rid resource id of the tuple of delete
    * @param txn transaction performing the delete
-   * @return true iff the delete is successful (i.e the tuple exists)
+   * @return true iff the delete is successful (i.e the tuple exists). The transaction is aborted if another one wrote
+   * the tuple and has not committed yet, or, under snapshot isolation, committed after its snapshot. An optimistic
+   * transaction only reads the tuple and buffers the delete.
    */
   auto MarkDelete(const RID &rid, Transaction *txn) -> bool;  // for delete
 
@@ -72,12 +83,13 @@ class TableHeap {
    * @param tuple new tuple
    * @param rid rid of the old tuple
    * @param txn transaction performing the update
-   * @return true is update is successful.
+   * @return true is update is successful. The transaction is aborted on a write-write conflict, as in MarkDelete.
+   * An optimistic transaction only reads the tuple and buffers the update.
    */
   auto UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) -> bool;
 
   /**
-   * Called on Commit/Abort to actually delete a tuple or rollback an insert.
+   * Called on Abort to rollback an insert, and by the garbage collection to actually delete a tuple.
    * @param rid rid of the tuple to delete
    * @param txn transaction performing the delete.
    */
@@ -90,12 +102,22 @@ class TableHeap {
    */
   void RollbackDelete(const RID &rid, Transaction *txn);
 
+  /**
+   * Drop the versions of a tuple that no snapshot can see anymore, and apply its delete if it was deleted.
+   * @param rid rid of the tuple
+   * @param watermark the read timestamp of the oldest running snapshot
+   * @param txn transaction performing the garbage collection
+   */
+  void GarbageCollect(const RID &rid, timestamp_t watermark, Transaction *txn);
+
   /**
    * Read a tuple from the table.
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
-   * @return true if the read was successful (i.e. the tuple exists)
+   * @return true if the read was successful (i.e. the tuple exists, in the snapshot of `txn` under snapshot isolation)
+   * An optimistic transaction records the read, and is aborted if another transaction wrote the tuple and has not
+   * committed yet.
    */
   auto GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock = true) -> bool;
 
@@ -108,11 +130,29 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline auto GetFirstPageId() const -> page_id_t { return first_page_id_; }
 
+  /** @return the older versions of the tuples of this table */
+  inline auto GetVersionStore() -> VersionStore * { return &version_store_; }
+
+  /** @return the version latches of the tuples of this table, for optimistic transactions */
+  inline auto GetVersionLatches() -> VersionLatchTable * { return &version_latches_; }
+
  private:
+  /** @return whether `txn` buffers its updates and deletes instead of writing in place */
+  static auto BuffersWrites(const Transaction *txn) -> bool {
+    return txn->IsOptimistic() && txn->GetState() == TransactionState::GROWING;
+  }
+
+  /** @return whether `txn` is an optimistic transaction installing or rolling back its writes under its latches */
+  static auto HoldsVersionLatches(const Transaction *txn) -> bool {
+    return txn->IsOptimistic() && txn->GetState() != TransactionState::GROWING;
+  }
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  VersionStore version_store_;
+  VersionLatchTable version_latches_;
 };
 
 }  // namespace bustub
@@ -17,6 +17,7 @@
 
 #include "catalog/schema.h"
 #include "common/rid.h"
+#include "storage/table/tuple_view.h"
 #include "type/value.h"
 
 namespace bustub {
@@ -42,12 +43,30 @@ class Tuple {
   // constructor for creating a new tuple based on input value
   Tuple(std::vector<Value> values, const Schema *schema);
 
+  // constructor for an owning copy of the viewed tuple, deep copy
+  explicit Tuple(const TupleView &view);
+
+  // constructor for a tuple borrowing serialized bytes that outlive it, e.g. in a transaction arena; copies of it are
+  // shallow too
+  Tuple(RID rid, char *data, uint32_t size) : rid_(rid), size_(size), data_(data) {}
+
   // copy constructor, deep copy
   Tuple(const Tuple &other);
 
+  // move constructor, takes over the data of `other` and leaves it empty
+  Tuple(Tuple &&other) noexcept
+      : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_), data_(other.data_) {
+    other.allocated_ = false;
+    other.size_ = 0;
+    other.data_ = nullptr;
+  }
+
   // assign operator, deep copy
   auto operator=(const Tuple &other) -> Tuple &;
 
+  // move assign operator, takes over the data of `other` and leaves it empty
+  auto operator=(Tuple &&other) noexcept -> Tuple &;
+
   ~Tuple() {
     if (allocated_) {
       delete[] data_;
@@ -74,6 +93,14 @@ class Tuple {
   // checks the schema to see how to return the Value.
   auto GetValue(const Schema *schema, uint32_t column_idx) const -> Value;
 
+  // Get a non-owning view of this tuple, valid until the tuple is destroyed, assigned to or moved from
+  inline auto GetView() const -> TupleView { return {data_, size_, rid_}; }
+
+  // Get a non-owning view of the value of a specified column, without deserializing it
+  inline auto GetValueView(const Schema *schema, uint32_t column_idx) const -> ValueView {
+    return GetView().GetValueView(schema, column_idx);
+  }
+
   // Generates a key tuple given schemas and attributes
   auto KeyFromTuple(const Schema &schema, const Schema &key_schema, const std::vector<uint32_t> &key_attrs) -> Tuple;
 
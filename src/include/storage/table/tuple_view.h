@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_view.h
+//
+// Identification: src/include/storage/table/tuple_view.h
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "catalog/schema.h"
+#include "common/rid.h"
+#include "type/limits.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * ValueView is a non-owning, read-only view of one serialized column value. It exposes the same accessors as
+ * `Value` (`IsNull`, `GetAs`, `GetData`, `GetLength`) but reads them straight from the serialized bytes, so
+ * inspecting a value never allocates, not even for VARCHAR.
+ *
+ * A ValueView is valid exactly as long as the bytes it points to: see TupleView for the lifetime rules.
+ */
+class ValueView {
+ public:
+  ValueView(TypeId type_id, const char *data) : type_id_(type_id), data_(data) {}
+
+  /** @return the type of the value */
+  inline auto GetTypeId() const -> TypeId { return type_id_; }
+
+  /** @return whether the value is NULL, i.e. holds the NULL sentinel of its type */
+  auto IsNull() const -> bool {
+    switch (type_id_) {
+      case TypeId::BOOLEAN:
+        return GetAs<int8_t>() == BUSTUB_BOOLEAN_NULL;
+      case TypeId::TINYINT:
+        return GetAs<int8_t>() == BUSTUB_INT8_NULL;
+      case TypeId::SMALLINT:
+        return GetAs<int16_t>() == BUSTUB_INT16_NULL;
+      case TypeId::INTEGER:
+        return GetAs<int32_t>() == BUSTUB_INT32_NULL;
+      case TypeId::BIGINT:
+        return GetAs<int64_t>() == BUSTUB_INT64_NULL;
+      case TypeId::DECIMAL:
+        return GetAs<double>() == BUSTUB_DECIMAL_NULL;
+      case TypeId::TIMESTAMP:
+        return GetAs<uint64_t>() == BUSTUB_TIMESTAMP_NULL;
+      case TypeId::VARCHAR:
+        return GetAs<uint32_t>() == BUSTUB_VALUE_NULL;
+      default:
+        return false;
+    }
+  }
+
+  /** @return the fixed-size value reinterpreted as T; T must match the width of the type */
+  template <class T>
+  inline auto GetAs() const -> T {
+    T value;
+    memcpy(&value, data_, sizeof(T));
+    return value;
+  }
+
+  /** @return the length of a VARCHAR value, including its trailing '\0' as for `Value::GetLength` */
+  inline auto GetLength() const -> uint32_t { return GetAs<uint32_t>(); }
+
+  /** @return the bytes of a VARCHAR value */
+  inline auto GetData() const -> const char * { return data_ + sizeof(uint32_t); }
+
+  /** @return the characters of a non-null VARCHAR value, without the trailing '\0' */
+  inline auto GetStringView() const -> std::string_view {
+    auto len = GetLength();
+    return {GetData(), len > 0 ? len - 1 : 0};
+  }
+
+  /** @return an owning copy of the value; allocates for VARCHAR */
+  inline auto ToValue() const -> Value { return Value::DeserializeFrom(data_, type_id_); }
+
+ private:
+  /** The type of the value */
+  TypeId type_id_;
+  /** The serialized value: the value itself for fixed-size types, the length prefix for VARCHAR */
+  const char *data_;
+};
+
+/**
+ * TupleView is a non-owning, read-only view of a serialized tuple, for instance the bytes of a tuple inside a table
+ * page or the buffer of a `Tuple`. Columns are accessed as ValueViews without deserializing or copying anything;
+ * `Tuple(const TupleView &)` makes an owning copy when one is needed.
+ *
+ * Lifetime rules: a view borrows the bytes it points to and never extends their lifetime.
+ * - A view of a `Tuple` is valid until the tuple is destroyed, assigned to, or moved from.
+ * - A view of a table page is valid only while the page stays pinned in the buffer pool *and* the caller holds the
+ *   page's read latch: deleting a tuple compacts the page and moves the bytes of the other tuples on it. Unpin the
+ *   page (or release the latch) only after the last use of every view into it, and copy out into a `Tuple` any
+ *   tuple that has to outlive the pin, e.g. one returned from an executor's `Next`.
+ */
+class TupleView {
+ public:
+  TupleView() = default;
+
+  TupleView(const char *data, uint32_t size, RID rid) : data_(data), size_(size), rid_(rid) {}
+
+  /** @return the RID of the tuple, if it was read from a table */
+  inline auto GetRid() const -> RID { return rid_; }
+
+  /** @return the serialized tuple */
+  inline auto GetData() const -> const char * { return data_; }
+
+  /** @return the size of the serialized tuple */
+  inline auto GetLength() const -> uint32_t { return size_; }
+
+  /** @return a view of the value of a column */
+  auto GetValueView(const Schema *schema, uint32_t column_idx) const -> ValueView {
+    const auto &col = schema->GetColumn(column_idx);
+    if (col.IsInlined()) {
+      return {col.GetType(), data_ + col.GetOffset()};
+    }
+    // The inline part of a VARCHAR column holds the offset of its length-prefixed payload.
+    uint32_t offset;
+    memcpy(&offset, data_ + col.GetOffset(), sizeof(offset));
+    return {col.GetType(), data_ + offset};
+  }
+
+ private:
+  const char *data_{nullptr};
+  uint32_t size_{0};
+  RID rid_{};
+};
+
+}  // namespace bustub
@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <memory>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/stream_aggregation_plan.h"
+#include "execution/plans/topn_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the leading column references of an ORDER BY clause, only up to the first descending one if `ascending` */
+auto OrderByColumns(const std::vector<std::pair<OrderByType, AbstractExpressionRef>> &order_bys, bool ascending)
+    -> std::vector<uint32_t> {
+  std::vector<uint32_t> columns;
+  for (const auto &[order_by_type, expr] : order_bys) {
+    const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+    if (column_value_expr == nullptr || (ascending && order_by_type == OrderByType::DESC)) {
+      break;
+    }
+    columns.push_back(column_value_expr->GetColIdx());
+  }
+  return columns;
+}
+
+}  // namespace
+
+auto Optimizer::OrderedOutputColumns(const AbstractPlanNodeRef &plan, bool ascending) -> std::vector<uint32_t> {
+  switch (plan->GetType()) {
+    case PlanType::Sort:
+      return OrderByColumns(dynamic_cast<const SortPlanNode &>(*plan).GetOrderBy(), ascending);
+    case PlanType::TopN:
+      return OrderByColumns(dynamic_cast<const TopNPlanNode &>(*plan).GetOrderBy(), ascending);
+    case PlanType::IndexScan: {
+      // The index scan produces the base table rows in ascending index key order.
+      const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*plan);
+      const auto *index_info = catalog_.GetIndex(index_scan.GetIndexOid());
+      if (index_info == Catalog::NULL_INDEX_INFO) {
+        return {};
+      }
+      return index_info->index_->GetKeyAttrs();
+    }
+    case PlanType::Filter:
+    case PlanType::Limit:
+      return OrderedOutputColumns(plan->GetChildAt(0), ascending);
+    case PlanType::MergeJoin:
+      // The merge join emits the joined tuples in the order of the left child, whose columns come first.
+      return OrderedOutputColumns(plan->GetChildAt(0), ascending);
+    case PlanType::Projection: {
+      // The order survives as long as the projection passes the ordered columns through.
+      const auto &projection = dynamic_cast<const ProjectionPlanNode &>(*plan);
+      const auto &exprs = projection.GetExpressions();
+      std::vector<uint32_t> columns;
+      for (auto child_col : OrderedOutputColumns(projection.GetChildPlan(), ascending)) {
+        auto it = std::find_if(exprs.begin(), exprs.end(), [child_col](const AbstractExpressionRef &expr) {
+          const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+          return column_value_expr != nullptr && column_value_expr->GetColIdx() == child_col;
+        });
+        if (it == exprs.end()) {
+          break;
+        }
+        columns.push_back(static_cast<uint32_t>(it - exprs.begin()));
+      }
+      return columns;
+    }
+    default:
+      return {};
+  }
+}
+
+auto Optimizer::OptimizeAggregationAsStreamAggregation(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeAggregationAsStreamAggregation(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::Aggregation) {
+    return optimized_plan;
+  }
+  const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*optimized_plan);
+  if (agg_plan.GetGroupBys().empty()) {
+    // A single group is already aggregated in constant memory.
+    return optimized_plan;
+  }
+
+  // Every group-by expression must be a plain column of the child.
+  std::unordered_set<uint32_t> group_by_columns;
+  for (const auto &expr : agg_plan.GetGroupBys()) {
+    const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+    if (column_value_expr == nullptr) {
+      return optimized_plan;
+    }
+    group_by_columns.insert(column_value_expr->GetColIdx());
+  }
+
+  // Rows of a group are adjacent iff the child is ordered on exactly the group-by columns first, in any order and
+  // any direction.
+  auto ordered_columns = OrderedOutputColumns(agg_plan.GetChildPlan());
+  std::unordered_set<uint32_t> prefix;
+  for (auto col : ordered_columns) {
+    if (prefix.size() == group_by_columns.size()) {
+      break;
+    }
+    prefix.insert(col);
+  }
+  if (prefix != group_by_columns) {
+    return optimized_plan;
+  }
+  return std::make_shared<StreamAggregationPlanNode>(agg_plan);
+}
+
+}  // namespace bustub
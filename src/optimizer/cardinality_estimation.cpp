@@ -0,0 +1,321 @@
+#include <algorithm>
+#include <optional>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "catalog/table_statistics.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/index_scan_plan.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/mock_scan_plan.h"
+#include "execution/plans/nested_index_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/topn_plan.h"
+#include "execution/plans/values_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** Selectivities assumed for predicates over columns without statistics, as in System R. */
+constexpr double DEFAULT_EQUAL_SELECTIVITY = 0.1;
+constexpr double DEFAULT_RANGE_SELECTIVITY = 1.0 / 3;
+constexpr double DEFAULT_SELECTIVITY = 0.5;
+/** Cardinality assumed for a table that has not been analyzed and whose size cannot be guessed from its name. */
+constexpr double DEFAULT_TABLE_CARDINALITY = 1000;
+
+/** @return the comparison with its operands swapped, i.e. `b op' a` for `a op b` */
+auto FlipComparison(ComparisonType comp_type) -> ComparisonType {
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comp_type;
+  }
+}
+
+auto DefaultSelectivity(ComparisonType comp_type) -> double {
+  switch (comp_type) {
+    case ComparisonType::Equal:
+      return DEFAULT_EQUAL_SELECTIVITY;
+    case ComparisonType::NotEqual:
+      return 1 - DEFAULT_EQUAL_SELECTIVITY;
+    default:
+      return DEFAULT_RANGE_SELECTIVITY;
+  }
+}
+
+/** @return the selectivity of `column op constant` */
+auto ColumnConstantSelectivity(const ColumnStatistics *stats, ComparisonType comp_type, const Value &constant)
+    -> double {
+  if (stats == nullptr) {
+    return DefaultSelectivity(comp_type);
+  }
+  if (comp_type == ComparisonType::Equal) {
+    return stats->EstimateEqualSelectivity(constant);
+  }
+  if (comp_type == ComparisonType::NotEqual) {
+    return std::max(0.0, 1 - stats->GetNullFraction() - stats->EstimateEqualSelectivity(constant));
+  }
+  auto numeric = ColumnStatistics::ToNumeric(constant);
+  if (!numeric.has_value()) {
+    return constant.IsNull() ? 0 : DEFAULT_RANGE_SELECTIVITY;
+  }
+  switch (comp_type) {
+    case ComparisonType::LessThan:
+      return stats->EstimateRangeSelectivity(std::nullopt, false, numeric, false);
+    case ComparisonType::LessThanOrEqual:
+      return stats->EstimateRangeSelectivity(std::nullopt, false, numeric, true);
+    case ComparisonType::GreaterThan:
+      return stats->EstimateRangeSelectivity(numeric, false, std::nullopt, false);
+    default:
+      return stats->EstimateRangeSelectivity(numeric, true, std::nullopt, false);
+  }
+}
+
+}  // namespace
+
+auto Optimizer::ScannedTable(const AbstractPlanNode &plan) -> const TableInfo * {
+  switch (plan.GetType()) {
+    case PlanType::SeqScan:
+      return catalog_.GetTable(dynamic_cast<const SeqScanPlanNode &>(plan).GetTableOid());
+    case PlanType::MockScan:
+      return catalog_.GetTable(dynamic_cast<const MockScanPlanNode &>(plan).GetTable());
+    case PlanType::IndexScan: {
+      const auto *index = catalog_.GetIndex(dynamic_cast<const IndexScanPlanNode &>(plan).GetIndexOid());
+      return index == nullptr ? nullptr : catalog_.GetTable(index->table_name_);
+    }
+    default:
+      return nullptr;
+  }
+}
+
+auto Optimizer::ColumnStatisticsOf(const AbstractPlanNode &plan, uint32_t col_idx) -> const ColumnStatistics * {
+  switch (plan.GetType()) {
+    case PlanType::SeqScan:
+    case PlanType::MockScan:
+    case PlanType::IndexScan: {
+      const auto *table = ScannedTable(plan);
+      const auto *stats = table == nullptr ? nullptr : catalog_.GetTableStatistics(table->oid_);
+      return stats == nullptr || col_idx >= stats->columns_.size() ? nullptr : &stats->columns_[col_idx];
+    }
+    case PlanType::Filter:
+    case PlanType::Sort:
+    case PlanType::Limit:
+    case PlanType::TopN:
+      return ColumnStatisticsOf(*plan.GetChildAt(0), col_idx);
+    case PlanType::Projection: {
+      const auto &expr = dynamic_cast<const ProjectionPlanNode &>(plan).GetExpressions()[col_idx];
+      const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+      return column_value_expr == nullptr ? nullptr
+                                          : ColumnStatisticsOf(*plan.GetChildAt(0), column_value_expr->GetColIdx());
+    }
+    case PlanType::Aggregation:
+    case PlanType::StreamAggregation: {
+      const auto &group_bys = dynamic_cast<const AggregationPlanNode &>(plan).GetGroupBys();
+      if (col_idx >= group_bys.size()) {
+        return nullptr;
+      }
+      const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(group_bys[col_idx].get());
+      return column_value_expr == nullptr ? nullptr
+                                          : ColumnStatisticsOf(*plan.GetChildAt(0), column_value_expr->GetColIdx());
+    }
+    case PlanType::NestedLoopJoin:
+    case PlanType::HashJoin:
+    case PlanType::MergeJoin: {
+      auto left_column_cnt = plan.GetChildAt(0)->OutputSchema().GetColumnCount();
+      return col_idx < left_column_cnt ? ColumnStatisticsOf(*plan.GetChildAt(0), col_idx)
+                                       : ColumnStatisticsOf(*plan.GetChildAt(1), col_idx - left_column_cnt);
+    }
+    default:
+      return nullptr;
+  }
+}
+
+auto Optimizer::EstimateSelectivity(const AbstractExpression &expr, const std::vector<const AbstractPlanNode *> &inputs)
+    -> double {
+  auto column_stats = [&](const ColumnValueExpression &column_value_expr) -> const ColumnStatistics * {
+    if (column_value_expr.GetTupleIdx() >= inputs.size()) {
+      return nullptr;
+    }
+    return ColumnStatisticsOf(*inputs[column_value_expr.GetTupleIdx()], column_value_expr.GetColIdx());
+  };
+
+  if (const auto *const_expr = dynamic_cast<const ConstantValueExpression *>(&expr); const_expr != nullptr) {
+    return IsPredicateTrue(expr) ? 1 : 0;
+  }
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(&expr); logic_expr != nullptr) {
+    auto left = EstimateSelectivity(*logic_expr->GetChildAt(0), inputs);
+    auto right = EstimateSelectivity(*logic_expr->GetChildAt(1), inputs);
+    // Assume the operands to be independent.
+    return logic_expr->logic_type_ == LogicType::And ? left * right : left + right - left * right;
+  }
+  const auto *comp_expr = dynamic_cast<const ComparisonExpression *>(&expr);
+  if (comp_expr == nullptr) {
+    return DEFAULT_SELECTIVITY;
+  }
+
+  const auto *left_column = dynamic_cast<const ColumnValueExpression *>(comp_expr->GetChildAt(0).get());
+  const auto *right_column = dynamic_cast<const ColumnValueExpression *>(comp_expr->GetChildAt(1).get());
+  const auto *left_const = dynamic_cast<const ConstantValueExpression *>(comp_expr->GetChildAt(0).get());
+  const auto *right_const = dynamic_cast<const ConstantValueExpression *>(comp_expr->GetChildAt(1).get());
+
+  if (left_column != nullptr && right_column != nullptr) {
+    const auto *left_stats = column_stats(*left_column);
+    const auto *right_stats = column_stats(*right_column);
+    if (comp_expr->comp_type_ != ComparisonType::Equal || (left_stats == nullptr && right_stats == nullptr)) {
+      return DefaultSelectivity(comp_expr->comp_type_);
+    }
+    // Containment of value sets: every value of the side with fewer distinct values finds a match on the other side.
+    double distinct = 1;
+    double non_null = 1;
+    for (const auto *stats : {left_stats, right_stats}) {
+      if (stats != nullptr) {
+        distinct = std::max(distinct, static_cast<double>(stats->GetDistinctCount()));
+        non_null *= 1 - stats->GetNullFraction();
+      }
+    }
+    return non_null / distinct;
+  }
+  if (left_column != nullptr && right_const != nullptr) {
+    return ColumnConstantSelectivity(column_stats(*left_column), comp_expr->comp_type_, right_const->val_);
+  }
+  if (left_const != nullptr && right_column != nullptr) {
+    return ColumnConstantSelectivity(column_stats(*right_column), FlipComparison(comp_expr->comp_type_),
+                                     left_const->val_);
+  }
+  return DefaultSelectivity(comp_expr->comp_type_);
+}
+
+auto Optimizer::EstimateCardinality(const AbstractPlanNode &plan) -> double {
+  double cardinality = DEFAULT_TABLE_CARDINALITY;
+  switch (plan.GetType()) {
+    case PlanType::SeqScan:
+    case PlanType::MockScan:
+    case PlanType::IndexScan: {
+      const auto *table = ScannedTable(plan);
+      const auto *stats = table == nullptr ? nullptr : catalog_.GetTableStatistics(table->oid_);
+      if (stats != nullptr) {
+        cardinality = static_cast<double>(stats->row_count_);
+      } else if (auto estimated = table == nullptr ? std::nullopt : EstimatedCardinality(table->name_);
+                 estimated.has_value()) {
+        cardinality = static_cast<double>(*estimated);
+      }
+      if (plan.GetType() == PlanType::SeqScan) {
+        const auto &filter_predicate = dynamic_cast<const SeqScanPlanNode &>(plan).filter_predicate_;
+        if (filter_predicate != nullptr) {
+          cardinality *= EstimateSelectivity(*filter_predicate, {&plan});
+        }
+      }
+      if (plan.GetType() == PlanType::IndexScan) {
+        if (auto limit = dynamic_cast<const IndexScanPlanNode &>(plan).GetLimit(); limit.has_value()) {
+          cardinality = std::min(cardinality, static_cast<double>(*limit));
+        }
+      }
+      break;
+    }
+    case PlanType::Filter: {
+      const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(plan);
+      cardinality = EstimateCardinality(*plan.GetChildAt(0)) *
+                    EstimateSelectivity(*filter_plan.GetPredicate(), {plan.GetChildAt(0).get()});
+      break;
+    }
+    case PlanType::Projection:
+    case PlanType::Sort:
+      cardinality = EstimateCardinality(*plan.GetChildAt(0));
+      break;
+    case PlanType::Limit:
+      cardinality = std::min(EstimateCardinality(*plan.GetChildAt(0)),
+                             static_cast<double>(dynamic_cast<const LimitPlanNode &>(plan).GetLimit()));
+      break;
+    case PlanType::TopN:
+      cardinality = std::min(EstimateCardinality(*plan.GetChildAt(0)),
+                             static_cast<double>(dynamic_cast<const TopNPlanNode &>(plan).GetN()));
+      break;
+    case PlanType::Aggregation:
+    case PlanType::StreamAggregation: {
+      const auto &group_bys = dynamic_cast<const AggregationPlanNode &>(plan).GetGroupBys();
+      auto child_cardinality = EstimateCardinality(*plan.GetChildAt(0));
+      if (group_bys.empty()) {
+        cardinality = 1;
+        break;
+      }
+      // At most one group per combination of distinct group-by values, and never more groups than input rows.
+      cardinality = 1;
+      for (const auto &group_by : group_bys) {
+        const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(group_by.get());
+        const auto *stats = column_value_expr == nullptr
+                                ? nullptr
+                                : ColumnStatisticsOf(*plan.GetChildAt(0), column_value_expr->GetColIdx());
+        cardinality *= stats == nullptr ? child_cardinality : static_cast<double>(stats->GetDistinctCount() + 1);
+        cardinality = std::min(cardinality, child_cardinality);
+      }
+      break;
+    }
+    case PlanType::NestedLoopJoin: {
+      const auto &nlj_plan = dynamic_cast<const NestedLoopJoinPlanNode &>(plan);
+      auto left = EstimateCardinality(*nlj_plan.GetLeftPlan());
+      auto right = EstimateCardinality(*nlj_plan.GetRightPlan());
+      cardinality =
+          left * right *
+          EstimateSelectivity(nlj_plan.Predicate(), {nlj_plan.GetLeftPlan().get(), nlj_plan.GetRightPlan().get()});
+      if (nlj_plan.GetJoinType() == JoinType::LEFT) {
+        cardinality = std::max(cardinality, left);
+      }
+      break;
+    }
+    case PlanType::HashJoin:
+    case PlanType::MergeJoin: {
+      const auto &hash_join_plan = dynamic_cast<const HashJoinPlanNode &>(plan);
+      auto left = EstimateCardinality(*hash_join_plan.GetLeftPlan());
+      auto right = EstimateCardinality(*hash_join_plan.GetRightPlan());
+      // Both keys are evaluated against their own side, so rebase the right key onto the second input.
+      const auto *left_key = dynamic_cast<const ColumnValueExpression *>(&hash_join_plan.LeftJoinKeyExpression());
+      const auto *right_key = dynamic_cast<const ColumnValueExpression *>(&hash_join_plan.RightJoinKeyExpression());
+      double selectivity = DEFAULT_EQUAL_SELECTIVITY;
+      if (left_key != nullptr && right_key != nullptr) {
+        ComparisonExpression key_equal(
+            std::make_shared<ColumnValueExpression>(0, left_key->GetColIdx(), left_key->GetReturnType()),
+            std::make_shared<ColumnValueExpression>(1, right_key->GetColIdx(), right_key->GetReturnType()),
+            ComparisonType::Equal);
+        selectivity =
+            EstimateSelectivity(key_equal, {hash_join_plan.GetLeftPlan().get(), hash_join_plan.GetRightPlan().get()});
+      }
+      cardinality = left * right * selectivity;
+      if (hash_join_plan.GetJoinType() == JoinType::LEFT) {
+        cardinality = std::max(cardinality, left);
+      }
+      break;
+    }
+    case PlanType::NestedIndexJoin:
+      cardinality = EstimateCardinality(*plan.GetChildAt(0));
+      break;
+    case PlanType::Values:
+      cardinality = static_cast<double>(dynamic_cast<const ValuesPlanNode &>(plan).GetValues().size());
+      break;
+    case PlanType::Insert:
+    case PlanType::Update:
+    case PlanType::Delete:
+      cardinality = 1;
+      break;
+  }
+  return std::max(cardinality, 1.0);
+}
+
+}  // namespace bustub
@@ -0,0 +1,179 @@
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/exception.h"
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/topn_plan.h"
+#include "execution/plans/update_plan.h"
+#include "execution/plans/values_plan.h"
+#include "optimizer/optimizer.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the constant `expr` is, or nullptr if it is not a constant */
+auto AsConstant(const AbstractExpressionRef &expr) -> const Value * {
+  const auto *constant_expr = dynamic_cast<const ConstantValueExpression *>(expr.get());
+  return constant_expr != nullptr ? &constant_expr->val_ : nullptr;
+}
+
+/** @return whether `expr` is the boolean constant `value` */
+auto IsBooleanConstant(const AbstractExpressionRef &expr, bool value) -> bool {
+  const auto *constant = AsConstant(expr);
+  return constant != nullptr && constant->GetTypeId() == TypeId::BOOLEAN && !constant->IsNull() &&
+         constant->GetAs<bool>() == value;
+}
+
+/**
+ * Simplify an AND or OR with a non-NULL boolean constant operand: `x AND true` and `x OR false` are `x`, `x AND false`
+ * is false and `x OR true` is true, whatever `x` evaluates to, NULL included.
+ * @return the simplified expression, or nullptr if neither operand is such a constant
+ */
+auto SimplifyLogic(const LogicExpression &logic_expr) -> AbstractExpressionRef {
+  const bool is_and = logic_expr.logic_type_ == LogicType::And;
+  for (size_t i = 0; i < 2; i++) {
+    const auto &operand = logic_expr.GetChildAt(i);
+    const auto &other = logic_expr.GetChildAt(1 - i);
+    if (IsBooleanConstant(operand, is_and)) {
+      return other;
+    }
+    if (IsBooleanConstant(operand, !is_and)) {
+      return operand;
+    }
+  }
+  return nullptr;
+}
+
+/**
+ * Fold an expression bottom-up: arithmetic and comparisons whose operands are constants are computed once here rather
+ * than once per tuple, so are those with a NULL constant operand, which are NULL whatever the other operand is, and
+ * logic expressions are simplified with `SimplifyLogic`. Parameters are left alone, as they are only bound at execution.
+ */
+auto FoldExpression(const AbstractExpressionRef &expr) -> AbstractExpressionRef {
+  if (expr->GetChildren().empty()) {
+    return expr;
+  }
+  std::vector<AbstractExpressionRef> children;
+  bool all_constant = true;
+  bool any_null = false;
+  for (const auto &child : expr->GetChildren()) {
+    children.emplace_back(FoldExpression(child));
+    const auto *constant = AsConstant(children.back());
+    all_constant = all_constant && constant != nullptr;
+    any_null = any_null || (constant != nullptr && constant->IsNull());
+  }
+  auto folded = expr->CloneWithChildren(std::move(children));
+
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(folded.get()); logic_expr != nullptr) {
+    if (auto simplified = SimplifyLogic(*logic_expr); simplified != nullptr) {
+      return simplified;
+    }
+  } else if (dynamic_cast<const ArithmeticExpression *>(folded.get()) == nullptr &&
+             dynamic_cast<const ComparisonExpression *>(folded.get()) == nullptr) {
+    return folded;
+  } else if (any_null) {
+    return std::make_shared<ConstantValueExpression>(ValueFactory::GetNullValueByType(folded->GetReturnType()));
+  }
+  if (!all_constant) {
+    return folded;
+  }
+  try {
+    // Constants do not read the tuple.
+    return std::make_shared<ConstantValueExpression>(folded->Evaluate(nullptr, Schema(std::vector<Column>{})));
+  } catch (const Exception &e) {
+    // Leave the error to be raised at execution, if the expression is ever evaluated.
+    return folded;
+  }
+}
+
+/** Fold every expression of a list in place. */
+void FoldExpressions(std::vector<AbstractExpressionRef> *exprs) {
+  for (auto &expr : *exprs) {
+    expr = FoldExpression(expr);
+  }
+}
+
+/** Fold the expressions of ORDER BY clauses in place. */
+void FoldOrderBys(std::vector<std::pair<OrderByType, AbstractExpressionRef>> *order_bys) {
+  for (auto &[order_by_type, expr] : *order_bys) {
+    expr = FoldExpression(expr);
+  }
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeFoldExpressions(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeFoldExpressions(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  switch (optimized_plan->GetType()) {
+    case PlanType::Filter: {
+      auto &filter_plan = dynamic_cast<FilterPlanNode &>(*optimized_plan);
+      filter_plan.predicate_ = FoldExpression(filter_plan.predicate_);
+      // A filter that is never true produces nothing.
+      const auto *constant = AsConstant(filter_plan.predicate_);
+      if (constant != nullptr && (constant->IsNull() || IsBooleanConstant(filter_plan.predicate_, false))) {
+        return std::make_shared<ValuesPlanNode>(filter_plan.output_schema_,
+                                                std::vector<std::vector<AbstractExpressionRef>>{});
+      }
+      break;
+    }
+    case PlanType::SeqScan: {
+      auto &seq_scan_plan = dynamic_cast<SeqScanPlanNode &>(*optimized_plan);
+      if (seq_scan_plan.filter_predicate_ != nullptr) {
+        seq_scan_plan.filter_predicate_ = FoldExpression(seq_scan_plan.filter_predicate_);
+      }
+      break;
+    }
+    case PlanType::Projection:
+      FoldExpressions(&dynamic_cast<ProjectionPlanNode &>(*optimized_plan).expressions_);
+      break;
+    case PlanType::NestedLoopJoin: {
+      auto &nlj_plan = dynamic_cast<NestedLoopJoinPlanNode &>(*optimized_plan);
+      nlj_plan.predicate_ = FoldExpression(nlj_plan.predicate_);
+      break;
+    }
+    case PlanType::Aggregation: {
+      auto &agg_plan = dynamic_cast<AggregationPlanNode &>(*optimized_plan);
+      FoldExpressions(&agg_plan.group_bys_);
+      FoldExpressions(&agg_plan.aggregates_);
+      break;
+    }
+    case PlanType::Sort:
+      FoldOrderBys(&dynamic_cast<SortPlanNode &>(*optimized_plan).order_bys_);
+      break;
+    case PlanType::TopN:
+      FoldOrderBys(&dynamic_cast<TopNPlanNode &>(*optimized_plan).order_bys_);
+      break;
+    case PlanType::Values:
+      for (auto &row : dynamic_cast<ValuesPlanNode &>(*optimized_plan).values_) {
+        FoldExpressions(&row);
+      }
+      break;
+    case PlanType::Update:
+      FoldExpressions(&dynamic_cast<UpdatePlanNode &>(*optimized_plan).target_expressions_);
+      break;
+    default:
+      break;
+  }
+  return optimized_plan;
+}
+
+}  // namespace bustub
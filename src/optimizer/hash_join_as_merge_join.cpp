@@ -0,0 +1,48 @@
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/merge_join_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return whether the leading ascending column of `ordered_columns` is the column that `key_expr` reads */
+auto IsOrderedOn(const std::vector<uint32_t> &ordered_columns, const AbstractExpression &key_expr) -> bool {
+  const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(&key_expr);
+  return column_value_expr != nullptr && !ordered_columns.empty() &&
+         ordered_columns[0] == column_value_expr->GetColIdx();
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeHashJoinAsMergeJoin(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  std::vector<AbstractPlanNodeRef> children;
+  for (const auto &child : plan->GetChildren()) {
+    children.emplace_back(OptimizeHashJoinAsMergeJoin(child));
+  }
+  auto optimized_plan = plan->CloneWithChildren(std::move(children));
+
+  if (optimized_plan->GetType() != PlanType::HashJoin) {
+    return optimized_plan;
+  }
+  const auto &hash_join_plan = dynamic_cast<const HashJoinPlanNode &>(*optimized_plan);
+  if (hash_join_plan.GetJoinType() != JoinType::INNER && hash_join_plan.GetJoinType() != JoinType::LEFT) {
+    return optimized_plan;
+  }
+  // Both children are already optimized, so an order below them has been turned into a sort, an index scan or a merge
+  // join by now.
+  if (!IsOrderedOn(OrderedOutputColumns(hash_join_plan.GetLeftPlan(), true), hash_join_plan.LeftJoinKeyExpression()) ||
+      !IsOrderedOn(OrderedOutputColumns(hash_join_plan.GetRightPlan(), true),
+                   hash_join_plan.RightJoinKeyExpression())) {
+    return optimized_plan;
+  }
+  return std::make_shared<MergeJoinPlanNode>(hash_join_plan);
+}
+
+}  // namespace bustub
@@ -0,0 +1,443 @@
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "optimizer/optimizer.h"
+
+namespace bustub {
+
+namespace {
+
+/** A column of one of the relations of a join graph: (relation index, column index within the relation). */
+using RelationColumn = std::pair<uint32_t, uint32_t>;
+
+/** The join graph of a tree of inner nested loop joins. */
+struct JoinGraph {
+  /** The relations being joined, in their original left-to-right order */
+  std::vector<AbstractPlanNodeRef> relations_;
+  /** The conjuncts of all join predicates, with `#i.j` referring to column j of relations_[i] */
+  std::vector<AbstractExpressionRef> conjuncts_;
+};
+
+/** A plan for a subset of the relations of a join graph. */
+struct JoinPlan {
+  AbstractPlanNodeRef plan_;
+  /** The output columns of the plan */
+  std::vector<RelationColumn> columns_;
+  double cardinality_;
+  double cost_;
+};
+
+/** @return the expression with every column reference `#t.c` replaced by `rewrite(t, c)` */
+template <typename F>
+auto RewriteColumns(const AbstractExpressionRef &expr, F &&rewrite) -> AbstractExpressionRef {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+      column_value_expr != nullptr) {
+    auto [tuple_idx, col_idx] = rewrite(column_value_expr->GetTupleIdx(), column_value_expr->GetColIdx());
+    return std::make_shared<ColumnValueExpression>(tuple_idx, col_idx, column_value_expr->GetReturnType());
+  }
+  std::vector<AbstractExpressionRef> children;
+  for (const auto &child : expr->GetChildren()) {
+    children.emplace_back(RewriteColumns(child, rewrite));
+  }
+  return expr->CloneWithChildren(std::move(children));
+}
+
+/** @return the bitmask of the relations an expression over a join graph refers to */
+auto RelationsOf(const AbstractExpression &expr) -> uint64_t {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(&expr);
+      column_value_expr != nullptr) {
+    return uint64_t{1} << column_value_expr->GetTupleIdx();
+  }
+  uint64_t relations = 0;
+  for (const auto &child : expr.GetChildren()) {
+    relations |= RelationsOf(*child);
+  }
+  return relations;
+}
+
+auto PositionOf(const std::vector<RelationColumn> &columns, RelationColumn column) -> uint32_t {
+  auto it = std::find(columns.begin(), columns.end(), column);
+  BUSTUB_ENSURE(it != columns.end(), "column not produced by the join plan");
+  return static_cast<uint32_t>(it - columns.begin());
+}
+
+/** @return the two columns of a `column = column` conjunct, if it is one */
+auto EquatedColumns(const AbstractExpression &expr) -> std::optional<std::pair<RelationColumn, RelationColumn>> {
+  const auto *comp_expr = dynamic_cast<const ComparisonExpression *>(&expr);
+  if (comp_expr == nullptr || comp_expr->comp_type_ != ComparisonType::Equal) {
+    return std::nullopt;
+  }
+  const auto *lhs = dynamic_cast<const ColumnValueExpression *>(comp_expr->GetChildAt(0).get());
+  const auto *rhs = dynamic_cast<const ColumnValueExpression *>(comp_expr->GetChildAt(1).get());
+  if (lhs == nullptr || rhs == nullptr) {
+    return std::nullopt;
+  }
+  return std::make_pair(RelationColumn{lhs->GetTupleIdx(), lhs->GetColIdx()},
+                        RelationColumn{rhs->GetTupleIdx(), rhs->GetColIdx()});
+}
+
+/** @return the columns an expression refers to */
+void CollectColumns(const AbstractExpression &expr, std::vector<RelationColumn> *columns) {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(&expr);
+      column_value_expr != nullptr) {
+    RelationColumn column{column_value_expr->GetTupleIdx(), column_value_expr->GetColIdx()};
+    if (std::find(columns->begin(), columns->end(), column) == columns->end()) {
+      columns->push_back(column);
+    }
+    return;
+  }
+  for (const auto &child : expr.GetChildren()) {
+    CollectColumns(*child, columns);
+  }
+}
+
+/**
+ * Flatten a tree of inner nested loop joins into its relations and join conjuncts.
+ * @return the output columns of `plan`
+ */
+template <typename SplitFn>
+auto FlattenJoinTree(const AbstractPlanNodeRef &plan, JoinGraph *graph, SplitFn &&split)
+    -> std::vector<RelationColumn> {
+  if (plan->GetType() != PlanType::NestedLoopJoin ||
+      dynamic_cast<const NestedLoopJoinPlanNode &>(*plan).GetJoinType() != JoinType::INNER) {
+    auto relation = static_cast<uint32_t>(graph->relations_.size());
+    graph->relations_.push_back(plan);
+    std::vector<RelationColumn> columns;
+    for (uint32_t i = 0; i < plan->OutputSchema().GetColumnCount(); i++) {
+      columns.emplace_back(relation, i);
+    }
+    return columns;
+  }
+  const auto &nlj_plan = dynamic_cast<const NestedLoopJoinPlanNode &>(*plan);
+  auto left_columns = FlattenJoinTree(nlj_plan.GetLeftPlan(), graph, split);
+  auto right_columns = FlattenJoinTree(nlj_plan.GetRightPlan(), graph, split);
+  auto conjuncts = split(nlj_plan.predicate_);
+  for (const auto &conjunct : conjuncts) {
+    graph->conjuncts_.push_back(RewriteColumns(conjunct, [&](uint32_t tuple_idx, uint32_t col_idx) {
+      const auto &columns = tuple_idx == 0 ? left_columns : right_columns;
+      return columns[col_idx];
+    }));
+  }
+  left_columns.insert(left_columns.end(), right_columns.begin(), right_columns.end());
+  return left_columns;
+}
+
+}  // namespace
+
+auto Optimizer::OptimizeJoinOrder(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  if (plan->GetType() != PlanType::NestedLoopJoin ||
+      dynamic_cast<const NestedLoopJoinPlanNode &>(*plan).GetJoinType() != JoinType::INNER) {
+    std::vector<AbstractPlanNodeRef> children;
+    for (const auto &child : plan->GetChildren()) {
+      children.emplace_back(OptimizeJoinOrder(child));
+    }
+    return plan->CloneWithChildren(std::move(children));
+  }
+
+  JoinGraph graph;
+  auto output_columns = FlattenJoinTree(plan, &graph, [this](const AbstractExpressionRef &predicate) {
+    std::vector<AbstractExpressionRef> conjuncts;
+    SplitConjuncts(predicate, &conjuncts);
+    return conjuncts;
+  });
+  auto relation_cnt = graph.relations_.size();
+  if (relation_cnt > JOIN_ORDER_MAX_RELATIONS) {
+    std::vector<AbstractPlanNodeRef> children;
+    for (const auto &child : plan->GetChildren()) {
+      children.emplace_back(OptimizeJoinOrder(child));
+    }
+    return plan->CloneWithChildren(std::move(children));
+  }
+  for (auto &relation : graph.relations_) {
+    relation = OptimizeJoinOrder(relation);
+  }
+
+  // Conjuncts over a single relation are applied right above it; the others become join conditions. Conjuncts that
+  // refer to no relation at all are kept on top. Equi-join conditions are collected into classes of equal columns
+  // instead, so that equalities implied by transitivity can serve as join conditions too: with `a.x = b.x` and
+  // `b.x = c.x`, a and c can be joined directly on `a.x = c.x`.
+  std::vector<std::pair<uint32_t, AbstractExpressionRef>> single_conjuncts;
+  std::vector<std::pair<uint64_t, AbstractExpressionRef>> join_conjuncts;
+  std::vector<AbstractExpressionRef> constant_conjuncts;
+  std::vector<std::vector<RelationColumn>> classes;
+  auto class_of = [&](RelationColumn column) -> std::optional<size_t> {
+    for (size_t i = 0; i < classes.size(); i++) {
+      if (std::find(classes[i].begin(), classes[i].end(), column) != classes[i].end()) {
+        return i;
+      }
+    }
+    return std::nullopt;
+  };
+  for (const auto &conjunct : graph.conjuncts_) {
+    auto relations = RelationsOf(*conjunct);
+    if (relations == 0) {
+      constant_conjuncts.push_back(conjunct);
+    } else if ((relations & (relations - 1)) == 0) {
+      single_conjuncts.emplace_back(static_cast<uint32_t>(__builtin_ctzll(relations)), conjunct);
+    } else if (auto equated = EquatedColumns(*conjunct); equated.has_value()) {
+      auto [lhs, rhs] = *equated;
+      auto lhs_class = class_of(lhs);
+      auto rhs_class = class_of(rhs);
+      if (!lhs_class.has_value() && !rhs_class.has_value()) {
+        classes.push_back({lhs, rhs});
+      } else if (!rhs_class.has_value()) {
+        classes[*lhs_class].push_back(rhs);
+      } else if (!lhs_class.has_value()) {
+        classes[*rhs_class].push_back(lhs);
+      } else if (*lhs_class != *rhs_class) {
+        classes[*lhs_class].insert(classes[*lhs_class].end(), classes[*rhs_class].begin(), classes[*rhs_class].end());
+        classes.erase(classes.begin() + static_cast<std::ptrdiff_t>(*rhs_class));
+      }
+    } else {
+      join_conjuncts.emplace_back(relations, conjunct);
+    }
+  }
+
+  // A filter on one column of a class holds for every other column of the class as well: with `a.x = b.x` and
+  // `a.x < 10`, b can be filtered on `b.x < 10` before the join.
+  std::vector<std::vector<AbstractExpressionRef>> relation_conjuncts(relation_cnt);
+  std::vector<std::vector<std::string>> relation_conjunct_strings(relation_cnt);
+  auto add_relation_conjunct = [&](uint32_t relation, const AbstractExpressionRef &conjunct) {
+    auto rewritten = RewriteColumns(
+        conjunct, [](uint32_t /* tuple_idx */, uint32_t col_idx) { return RelationColumn{0, col_idx}; });
+    auto str = rewritten->ToString();
+    auto &strings = relation_conjunct_strings[relation];
+    if (std::find(strings.begin(), strings.end(), str) == strings.end()) {
+      strings.push_back(std::move(str));
+      relation_conjuncts[relation].push_back(std::move(rewritten));
+    }
+  };
+  for (const auto &[relation, conjunct] : single_conjuncts) {
+    add_relation_conjunct(relation, conjunct);
+    std::vector<RelationColumn> columns;
+    CollectColumns(*conjunct, &columns);
+    auto column_class = columns.size() == 1 ? class_of(columns[0]) : std::nullopt;
+    if (!column_class.has_value()) {
+      continue;
+    }
+    for (const auto &member : classes[*column_class]) {
+      if (member != columns[0]) {
+        add_relation_conjunct(member.first, RewriteColumns(conjunct, [&](uint32_t /* tuple_idx */,
+                                                                           uint32_t /* col_idx */) { return member; }));
+      }
+    }
+  }
+
+  // The joins only check one equality of a class across their two sides, so the columns of a class that belong to the
+  // same relation are equated right above it: with `a.x = b.x` and `b.x = a.y`, a is filtered on `a.x = a.y`.
+  for (const auto &members : classes) {
+    for (auto it = members.begin(); it != members.end(); ++it) {
+      auto next = std::find_if(std::next(it), members.end(),
+                               [&](const RelationColumn &column) { return column.first == it->first; });
+      if (next == members.end()) {
+        continue;
+      }
+      const auto &schema = graph.relations_[it->first]->OutputSchema();
+      add_relation_conjunct(
+          it->first,
+          std::make_shared<ComparisonExpression>(
+              std::make_shared<ColumnValueExpression>(it->first, it->second, schema.GetColumn(it->second).GetType()),
+              std::make_shared<ColumnValueExpression>(next->first, next->second,
+                                                      schema.GetColumn(next->second).GetType()),
+              ComparisonType::Equal));
+    }
+  }
+
+  std::vector<const AbstractPlanNode *> relation_plans;
+  std::vector<std::optional<JoinPlan>> best(uint64_t{1} << relation_cnt);
+  for (uint32_t i = 0; i < relation_cnt; i++) {
+    auto relation = graph.relations_[i];
+    if (!relation_conjuncts[i].empty()) {
+      relation = OptimizePredicatePushdown(std::make_shared<FilterPlanNode>(
+          relation->output_schema_, CombineConjuncts(relation_conjuncts[i]), relation));
+    }
+    graph.relations_[i] = relation;
+    relation_plans.push_back(relation.get());
+    std::vector<RelationColumn> columns;
+    for (uint32_t col = 0; col < relation->OutputSchema().GetColumnCount(); col++) {
+      columns.emplace_back(i, col);
+    }
+    best[uint64_t{1} << i] = JoinPlan{relation, std::move(columns), EstimateCardinality(*relation), 0};
+  }
+
+  // @return one equality of a class between a column in `left_set` and one in `right_set`, if the class spans both
+  auto class_equality = [&](const std::vector<RelationColumn> &members, uint64_t left_set,
+                            uint64_t right_set) -> AbstractExpressionRef {
+    auto in = [&](uint64_t set) {
+      return std::find_if(members.begin(), members.end(),
+                          [&](const RelationColumn &column) { return (set >> column.first & 1) != 0; });
+    };
+    auto left_member = in(left_set);
+    auto right_member = in(right_set);
+    if (left_member == members.end() || right_member == members.end()) {
+      return nullptr;
+    }
+    auto column_expr = [&](RelationColumn column) {
+      const auto &type = graph.relations_[column.first]->OutputSchema().GetColumn(column.second).GetType();
+      return std::make_shared<ColumnValueExpression>(column.first, column.second, type);
+    };
+    return std::make_shared<ComparisonExpression>(column_expr(*left_member), column_expr(*right_member),
+                                                  ComparisonType::Equal);
+  };
+
+  // Join `left` (probe side) with `right` (build side), applying every join conjunct that the pair covers.
+  auto join = [&](const JoinPlan &left, uint64_t left_set, const JoinPlan &right, uint64_t right_set) -> JoinPlan {
+    auto set = left_set | right_set;
+    std::vector<AbstractExpressionRef> conjuncts;
+    double selectivity = 1;
+    // Both sides already enforce the equalities among their own columns of a class, so one equality across suffices.
+    for (const auto &members : classes) {
+      if (auto conjunct = class_equality(members, left_set, right_set); conjunct != nullptr) {
+        conjuncts.push_back(conjunct);
+        selectivity *= EstimateSelectivity(*conjunct, relation_plans);
+      }
+    }
+    for (const auto &[relations, conjunct] : join_conjuncts) {
+      if ((relations & set) == relations && (relations & left_set) != 0 && (relations & right_set) != 0) {
+        conjuncts.push_back(conjunct);
+        selectivity *= EstimateSelectivity(*conjunct, relation_plans);
+      }
+    }
+    auto columns = left.columns_;
+    columns.insert(columns.end(), right.columns_.begin(), right.columns_.end());
+    auto schema = std::make_shared<Schema>(NestedLoopJoinPlanNode::InferJoinSchema(*left.plan_, *right.plan_));
+    auto cardinality = std::max(1.0, left.cardinality_ * right.cardinality_ * selectivity);
+
+    // Pick the most selective `left column = right column` conjunct as the hash key.
+    std::optional<size_t> key;
+    double key_selectivity = 1;
+    for (size_t i = 0; i < conjuncts.size(); i++) {
+      const auto *comp_expr = dynamic_cast<const ComparisonExpression *>(conjuncts[i].get());
+      if (comp_expr == nullptr || comp_expr->comp_type_ != ComparisonType::Equal) {
+        continue;
+      }
+      const auto *lhs = dynamic_cast<const ColumnValueExpression *>(comp_expr->GetChildAt(0).get());
+      const auto *rhs = dynamic_cast<const ColumnValueExpression *>(comp_expr->GetChildAt(1).get());
+      if (lhs == nullptr || rhs == nullptr) {
+        continue;
+      }
+      if (auto conjunct_selectivity = EstimateSelectivity(*comp_expr, relation_plans);
+          !key.has_value() || conjunct_selectivity < key_selectivity) {
+        key = i;
+        key_selectivity = conjunct_selectivity;
+      }
+    }
+
+    if (!key.has_value()) {
+      auto predicate = RewriteColumns(CombineConjuncts(conjuncts), [&](uint32_t tuple_idx, uint32_t col_idx) {
+        RelationColumn column{tuple_idx, col_idx};
+        if ((left_set >> tuple_idx & 1) != 0) {
+          return RelationColumn{0, PositionOf(left.columns_, column)};
+        }
+        return RelationColumn{1, PositionOf(right.columns_, column)};
+      });
+      auto plan = std::make_shared<NestedLoopJoinPlanNode>(std::move(schema), left.plan_, right.plan_,
+                                                           std::move(predicate), JoinType::INNER);
+      // The right side is rescanned for every left tuple.
+      auto cost = left.cost_ + left.cardinality_ * (right.cost_ + right.cardinality_);
+      return JoinPlan{std::move(plan), std::move(columns), cardinality, cost};
+    }
+
+    // Both hash keys are evaluated against a tuple of their own side.
+    const auto &key_expr = dynamic_cast<const ComparisonExpression &>(*conjuncts[*key]);
+    AbstractExpressionRef left_key;
+    AbstractExpressionRef right_key;
+    for (const auto &operand : key_expr.GetChildren()) {
+      const auto &column_value_expr = dynamic_cast<const ColumnValueExpression &>(*operand);
+      RelationColumn column{column_value_expr.GetTupleIdx(), column_value_expr.GetColIdx()};
+      if ((left_set >> column.first & 1) != 0) {
+        left_key = std::make_shared<ColumnValueExpression>(0, PositionOf(left.columns_, column),
+                                                           column_value_expr.GetReturnType());
+      } else {
+        right_key = std::make_shared<ColumnValueExpression>(0, PositionOf(right.columns_, column),
+                                                            column_value_expr.GetReturnType());
+      }
+    }
+    AbstractPlanNodeRef plan = std::make_shared<HashJoinPlanNode>(schema, left.plan_, right.plan_, std::move(left_key),
+                                                                  std::move(right_key), JoinType::INNER);
+    conjuncts.erase(conjuncts.begin() + static_cast<std::ptrdiff_t>(*key));
+    if (!conjuncts.empty()) {
+      auto predicate = RewriteColumns(CombineConjuncts(conjuncts), [&](uint32_t tuple_idx, uint32_t col_idx) {
+        return RelationColumn{0, PositionOf(columns, {tuple_idx, col_idx})};
+      });
+      plan = std::make_shared<FilterPlanNode>(schema, std::move(predicate), std::move(plan));
+    }
+    // Building the hash table costs more per tuple than probing it.
+    auto cost = left.cost_ + right.cost_ + left.cardinality_ + 2 * right.cardinality_ + cardinality;
+    return JoinPlan{std::move(plan), std::move(columns), cardinality, cost};
+  };
+
+  auto connected = [&](uint64_t left_set, uint64_t right_set) {
+    return std::any_of(classes.begin(), classes.end(),
+                       [&](const auto &members) { return class_equality(members, left_set, right_set) != nullptr; }) ||
+           std::any_of(join_conjuncts.begin(), join_conjuncts.end(), [&](const auto &join_conjunct) {
+             auto relations = join_conjunct.first;
+             return (relations & left_set) != 0 && (relations & right_set) != 0 &&
+                    (relations & ~(left_set | right_set)) == 0;
+           });
+  };
+
+  // Dynamic programming over subsets of relations, by increasing size. Cross products are only considered when the
+  // join graph is not connected.
+  auto full_set = (uint64_t{1} << relation_cnt) - 1;
+  for (bool allow_cross_products : {false, true}) {
+    for (size_t size = 2; size <= relation_cnt; size++) {
+      for (uint64_t set = 1; set <= full_set; set++) {
+        if (static_cast<size_t>(__builtin_popcountll(set)) != size) {
+          continue;
+        }
+        for (uint64_t left_set = (set - 1) & set; left_set != 0; left_set = (left_set - 1) & set) {
+          auto right_set = set & ~left_set;
+          if (!best[left_set].has_value() || !best[right_set].has_value()) {
+            continue;
+          }
+          if (!allow_cross_products && !connected(left_set, right_set)) {
+            continue;
+          }
+          auto candidate = join(*best[left_set], left_set, *best[right_set], right_set);
+          if (!best[set].has_value() || candidate.cost_ < best[set]->cost_) {
+            best[set] = std::move(candidate);
+          }
+        }
+      }
+    }
+    if (best[full_set].has_value()) {
+      break;
+    }
+  }
+
+  auto result = *best[full_set];
+  auto optimized_plan = result.plan_;
+  if (!constant_conjuncts.empty()) {
+    optimized_plan = std::make_shared<FilterPlanNode>(optimized_plan->output_schema_,
+                                                      CombineConjuncts(constant_conjuncts), optimized_plan);
+  }
+  if (result.columns_ != output_columns) {
+    // Restore the column order of the original join.
+    std::vector<AbstractExpressionRef> exprs;
+    for (uint32_t i = 0; i < output_columns.size(); i++) {
+      exprs.emplace_back(std::make_shared<ColumnValueExpression>(0, PositionOf(result.columns_, output_columns[i]),
+                                                                 plan->OutputSchema().GetColumn(i).GetType()));
+    }
+    return std::make_shared<ProjectionPlanNode>(plan->output_schema_, std::move(exprs), optimized_plan);
+  }
+  return optimized_plan;
+}
+
+}  // namespace bustub
@@ -38,7 +38,7 @@ auto Optimizer::RewriteExpressionForJoin(const AbstractExpressionRef &expr, size
 
 auto Optimizer::IsPredicateTrue(const AbstractExpression &expr) -> bool {
   if (const auto *const_expr = dynamic_cast<const ConstantValueExpression *>(&expr); const_expr != nullptr) {
-    return const_expr->val_.CastAs(TypeId::BOOLEAN).GetAs<bool>();
+    return !const_expr->val_.IsNull() && const_expr->val_.CastAs(TypeId::BOOLEAN).GetAs<bool>();
   }
   return false;
 }
@@ -10,11 +10,15 @@ namespace bustub {
 auto Optimizer::OptimizeCustom(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
   auto p = plan;
   p = OptimizeMergeProjection(p);
-  p = OptimizeMergeFilterNLJ(p);
+  p = OptimizeFoldExpressions(p);
+  p = OptimizePredicatePushdown(p);
+  p = OptimizeJoinOrder(p);
   p = OptimizeNLJAsIndexJoin(p);
-  // p = OptimizeNLJAsHashJoin(p);  // Enable this rule after you have implemented hash join.
+  p = OptimizeNLJAsHashJoin(p);
   p = OptimizeOrderByAsIndexScan(p);
   p = OptimizeSortLimitAsTopN(p);
+  p = OptimizeHashJoinAsMergeJoin(p);
+  p = OptimizeAggregationAsStreamAggregation(p);
   return p;
 }
 
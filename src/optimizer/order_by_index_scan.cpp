@@ -12,6 +12,7 @@
 #include "execution/plans/abstract_plan.h"
 #include "execution/plans/filter_plan.h"
 #include "execution/plans/index_scan_plan.h"
+#include "execution/plans/limit_plan.h"
 #include "execution/plans/nested_loop_join_plan.h"
 #include "execution/plans/projection_plan.h"
 #include "execution/plans/seq_scan_plan.h"
@@ -28,6 +29,18 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
   }
   auto optimized_plan = plan->CloneWithChildren(std::move(children));
 
+  if (optimized_plan->GetType() == PlanType::Limit) {
+    // The index scan produces the tuples in order, so it can stop after the first ones instead of scanning on for a
+    // limit to discard.
+    const auto &limit_plan = dynamic_cast<const LimitPlanNode &>(*optimized_plan);
+    const auto &child_plan = limit_plan.GetChildPlan();
+    if (child_plan->GetType() == PlanType::IndexScan) {
+      const auto &index_scan = dynamic_cast<const IndexScanPlanNode &>(*child_plan);
+      auto limit = std::min(limit_plan.GetLimit(), index_scan.GetLimit().value_or(limit_plan.GetLimit()));
+      return std::make_shared<IndexScanPlanNode>(index_scan.output_schema_, index_scan.GetIndexOid(), limit);
+    }
+  }
+
   if (optimized_plan->GetType() == PlanType::Sort) {
     const auto &sort_plan = dynamic_cast<const SortPlanNode &>(*optimized_plan);
     const auto &order_bys = sort_plan.GetOrderBy();
@@ -64,8 +77,13 @@ auto Optimizer::OptimizeOrderByAsIndexScan(const AbstractPlanNodeRef &plan) -> A
         const auto &columns = index->key_schema_.GetColumns();
         if (columns.size() == 1 &&
             columns[0].GetName() == table_info->schema_.GetColumn(order_by_column_id).GetName()) {
-          // Index matched, return index scan instead
-          return std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+          // Index matched, return index scan instead, filtered by the conjuncts pushed down into the scan if any
+          auto index_scan = std::make_shared<IndexScanPlanNode>(optimized_plan->output_schema_, index->index_oid_);
+          if (seq_scan.filter_predicate_ != nullptr) {
+            return std::make_shared<FilterPlanNode>(optimized_plan->output_schema_, seq_scan.filter_predicate_,
+                                                    index_scan);
+          }
+          return index_scan;
         }
       }
     }
@@ -0,0 +1,227 @@
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/macros.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/projection_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "optimizer/optimizer.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** Bits of the sides of a join an expression refers to. */
+constexpr uint8_t LEFT_SIDE = 1;
+constexpr uint8_t RIGHT_SIDE = 2;
+
+auto SidesOf(const AbstractExpression &expr) -> uint8_t {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(&expr);
+      column_value_expr != nullptr) {
+    return column_value_expr->GetTupleIdx() == 0 ? LEFT_SIDE : RIGHT_SIDE;
+  }
+  uint8_t sides = 0;
+  for (const auto &child : expr.GetChildren()) {
+    sides |= SidesOf(*child);
+  }
+  return sides;
+}
+
+/** @return whether every column the expression refers to is below `column_cnt`; false if it refers to none */
+auto OnlyReferencesColumnsBelow(const AbstractExpression &expr, uint32_t column_cnt, bool *has_column) -> bool {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(&expr);
+      column_value_expr != nullptr) {
+    *has_column = true;
+    return column_value_expr->GetColIdx() < column_cnt;
+  }
+  for (const auto &child : expr.GetChildren()) {
+    if (!OnlyReferencesColumnsBelow(*child, column_cnt, has_column)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** @return the expression with every column reference `#t.c` replaced by `exprs[c]` */
+auto SubstituteColumns(const AbstractExpressionRef &expr, const std::vector<AbstractExpressionRef> &exprs)
+    -> AbstractExpressionRef {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+      column_value_expr != nullptr) {
+    return exprs[column_value_expr->GetColIdx()];
+  }
+  std::vector<AbstractExpressionRef> children;
+  for (const auto &child : expr->GetChildren()) {
+    children.emplace_back(SubstituteColumns(child, exprs));
+  }
+  return expr->CloneWithChildren(std::move(children));
+}
+
+/** @return the expression with every column reference moved to tuple 0, to evaluate it against one join side */
+auto ToTupleZero(const AbstractExpressionRef &expr) -> AbstractExpressionRef {
+  if (const auto *column_value_expr = dynamic_cast<const ColumnValueExpression *>(expr.get());
+      column_value_expr != nullptr) {
+    return std::make_shared<ColumnValueExpression>(0, column_value_expr->GetColIdx(),
+                                                   column_value_expr->GetReturnType());
+  }
+  std::vector<AbstractExpressionRef> children;
+  for (const auto &child : expr->GetChildren()) {
+    children.emplace_back(ToTupleZero(child));
+  }
+  return expr->CloneWithChildren(std::move(children));
+}
+
+}  // namespace
+
+void Optimizer::SplitConjuncts(const AbstractExpressionRef &expr, std::vector<AbstractExpressionRef> *conjuncts) {
+  if (const auto *logic_expr = dynamic_cast<const LogicExpression *>(expr.get());
+      logic_expr != nullptr && logic_expr->logic_type_ == LogicType::And) {
+    SplitConjuncts(logic_expr->GetChildAt(0), conjuncts);
+    SplitConjuncts(logic_expr->GetChildAt(1), conjuncts);
+    return;
+  }
+  if (!IsPredicateTrue(*expr)) {
+    conjuncts->push_back(expr);
+  }
+}
+
+auto Optimizer::CombineConjuncts(const std::vector<AbstractExpressionRef> &conjuncts) -> AbstractExpressionRef {
+  if (conjuncts.empty()) {
+    return std::make_shared<ConstantValueExpression>(ValueFactory::GetBooleanValue(true));
+  }
+  auto expr = conjuncts[0];
+  for (size_t i = 1; i < conjuncts.size(); i++) {
+    expr = std::make_shared<LogicExpression>(expr, conjuncts[i], LogicType::And);
+  }
+  return expr;
+}
+
+auto Optimizer::OptimizePredicatePushdown(const AbstractPlanNodeRef &plan) -> AbstractPlanNodeRef {
+  return PushDownConjuncts(plan, {});
+}
+
+auto Optimizer::PushDownConjuncts(const AbstractPlanNodeRef &plan, std::vector<AbstractExpressionRef> conjuncts)
+    -> AbstractPlanNodeRef {
+  // Apply whatever could not be pushed any further in a filter right above `node`.
+  auto filter_above = [&](AbstractPlanNodeRef node, const std::vector<AbstractExpressionRef> &remaining) {
+    if (remaining.empty()) {
+      return node;
+    }
+    return AbstractPlanNodeRef(
+        std::make_shared<FilterPlanNode>(plan->output_schema_, CombineConjuncts(remaining), std::move(node)));
+  };
+
+  switch (plan->GetType()) {
+    case PlanType::Filter: {
+      const auto &filter_plan = dynamic_cast<const FilterPlanNode &>(*plan);
+      SplitConjuncts(filter_plan.GetPredicate(), &conjuncts);
+      return PushDownConjuncts(filter_plan.GetChildPlan(), std::move(conjuncts));
+    }
+    case PlanType::SeqScan: {
+      const auto &seq_scan_plan = dynamic_cast<const SeqScanPlanNode &>(*plan);
+      if (conjuncts.empty()) {
+        return plan;
+      }
+      if (seq_scan_plan.filter_predicate_ != nullptr) {
+        conjuncts.insert(conjuncts.begin(), seq_scan_plan.filter_predicate_);
+      }
+      return std::make_shared<SeqScanPlanNode>(seq_scan_plan.output_schema_, seq_scan_plan.table_oid_,
+                                               seq_scan_plan.table_name_, CombineConjuncts(conjuncts));
+    }
+    case PlanType::Projection: {
+      // The projected expressions are deterministic, so any conjunct can be evaluated on the input instead.
+      const auto &projection_plan = dynamic_cast<const ProjectionPlanNode &>(*plan);
+      std::vector<AbstractExpressionRef> pushed;
+      for (const auto &conjunct : conjuncts) {
+        pushed.push_back(SubstituteColumns(conjunct, projection_plan.GetExpressions()));
+      }
+      return plan->CloneWithChildren({PushDownConjuncts(projection_plan.GetChildAt(0), std::move(pushed))});
+    }
+    case PlanType::Sort:
+      return plan->CloneWithChildren({PushDownConjuncts(plan->GetChildAt(0), std::move(conjuncts))});
+    case PlanType::Aggregation:
+    case PlanType::StreamAggregation: {
+      // Conjuncts over the group-by columns filter out whole groups and can be applied to the input.
+      const auto &agg_plan = dynamic_cast<const AggregationPlanNode &>(*plan);
+      std::vector<AbstractExpressionRef> pushed;
+      std::vector<AbstractExpressionRef> remaining;
+      for (const auto &conjunct : conjuncts) {
+        bool has_column = false;
+        if (OnlyReferencesColumnsBelow(*conjunct, agg_plan.GetGroupBys().size(), &has_column) && has_column) {
+          pushed.push_back(SubstituteColumns(conjunct, agg_plan.GetGroupBys()));
+        } else {
+          remaining.push_back(conjunct);
+        }
+      }
+      return filter_above(plan->CloneWithChildren({PushDownConjuncts(agg_plan.GetChildAt(0), std::move(pushed))}),
+                          remaining);
+    }
+    case PlanType::NestedLoopJoin: {
+      const auto &nlj_plan = dynamic_cast<const NestedLoopJoinPlanNode &>(*plan);
+      auto left_column_cnt = nlj_plan.GetLeftPlan()->OutputSchema().GetColumnCount();
+      auto right_column_cnt = nlj_plan.GetRightPlan()->OutputSchema().GetColumnCount();
+      std::vector<AbstractExpressionRef> join_conjuncts;
+      SplitConjuncts(nlj_plan.predicate_, &join_conjuncts);
+
+      std::vector<AbstractExpressionRef> left_pushed;
+      std::vector<AbstractExpressionRef> right_pushed;
+      std::vector<AbstractExpressionRef> remaining;
+      std::vector<AbstractExpressionRef> join_predicate;
+      if (nlj_plan.GetJoinType() == JoinType::INNER) {
+        // Conjuncts above an inner join are join conditions as well.
+        for (const auto &conjunct : conjuncts) {
+          join_conjuncts.push_back(RewriteExpressionForJoin(conjunct, left_column_cnt, right_column_cnt));
+        }
+        for (const auto &conjunct : join_conjuncts) {
+          auto sides = SidesOf(*conjunct);
+          if (sides == LEFT_SIDE) {
+            left_pushed.push_back(conjunct);
+          } else if (sides == RIGHT_SIDE) {
+            right_pushed.push_back(ToTupleZero(conjunct));
+          } else {
+            join_predicate.push_back(conjunct);
+          }
+        }
+      } else {
+        // Above a left join, only conjuncts over the preserved side can be applied early: the others must also see the
+        // NULL-padded rows. In the join condition, only conjuncts over the inner side can.
+        for (const auto &conjunct : conjuncts) {
+          auto rewritten = RewriteExpressionForJoin(conjunct, left_column_cnt, right_column_cnt);
+          if (SidesOf(*rewritten) == LEFT_SIDE) {
+            left_pushed.push_back(rewritten);
+          } else {
+            remaining.push_back(conjunct);
+          }
+        }
+        for (const auto &conjunct : join_conjuncts) {
+          if (SidesOf(*conjunct) == RIGHT_SIDE) {
+            right_pushed.push_back(ToTupleZero(conjunct));
+          } else {
+            join_predicate.push_back(conjunct);
+          }
+        }
+      }
+      auto optimized_plan = std::make_shared<NestedLoopJoinPlanNode>(
+          nlj_plan.output_schema_, PushDownConjuncts(nlj_plan.GetLeftPlan(), std::move(left_pushed)),
+          PushDownConjuncts(nlj_plan.GetRightPlan(), std::move(right_pushed)), CombineConjuncts(join_predicate),
+          nlj_plan.GetJoinType());
+      return filter_above(optimized_plan, remaining);
+    }
+    default: {
+      std::vector<AbstractPlanNodeRef> children;
+      for (const auto &child : plan->GetChildren()) {
+        children.emplace_back(PushDownConjuncts(child, {}));
+      }
+      return filter_above(plan->CloneWithChildren(std::move(children)), conjuncts);
+    }
+  }
+}
+
+}  // namespace bustub
@@ -7,6 +7,7 @@
 #include "binder/expressions/bound_binary_op.h"
 #include "binder/expressions/bound_column_ref.h"
 #include "binder/expressions/bound_constant.h"
+#include "binder/expressions/bound_parameter.h"
 #include "binder/expressions/bound_unary_op.h"
 #include "binder/statement/select_statement.h"
 #include "common/exception.h"
@@ -14,6 +15,7 @@
 #include "common/util/string_util.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
 #include "execution/plans/abstract_plan.h"
 #include "fmt/format.h"
 #include "planner/planner.h"
@@ -22,8 +24,19 @@ namespace bustub {
 
 auto Planner::PlanBinaryOp(const BoundBinaryOp &expr, const std::vector<AbstractPlanNodeRef> &children)
     -> AbstractExpressionRef {
-  auto [_1, left] = PlanExpression(*expr.larg_, children);
-  auto [_2, right] = PlanExpression(*expr.rarg_, children);
+  AbstractExpressionRef left;
+  AbstractExpressionRef right;
+  // A parameter compared with (or added to) a typed operand takes its type, e.g. `$1` in `WHERE name = $1`.
+  if (expr.larg_->type_ == ExpressionType::PARAMETER && expr.rarg_->type_ != ExpressionType::PARAMETER) {
+    right = std::get<1>(PlanExpression(*expr.rarg_, children));
+    left = PlanParameter(dynamic_cast<const BoundParameter &>(*expr.larg_), right->GetReturnType());
+  } else if (expr.rarg_->type_ == ExpressionType::PARAMETER) {
+    left = std::get<1>(PlanExpression(*expr.larg_, children));
+    right = PlanParameter(dynamic_cast<const BoundParameter &>(*expr.rarg_), left->GetReturnType());
+  } else {
+    left = std::get<1>(PlanExpression(*expr.larg_, children));
+    right = std::get<1>(PlanExpression(*expr.rarg_, children));
+  }
   const auto &op_name = expr.op_name_;
   return GetBinaryExpressionFromFactory(op_name, std::move(left), std::move(right));
 }
@@ -99,27 +112,36 @@ auto Planner::PlanConstant(const BoundConstant &expr, const std::vector<Abstract
   return std::make_shared<ConstantValueExpression>(expr.val_);
 }
 
-void Planner::AddAggCallToContext(BoundExpression &expr) {
+auto Planner::PlanParameter(const BoundParameter &expr, TypeId type_hint) -> AbstractExpressionRef {
+  if (expr.idx_ >= parameter_types_.size()) {
+    parameter_types_.resize(expr.idx_ + 1, TypeId::INVALID);
+  }
+  auto &type = parameter_types_[expr.idx_];
+  if (type == TypeId::INVALID) {
+    type = type_hint == TypeId::INVALID ? TypeId::INTEGER : type_hint;
+  }
+  return std::make_shared<ParameterValueExpression>(expr.idx_, type, parameter_values_);
+}
+
+void Planner::AddAggCallToContext(const BoundExpression &expr) {
   switch (expr.type_) {
     case ExpressionType::AGG_CALL: {
-      auto &agg_call_expr = dynamic_cast<BoundAggCall &>(expr);
-      auto agg_name = fmt::format("__pseudo_agg#{}", ctx_.aggregations_.size());
-      auto agg_call =
-          BoundAggCall(agg_name, agg_call_expr.is_distinct_, std::vector<std::unique_ptr<BoundExpression>>{});
-      // Replace the agg call in the original bound expression with a pseudo one, add agg call to the context.
-      ctx_.AddAggregation(std::make_unique<BoundAggCall>(std::exchange(agg_call_expr, std::move(agg_call))));
+      // Add the agg call to the context. Agg calls are planned in the order they are added, which is the order
+      // `PlanExpression` meets them in.
+      ctx_.AddAggregation(&expr);
       return;
     }
     case ExpressionType::COLUMN_REF: {
       return;
     }
     case ExpressionType::BINARY_OP: {
-      auto &binary_op_expr = dynamic_cast<BoundBinaryOp &>(expr);
+      const auto &binary_op_expr = dynamic_cast<const BoundBinaryOp &>(expr);
       AddAggCallToContext(*binary_op_expr.larg_);
       AddAggCallToContext(*binary_op_expr.rarg_);
       return;
     }
-    case ExpressionType::CONSTANT: {
+    case ExpressionType::CONSTANT:
+    case ExpressionType::PARAMETER: {
       return;
     }
     case ExpressionType::ALIAS: {
@@ -154,6 +176,10 @@ auto Planner::PlanExpression(const BoundExpression &expr, const std::vector<Abst
       const auto &constant_expr = dynamic_cast<const BoundConstant &>(expr);
       return std::make_tuple(UNNAMED_COLUMN, PlanConstant(constant_expr, children));
     }
+    case ExpressionType::PARAMETER: {
+      const auto &parameter_expr = dynamic_cast<const BoundParameter &>(expr);
+      return std::make_tuple(UNNAMED_COLUMN, PlanParameter(parameter_expr, TypeId::INVALID));
+    }
     case ExpressionType::ALIAS: {
       const auto &alias_expr = dynamic_cast<const BoundAlias &>(expr);
       auto [_1, expr] = PlanExpression(*alias_expr.child_, children);
@@ -59,11 +59,11 @@ auto Planner::MakeOutputSchema(const std::vector<std::pair<std::string, TypeId>>
   return std::make_shared<Schema>(cols);
 }
 
-void PlannerContext::AddAggregation(std::unique_ptr<BoundExpression> expr) {
+void PlannerContext::AddAggregation(const BoundExpression *expr) {
   if (!allow_aggregation_) {
     throw bustub::Exception("AggCall not allowed in this position");
   }
-  aggregations_.push_back(std::move(expr));
+  aggregations_.push_back(expr);
 }
 
 }  // namespace bustub
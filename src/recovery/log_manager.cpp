@@ -12,6 +12,11 @@
 
 #include "recovery/log_manager.h"
 
+#include <cstring>
+#include <utility>
+
+#include "common/macros.h"
+
 namespace bustub {
 /*
  * set enable_logging = true
@@ -22,12 +27,61 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::scoped_lock lock(latch_);
+  if (flush_thread_ != nullptr) {
+    return;
+  }
+  stop_ = false;
+  enable_logging = true;
+  flush_thread_ = new std::thread(&LogManager::FlushLoop, this);
+}
+
+void LogManager::FlushLoop() {
+  std::unique_lock lock(latch_);
+  while (true) {
+    cv_.wait_for(lock, log_timeout, [this] { return stop_ || flush_requested_; });
+    flush_requested_ = false;
+    if (offset_ == 0) {
+      if (stop_) {
+        break;
+      }
+      continue;
+    }
+    // Records go on being appended to the other buffer while this one is written. The LSNs are assigned under the
+    // latch, so the buffer holds every record up to the last LSN assigned.
+    std::swap(log_buffer_, flush_buffer_);
+    auto size = offset_;
+    lsn_t last_lsn = next_lsn_ - 1;
+    offset_ = 0;
+    flushed_cv_.notify_all();
+
+    lock.unlock();
+    disk_manager_->WriteLog(flush_buffer_, size);
+    lock.lock();
+    persistent_lsn_ = last_lsn;
+    flushed_cv_.notify_all();
+  }
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  std::thread *flush_thread;
+  {
+    std::scoped_lock lock(latch_);
+    if (flush_thread_ == nullptr) {
+      return;
+    }
+    enable_logging = false;
+    stop_ = true;
+    cv_.notify_one();
+    flush_thread = std::exchange(flush_thread_, nullptr);
+  }
+  flush_thread->join();
+  delete flush_thread;
+}
 
 /*
  * append a log record into log buffer
@@ -49,6 +103,61 @@ void LogManager::StopFlushThread() {}
  *  }
  *
  */
-auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t { return INVALID_LSN; }
+auto LogManager::AppendLogRecord(LogRecord *log_record) -> lsn_t {
+  BUSTUB_ASSERT(log_record->size_ <= LOG_BUFFER_SIZE, "log record larger than the log buffer");
+  std::unique_lock lock(latch_);
+  // A full buffer is flushed right away, rather than at the timeout.
+  while (offset_ + log_record->size_ > LOG_BUFFER_SIZE) {
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+
+  log_record->lsn_ = next_lsn_++;
+  memcpy(log_buffer_ + offset_, log_record, LogRecord::HEADER_SIZE);
+  int pos = offset_ + LogRecord::HEADER_SIZE;
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      memcpy(log_buffer_ + pos, &log_record->insert_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->insert_tuple_.SerializeTo(log_buffer_ + pos);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      memcpy(log_buffer_ + pos, &log_record->delete_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->delete_tuple_.SerializeTo(log_buffer_ + pos);
+      break;
+    case LogRecordType::UPDATE:
+      memcpy(log_buffer_ + pos, &log_record->update_rid_, sizeof(RID));
+      pos += sizeof(RID);
+      log_record->old_tuple_.SerializeTo(log_buffer_ + pos);
+      pos += sizeof(int32_t) + log_record->old_tuple_.GetLength();
+      log_record->new_tuple_.SerializeTo(log_buffer_ + pos);
+      break;
+    case LogRecordType::NEWPAGE:
+      memcpy(log_buffer_ + pos, &log_record->prev_page_id_, sizeof(page_id_t));
+      pos += sizeof(page_id_t);
+      memcpy(log_buffer_ + pos, &log_record->page_id_, sizeof(page_id_t));
+      break;
+    default:
+      break;
+  }
+  offset_ += log_record->size_;
+  return log_record->lsn_;
+}
+
+void LogManager::WaitUntilPersistent(lsn_t lsn) {
+  if (persistent_lsn_ >= lsn) {
+    return;
+  }
+  std::unique_lock lock(latch_);
+  while (persistent_lsn_ < lsn) {
+    flush_requested_ = true;
+    cv_.notify_one();
+    flushed_cv_.wait(lock);
+  }
+}
 
 }  // namespace bustub
@@ -326,10 +326,45 @@ auto TablePage::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockMan
   return true;
 }
 
-auto TablePage::GetFirstTupleRid(RID *first_rid) -> bool {
+auto TablePage::GetTupleView(const RID &rid, TupleView *view) -> bool {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount()) {
+    return false;
+  }
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  if (IsDeleted(tuple_size)) {
+    return false;
+  }
+  *view = TupleView(GetData() + GetTupleOffsetAtSlot(slot_num), tuple_size, rid);
+  return true;
+}
+
+auto TablePage::GetTupleVersion(const RID &rid, Tuple *tuple, bool *is_deleted) -> bool {
+  uint32_t slot_num = rid.GetSlotNum();
+  if (slot_num >= GetTupleCount()) {
+    return false;
+  }
+  uint32_t tuple_size = GetTupleSize(slot_num);
+  if (!HoldsTuple(tuple_size, true)) {
+    return false;
+  }
+  *is_deleted = IsDeleted(tuple_size);
+  tuple_size = UnsetDeletedFlag(tuple_size);
+  tuple->size_ = tuple_size;
+  if (tuple->allocated_) {
+    delete[] tuple->data_;
+  }
+  tuple->data_ = new char[tuple->size_];
+  memcpy(tuple->data_, GetData() + GetTupleOffsetAtSlot(slot_num), tuple->size_);
+  tuple->rid_ = rid;
+  tuple->allocated_ = true;
+  return true;
+}
+
+auto TablePage::GetFirstTupleRid(RID *first_rid, bool include_deleted) -> bool {
   // Find and return the first valid tuple.
   for (uint32_t i = 0; i < GetTupleCount(); ++i) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (HoldsTuple(GetTupleSize(i), include_deleted)) {
       first_rid->Set(GetTablePageId(), i);
       return true;
     }
@@ -338,11 +373,11 @@ auto TablePage::GetFirstTupleRid(RID *first_rid) -> bool {
   return false;
 }
 
-auto TablePage::GetNextTupleRid(const RID &cur_rid, RID *next_rid) -> bool {
+auto TablePage::GetNextTupleRid(const RID &cur_rid, RID *next_rid, bool include_deleted) -> bool {
   BUSTUB_ASSERT(cur_rid.GetPageId() == GetTablePageId(), "Wrong table!");
   // Find and return the first valid tuple after our current slot number.
   for (auto i = cur_rid.GetSlotNum() + 1; i < GetTupleCount(); ++i) {
-    if (!IsDeleted(GetTupleSize(i))) {
+    if (HoldsTuple(GetTupleSize(i), include_deleted)) {
       next_rid->Set(GetTablePageId(), i);
       return true;
     }
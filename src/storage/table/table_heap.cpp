@@ -82,16 +82,30 @@ auto TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) -> b
       cur_page = new_page;
     }
   }
+  // Hide the tuple from the snapshots before any of them can read it.
+  version_store_.AddInsert(*rid, txn);
   // This line has caused most of us to double-take and "whoa double unlatch".
   // We are not, in fact, double unlatching. See the invariant above.
   cur_page->WUnlatch();
   buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), true);
+  if (!HoldsVersionLatches(txn)) {
+    version_latches_.Bump(*rid);
+  }
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(*rid, WType::INSERT, Tuple{}, this);
   return true;
 }
 
 auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
+  if (BuffersWrites(txn)) {
+    // Reading the tuple first also validates that it still exists at commit.
+    Tuple old_tuple;
+    if (!GetTuple(rid, &old_tuple, txn)) {
+      return false;
+    }
+    txn->GetBufferedWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
+    return true;
+  }
   // TODO(Amadou): remove empty page
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
@@ -100,17 +114,38 @@ auto TableHeap::MarkDelete(const RID &rid, Transaction *txn) -> bool {
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
-  // Otherwise, mark the tuple as deleted.
+  // Otherwise, mark the tuple as deleted, keeping the deleted version for the snapshots that still see it.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  if (!version_store_.CanWrite(rid, txn)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  Tuple old_tuple;
+  if (page->GetTuple(rid, &old_tuple, txn, lock_manager_) &&
+      page->MarkDelete(rid, txn, lock_manager_, log_manager_)) {
+    version_store_.AddVersion(rid, txn, old_tuple, true);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
+  if (!HoldsVersionLatches(txn)) {
+    version_latches_.Bump(rid);
+  }
   // Update the transaction's write set.
   txn->GetWriteSet()->emplace_back(rid, WType::DELETE, Tuple{}, this);
   return true;
 }
 
 auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) -> bool {
+  if (BuffersWrites(txn)) {
+    Tuple old_tuple;
+    if (!GetTuple(rid, &old_tuple, txn)) {
+      return false;
+    }
+    txn->GetBufferedWriteSet()->emplace_back(rid, WType::UPDATE, txn->CopyToArena(tuple), this);
+    return true;
+  }
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -121,12 +156,24 @@ auto TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
   // Update the tuple; but first save the old value for rollbacks.
   Tuple old_tuple;
   page->WLatch();
+  if (!version_store_.CanWrite(rid, txn)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
   bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (is_updated) {
+    version_store_.AddVersion(rid, txn, old_tuple, false);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
+  if (is_updated && !HoldsVersionLatches(txn)) {
+    version_latches_.Bump(rid);
+  }
   // Update the transaction's write set.
   if (is_updated && txn->GetState() != TransactionState::ABORTED) {
-    txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, old_tuple, this);
+    txn->GetWriteSet()->emplace_back(rid, WType::UPDATE, txn->CopyToArena(old_tuple), this);
   }
   return is_updated;
 }
@@ -138,6 +185,8 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   // Delete the tuple from the page.
   page->WLatch();
   page->ApplyDelete(rid, txn, log_manager_);
+  // The slot may be reused by the next insert.
+  version_store_.Erase(rid);
   /** Commented out to make compatible with p4; This is called only on commit or delete, which consequently unlocks the
    * tuple; so should be fine */
   // lock_manager_->Unlock(txn, rid);
@@ -156,7 +205,33 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
+void TableHeap::GarbageCollect(const RID &rid, timestamp_t watermark, Transaction *txn) {
+  // Pruning does not change what any snapshot reads, so needs no page latch. Only the delete does.
+  if (version_store_.Prune(rid, watermark)) {
+    ApplyDelete(rid, txn);
+  }
+}
+
 auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool acquire_read_lock) -> bool {
+  const bool optimistic = txn != nullptr && txn->IsOptimistic();
+  uint64_t version = 0;
+  if (optimistic) {
+    // An optimistic transaction reads its own buffered writes, newest first.
+    const auto &buffered_write_set = *txn->GetBufferedWriteSet();
+    for (auto it = buffered_write_set.rbegin(); it != buffered_write_set.rend(); ++it) {
+      if (it->table_ == this && it->rid_ == rid) {
+        if (it->wtype_ == WType::DELETE) {
+          return false;
+        }
+        // `rid` may be the RID of `tuple` itself, as for a table iterator. The copy must outlive the transaction.
+        *tuple = Tuple(it->tuple_.GetView());
+        tuple->rid_ = it->rid_;
+        return true;
+      }
+    }
+    // Any write installed from now on changes the version, and fails the validation of this read.
+    version = version_latches_.GetVersion(VersionLatchTable::SlotOf(rid));
+  }
   // Find the page which contains the tuple.
   auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -168,7 +243,24 @@ auto TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, bool ac
   if (acquire_read_lock) {
     page->RLatch();
   }
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  bool res;
+  if (VersionStore::IsSnapshotRead(txn)) {
+    bool is_deleted;
+    res = page->GetTupleVersion(rid, tuple, &is_deleted) &&
+          version_store_.GetVisibleVersion(rid, txn, tuple, is_deleted);
+    tuple->rid_ = rid;
+  } else {
+    res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  }
+  if (optimistic) {
+    txn->GetReadSet()->emplace_back(rid, version, this);
+    // A tuple written by a transaction that has not committed yet is as good as locked: no need to read on only to
+    // fail the validation.
+    if (!version_store_.CanWrite(rid, txn)) {
+      txn->SetState(TransactionState::ABORTED);
+      res = false;
+    }
+  }
   if (acquire_read_lock) {
     page->RUnlatch();
   }
@@ -185,7 +277,7 @@ auto TableHeap::Begin(Transaction *txn) -> TableIterator {
     auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the default-constructed value, which means EOF.
-    auto found_tuple = page->GetFirstTupleRid(&rid);
+    auto found_tuple = page->GetFirstTupleRid(&rid, VersionStore::IsSnapshotRead(txn));
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
@@ -61,10 +61,12 @@ Tuple::Tuple(std::vector<Value> values, const Schema *schema) : allocated_(true)
   }
 }
 
+Tuple::Tuple(const TupleView &view) : allocated_(true), rid_(view.GetRid()), size_(view.GetLength()) {
+  data_ = new char[size_];
+  memcpy(data_, view.GetData(), size_);
+}
+
 Tuple::Tuple(const Tuple &other) : allocated_(other.allocated_), rid_(other.rid_), size_(other.size_) {
-  if (allocated_) {
-    delete[] data_;
-  }
   if (allocated_) {
     // Deep copy.
     data_ = new char[size_];
@@ -95,6 +97,23 @@ auto Tuple::operator=(const Tuple &other) -> Tuple & {
   return *this;
 }
 
+auto Tuple::operator=(Tuple &&other) noexcept -> Tuple & {
+  if (this == &other) {
+    return *this;
+  }
+  if (allocated_) {
+    delete[] data_;
+  }
+  allocated_ = other.allocated_;
+  rid_ = other.rid_;
+  size_ = other.size_;
+  data_ = other.data_;
+  other.allocated_ = false;
+  other.size_ = 0;
+  other.data_ = nullptr;
+  return *this;
+}
+
 auto Tuple::GetValue(const Schema *schema, const uint32_t column_idx) const -> Value {
   assert(schema);
   assert(data_);
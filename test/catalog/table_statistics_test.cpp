@@ -0,0 +1,86 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_statistics_test.cpp
+//
+// Identification: test/catalog/table_statistics_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <optional>
+#include <string>
+
+#include "catalog/table_statistics.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(TableStatisticsTest, CollectAndEstimate) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+  TableStatisticsCollector collector(schema);
+  // a: 0..999 uniformly, with every tenth row NULL; b: 5 distinct strings.
+  for (int i = 0; i < 1000; i++) {
+    auto a = i % 10 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER) : ValueFactory::GetIntegerValue(i);
+    auto b = ValueFactory::GetVarcharValue(std::to_string(i % 5));
+    collector.Add(Tuple({a, b}, &schema));
+  }
+  auto stats = collector.Finish();
+
+  ASSERT_EQ(1000, stats.row_count_);
+  ASSERT_EQ(2, stats.columns_.size());
+  const auto &a = stats.columns_[0];
+  const auto &b = stats.columns_[1];
+  ASSERT_EQ(900, a.GetDistinctCount());
+  ASSERT_DOUBLE_EQ(0.1, a.GetNullFraction());
+  ASSERT_EQ(1, a.GetHistogramBounds().front());
+  ASSERT_EQ(999, a.GetHistogramBounds().back());
+  ASSERT_EQ(5, b.GetDistinctCount());
+  ASSERT_TRUE(b.GetHistogramBounds().empty());
+
+  ASSERT_NEAR(0.9 / 900, a.EstimateEqualSelectivity(ValueFactory::GetIntegerValue(500)), 1e-9);
+  ASSERT_EQ(0, a.EstimateEqualSelectivity(ValueFactory::GetIntegerValue(5000)));
+  ASSERT_EQ(0, a.EstimateEqualSelectivity(ValueFactory::GetNullValueByType(TypeId::INTEGER)));
+  ASSERT_NEAR(0.2, b.EstimateEqualSelectivity(ValueFactory::GetVarcharValue("3")), 1e-9);
+
+  // a < 250: about a quarter of the non-null rows.
+  ASSERT_NEAR(0.9 * 0.25, a.EstimateRangeSelectivity(std::nullopt, false, 250, false), 0.02);
+  // 100 <= a < 300
+  ASSERT_NEAR(0.9 * 0.2, a.EstimateRangeSelectivity(100, true, 300, false), 0.02);
+  ASSERT_EQ(0, a.EstimateRangeSelectivity(2000, true, std::nullopt, false));
+  ASSERT_NEAR(0.9, a.EstimateRangeSelectivity(std::nullopt, false, 2000, false), 1e-9);
+}
+
+// NOLINTNEXTLINE
+TEST(TableStatisticsTest, ManyDistinctValues) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::BIGINT)});
+  TableStatisticsCollector collector(schema);
+  // a: 200,000 distinct values, each twice; b: 100,000 distinct values far apart. The value hash collides heavily on
+  // such values, so counting hashes would underestimate both.
+  for (int i = 0; i < 400000; i++) {
+    auto a = ValueFactory::GetIntegerValue(i / 2);
+    auto b = ValueFactory::GetBigIntValue(static_cast<int64_t>(i % 100000) << 32);
+    collector.Add(Tuple({a, b}, &schema));
+  }
+  auto stats = collector.Finish();
+  ASSERT_EQ(400000, stats.row_count_);
+  ASSERT_EQ(200000, stats.columns_[0].GetDistinctCount());
+  ASSERT_EQ(100000, stats.columns_[1].GetDistinctCount());
+}
+
+// NOLINTNEXTLINE
+TEST(TableStatisticsTest, EmptyTable) {
+  Schema schema({Column("a", TypeId::INTEGER)});
+  TableStatisticsCollector collector(schema);
+  auto stats = collector.Finish();
+  ASSERT_EQ(0, stats.row_count_);
+  ASSERT_EQ(0, stats.columns_[0].GetDistinctCount());
+  ASSERT_EQ(0, stats.columns_[0].EstimateEqualSelectivity(ValueFactory::GetIntegerValue(1)));
+  ASSERT_EQ(0, stats.columns_[0].EstimateRangeSelectivity(std::nullopt, false, 1, false));
+}
+
+}  // namespace bustub
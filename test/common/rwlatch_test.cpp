@@ -10,10 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <random>
+#include <shared_mutex>
 #include <thread>  // NOLINT
+#include <type_traits>
 #include <vector>
 
 #include "common/rwlatch.h"
+#include "fmt/core.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -57,4 +63,151 @@ TEST(RWLatchTest, BasicTest) {
   }
   EXPECT_EQ(counter.Read(), 55);
 }
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, WriterPreferenceTest) {
+  ReaderWriterLatch latch;
+  std::atomic<int> order{0};
+  int writer_order = 0;
+  int reader_order = 0;
+  latch.RLock();
+  std::thread writer([&] {
+    latch.WLock();
+    writer_order = ++order;
+    latch.WUnlock();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  // The writer waits for the reader, and the reader that comes next waits for the writer.
+  std::thread reader([&] {
+    latch.RLock();
+    reader_order = ++order;
+    latch.RUnlock();
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(order, 0);
+  latch.RUnlock();
+  writer.join();
+  reader.join();
+  EXPECT_EQ(writer_order, 1);
+  EXPECT_EQ(reader_order, 2);
+}
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, OptimisticReadTest) {
+  ReaderWriterLatch latch;
+  auto version = latch.OptimisticRead();
+  EXPECT_TRUE(latch.Validate(version));
+  // Readers do not invalidate an optimistic read, a writer does, even before it unlocks.
+  latch.RLock();
+  latch.RUnlock();
+  EXPECT_TRUE(latch.Validate(version));
+  latch.WLock();
+  EXPECT_FALSE(latch.Validate(version));
+  auto locked_version = latch.OptimisticRead();
+  EXPECT_FALSE(latch.Validate(locked_version));
+  latch.WUnlock();
+  EXPECT_FALSE(latch.Validate(version));
+  EXPECT_FALSE(latch.Validate(locked_version));
+  EXPECT_TRUE(latch.Validate(latch.OptimisticRead()));
+}
+
+/** std::shared_mutex behind the interface of ReaderWriterLatch, to compare them. */
+class SharedMutexLatch {
+ public:
+  void WLock() { mutex_.lock(); }
+  void WUnlock() { mutex_.unlock(); }
+  void RLock() { mutex_.lock_shared(); }
+  void RUnlock() { mutex_.unlock_shared(); }
+
+ private:
+  std::shared_mutex mutex_;
+};
+
+/**
+ * Run threads that keep latching one of a few latches, each guarding a pair of counters that writers increment
+ * together and readers check are equal. Optimistic readers retry until the read validates.
+ * @return the latch operations per second
+ */
+template <typename Latch>
+auto StressLatch(int num_threads, int read_pct, bool optimistic, std::chrono::milliseconds duration) -> double {
+  struct Guarded {
+    Latch latch_;
+    std::atomic<int> a_{0};
+    std::atomic<int> b_{0};
+  };
+  const int num_latches = 4;
+  std::vector<Guarded> guarded(num_latches);
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> total_ops{0};
+  std::atomic<uint64_t> inconsistent_reads{0};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&, tid] {
+      std::mt19937 gen(tid);
+      uint64_t ops = 0;
+      while (!stop) {
+        auto &g = guarded[gen() % num_latches];
+        if (static_cast<int>(gen() % 100) >= read_pct) {
+          g.latch_.WLock();
+          g.a_.store(g.a_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+          g.b_.store(g.b_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+          g.latch_.WUnlock();
+        } else if (optimistic) {
+          if constexpr (std::is_same_v<Latch, ReaderWriterLatch>) {
+            while (true) {
+              auto version = g.latch_.OptimisticRead();
+              auto a = g.a_.load(std::memory_order_relaxed);
+              auto b = g.b_.load(std::memory_order_relaxed);
+              if (g.latch_.Validate(version)) {
+                inconsistent_reads += a == b ? 0 : 1;
+                break;
+              }
+            }
+          }
+        } else {
+          g.latch_.RLock();
+          inconsistent_reads += g.a_.load(std::memory_order_relaxed) == g.b_.load(std::memory_order_relaxed) ? 0 : 1;
+          g.latch_.RUnlock();
+        }
+        ops++;
+      }
+      total_ops += ops;
+    });
+  }
+  std::this_thread::sleep_for(duration);
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(inconsistent_reads, 0);
+  int writes = 0;
+  for (auto &g : guarded) {
+    EXPECT_EQ(g.a_, g.b_);
+    writes += g.a_;
+  }
+  EXPECT_GT(writes, 0);
+  return static_cast<double>(total_ops) / std::chrono::duration<double>(duration).count();
+}
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, StressTest) {
+  StressLatch<ReaderWriterLatch>(8, 90, false, std::chrono::milliseconds(200));
+  StressLatch<ReaderWriterLatch>(8, 90, true, std::chrono::milliseconds(200));
+  StressLatch<ReaderWriterLatch>(8, 10, false, std::chrono::milliseconds(200));
+}
+
+// NOLINTNEXTLINE
+TEST(RWLatchTest, DISABLED_BenchmarkTest) {
+  const auto duration = std::chrono::milliseconds(1000);
+  for (int num_threads : {1, 4, 16}) {
+    for (int read_pct : {50, 90, 99}) {
+      auto shared_mutex_ops = StressLatch<SharedMutexLatch>(num_threads, read_pct, false, duration);
+      auto latch_ops = StressLatch<ReaderWriterLatch>(num_threads, read_pct, false, duration);
+      auto optimistic_ops = StressLatch<ReaderWriterLatch>(num_threads, read_pct, true, duration);
+      fmt::print("threads={} read_pct={} shared_mutex={:.0f} ops/s rwlatch={:.0f} ops/s optimistic={:.0f} ops/s\n",
+                 num_threads, read_pct, shared_mutex_ops, latch_ops, optimistic_ops);
+    }
+  }
+}
+
 }  // namespace bustub
@@ -21,7 +21,7 @@
       << "Test Failed Due to Time Out";
 
 namespace bustub {
-TEST(LockManagerDeadlockDetectionTest, DISABLED_EdgeTest) {
+TEST(LockManagerDeadlockDetectionTest, EdgeTest) {
   LockManager lock_mgr{};
 
   const int num_nodes = 100;
@@ -63,7 +63,7 @@ TEST(LockManagerDeadlockDetectionTest, DISABLED_EdgeTest) {
   }
 }
 
-TEST(LockManagerDeadlockDetectionTest, DISABLED_BasicDeadlockDetectionTest) {
+TEST(LockManagerDeadlockDetectionTest, BasicDeadlockDetectionTest) {
   LockManager lock_mgr{};
   TransactionManager txn_mgr{&lock_mgr};
 
@@ -122,4 +122,135 @@ TEST(LockManagerDeadlockDetectionTest, DISABLED_BasicDeadlockDetectionTest) {
   delete txn0;
   delete txn1;
 }
+/** Each transaction holds a row and waits for the row of the next one: the newest transaction is aborted */
+TEST(LockManagerDeadlockDetectionTest, CycleDetectionTest) {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  table_oid_t toid{0};
+  const int num_txns = 3;
+
+  std::vector<Transaction *> txns;
+  for (int i = 0; i < num_txns; i++) {
+    txns.push_back(txn_mgr.Begin());
+    EXPECT_TRUE(lock_mgr.LockTable(txns[i], LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+    EXPECT_TRUE(lock_mgr.LockRow(txns[i], LockManager::LockMode::EXCLUSIVE, toid, RID{i, 0}));
+  }
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_txns; i++) {
+    threads.emplace_back([&, i] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20 * i));
+      bool res = lock_mgr.LockRow(txns[i], LockManager::LockMode::EXCLUSIVE, toid, RID{(i + 1) % num_txns, 0});
+      if (i == num_txns - 1) {
+        EXPECT_FALSE(res);
+        EXPECT_EQ(TransactionState::ABORTED, txns[i]->GetState());
+        txn_mgr.Abort(txns[i]);
+      } else {
+        EXPECT_TRUE(res);
+        txn_mgr.Commit(txns[i]);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_TRUE(lock_mgr.GetEdgeList().empty());
+
+  auto stats = lock_mgr.GetDeadlockStats();
+  EXPECT_EQ(1, stats.cycle_cnt_);
+  EXPECT_EQ(1, stats.aborted_txn_cnt_);
+  EXPECT_LE(stats.max_detection_latency_, stats.total_detection_latency_);
+  EXPECT_LT(stats.max_detection_latency_, cycle_detection_interval * 2);
+
+  for (auto *txn : txns) {
+    delete txn;
+  }
+}
+
+/** Under WAIT_DIE, a newer transaction is aborted rather than wait for an older one, which waits for newer ones */
+TEST(LockManagerDeadlockDetectionTest, WaitDieTest) {
+  LockManager lock_mgr{};
+  lock_mgr.SetDeadlockPolicy(LockManager::DeadlockPolicy::WAIT_DIE);
+  TransactionManager txn_mgr{&lock_mgr};
+  table_oid_t toid{0};
+  RID rid0{0, 0};
+  RID rid1{1, 1};
+  auto *txn0 = txn_mgr.Begin();
+  auto *txn1 = txn_mgr.Begin();
+
+  EXPECT_TRUE(lock_mgr.LockTable(txn0, LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+  EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, toid, rid0));
+  EXPECT_TRUE(lock_mgr.LockRow(txn1, LockManager::LockMode::EXCLUSIVE, toid, rid1));
+
+  std::thread t0([&] {
+    /** Waits for the newer txn1 */
+    EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, toid, rid1));
+    txn_mgr.Commit(txn0);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(TransactionState::GROWING, txn0->GetState());
+
+  /** Dies instead of waiting for the older txn0 */
+  EXPECT_FALSE(lock_mgr.LockRow(txn1, LockManager::LockMode::EXCLUSIVE, toid, rid0));
+  EXPECT_EQ(TransactionState::ABORTED, txn1->GetState());
+  txn_mgr.Abort(txn1);
+  t0.join();
+  EXPECT_EQ(TransactionState::COMMITTED, txn0->GetState());
+  EXPECT_EQ(1, lock_mgr.GetDeadlockStats().aborted_txn_cnt_);
+  EXPECT_TRUE(lock_mgr.GetEdgeList().empty());
+
+  delete txn0;
+  delete txn1;
+}
+
+/** Under WOUND_WAIT, an older transaction aborts the newer ones it would wait for, and waits for them to release */
+TEST(LockManagerDeadlockDetectionTest, WoundWaitTest) {
+  LockManager lock_mgr{};
+  lock_mgr.SetDeadlockPolicy(LockManager::DeadlockPolicy::WOUND_WAIT);
+  TransactionManager txn_mgr{&lock_mgr};
+  table_oid_t toid{0};
+  RID rid0{0, 0};
+  RID rid1{1, 1};
+  auto *txn0 = txn_mgr.Begin();
+  auto *txn1 = txn_mgr.Begin();
+  auto *txn2 = txn_mgr.Begin();
+
+  for (auto *txn : {txn0, txn1, txn2}) {
+    EXPECT_TRUE(lock_mgr.LockTable(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, toid));
+  }
+  EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, toid, rid0));
+  EXPECT_TRUE(lock_mgr.LockRow(txn1, LockManager::LockMode::EXCLUSIVE, toid, rid1));
+
+  /** The newer txn2 waits for txn1, until txn1 is wounded */
+  std::thread t2([&] {
+    EXPECT_FALSE(lock_mgr.LockRow(txn2, LockManager::LockMode::EXCLUSIVE, toid, rid1));
+    txn_mgr.Abort(txn2);
+  });
+  /** txn1 waits for the older txn0, until it is wounded */
+  std::thread t1([&] {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    EXPECT_FALSE(lock_mgr.LockRow(txn1, LockManager::LockMode::EXCLUSIVE, toid, rid0));
+    txn_mgr.Abort(txn1);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_EQ(TransactionState::GROWING, txn1->GetState());
+
+  /** txn0 wounds txn2, which waits in the queue of rid1 ahead of it, as well as txn1, which holds rid1 */
+  std::thread t0([&] {
+    EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, toid, rid1));
+    txn_mgr.Commit(txn0);
+  });
+  t2.join();
+  t1.join();
+  t0.join();
+  EXPECT_EQ(TransactionState::ABORTED, txn1->GetState());
+  EXPECT_EQ(TransactionState::ABORTED, txn2->GetState());
+  EXPECT_EQ(TransactionState::COMMITTED, txn0->GetState());
+  EXPECT_EQ(2, lock_mgr.GetDeadlockStats().aborted_txn_cnt_);
+
+  for (auto *txn : {txn0, txn1, txn2}) {
+    delete txn;
+  }
+}
 }  // namespace bustub
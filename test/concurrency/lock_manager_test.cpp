@@ -4,7 +4,10 @@
 
 #include "concurrency/lock_manager.h"
 
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <random>
+#include <set>
 #include <thread>  // NOLINT
 
 #include "common/config.h"
@@ -109,7 +112,7 @@ void TableLockTest1() {
     delete txns[i];
   }
 }
-TEST(LockManagerTest, DISABLED_TableLockTest1) { TableLockTest1(); }  // NOLINT
+TEST(LockManagerTest, TableLockTest1) { TableLockTest1(); }  // NOLINT
 
 /** Upgrading single transaction from S -> X */
 void TableLockUpgradeTest1() {
@@ -134,7 +137,7 @@ void TableLockUpgradeTest1() {
 
   delete txn1;
 }
-TEST(LockManagerTest, DISABLED_TableLockUpgradeTest1) { TableLockUpgradeTest1(); }  // NOLINT
+TEST(LockManagerTest, TableLockUpgradeTest1) { TableLockUpgradeTest1(); }  // NOLINT
 
 void RowLockTest1() {
   LockManager lock_mgr{};
@@ -190,7 +193,7 @@ void RowLockTest1() {
     delete txns[i];
   }
 }
-TEST(LockManagerTest, DISABLED_RowLockTest1) { RowLockTest1(); }  // NOLINT
+TEST(LockManagerTest, RowLockTest1) { RowLockTest1(); }  // NOLINT
 
 void TwoPLTest1() {
   LockManager lock_mgr{};
@@ -239,6 +242,335 @@ void TwoPLTest1() {
   delete txn;
 }
 
-TEST(LockManagerTest, DISABLED_TwoPLTest1) { TwoPLTest1(); }  // NOLINT
+TEST(LockManagerTest, TwoPLTest1) { TwoPLTest1(); }  // NOLINT
+
+/** Intention locks coexist, while an X lock waits for all of them and is granted before later requests */
+void TableLockCompatibilityTest() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  table_oid_t oid = 0;
+
+  auto *txn0 = txn_mgr.Begin();
+  auto *txn1 = txn_mgr.Begin();
+  auto *txn2 = txn_mgr.Begin();
+  auto *txn3 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn0, LockManager::LockMode::INTENTION_SHARED, oid));
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+
+  std::atomic<bool> x_granted{false};
+  std::atomic<bool> is_granted{false};
+  std::thread x_thread([&] {
+    EXPECT_TRUE(lock_mgr.LockTable(txn2, LockManager::LockMode::EXCLUSIVE, oid));
+    x_granted = true;
+    EXPECT_FALSE(is_granted);
+    txn_mgr.Commit(txn2);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  /** IS is compatible with the granted locks, but is queued behind the waiting X */
+  std::thread is_thread([&] {
+    EXPECT_TRUE(lock_mgr.LockTable(txn3, LockManager::LockMode::INTENTION_SHARED, oid));
+    is_granted = true;
+    txn_mgr.Commit(txn3);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(x_granted);
+  EXPECT_FALSE(is_granted);
+
+  txn_mgr.Commit(txn0);
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(x_granted);
+  txn_mgr.Commit(txn1);
+  x_thread.join();
+  is_thread.join();
+  EXPECT_TRUE(x_granted);
+  EXPECT_TRUE(is_granted);
+
+  for (auto *txn : {txn0, txn1, txn2, txn3}) {
+    delete txn;
+  }
+}
+TEST(LockManagerTest, TableLockCompatibilityTest) { TableLockCompatibilityTest(); }  // NOLINT
+
+/** An upgrade is granted before the requests that were waiting when it was made */
+void TableLockUpgradePriorityTest() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  table_oid_t oid = 0;
+
+  auto *txn0 = txn_mgr.Begin();
+  auto *txn1 = txn_mgr.Begin();
+  auto *txn2 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn0, LockManager::LockMode::SHARED, oid));
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, LockManager::LockMode::SHARED, oid));
+
+  std::atomic<int> order{0};
+  std::atomic<int> x_order{-1};
+  std::atomic<int> upgrade_order{-1};
+  std::thread x_thread([&] {
+    EXPECT_TRUE(lock_mgr.LockTable(txn2, LockManager::LockMode::EXCLUSIVE, oid));
+    x_order = order++;
+    txn_mgr.Commit(txn2);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  std::thread upgrade_thread([&] {
+    EXPECT_TRUE(lock_mgr.LockTable(txn0, LockManager::LockMode::EXCLUSIVE, oid));
+    upgrade_order = order++;
+    CheckTableLockSizes(txn0, 0, 1, 0, 0, 0);
+    txn_mgr.Commit(txn0);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+  /** A second upgrade on the same table conflicts with the pending one */
+  EXPECT_THROW(lock_mgr.LockTable(txn1, LockManager::LockMode::EXCLUSIVE, oid), TransactionAbortException);
+  CheckAborted(txn1);
+  txn_mgr.Abort(txn1);
+
+  upgrade_thread.join();
+  x_thread.join();
+  EXPECT_EQ(upgrade_order, 0);
+  EXPECT_EQ(x_order, 1);
+
+  for (auto *txn : {txn0, txn1, txn2}) {
+    delete txn;
+  }
+}
+TEST(LockManagerTest, TableLockUpgradePriorityTest) { TableLockUpgradePriorityTest(); }  // NOLINT
+
+/** Requests that break the locking protocol abort the transaction */
+void LockProtocolTest() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  table_oid_t oid = 0;
+  RID rid{0, 0};
+
+  auto expect_abort = [&](Transaction *txn, AbortReason reason, auto &&request) {
+    try {
+      request();
+      ADD_FAILURE() << "the request did not abort the transaction";
+    } catch (TransactionAbortException &e) {
+      EXPECT_EQ(e.GetAbortReason(), reason);
+    }
+    CheckAborted(txn);
+    txn_mgr.Abort(txn);
+    delete txn;
+  };
+
+  auto *txn = txn_mgr.Begin();
+  expect_abort(txn, AbortReason::TABLE_LOCK_NOT_PRESENT,
+               [&] { lock_mgr.LockRow(txn, LockManager::LockMode::SHARED, oid, rid); });
+
+  txn = txn_mgr.Begin();
+  expect_abort(txn, AbortReason::ATTEMPTED_INTENTION_LOCK_ON_ROW, [&] {
+    lock_mgr.LockTable(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, oid);
+    lock_mgr.LockRow(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, oid, rid);
+  });
+
+  txn = txn_mgr.Begin();
+  expect_abort(txn, AbortReason::TABLE_LOCK_NOT_PRESENT, [&] {
+    lock_mgr.LockTable(txn, LockManager::LockMode::INTENTION_SHARED, oid);
+    lock_mgr.LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, rid);
+  });
+
+  txn = txn_mgr.Begin();
+  expect_abort(txn, AbortReason::TABLE_UNLOCKED_BEFORE_UNLOCKING_ROWS, [&] {
+    lock_mgr.LockTable(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, oid);
+    lock_mgr.LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, rid);
+    lock_mgr.UnlockTable(txn, oid);
+  });
+
+  txn = txn_mgr.Begin();
+  expect_abort(txn, AbortReason::ATTEMPTED_UNLOCK_BUT_NO_LOCK_HELD, [&] { lock_mgr.UnlockTable(txn, oid); });
+
+  txn = txn_mgr.Begin();
+  expect_abort(txn, AbortReason::INCOMPATIBLE_UPGRADE, [&] {
+    lock_mgr.LockTable(txn, LockManager::LockMode::SHARED_INTENTION_EXCLUSIVE, oid);
+    lock_mgr.LockTable(txn, LockManager::LockMode::SHARED, oid);
+  });
+
+  txn = txn_mgr.Begin(nullptr, IsolationLevel::READ_UNCOMMITTED);
+  expect_abort(txn, AbortReason::LOCK_SHARED_ON_READ_UNCOMMITTED,
+               [&] { lock_mgr.LockTable(txn, LockManager::LockMode::INTENTION_SHARED, oid); });
+
+  /** Under READ_COMMITTED, S locks can still be taken while shrinking */
+  txn = txn_mgr.Begin(nullptr, IsolationLevel::READ_COMMITTED);
+  EXPECT_TRUE(lock_mgr.LockTable(txn, LockManager::LockMode::EXCLUSIVE, oid));
+  EXPECT_TRUE(lock_mgr.UnlockTable(txn, oid));
+  CheckShrinking(txn);
+  EXPECT_TRUE(lock_mgr.LockTable(txn, LockManager::LockMode::SHARED, oid));
+  expect_abort(txn, AbortReason::LOCK_ON_SHRINKING,
+               [&] { lock_mgr.LockTable(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, oid + 1); });
+}
+TEST(LockManagerTest, LockProtocolTest) { LockProtocolTest(); }  // NOLINT
+
+/** Transactions X-lock random rows in ascending order, so that they cannot deadlock, and check they own them */
+void RowLockStressTest() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  table_oid_t oid = 0;
+  const int num_threads = 8;
+  const int num_rows = 256;
+  const int txns_per_thread = 200;
+  const int rows_per_txn = 8;
+  std::vector<std::atomic<int>> owners(num_rows);
+  for (auto &owner : owners) {
+    owner = -1;
+  }
+
+  auto task = [&](int thread_id) {
+    std::mt19937 gen(thread_id);
+    std::uniform_int_distribution<int> dist(0, num_rows - 1);
+    for (int i = 0; i < txns_per_thread; i++) {
+      std::set<int> rows;
+      while (rows.size() < rows_per_txn) {
+        rows.insert(dist(gen));
+      }
+      auto *txn = txn_mgr.Begin();
+      EXPECT_TRUE(lock_mgr.LockTable(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+      for (int row : rows) {
+        RID rid{row / 16, static_cast<uint32_t>(row % 16)};
+        EXPECT_TRUE(lock_mgr.LockRow(txn, LockManager::LockMode::EXCLUSIVE, oid, rid));
+        EXPECT_EQ(owners[row].exchange(thread_id), -1);
+      }
+      CheckTxnRowLockSize(txn, oid, 0, rows_per_txn);
+      for (int row : rows) {
+        owners[row] = -1;
+      }
+      txn_mgr.Commit(txn);
+      delete txn;
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back(task, i);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+TEST(LockManagerTest, RowLockStressTest) { RowLockStressTest(); }  // NOLINT
+
+/** Row locks past the escalation threshold are replaced with a table lock covering them */
+void LockEscalationTest() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  lock_mgr.SetLockEscalationThreshold(4);
+  table_oid_t oid = 0;
+
+  /** X rows escalate to a table X lock */
+  auto *txn0 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn0, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+  for (uint32_t i = 0; i < 3; i++) {
+    EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, oid, RID{0, i}));
+  }
+  CheckTxnRowLockSize(txn0, oid, 0, 3);
+  EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, oid, RID{0, 3}));
+  CheckTxnRowLockSize(txn0, oid, 0, 0);
+  CheckTableLockSizes(txn0, 0, 1, 0, 0, 0);
+  /** Covered rows are neither locked nor unlocked individually, and escalation does not end the growing phase */
+  EXPECT_TRUE(lock_mgr.LockRow(txn0, LockManager::LockMode::EXCLUSIVE, oid, RID{0, 4}));
+  CheckTxnRowLockSize(txn0, oid, 0, 0);
+  EXPECT_TRUE(lock_mgr.UnlockRow(txn0, oid, RID{0, 4}));
+  CheckGrowing(txn0);
+  txn_mgr.Commit(txn0);
+  CheckTableLockSizes(txn0, 0, 0, 0, 0, 0);
+
+  /** S rows under an IX table lock escalate to SIX, once the conflicting IX lock of another transaction is released */
+  auto *txn1 = txn_mgr.Begin();
+  auto *txn2 = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockTable(txn1, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+  EXPECT_TRUE(lock_mgr.LockTable(txn2, LockManager::LockMode::INTENTION_EXCLUSIVE, oid));
+  for (uint32_t i = 0; i < 4; i++) {
+    EXPECT_TRUE(lock_mgr.LockRow(txn1, LockManager::LockMode::SHARED, oid, RID{1, i}));
+  }
+  CheckTxnRowLockSize(txn1, oid, 4, 0);
+  CheckTableLockSizes(txn1, 0, 0, 0, 1, 0);
+  txn_mgr.Commit(txn2);
+  for (uint32_t i = 4; i < 8; i++) {
+    EXPECT_TRUE(lock_mgr.LockRow(txn1, LockManager::LockMode::SHARED, oid, RID{1, i}));
+  }
+  CheckTxnRowLockSize(txn1, oid, 0, 0);
+  CheckTableLockSizes(txn1, 0, 0, 0, 0, 1);
+  /** SIX still lets the transaction X-lock rows */
+  EXPECT_TRUE(lock_mgr.LockRow(txn1, LockManager::LockMode::EXCLUSIVE, oid, RID{1, 0}));
+  CheckTxnRowLockSize(txn1, oid, 0, 1);
+  txn_mgr.Commit(txn1);
+  CheckTxnRowLockSize(txn1, oid, 0, 0);
+  CheckTableLockSizes(txn1, 0, 0, 0, 0, 0);
+
+  for (auto *txn : {txn0, txn1, txn2}) {
+    delete txn;
+  }
+}
+TEST(LockManagerTest, LockEscalationTest) { LockEscalationTest(); }  // NOLINT
+
+/** Key locks of a scanner keep inserts out of the gaps before the keys it read, until it commits */
+void KeyLockTest() {
+  LockManager lock_mgr{};
+  TransactionManager txn_mgr{&lock_mgr};
+  index_oid_t index_oid = 0;
+  int32_t keys[] = {10, 20};
+  auto key_lock = [&](int i) { return LockManager::KeyLockOf(reinterpret_cast<char *>(&keys[i]), sizeof(keys[i])); };
+  EXPECT_NE(key_lock(0), key_lock(1));
+  EXPECT_NE(LockManager::KEY_LOCK_SUPREMUM, key_lock(0));
+
+  /** The scanner reads key 10 and the end of the index */
+  auto *scanner = txn_mgr.Begin();
+  EXPECT_TRUE(lock_mgr.LockKey(scanner, LockManager::LockMode::SHARED, index_oid, key_lock(0)));
+  EXPECT_TRUE(lock_mgr.LockKey(scanner, LockManager::LockMode::SHARED, index_oid, LockManager::KEY_LOCK_SUPREMUM));
+  EXPECT_TRUE(scanner->IsKeySharedLocked(index_oid, key_lock(0)));
+
+  /** An inserter of key 20 locks it, then waits for the gap at the end of the index */
+  auto *inserter = txn_mgr.Begin();
+  std::atomic<bool> gap_locked{false};
+  std::thread insert([&] {
+    EXPECT_TRUE(lock_mgr.LockKey(inserter, LockManager::LockMode::EXCLUSIVE, index_oid, key_lock(1)));
+    EXPECT_TRUE(
+        lock_mgr.LockKey(inserter, LockManager::LockMode::EXCLUSIVE, index_oid, LockManager::KEY_LOCK_SUPREMUM));
+    gap_locked = true;
+    /** Releasing the gap lock once the key is inserted does not end the growing phase */
+    EXPECT_TRUE(lock_mgr.UnlockKey(inserter, index_oid, LockManager::KEY_LOCK_SUPREMUM));
+    CheckGrowing(inserter);
+    EXPECT_TRUE(inserter->IsKeyExclusiveLocked(index_oid, key_lock(1)));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(gap_locked);
+  /** An X lock covers an S request, an S lock is upgraded by an X request */
+  EXPECT_TRUE(lock_mgr.LockKey(scanner, LockManager::LockMode::EXCLUSIVE, index_oid, key_lock(0)));
+  EXPECT_TRUE(lock_mgr.LockKey(scanner, LockManager::LockMode::SHARED, index_oid, key_lock(0)));
+  EXPECT_TRUE(scanner->IsKeyExclusiveLocked(index_oid, key_lock(0)));
+  EXPECT_FALSE(scanner->IsKeySharedLocked(index_oid, key_lock(0)));
+  txn_mgr.Commit(scanner);
+  EXPECT_TRUE(scanner->GetSharedKeyLockSet()->empty());
+  EXPECT_TRUE(scanner->GetExclusiveKeyLockSet()->empty());
+  insert.join();
+  EXPECT_TRUE(gap_locked);
+
+  /** The uncommitted key blocks a new scanner reading it */
+  auto *reader = txn_mgr.Begin();
+  std::atomic<bool> key_read{false};
+  std::thread read([&] {
+    EXPECT_TRUE(lock_mgr.LockKey(reader, LockManager::LockMode::SHARED, index_oid, key_lock(1)));
+    key_read = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(key_read);
+  txn_mgr.Commit(inserter);
+  read.join();
+  EXPECT_TRUE(key_read);
+  txn_mgr.Commit(reader);
+
+  /** Unlocking a key that is not locked aborts */
+  auto *txn = txn_mgr.Begin();
+  EXPECT_THROW(lock_mgr.UnlockKey(txn, index_oid, key_lock(0)), TransactionAbortException);
+  CheckAborted(txn);
+  txn_mgr.Abort(txn);
+
+  for (auto *t : {scanner, inserter, reader, txn}) {
+    delete t;
+  }
+}
+TEST(LockManagerTest, KeyLockTest) { KeyLockTest(); }  // NOLINT
 
 }  // namespace bustub
@@ -12,11 +12,14 @@
 
 #include "concurrency/transaction.h"
 
+#include <algorithm>
 #include <atomic>
 #include <cstdio>
 #include <memory>
 #include <random>
+#include <set>
 #include <string>
+#include <thread>  // NOLINT
 #include <utility>
 #include <vector>
 
@@ -48,7 +51,11 @@ class TransactionTest : public ::testing::Test {
   }
 
   // This function is called after every test.
-  void TearDown() override { remove("executor_test.db"); };
+  void TearDown() override {
+    bustub_.reset();
+    remove("executor_test.db");
+    remove("executor_test.log");
+  };
 
   std::unique_ptr<BustubInstance> bustub_;
 };
@@ -119,4 +126,325 @@ TEST_F(TransactionTest, DISABLED_DirtyReadsTest) {
   delete txn1;
 }
 
+/** @return the rows of a table read by `txn`, one per line, by RID */
+auto ReadRows(BustubInstance *bustub, const std::string &table, Transaction *txn) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true);
+  bustub->ExecuteSqlTxn(fmt::format("SELECT * FROM {}", table), writer, txn);
+  return ss.str();
+}
+
+// NOLINTNEXTLINE
+TEST_F(TransactionTest, SnapshotIsolationTest) {
+  auto noop_writer = NoopWriter();
+  bustub_->ExecuteSql("CREATE TABLE t (x int, y int);", noop_writer);
+  bustub_->ExecuteSql("INSERT INTO t VALUES (1, 10), (2, 20);", noop_writer);
+  auto *table_info = bustub_->catalog_->GetTable("t");
+  auto *table = table_info->table_.get();
+  auto *txn_mgr = bustub_->txn_manager_;
+  auto make_tuple = [&](int x, int y) {
+    return Tuple{{ValueFactory::GetIntegerValue(x), ValueFactory::GetIntegerValue(y)}, &table_info->schema_};
+  };
+  std::vector<RID> rids;
+  auto *txn = txn_mgr->Begin();
+  for (auto it = table->Begin(txn); it != table->End(); ++it) {
+    rids.push_back(it->GetRid());
+  }
+  txn_mgr->Commit(txn);
+  delete txn;
+  ASSERT_EQ(rids.size(), 2);
+
+  // A snapshot does not see the writes of a transaction, before nor after it commits.
+  auto *reader = txn_mgr->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  auto *writer = txn_mgr->Begin();
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(1, 11), rids[0], writer));
+  ASSERT_TRUE(table->MarkDelete(rids[1], writer));
+  bustub_->ExecuteSqlTxn("INSERT INTO t VALUES (3, 30);", noop_writer, writer);
+  EXPECT_EQ(ReadRows(bustub_.get(), "t", writer), "1\t11\t\n3\t30\t\n");
+  EXPECT_EQ(ReadRows(bustub_.get(), "t", reader), "1\t10\t\n2\t20\t\n");
+  txn_mgr->Commit(writer);
+  delete writer;
+  EXPECT_EQ(ReadRows(bustub_.get(), "t", reader), "1\t10\t\n2\t20\t\n");
+  Tuple tuple;
+  ASSERT_TRUE(table->GetTuple(rids[1], &tuple, reader));
+  EXPECT_EQ(tuple.GetValue(&table_info->schema_, 1).GetAs<int32_t>(), 20);
+
+  // A later snapshot does, and the older versions are kept only while the first snapshot runs.
+  auto *later_reader = txn_mgr->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  EXPECT_EQ(ReadRows(bustub_.get(), "t", later_reader), "1\t11\t\n3\t30\t\n");
+  EXPECT_FALSE(table->GetTuple(rids[1], &tuple, later_reader));
+  txn_mgr->Commit(later_reader);
+  delete later_reader;
+  EXPECT_EQ(table->GetVersionStore()->GetChainCount(), 3);
+  txn_mgr->Commit(reader);
+  delete reader;
+  EXPECT_EQ(table->GetVersionStore()->GetChainCount(), 0);
+  EXPECT_EQ(txn_mgr->GetWatermark(), 2);
+
+  // The first updater wins.
+  reader = txn_mgr->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  writer = txn_mgr->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(1, 12), rids[0], writer));
+  EXPECT_FALSE(table->UpdateTuple(make_tuple(1, 13), rids[0], reader));
+  CheckAborted(reader);
+  txn_mgr->Abort(reader);
+  delete reader;
+  txn_mgr->Commit(writer);
+  delete writer;
+  reader = txn_mgr->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  writer = txn_mgr->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(1, 14), rids[0], writer));
+  txn_mgr->Commit(writer);
+  delete writer;
+  EXPECT_FALSE(table->MarkDelete(rids[0], reader));
+  CheckAborted(reader);
+  txn_mgr->Abort(reader);
+  delete reader;
+
+  // An aborted write is never seen, and leaves no version behind.
+  reader = txn_mgr->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  writer = txn_mgr->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(1, 15), rids[0], writer));
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(1, 16), rids[0], writer));
+  bustub_->ExecuteSqlTxn("INSERT INTO t VALUES (4, 40);", noop_writer, writer);
+  EXPECT_EQ(ReadRows(bustub_.get(), "t", reader), "1\t14\t\n3\t30\t\n");
+  txn_mgr->Abort(writer);
+  delete writer;
+  EXPECT_EQ(ReadRows(bustub_.get(), "t", reader), "1\t14\t\n3\t30\t\n");
+  txn_mgr->Commit(reader);
+  delete reader;
+  EXPECT_EQ(table->GetVersionStore()->GetChainCount(), 0);
+}
+
+// NOLINTNEXTLINE
+TEST_F(TransactionTest, OptimisticConcurrencyControlTest) {
+  auto noop_writer = NoopWriter();
+  bustub_->ExecuteSql("CREATE TABLE t (x int, y int);", noop_writer);
+  bustub_->ExecuteSql("INSERT INTO t VALUES (1, 10), (2, 20);", noop_writer);
+  auto *table_info = bustub_->catalog_->GetTable("t");
+  auto *table = table_info->table_.get();
+  auto *txn_mgr = bustub_->txn_manager_;
+  auto make_tuple = [&](int x, int y) {
+    return Tuple{{ValueFactory::GetIntegerValue(x), ValueFactory::GetIntegerValue(y)}, &table_info->schema_};
+  };
+  auto begin_occ = [&] {
+    return txn_mgr->Begin(nullptr, IsolationLevel::REPEATABLE_READ, ConcurrencyControl::OPTIMISTIC);
+  };
+  std::vector<RID> rids;
+  auto *txn = txn_mgr->Begin();
+  for (auto it = table->Begin(txn); it != table->End(); ++it) {
+    rids.push_back(it->GetRid());
+  }
+  txn_mgr->Commit(txn);
+  delete txn;
+  ASSERT_EQ(rids.size(), 2);
+
+  // The writes are buffered: only the writer reads them until it commits. Optimistic transactions take no locks.
+  auto *writer = begin_occ();
+  ASSERT_TRUE(bustub_->lock_manager_->LockTable(writer, LockManager::LockMode::EXCLUSIVE, table_info->oid_));
+  EXPECT_TRUE(writer->GetExclusiveTableLockSet()->empty());
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(1, 11), rids[0], writer));
+  ASSERT_TRUE(table->MarkDelete(rids[1], writer));
+  EXPECT_EQ(ReadRows(bustub_.get(), "t", writer), "1\t11\t\n");
+  auto *reader = txn_mgr->Begin();
+  EXPECT_EQ(ReadRows(bustub_.get(), "t", reader), "1\t10\t\n2\t20\t\n");
+  txn_mgr->Commit(reader);
+  delete reader;
+  txn_mgr->Commit(writer);
+  EXPECT_EQ(writer->GetState(), TransactionState::COMMITTED);
+  // The records of the transaction were dropped along with its arena.
+  EXPECT_TRUE(writer->GetWriteSet()->empty());
+  EXPECT_EQ(writer->GetArena()->GetAllocatedSize(), 0);
+  delete writer;
+  reader = txn_mgr->Begin();
+  EXPECT_EQ(ReadRows(bustub_.get(), "t", reader), "1\t11\t\n");
+  txn_mgr->Commit(reader);
+  delete reader;
+
+  // A transaction whose read was overwritten before it commits fails validation, and its writes are not installed.
+  bustub_->ExecuteSql("INSERT INTO t VALUES (3, 30);", noop_writer);
+  rids.clear();
+  txn = txn_mgr->Begin();
+  for (auto it = table->Begin(txn); it != table->End(); ++it) {
+    rids.push_back(it->GetRid());
+  }
+  txn_mgr->Commit(txn);
+  delete txn;
+  ASSERT_EQ(rids.size(), 2);
+  reader = begin_occ();
+  writer = begin_occ();
+  Tuple tuple;
+  ASSERT_TRUE(table->GetTuple(rids[0], &tuple, reader));
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(3, 31), rids[1], reader));
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(1, 12), rids[0], writer));
+  txn_mgr->Commit(writer);
+  EXPECT_EQ(writer->GetState(), TransactionState::COMMITTED);
+  delete writer;
+  txn_mgr->Commit(reader);
+  CheckAborted(reader);
+  delete reader;
+  txn = txn_mgr->Begin();
+  EXPECT_EQ(ReadRows(bustub_.get(), "t", txn), "1\t12\t\n3\t30\t\n");
+
+  // Reading a tuple written by a transaction that has not committed yet aborts the reader.
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(3, 32), rids[1], txn));
+  reader = begin_occ();
+  EXPECT_FALSE(table->GetTuple(rids[1], &tuple, reader));
+  CheckAborted(reader);
+  txn_mgr->Commit(reader);
+  CheckAborted(reader);
+  delete reader;
+
+  // A read overwritten by a lock-based transaction fails validation too.
+  reader = begin_occ();
+  ASSERT_TRUE(table->GetTuple(rids[0], &tuple, reader));
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(1, 13), rids[0], txn));
+  txn_mgr->Commit(txn);
+  delete txn;
+  txn_mgr->Commit(reader);
+  CheckAborted(reader);
+  delete reader;
+
+  // A transaction whose reads are unchanged commits.
+  reader = begin_occ();
+  ASSERT_TRUE(table->GetTuple(rids[0], &tuple, reader));
+  ASSERT_TRUE(table->UpdateTuple(make_tuple(3, 33), rids[1], reader));
+  txn_mgr->Commit(reader);
+  EXPECT_EQ(reader->GetState(), TransactionState::COMMITTED);
+  delete reader;
+  txn = txn_mgr->Begin();
+  EXPECT_EQ(ReadRows(bustub_.get(), "t", txn), "1\t13\t\n3\t33\t\n");
+  txn_mgr->Commit(txn);
+  delete txn;
+}
+
+// NOLINTNEXTLINE
+TEST_F(TransactionTest, TransactionMapTest) {
+  auto *txn_mgr = bustub_->txn_manager_;
+
+  // More running transactions than slots in the map: the newest ones overflow.
+  std::vector<Transaction *> txns;
+  for (int i = 0; i < TXN_MAP_SLOTS + 100; i++) {
+    txns.push_back(txn_mgr->Begin());
+  }
+  for (auto *txn : txns) {
+    ASSERT_EQ(TransactionManager::GetTransaction(txn->GetTransactionId()), txn);
+  }
+  // Committing the oldest frees slots for the next ones, while the overflowed ones are still found.
+  for (int i = 0; i < 100; i++) {
+    txn_mgr->Commit(txns[i]);
+    delete txns[i];
+  }
+  txns.erase(txns.begin(), txns.begin() + 100);
+  for (int i = 0; i < 100; i++) {
+    txns.push_back(txn_mgr->Begin());
+  }
+  for (auto *txn : txns) {
+    ASSERT_EQ(TransactionManager::GetTransaction(txn->GetTransactionId()), txn);
+    txn_mgr->Abort(txn);
+    delete txn;
+  }
+
+  // Threads take ids from their own batches: they never collide, and follow the order of Begin within a thread.
+  const int num_threads = 4;
+  std::vector<std::vector<txn_id_t>> txn_ids(num_threads);
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&, i] {
+      for (int j = 0; j < 3 * TXN_ID_BATCH_SIZE; j++) {
+        auto *txn = txn_mgr->Begin();
+        EXPECT_EQ(TransactionManager::GetTransaction(txn->GetTransactionId()), txn);
+        txn_ids[i].push_back(txn->GetTransactionId());
+        txn_mgr->Commit(txn);
+        delete txn;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::set<txn_id_t> all_txn_ids;
+  for (const auto &thread_txn_ids : txn_ids) {
+    EXPECT_TRUE(std::is_sorted(thread_txn_ids.begin(), thread_txn_ids.end()));
+    all_txn_ids.insert(thread_txn_ids.begin(), thread_txn_ids.end());
+  }
+  EXPECT_EQ(all_txn_ids.size(), num_threads * 3 * TXN_ID_BATCH_SIZE);
+}
+
+// NOLINTNEXTLINE
+TEST_F(TransactionTest, EarlyLockReleaseTest) {
+  auto noop_writer = NoopWriter();
+  bustub_->ExecuteSql("CREATE TABLE t (x int, y int);", noop_writer);
+  bustub_->ExecuteSql("INSERT INTO t VALUES (1, 0);", noop_writer);
+  auto *table_info = bustub_->catalog_->GetTable("t");
+  auto *table = table_info->table_.get();
+  auto *txn_mgr = bustub_->txn_manager_;
+  auto *lock_mgr = bustub_->lock_manager_;
+  auto *log_mgr = bustub_->log_manager_;
+  auto *txn = txn_mgr->Begin();
+  RID rid = table->Begin(txn)->GetRid();
+  txn_mgr->Commit(txn);
+  delete txn;
+
+  log_mgr->RunFlushThread();
+  txn_mgr->SetEarlyLockRelease(true);
+  auto increment = [&](Transaction *txn) {
+    ASSERT_TRUE(lock_mgr->LockTable(txn, LockManager::LockMode::INTENTION_EXCLUSIVE, table_info->oid_));
+    ASSERT_TRUE(lock_mgr->LockRow(txn, LockManager::LockMode::EXCLUSIVE, table_info->oid_, rid));
+    Tuple tuple;
+    ASSERT_TRUE(table->GetTuple(rid, &tuple, txn));
+    auto y = tuple.GetValue(&table_info->schema_, 1).GetAs<int32_t>();
+    Tuple new_tuple{{ValueFactory::GetIntegerValue(1), ValueFactory::GetIntegerValue(y + 1)}, &table_info->schema_};
+    ASSERT_TRUE(table->UpdateTuple(new_tuple, rid, txn));
+  };
+
+  // A writer waits for its own commit record, and the next holder of its lock inherits that wait, even though the
+  // queue of the row was dropped in between.
+  auto *writer = txn_mgr->Begin();
+  increment(writer);
+  txn_mgr->Commit(writer);
+  auto commit_lsn = writer->GetPrevLSN();
+  EXPECT_EQ(writer->GetDependencyLSN(), commit_lsn);
+  EXPECT_GE(log_mgr->GetPersistentLSN(), commit_lsn);
+  auto *reader = txn_mgr->Begin();
+  ASSERT_TRUE(lock_mgr->LockTable(reader, LockManager::LockMode::INTENTION_SHARED, table_info->oid_));
+  ASSERT_TRUE(lock_mgr->LockRow(reader, LockManager::LockMode::SHARED, table_info->oid_, rid));
+  EXPECT_EQ(reader->GetDependencyLSN(), commit_lsn);
+  txn_mgr->Commit(reader);
+  // A read-only transaction does not wait for its own commit record, nor passes it on.
+  EXPECT_EQ(reader->GetDependencyLSN(), commit_lsn);
+  delete writer;
+  delete reader;
+
+  // Every commit of the hot row is acknowledged only once the commits it saw are persistent.
+  const int num_threads = 4;
+  const int num_txns = 50;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; i++) {
+    threads.emplace_back([&] {
+      for (int j = 0; j < num_txns; j++) {
+        auto *txn = txn_mgr->Begin();
+        increment(txn);
+        auto lsn_before = log_mgr->GetNextLSN();
+        txn_mgr->Commit(txn);
+        EXPECT_GE(txn->GetDependencyLSN(), lsn_before);
+        EXPECT_GE(log_mgr->GetPersistentLSN(), txn->GetDependencyLSN());
+        delete txn;
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  log_mgr->StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+
+  txn = txn_mgr->Begin();
+  Tuple tuple;
+  ASSERT_TRUE(table->GetTuple(rid, &tuple, txn));
+  EXPECT_EQ(tuple.GetValue(&table_info->schema_, 1).GetAs<int32_t>(), 1 + num_threads * num_txns);
+  txn_mgr->Commit(txn);
+  delete txn;
+}
+
 }  // namespace bustub
@@ -0,0 +1,81 @@
+/**
+ * flat_hash_table_test.cpp
+ */
+
+#include <array>
+#include <random>
+#include <unordered_set>
+#include <vector>
+
+#include "common/arena.h"
+#include "common/rid.h"
+#include "container/hash/flat_hash_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(FlatHashTableTest, SampleTest) {
+  Arena arena;
+  FlatHashMap<uint32_t, FlatHashSet<RID>> row_lock_set(&arena);
+
+  row_lock_set[1].insert(RID(0, 1));
+  row_lock_set[1].insert(RID(0, 2));
+  row_lock_set[1].insert(RID(0, 1));
+  row_lock_set[2].insert(RID(3, 4));
+  EXPECT_EQ(2, row_lock_set.size());
+  EXPECT_EQ(2, row_lock_set[1].size());
+  EXPECT_EQ(1, row_lock_set[1].count(RID(0, 2)));
+  EXPECT_EQ(0, row_lock_set[2].count(RID(0, 2)));
+  EXPECT_EQ(row_lock_set.end(), row_lock_set.find(3));
+
+  auto it = row_lock_set.find(1);
+  ASSERT_NE(row_lock_set.end(), it);
+  EXPECT_EQ(1, it->second.erase(RID(0, 1)));
+  EXPECT_EQ(0, it->second.erase(RID(0, 1)));
+  EXPECT_EQ(1, it->second.erase(RID(0, 2)));
+  EXPECT_TRUE(it->second.empty());
+  row_lock_set.erase(it);
+  EXPECT_EQ(1, row_lock_set.size());
+
+  std::vector<RID> rids;
+  for (const auto &[oid, rid_set] : row_lock_set) {
+    EXPECT_EQ(2, oid);
+    rids.insert(rids.end(), rid_set.begin(), rid_set.end());
+  }
+  EXPECT_EQ(std::vector<RID>{RID(3, 4)}, rids);
+}
+
+TEST(FlatHashTableTest, RandomInsertEraseTest) {
+  std::array<std::byte, 1024> block;
+  Arena arena(block.data(), block.size());
+  std::mt19937 gen(15445);
+  // A narrow key range makes long probe runs, which erasing has to shift back correctly.
+  std::uniform_int_distribution<int> key_dist(0, 511);
+
+  for (int round = 0; round < 3; round++) {
+    FlatHashSet<int> set(&arena);
+    std::unordered_set<int> expected;
+    for (int i = 0; i < 20000; i++) {
+      auto key = key_dist(gen);
+      if (gen() % 3 == 0) {
+        EXPECT_EQ(expected.erase(key), set.erase(key));
+      } else {
+        EXPECT_EQ(expected.insert(key).second, set.insert(key).second);
+      }
+      ASSERT_EQ(expected.size(), set.size());
+    }
+    for (int key = 0; key < 512; key++) {
+      EXPECT_EQ(expected.count(key), set.count(key));
+    }
+    std::unordered_set<int> iterated(set.begin(), set.end());
+    EXPECT_EQ(expected, iterated);
+
+    // The set outgrew the first block, which is all that is left after the reset.
+    EXPECT_GT(arena.GetHeapBlockCount(), 0);
+    arena.Reset();
+    EXPECT_EQ(0, arena.GetHeapBlockCount());
+    EXPECT_EQ(0, arena.GetAllocatedSize());
+  }
+}
+
+}  // namespace bustub
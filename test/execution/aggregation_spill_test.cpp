@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// aggregation_spill_test.cpp
+//
+// Identification: test/execution/aggregation_spill_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <sstream>
+#include <string>
+
+#include "common/bustub_instance.h"
+#include "common/util/string_util.h"
+#include "fmt/format.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+static auto Capture(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true);
+  bustub->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+// NOLINTNEXTLINE
+TEST(AggregationSpillTest, SpilledGroupsMergeBack) {
+  auto bustub = std::make_unique<BustubInstance>();
+  bustub->GenerateMockTable();
+  // x runs over 0..499999 twice, so each group holds two rows with x = g.
+  const std::string groups = "select x as g, count(*) as c, sum(x) as s from __mock_t4_1m where x < 50000 group by x";
+  const std::string check =
+      "select count(*), sum(c), min(c), max(c), min(s - g - g), max(s - g - g) from (" + groups + ");";
+  const std::string expected = "50000\t100000\t2\t2\t0\t0\t\n";
+
+  // With the default threshold, the groups fit in memory.
+  EXPECT_EQ(expected, Capture(bustub.get(), check));
+
+  // A tiny threshold makes every worker spill its partial groups many times over.
+  Capture(bustub.get(), "set aggregation_spill_threshold=64;");
+  auto output = Capture(bustub.get(), "explain analyze " + groups + ";");
+  EXPECT_TRUE(StringUtil::Contains(output, "spilled_pages=")) << output;
+  EXPECT_TRUE(StringUtil::Contains(output, ", 50000 rows")) << output;
+  EXPECT_EQ(expected, Capture(bustub.get(), check));
+
+  // Low cardinality: the few groups stay in the local tables of the workers, which merge them back in phase two.
+  std::string low;
+  for (int v1 = 0; v1 < 10; v1++) {
+    // v1 is (cursor + 2) % 10 over 10000 rows, and v2 is the cursor.
+    low += fmt::format("{}\t1000\t{}\t{}\t\n", v1, (v1 + 8) % 10, 9990 + (v1 + 8) % 10);
+  }
+  EXPECT_EQ(low, Capture(bustub.get(),
+                         "select v1, count(*), min(v2), max(v2) from __mock_agg_input_big group by v1 order by v1;"));
+}
+
+}  // namespace bustub
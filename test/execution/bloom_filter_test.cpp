@@ -0,0 +1,116 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// bloom_filter_test.cpp
+//
+// Identification: test/execution/bloom_filter_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+#include "execution/bloom_filter.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+static auto HashOf(int32_t key) -> hash_t {
+  return RuntimeFilter::HashKey(ValueFactory::GetIntegerValue(key));
+}
+
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, NoFalseNegatives) {
+  constexpr int32_t key_cnt = 10000;
+  BlockedBloomFilter filter(key_cnt, RUNTIME_FILTER_BITS_PER_KEY);
+  for (int32_t i = 0; i < key_cnt; i++) {
+    filter.Insert(HashOf(i * 7));
+  }
+  for (int32_t i = 0; i < key_cnt; i++) {
+    ASSERT_TRUE(filter.MayContain(HashOf(i * 7))) << i * 7;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, FalsePositiveRate) {
+  constexpr int32_t key_cnt = 10000;
+  BlockedBloomFilter filter(key_cnt, RUNTIME_FILTER_BITS_PER_KEY);
+  for (int32_t i = 0; i < key_cnt; i++) {
+    filter.Insert(HashOf(i));
+  }
+  int false_positives = 0;
+  for (int32_t i = key_cnt; i < key_cnt * 11; i++) {
+    false_positives += static_cast<int>(filter.MayContain(HashOf(i)));
+  }
+  // About 0.5% are expected; leave some room for the hash.
+  EXPECT_LT(false_positives, key_cnt * 10 / 50);
+}
+
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, EmptyFilterRejectsEverything) {
+  BlockedBloomFilter filter(0, RUNTIME_FILTER_BITS_PER_KEY);
+  EXPECT_EQ(filter.SizeInBytes(), 32);
+  for (int32_t i = 0; i < 1000; i++) {
+    ASSERT_FALSE(filter.MayContain(HashOf(i)));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, RuntimeFilterDropsNonMatchingTuples) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+  BlockedBloomFilter bloom(2, RUNTIME_FILTER_BITS_PER_KEY);
+  auto one = ValueFactory::GetVarcharValue("one");
+  auto three = ValueFactory::GetVarcharValue("three");
+  bloom.Insert(RuntimeFilter::HashKey(one));
+  bloom.Insert(RuntimeFilter::HashKey(three));
+  RuntimeFilter filter(nullptr, 1, std::move(bloom));
+
+  std::vector<std::string> names{"one", "two", "three", "four"};
+  std::vector<bool> passed;
+  for (size_t i = 0; i < names.size(); i++) {
+    Tuple tuple({ValueFactory::GetIntegerValue(static_cast<int32_t>(i)), ValueFactory::GetVarcharValue(names[i])},
+                &schema);
+    passed.push_back(filter.Check(tuple, schema));
+  }
+  Tuple null_tuple({ValueFactory::GetIntegerValue(4), ValueFactory::GetNullValueByType(TypeId::VARCHAR)}, &schema);
+  passed.push_back(filter.Check(null_tuple, schema));
+
+  EXPECT_TRUE(passed[0]);
+  EXPECT_TRUE(passed[2]);
+  EXPECT_FALSE(passed[4]);
+  EXPECT_EQ(filter.RowsChecked(), 5);
+  EXPECT_EQ(filter.RowsEliminated(), std::count(passed.begin(), passed.end(), false));
+  EXPECT_GE(filter.RowsEliminated(), 1);
+}
+
+// NOLINTNEXTLINE
+TEST(BloomFilterTest, RuntimeFilterStopsWhenUnselective) {
+  Schema schema({Column("a", TypeId::INTEGER)});
+  BlockedBloomFilter bloom(RUNTIME_FILTER_SAMPLE_SIZE, RUNTIME_FILTER_BITS_PER_KEY);
+  // Every other key matches, which is selective enough.
+  for (int32_t i = 0; i < RUNTIME_FILTER_SAMPLE_SIZE * 2; i += 2) {
+    bloom.Insert(HashOf(i));
+  }
+  RuntimeFilter filter(nullptr, 0, bloom);
+  for (int32_t i = 0; i < RUNTIME_FILTER_SAMPLE_SIZE * 2; i++) {
+    filter.Check(Tuple({ValueFactory::GetIntegerValue(i)}, &schema), schema);
+  }
+  EXPECT_FALSE(filter.IsDisabled());
+
+  // Almost every key matches: after the sample, the filter lets everything through without checking.
+  RuntimeFilter unselective(nullptr, 0, bloom);
+  for (int32_t i = 0; i < RUNTIME_FILTER_SAMPLE_SIZE; i++) {
+    unselective.Check(Tuple({ValueFactory::GetIntegerValue(i % 2 == 0 ? i : 0)}, &schema), schema);
+  }
+  EXPECT_TRUE(unselective.IsDisabled());
+  EXPECT_TRUE(unselective.Check(Tuple({ValueFactory::GetIntegerValue(1)}, &schema), schema));
+  EXPECT_EQ(unselective.RowsChecked(), RUNTIME_FILTER_SAMPLE_SIZE);
+}
+
+}  // namespace bustub
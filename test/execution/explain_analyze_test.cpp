@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// explain_analyze_test.cpp
+//
+// Identification: test/execution/explain_analyze_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <sstream>
+#include <string>
+
+#include "common/bustub_instance.h"
+#include "common/util/string_util.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+static auto Capture(BustubInstance *bustub, const std::string &sql) -> std::string {
+  std::stringstream ss;
+  auto writer = SimpleStreamWriter(ss, true);
+  bustub->ExecuteSql(sql, writer);
+  return ss.str();
+}
+
+// NOLINTNEXTLINE
+TEST(ExplainAnalyzeTest, CountsRowsAndCalls) {
+  auto bustub = std::make_unique<BustubInstance>();
+  Capture(bustub.get(), "create table t1(x int, y int);");
+  Capture(bustub.get(), "create table t2(x int, y int);");
+  Capture(bustub.get(), "insert into t1 values (1, 10), (2, 20), (3, 30), (4, 40);");
+  Capture(bustub.get(), "insert into t2 values (1, 100), (3, 300);");
+
+  auto output = Capture(bustub.get(), "explain analyze select t1.y, t2.y from t1, t2 where t1.x = t2.x and t1.y > 5;");
+  EXPECT_TRUE(StringUtil::StartsWith(output, "=== ANALYZE ===")) << output;
+  EXPECT_TRUE(StringUtil::Contains(output, "HashJoin { type=Inner, left_key=#0.0, right_key=#0.0 } (rows=2 next=3 init=1"))
+      << output;
+  EXPECT_TRUE(StringUtil::Contains(output, "SeqScan { table=t2 } (rows=2 next=3 init=1")) << output;
+  EXPECT_TRUE(StringUtil::Contains(output, "SeqScan { table=t1, filter=(#0.1>5) } (rows=4 next=5 init=1")) << output;
+  EXPECT_TRUE(StringUtil::Contains(output, "Execution time: ")) << output;
+  EXPECT_TRUE(StringUtil::Contains(output, ", 2 rows")) << output;
+  // The scans fetch their pages, which are still in the buffer pool after the inserts.
+  EXPECT_FALSE(StringUtil::Contains(output, "bp_hits=0 ")) << output;
+  EXPECT_TRUE(StringUtil::Contains(output, "pages_read=0 ")) << output;
+
+  // EXPLAIN ANALYZE runs the statement.
+  Capture(bustub.get(), "explain analyze insert into t2 values (5, 500);");
+  EXPECT_EQ("1\t\n3\t\n5\t\n", Capture(bustub.get(), "select x from t2 order by x;"));
+}
+
+// NOLINTNEXTLINE
+TEST(ExplainAnalyzeTest, ShowsRuntimeFilters) {
+  auto bustub = std::make_unique<BustubInstance>();
+  Capture(bustub.get(), "create table fact(id int, dim1_id int, dim2_id int);");
+  Capture(bustub.get(), "create table dim1(id int, name varchar(16));");
+  Capture(bustub.get(), "create table dim2(id int, region int);");
+  Capture(bustub.get(), "insert into fact values (0, 0, 0), (1, 1, 0), (2, 2, 1), (3, 0, 1), (4, 1, 2), (5, 2, 2);");
+  Capture(bustub.get(), "insert into dim1 values (0, 'red'), (1, 'green'), (2, 'blue');");
+  Capture(bustub.get(), "insert into dim2 values (0, 100), (1, 200), (2, 300);");
+
+  auto output = Capture(bustub.get(),
+                    "explain analyze select dim1.name, dim2.region from fact, dim1, dim2 "
+                    "where fact.dim1_id = dim1.id and fact.dim2_id = dim2.id and dim1.name = 'green' and dim2.region = 100;");
+  EXPECT_TRUE(StringUtil::Contains(output, "(runtime_filter checked=6 eliminated=4)")) << output;
+  EXPECT_TRUE(StringUtil::Contains(output, ", 1 rows")) << output;
+}
+
+}  // namespace bustub
@@ -0,0 +1,237 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// expression_compiler_test.cpp
+//
+// Identification: test/execution/expression_compiler_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "execution/expression_compiler.h"
+#include "execution/expressions/arithmetic_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class ExpressionCompilerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    std::mt19937 gen(15445);
+    std::uniform_int_distribution<int> small(-10, 10);
+    auto maybe_null = [&](TypeId type, const Value &value) {
+      return small(gen) == 0 ? ValueFactory::GetNullValueByType(type) : value;
+    };
+    for (int i = 0; i < 3000; i++) {
+      std::vector<Value> values{
+          maybe_null(TypeId::INTEGER, ValueFactory::GetIntegerValue(small(gen))),
+          maybe_null(TypeId::INTEGER, ValueFactory::GetIntegerValue(small(gen))),
+          maybe_null(TypeId::INTEGER, ValueFactory::GetIntegerValue(small(gen) * 2)),
+          maybe_null(TypeId::BIGINT, ValueFactory::GetBigIntValue(small(gen) * (1LL << 40))),
+          maybe_null(TypeId::DECIMAL, ValueFactory::GetDecimalValue(small(gen) * 0.5)),
+          maybe_null(TypeId::BOOLEAN, ValueFactory::GetBooleanValue(small(gen) > 0)),
+          ValueFactory::GetVarcharValue("bustub"),
+      };
+      batch_.emplace_back(values, &schema_);
+    }
+  }
+
+  static auto Col(uint32_t idx, TypeId type) -> AbstractExpressionRef {
+    return std::make_shared<ColumnValueExpression>(0, idx, type);
+  }
+  static auto Const(const Value &val) -> AbstractExpressionRef { return std::make_shared<ConstantValueExpression>(val); }
+  static auto Cmp(AbstractExpressionRef lhs, AbstractExpressionRef rhs, ComparisonType type)
+      -> AbstractExpressionRef {
+    return std::make_shared<ComparisonExpression>(std::move(lhs), std::move(rhs), type);
+  }
+  static auto Logic(AbstractExpressionRef lhs, AbstractExpressionRef rhs, LogicType type) -> AbstractExpressionRef {
+    return std::make_shared<LogicExpression>(std::move(lhs), std::move(rhs), type);
+  }
+  static auto Arith(AbstractExpressionRef lhs, AbstractExpressionRef rhs, ArithmeticType type)
+      -> AbstractExpressionRef {
+    return std::make_shared<ArithmeticExpression>(std::move(lhs), std::move(rhs), type);
+  }
+
+  /** Check the compiled expression against the interpreted one, both as a projection and as a filter. */
+  void ExpectSameResults(const AbstractExpressionRef &expr) {
+    auto compiled = CompiledExpression::Compile(*expr, schema_);
+    ASSERT_NE(compiled, nullptr) << expr->ToString();
+    std::vector<Value> values;
+    compiled->Evaluate(batch_, &values);
+    ASSERT_EQ(values.size(), batch_.size());
+    std::vector<uint32_t> expected_selection;
+    for (uint32_t i = 0; i < batch_.size(); i++) {
+      auto expected = expr->Evaluate(&batch_[i], schema_);
+      ASSERT_EQ(expected.IsNull(), values[i].IsNull()) << expr->ToString() << " at row " << i;
+      if (!expected.IsNull()) {
+        ASSERT_EQ(expected.GetTypeId(), values[i].GetTypeId());
+        ASSERT_EQ(expected.CompareEquals(values[i]), CmpBool::CmpTrue) << expr->ToString() << " at row " << i;
+      }
+      if (expr->GetReturnType() == TypeId::BOOLEAN && !expected.IsNull() && expected.GetAs<bool>()) {
+        expected_selection.push_back(i);
+      }
+    }
+    if (expr->GetReturnType() == TypeId::BOOLEAN) {
+      std::vector<uint32_t> selection;
+      compiled->Filter(batch_, &selection);
+      ASSERT_EQ(expected_selection, selection) << expr->ToString();
+    }
+  }
+
+  Schema schema_{{Column("a", TypeId::INTEGER), Column("b", TypeId::INTEGER), Column("c", TypeId::INTEGER),
+                  Column("d", TypeId::BIGINT), Column("e", TypeId::DECIMAL), Column("f", TypeId::BOOLEAN),
+                  Column("g", TypeId::VARCHAR, 16)}};
+  std::vector<Tuple> batch_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(ExpressionCompilerTest, ConjunctivePredicate) {
+  // a > 5 AND b < 10 AND a + b = c
+  auto a = Col(0, TypeId::INTEGER);
+  auto b = Col(1, TypeId::INTEGER);
+  auto c = Col(2, TypeId::INTEGER);
+  auto expr = Logic(Logic(Cmp(a, Const(ValueFactory::GetIntegerValue(5)), ComparisonType::GreaterThan),
+                          Cmp(b, Const(ValueFactory::GetIntegerValue(10)), ComparisonType::LessThan), LogicType::And),
+                    Cmp(Arith(a, b, ArithmeticType::Plus), c, ComparisonType::Equal), LogicType::And);
+  ExpectSameResults(expr);
+
+  // `a` and `b` are decoded once although they are referenced twice.
+  auto compiled = CompiledExpression::Compile(*expr, schema_);
+  ASSERT_EQ(compiled->GetProgramSize(), 11U);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExpressionCompilerTest, NullsAndThreeValuedLogic) {
+  auto a = Col(0, TypeId::INTEGER);
+  auto b = Col(1, TypeId::INTEGER);
+  auto f = Col(5, TypeId::BOOLEAN);
+  auto null_int = Const(ValueFactory::GetNullValueByType(TypeId::INTEGER));
+  for (auto logic_type : {LogicType::And, LogicType::Or}) {
+    ExpectSameResults(Logic(Cmp(a, b, ComparisonType::LessThanOrEqual), f, logic_type));
+    ExpectSameResults(Logic(Cmp(a, null_int, ComparisonType::Equal), Cmp(b, a, ComparisonType::NotEqual), logic_type));
+  }
+  ExpectSameResults(Cmp(f, Const(ValueFactory::GetBooleanValue(true)), ComparisonType::Equal));
+  ExpectSameResults(Arith(a, null_int, ArithmeticType::Minus));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExpressionCompilerTest, MixedTypes) {
+  auto a = Col(0, TypeId::INTEGER);
+  auto d = Col(3, TypeId::BIGINT);
+  auto e = Col(4, TypeId::DECIMAL);
+  for (auto comp_type : {ComparisonType::Equal, ComparisonType::NotEqual, ComparisonType::LessThan,
+                         ComparisonType::LessThanOrEqual, ComparisonType::GreaterThan,
+                         ComparisonType::GreaterThanOrEqual}) {
+    ExpectSameResults(Cmp(a, d, comp_type));
+    ExpectSameResults(Cmp(e, a, comp_type));
+    ExpectSameResults(Cmp(d, Const(ValueFactory::GetDecimalValue(0.5)), comp_type));
+  }
+  ExpectSameResults(e);
+  ExpectSameResults(Arith(a, Const(ValueFactory::GetIntegerValue(7)), ArithmeticType::Minus));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExpressionCompilerTest, CommonSubexpressions) {
+  // a + 1 > 5 AND a + 1 < 10
+  auto a = Col(0, TypeId::INTEGER);
+  auto expr = Logic(Cmp(Arith(a, Const(ValueFactory::GetIntegerValue(1)), ArithmeticType::Plus),
+                        Const(ValueFactory::GetIntegerValue(5)), ComparisonType::GreaterThan),
+                    Cmp(Arith(a, Const(ValueFactory::GetIntegerValue(1)), ArithmeticType::Plus),
+                        Const(ValueFactory::GetIntegerValue(10)), ComparisonType::LessThan),
+                    LogicType::And);
+  ExpectSameResults(expr);
+  // a, 1, a + 1, 5, >, 10, <, AND: the second `a + 1` is the first one.
+  ASSERT_EQ(CompiledExpression::Compile(*expr, schema_)->GetProgramSize(), 8U);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExpressionCompilerTest, SharedProgram) {
+  // a + b, a + b - c, g = 'bustub' and c - 2 over one program
+  auto a = Col(0, TypeId::INTEGER);
+  auto b = Col(1, TypeId::INTEGER);
+  auto c = Col(2, TypeId::INTEGER);
+  auto g = Col(6, TypeId::VARCHAR);
+  std::vector<AbstractExpressionRef> exprs{
+      Arith(a, b, ArithmeticType::Plus), Arith(Arith(a, b, ArithmeticType::Plus), c, ArithmeticType::Minus),
+      Cmp(g, Const(ValueFactory::GetVarcharValue("bustub")), ComparisonType::Equal),
+      Arith(c, Const(ValueFactory::GetIntegerValue(2)), ArithmeticType::Minus)};
+  auto compiled = CompiledExpression::CompileAll(exprs, schema_);
+  ASSERT_NE(compiled, nullptr);
+  ASSERT_TRUE(compiled->IsCompiled(0));
+  ASSERT_TRUE(compiled->IsCompiled(1));
+  ASSERT_FALSE(compiled->IsCompiled(2));
+  ASSERT_TRUE(compiled->IsCompiled(3));
+  // a, b, a + b, c, - for the first two expressions, and 2, - for the last one.
+  ASSERT_EQ(compiled->GetProgramSize(), 7U);
+
+  std::vector<std::vector<Value>> values;
+  compiled->EvaluateAll(batch_, &values);
+  ASSERT_EQ(values.size(), exprs.size());
+  ASSERT_TRUE(values[2].empty());
+  for (size_t e : {0, 1, 3}) {
+    ASSERT_EQ(values[e].size(), batch_.size());
+    for (size_t i = 0; i < batch_.size(); i++) {
+      auto expected = exprs[e]->Evaluate(&batch_[i], schema_);
+      ASSERT_EQ(expected.IsNull(), values[e][i].IsNull()) << exprs[e]->ToString() << " at row " << i;
+      if (!expected.IsNull()) {
+        ASSERT_EQ(expected.CompareEquals(values[e][i]), CmpBool::CmpTrue) << exprs[e]->ToString() << " at row " << i;
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExpressionCompilerTest, UnsupportedExpression) {
+  auto g = Col(6, TypeId::VARCHAR);
+  auto expr = Cmp(g, Const(ValueFactory::GetVarcharValue("bustub")), ComparisonType::Equal);
+  ASSERT_EQ(CompiledExpression::Compile(*expr, schema_), nullptr);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExpressionCompilerTest, JoinPredicate) {
+  // left.a + 1 < right.b AND left.e <> right.e AND left.c > 0, over blocks of left tuples
+  auto left_a = Col(0, TypeId::INTEGER);
+  auto left_c = Col(2, TypeId::INTEGER);
+  auto left_e = Col(4, TypeId::DECIMAL);
+  auto right_b = std::make_shared<ColumnValueExpression>(1, 1, TypeId::INTEGER);
+  auto right_e = std::make_shared<ColumnValueExpression>(1, 4, TypeId::DECIMAL);
+  auto expr = Logic(Logic(Cmp(Arith(left_a, Const(ValueFactory::GetIntegerValue(1)), ArithmeticType::Plus), right_b,
+                              ComparisonType::LessThan),
+                          Cmp(left_e, right_e, ComparisonType::NotEqual), LogicType::And),
+                    Cmp(left_c, Const(ValueFactory::GetIntegerValue(0)), ComparisonType::GreaterThan), LogicType::And);
+  auto compiled = CompiledExpression::CompileJoin(*expr, schema_, schema_);
+  ASSERT_NE(compiled, nullptr);
+  ASSERT_EQ(CompiledExpression::Compile(*expr, schema_), nullptr);
+
+  for (size_t begin = 0; begin < batch_.size(); begin += 1000) {
+    std::vector<Tuple> block(batch_.begin() + begin, batch_.begin() + begin + 1000);
+    compiled->SetJoinBlock(block);
+    for (size_t r = 0; r < 50; r++) {
+      const auto &right = batch_[r];
+      std::vector<uint32_t> expected_selection;
+      for (uint32_t i = 0; i < block.size(); i++) {
+        auto expected = expr->EvaluateJoin(&block[i], schema_, &right, schema_);
+        if (!expected.IsNull() && expected.GetAs<bool>()) {
+          expected_selection.push_back(i);
+        }
+      }
+      std::vector<uint32_t> selection;
+      compiled->FilterJoin(right, &selection);
+      ASSERT_EQ(expected_selection, selection) << "block " << begin << ", right tuple " << r;
+    }
+  }
+}
+
+}  // namespace bustub
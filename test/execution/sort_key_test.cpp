@@ -0,0 +1,131 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key_test.cpp
+//
+// Identification: test/execution/sort_key_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <memory>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/sort_key.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** Reference comparison through the type system, with NULL sorting as the smallest value. */
+static auto ReferenceCompare(const Value &lhs, const Value &rhs) -> int {
+  if (lhs.IsNull() || rhs.IsNull()) {
+    return static_cast<int>(!lhs.IsNull()) - static_cast<int>(!rhs.IsNull());
+  }
+  if (lhs.CompareLessThan(rhs) == CmpBool::CmpTrue) {
+    return -1;
+  }
+  return rhs.CompareLessThan(lhs) == CmpBool::CmpTrue ? 1 : 0;
+}
+
+// NOLINTNEXTLINE
+TEST(SortKeyTest, MatchesValueComparison) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16), Column("c", TypeId::DECIMAL),
+                 Column("d", TypeId::BIGINT)});
+  std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys{
+      {OrderByType::ASC, std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER)},
+      {OrderByType::DESC, std::make_shared<ColumnValueExpression>(0, 1, TypeId::VARCHAR)},
+      {OrderByType::DEFAULT, std::make_shared<ColumnValueExpression>(0, 2, TypeId::DECIMAL)},
+      {OrderByType::DESC, std::make_shared<ColumnValueExpression>(0, 3, TypeId::BIGINT)},
+  };
+
+  std::mt19937 gen(15445);
+  std::uniform_int_distribution<int> small(-3, 3);
+  const std::vector<std::string> strings{"", "a", "ab", "b", std::string("a\0b", 3), "abc"};
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 2000; i++) {
+    auto a = small(gen) == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                             : ValueFactory::GetIntegerValue(small(gen) * 1000000);
+    auto b = small(gen) == 0 ? ValueFactory::GetNullValueByType(TypeId::VARCHAR)
+                             : ValueFactory::GetVarcharValue(strings[gen() % strings.size()]);
+    auto c = ValueFactory::GetDecimalValue(small(gen) * 0.5);
+    auto d = ValueFactory::GetBigIntValue(static_cast<int64_t>(gen()) - (1LL << 31));
+    tuples.emplace_back(std::vector<Value>{a, b, c, d}, &schema);
+  }
+
+  SortKeyEncoder encoder(order_bys);
+  std::vector<std::string> keys;
+  std::vector<SortEntry> entries;
+  for (const auto &tuple : tuples) {
+    keys.push_back(encoder.Encode(tuple, schema));
+  }
+  for (uint32_t i = 0; i < keys.size(); i++) {
+    entries.push_back({keys[i].data(), static_cast<uint32_t>(keys[i].size()), i});
+  }
+  SortByNormalizedKey(&entries);
+
+  auto reference_less = [&](uint32_t lhs, uint32_t rhs) {
+    for (uint32_t col = 0; col < order_bys.size(); col++) {
+      int cmp = ReferenceCompare(tuples[lhs].GetValue(&schema, col), tuples[rhs].GetValue(&schema, col));
+      if (order_bys[col].first == OrderByType::DESC) {
+        cmp = -cmp;
+      }
+      if (cmp != 0) {
+        return cmp < 0;
+      }
+    }
+    return lhs < rhs;
+  };
+  std::vector<uint32_t> expected(tuples.size());
+  for (uint32_t i = 0; i < expected.size(); i++) {
+    expected[i] = i;
+  }
+  std::sort(expected.begin(), expected.end(), reference_less);
+
+  ASSERT_EQ(expected.size(), entries.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    EXPECT_EQ(expected[i], entries[i].row_) << "mismatch at position " << i;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(SortKeyTest, EncodeIfBeforeMatchesCompare) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 16)});
+  std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys{
+      {OrderByType::DESC, std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER)},
+      {OrderByType::ASC, std::make_shared<ColumnValueExpression>(0, 1, TypeId::VARCHAR)},
+  };
+
+  std::mt19937 gen(15445);
+  const std::vector<std::string> strings{"", "a", "ab", "b", std::string("a\0b", 3)};
+  std::vector<Tuple> tuples;
+  for (int i = 0; i < 200; i++) {
+    auto a = gen() % 5 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                            : ValueFactory::GetIntegerValue(static_cast<int32_t>(gen() % 3));
+    tuples.emplace_back(std::vector<Value>{a, ValueFactory::GetVarcharValue(strings[gen() % strings.size()])},
+                        &schema);
+  }
+
+  SortKeyEncoder encoder(order_bys);
+  for (const auto &bound_tuple : tuples) {
+    auto bound = encoder.Encode(bound_tuple, schema);
+    for (const auto &tuple : tuples) {
+      auto full = encoder.Encode(tuple, schema);
+      std::string key;
+      bool before = encoder.EncodeIfBefore(tuple, schema, bound, &key);
+      ASSERT_EQ(SortKeyEncoder::Compare(full, bound) < 0, before);
+      if (before) {
+        ASSERT_EQ(full, key);
+      }
+    }
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,160 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_view_test.cpp
+//
+// Identification: test/execution/tuple_view_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/filter_executor.h"
+#include "execution/executors/mock_scan_executor.h"
+#include "execution/executors/sort_executor.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/plans/filter_plan.h"
+#include "execution/plans/mock_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "gtest/gtest.h"
+#include "storage/table/tuple.h"
+#include "storage/table/tuple_view.h"
+#include "type/value_factory.h"
+
+namespace {
+
+/** Counting allocator: every global operator new of this test binary goes through here. */
+size_t allocation_count = 0;
+
+}  // namespace
+
+auto operator new(size_t size) -> void * {
+  allocation_count++;
+  if (void *ptr = std::malloc(size == 0 ? 1 : size)) {  // NOLINT
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+auto operator new[](size_t size) -> void * { return operator new(size); }
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }  // NOLINT
+
+void operator delete[](void *ptr) noexcept { std::free(ptr); }  // NOLINT
+
+void operator delete(void *ptr, size_t /* size */) noexcept { std::free(ptr); }  // NOLINT
+
+void operator delete[](void *ptr, size_t /* size */) noexcept { std::free(ptr); }  // NOLINT
+
+namespace bustub {
+
+/** @return the number of allocations made by `f` */
+template <typename F>
+auto CountAllocations(F &&f) -> size_t {
+  auto before = allocation_count;
+  f();
+  return allocation_count - before;
+}
+
+// NOLINTNEXTLINE
+TEST(TupleViewTest, ValueViewMatchesValue) {
+  Schema schema({Column("a", TypeId::BOOLEAN), Column("b", TypeId::SMALLINT), Column("c", TypeId::INTEGER),
+                 Column("d", TypeId::BIGINT), Column("e", TypeId::DECIMAL), Column("f", TypeId::VARCHAR, 32),
+                 Column("g", TypeId::VARCHAR, 32)});
+  std::vector<std::vector<Value>> rows{
+      {ValueFactory::GetBooleanValue(true), ValueFactory::GetSmallIntValue(-7), ValueFactory::GetIntegerValue(15445),
+       ValueFactory::GetBigIntValue(1LL << 40), ValueFactory::GetDecimalValue(2.5),
+       ValueFactory::GetVarcharValue("zero-copy"), ValueFactory::GetVarcharValue("")},
+      {ValueFactory::GetNullValueByType(TypeId::BOOLEAN), ValueFactory::GetNullValueByType(TypeId::SMALLINT),
+       ValueFactory::GetNullValueByType(TypeId::INTEGER), ValueFactory::GetNullValueByType(TypeId::BIGINT),
+       ValueFactory::GetNullValueByType(TypeId::DECIMAL), ValueFactory::GetNullValueByType(TypeId::VARCHAR),
+       ValueFactory::GetVarcharValue("x")},
+  };
+
+  for (const auto &row : rows) {
+    Tuple tuple(row, &schema);
+    for (uint32_t i = 0; i < schema.GetColumnCount(); i++) {
+      auto expected = tuple.GetValue(&schema, i);
+      std::optional<ValueView> view;
+      ASSERT_EQ(0, CountAllocations([&] { view.emplace(tuple.GetValueView(&schema, i)); }));
+      ASSERT_EQ(expected.IsNull(), view->IsNull()) << "column " << i;
+      if (!expected.IsNull()) {
+        ASSERT_EQ(CmpBool::CmpTrue, expected.CompareEquals(view->ToValue())) << "column " << i;
+      }
+    }
+  }
+
+  Tuple tuple(rows[0], &schema);
+  ASSERT_EQ("zero-copy", tuple.GetValueView(&schema, 5).GetStringView());
+  ASSERT_EQ("", tuple.GetValueView(&schema, 6).GetStringView());
+
+  // A view can be copied out into an owning tuple.
+  Tuple copy(tuple.GetView());
+  ASSERT_EQ(tuple.ToString(&schema), copy.ToString(&schema));
+}
+
+// NOLINTNEXTLINE
+TEST(TupleViewTest, MoveTransfersOwnership) {
+  Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::VARCHAR, 32)});
+  Tuple tuple({ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue("bustub")}, &schema);
+  const auto *data = tuple.GetData();
+
+  ASSERT_EQ(1, CountAllocations([&] { Tuple copy(tuple); }));
+  Tuple moved;
+  ASSERT_EQ(0, CountAllocations([&] { moved = std::move(tuple); }));
+  ASSERT_EQ(data, moved.GetData());
+  ASSERT_EQ(nullptr, tuple.GetData());  // NOLINT
+  ASSERT_EQ("bustub", moved.GetValueView(&schema, 1).GetStringView());
+}
+
+// NOLINTNEXTLINE
+TEST(TupleViewTest, ExecutorAllocationsPerRow) {
+  // MockScan -> Filter (v1 > 2) -> Sort (v6 DESC, v2), over 10000 rows with a VARCHAR sort key.
+  ExecutorContext exec_ctx(nullptr, nullptr, nullptr, nullptr, nullptr);
+  auto schema = std::make_shared<Schema>(GetMockTableSchemaOf("__mock_agg_input_big"));
+  auto scan_plan = std::make_shared<MockScanPlanNode>(schema, "__mock_agg_input_big");
+  auto v1 = std::make_shared<ColumnValueExpression>(0, 0, TypeId::INTEGER);
+  auto two = std::make_shared<ConstantValueExpression>(ValueFactory::GetIntegerValue(2));
+  auto predicate = std::make_shared<ComparisonExpression>(v1, two, ComparisonType::GreaterThan);
+  auto filter_plan = std::make_shared<FilterPlanNode>(schema, predicate, scan_plan);
+  std::vector<std::pair<OrderByType, AbstractExpressionRef>> order_bys{
+      {OrderByType::DESC, std::make_shared<ColumnValueExpression>(0, 5, TypeId::VARCHAR)},
+      {OrderByType::ASC, std::make_shared<ColumnValueExpression>(0, 1, TypeId::INTEGER)}};
+  auto sort_plan = std::make_shared<SortPlanNode>(schema, filter_plan, order_bys);
+
+  auto scan = std::make_unique<MockScanExecutor>(&exec_ctx, scan_plan.get());
+  auto filter = std::make_unique<FilterExecutor>(&exec_ctx, filter_plan.get(), std::move(scan));
+  SortExecutor sort(&exec_ctx, sort_plan.get(), std::move(filter));
+
+  auto drain = [](AbstractExecutor *executor) {
+    size_t rows = 0;
+    executor->Init();
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      rows++;
+    }
+    return rows;
+  };
+
+  // Generating the mock rows allocates on its own (the Values and their vector); that is not the executors' cost.
+  MockScanExecutor baseline(&exec_ctx, scan_plan.get());
+  auto scan_allocations = CountAllocations([&] { ASSERT_EQ(10000, drain(&baseline)); });
+  auto allocations = CountAllocations([&] { ASSERT_EQ(7000, drain(&sort)); });
+  auto per_row = static_cast<double>(allocations - scan_allocations) / 7000.0;
+  // Filtering, sort key extraction and the hand-off of tuples between executors and to the caller do not allocate
+  // per row. What is left is amortized growth of the buffers that hold all the rows.
+  ASSERT_LT(per_row, 0.1) << "mock scan: " << scan_allocations << " allocations, filter + sort on top: " << allocations;
+}
+
+}  // namespace bustub
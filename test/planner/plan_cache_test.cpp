@@ -0,0 +1,63 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// plan_cache_test.cpp
+//
+// Identification: test/planner/plan_cache_test.cpp
+//
+// Copyright (c) 2015-2022, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <memory>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "planner/plan_cache.h"
+
+namespace bustub {
+
+static auto MakePlan(uint64_t catalog_version) -> std::shared_ptr<const CachedPlan> {
+  return std::make_shared<CachedPlan>(CachedPlan{nullptr, nullptr, catalog_version, {}, nullptr});
+}
+
+// NOLINTNEXTLINE
+TEST(PlanCacheTest, NormalizeSql) {
+  EXPECT_EQ("select * from t1 where x = 1", PlanCache::NormalizeSql("  SELECT *\n  FROM t1\tWHERE x  =  1;  "));
+  EXPECT_EQ("select 'A  b;' from t1", PlanCache::NormalizeSql("select 'A  b;' FROM t1;;"));
+  EXPECT_EQ("select \"Col\" from t1", PlanCache::NormalizeSql("Select \"Col\" From t1"));
+  EXPECT_NE(PlanCache::NormalizeSql("select 'A'"), PlanCache::NormalizeSql("select 'a'"));
+}
+
+// NOLINTNEXTLINE
+TEST(PlanCacheTest, StalePlansAreDropped) {
+  PlanCache cache(4);
+  auto plan = MakePlan(1);
+  cache.Put("q", plan);
+  EXPECT_EQ(plan, cache.Get("q", 1));
+  EXPECT_EQ(nullptr, cache.Get("q", 2));
+  EXPECT_EQ(0, cache.Size());
+  EXPECT_EQ(nullptr, cache.Get("q", 1));
+}
+
+// NOLINTNEXTLINE
+TEST(PlanCacheTest, EvictsLeastRecentlyUsed) {
+  PlanCache cache(2);
+  cache.Put("a", MakePlan(0));
+  cache.Put("b", MakePlan(0));
+  ASSERT_NE(nullptr, cache.Get("a", 0));
+  cache.Put("c", MakePlan(0));
+  EXPECT_EQ(2, cache.Size());
+  EXPECT_NE(nullptr, cache.Get("a", 0));
+  EXPECT_EQ(nullptr, cache.Get("b", 0));
+  EXPECT_NE(nullptr, cache.Get("c", 0));
+
+  // Putting a statement again replaces its plan.
+  auto plan = MakePlan(0);
+  cache.Put("c", plan);
+  EXPECT_EQ(2, cache.Size());
+  EXPECT_EQ(plan, cache.Get("c", 0));
+}
+
+}  // namespace bustub
@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "common/config.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "concurrency/transaction_manager.h"
+#include "fmt/core.h"
+
+#include <sys/resource.h>
+
+/**
+ * Measure the throughput of the lock manager alone: every transaction takes an IX lock on one table and X locks on a
+ * few random rows of it, in ascending order so that transactions never deadlock, then commits. Transactions locking
+ * many rows stand for bulk UPDATE and DELETE statements, and show the effect of lock escalation. With --random-order,
+ * the rows are locked in random order, so that transactions deadlock, and show the effect of the deadlock policy.
+ */
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-lock-manager-bench");
+  program.add_argument("--threads").help("number of threads running transactions").default_value(std::string("8"));
+  program.add_argument("--duration").help("run for n milliseconds").default_value(std::string("3000"));
+  program.add_argument("--rows").help("number of rows the transactions lock").default_value(std::string("1000000"));
+  program.add_argument("--rows-per-txn").help("number of rows each transaction locks").default_value(std::string("8"));
+  program.add_argument("--escalation-threshold")
+      .help("row locks on a table before they are escalated, 0 to disable escalation")
+      .default_value(std::to_string(bustub::LOCK_ESCALATION_THRESHOLD));
+  program.add_argument("--random-order").help("lock the rows in random order").default_value(false).implicit_value(true);
+  program.add_argument("--deadlock-policy")
+      .help("detection, wait-die or wound-wait")
+      .default_value(std::string("detection"));
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  const auto num_threads = std::stoul(program.get("--threads"));
+  const auto duration_ms = std::stoul(program.get("--duration"));
+  const auto num_rows = std::stoul(program.get("--rows"));
+  const auto rows_per_txn = std::stoul(program.get("--rows-per-txn"));
+  const auto escalation_threshold = std::stoul(program.get("--escalation-threshold"));
+  const auto random_order = program.get<bool>("--random-order");
+  const auto deadlock_policy = program.get("--deadlock-policy");
+
+  bustub::LockManager lock_manager;
+  lock_manager.SetLockEscalationThreshold(escalation_threshold);
+  if (deadlock_policy == "wait-die") {
+    lock_manager.SetDeadlockPolicy(bustub::LockManager::DeadlockPolicy::WAIT_DIE);
+  } else if (deadlock_policy == "wound-wait") {
+    lock_manager.SetDeadlockPolicy(bustub::LockManager::DeadlockPolicy::WOUND_WAIT);
+  } else if (deadlock_policy != "detection") {
+    std::cerr << "unknown deadlock policy " << deadlock_policy << std::endl;
+    return 1;
+  }
+  bustub::TransactionManager txn_manager(&lock_manager);
+  const bustub::table_oid_t oid = 0;
+
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> committed{0};
+  std::atomic<uint64_t> aborted{0};
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t thread_id = 0; thread_id < num_threads; thread_id++) {
+    threads.emplace_back([&, thread_id] {
+      std::mt19937_64 gen(thread_id);
+      std::uniform_int_distribution<uint64_t> dist(0, num_rows - 1);
+      std::vector<uint64_t> rows(rows_per_txn);
+      uint64_t committed_cnt = 0;
+      uint64_t aborted_cnt = 0;
+      while (!stop) {
+        std::generate(rows.begin(), rows.end(), [&] { return dist(gen); });
+        std::sort(rows.begin(), rows.end());
+        rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+        if (random_order) {
+          std::shuffle(rows.begin(), rows.end(), gen);
+        }
+        auto *txn = txn_manager.Begin();
+        bool locked = lock_manager.LockTable(txn, bustub::LockManager::LockMode::INTENTION_EXCLUSIVE, oid);
+        for (size_t i = 0; locked && i < rows.size(); i++) {
+          bustub::RID rid(static_cast<bustub::page_id_t>(rows[i] / 64), static_cast<uint32_t>(rows[i] % 64));
+          locked = lock_manager.LockRow(txn, bustub::LockManager::LockMode::EXCLUSIVE, oid, rid);
+        }
+        if (locked && txn->GetState() != bustub::TransactionState::ABORTED) {
+          txn_manager.Commit(txn);
+          committed_cnt++;
+        } else {
+          txn_manager.Abort(txn);
+          aborted_cnt++;
+        }
+        delete txn;
+        rows.resize(rows_per_txn);
+      }
+      committed += committed_cnt;
+      aborted += aborted_cnt;
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  fmt::print("threads={} row_shards={} escalation_threshold={} committed_txn={} throughput={:.0f} txn/s max_rss={}KB\n",
+             num_threads, bustub::LOCK_MANAGER_ROW_SHARDS, escalation_threshold, committed.load(),
+             committed / (duration_ms / 1000.0), usage.ru_maxrss);
+  auto stats = lock_manager.GetDeadlockStats();
+  fmt::print("deadlock_policy={} aborted_txn={} deadlock_aborts={} cycles={} avg_detection_latency={}us "
+             "max_detection_latency={}us\n",
+             deadlock_policy, aborted.load(), stats.aborted_txn_cnt_, stats.cycle_cnt_,
+             stats.cycle_cnt_ == 0 ? 0 : stats.total_detection_latency_.count() / stats.cycle_cnt_,
+             stats.max_detection_latency_.count());
+  return 0;
+}
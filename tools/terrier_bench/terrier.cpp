@@ -120,6 +120,7 @@ auto main(int argc, char **argv) -> int {
   program.add_argument("--duration").help("run terrier bench for n milliseconds");
   program.add_argument("--force-create-index").help("create index in terrier bench");
   program.add_argument("--force-enable-update").help("use update statement in terrier bench");
+  program.add_argument("--snapshot-isolation").help("run the benchmark transactions under snapshot isolation");
 
   try {
     program.parse_args(argc, argv);
@@ -172,6 +173,12 @@ auto main(int argc, char **argv) -> int {
     std::cerr << "x: use insert + delete" << std::endl;
   }
 
+  auto isolation_level = bustub::IsolationLevel::REPEATABLE_READ;
+  if (program.present("--snapshot-isolation") && ParseBool(program.get("--snapshot-isolation"))) {
+    isolation_level = bustub::IsolationLevel::SNAPSHOT_ISOLATION;
+    std::cerr << "x: use snapshot isolation" << std::endl;
+  }
+
   uint64_t duration_ms = 30000;
 
   if (program.present("--duration")) {
@@ -213,7 +220,7 @@ auto main(int argc, char **argv) -> int {
   total_metrics.Begin();
 
   for (size_t thread_id = 0; thread_id < BUSTUB_TERRIER_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &bustub, enable_update, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &bustub, enable_update, isolation_level, duration_ms, &total_metrics] {
       const size_t nft_range_size = BUSTUB_NFT_NUM / BUSTUB_TERRIER_THREAD;
       const size_t nft_range_begin = thread_id * nft_range_size;
       const size_t nft_range_end = (thread_id + 1) * nft_range_size;
@@ -233,7 +240,7 @@ auto main(int argc, char **argv) -> int {
         bool txn_success = true;
 
         if (enable_update) {
-          auto txn = bustub->txn_manager_->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ);
+          auto txn = bustub->txn_manager_->Begin(nullptr, isolation_level);
           std::string query = fmt::format("UPDATE nft SET terrier = {} WHERE id = {}", terrier_id, nft_id);
           if (!bustub->ExecuteSqlTxn(query, writer, txn)) {
             txn_success = false;
@@ -253,7 +260,7 @@ auto main(int argc, char **argv) -> int {
           }
           delete txn;
         } else {
-          auto txn = bustub->txn_manager_->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ);
+          auto txn = bustub->txn_manager_->Begin(nullptr, isolation_level);
 
           std::string query = fmt::format("DELETE FROM nft WHERE id = {}", nft_id);
           if (!bustub->ExecuteSqlTxn(query, writer, txn)) {
@@ -273,7 +280,7 @@ auto main(int argc, char **argv) -> int {
             bustub->txn_manager_->Commit(txn);
             delete txn;
 
-            txn = bustub->txn_manager_->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ);
+            txn = bustub->txn_manager_->Begin(nullptr, isolation_level);
 
             query = fmt::format("INSERT INTO nft VALUES ({}, {})", nft_id, terrier_id);
             if (!bustub->ExecuteSqlTxn(query, writer, txn)) {
@@ -304,7 +311,7 @@ auto main(int argc, char **argv) -> int {
   }
 
   for (size_t thread_id = 0; thread_id < BUSTUB_TERRIER_THREAD; thread_id++) {
-    threads.emplace_back(std::thread([thread_id, &bustub, duration_ms, &total_metrics] {
+    threads.emplace_back(std::thread([thread_id, &bustub, isolation_level, duration_ms, &total_metrics] {
       std::random_device r;
       std::default_random_engine gen(r());
       std::uniform_int_distribution<int> terrier_uniform_dist(0, BUSTUB_TERRIER_CNT - 1);
@@ -317,7 +324,7 @@ auto main(int argc, char **argv) -> int {
         auto writer = bustub::SimpleStreamWriter(ss, true);
         auto terrier_id = terrier_uniform_dist(gen);
 
-        auto txn = bustub->txn_manager_->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ);
+        auto txn = bustub->txn_manager_->Begin(nullptr, isolation_level);
         bool txn_success = true;
 
         std::string query = fmt::format("SELECT count(*) FROM nft WHERE terrier = {}", terrier_id);
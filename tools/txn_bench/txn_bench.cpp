@@ -0,0 +1,264 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "argparse/argparse.hpp"
+#include "catalog/catalog.h"
+#include "common/bustub_instance.h"
+#include "concurrency/lock_manager.h"
+#include "concurrency/transaction.h"
+#include "concurrency/transaction_manager.h"
+#include "fmt/core.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager_memory.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace {
+/** Heap allocations made by the current thread, to report the allocations per transaction. */
+thread_local uint64_t allocation_cnt = 0;
+}  // namespace
+
+auto operator new(std::size_t size) -> void * {
+  allocation_cnt++;
+  if (auto *ptr = std::malloc(size == 0 ? 1 : size); ptr != nullptr) {  // NOLINT
+    return ptr;
+  }
+  throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }  // NOLINT
+
+void operator delete(void *ptr, std::size_t size) noexcept { std::free(ptr); }  // NOLINT
+
+/** A log device that takes a fixed time to make every write durable, as an fsync would. */
+class SimulatedLogDisk : public bustub::DiskManagerUnlimitedMemory {
+ public:
+  explicit SimulatedLogDisk(std::chrono::microseconds latency) : latency_(latency) {}
+
+  void WriteLog(char *log_data, int size) override {
+    flush_cnt_++;
+    std::this_thread::sleep_for(latency_);
+  }
+
+  auto GetFlushCount() const -> uint64_t { return flush_cnt_; }
+
+ private:
+  std::chrono::microseconds latency_;
+  std::atomic<uint64_t> flush_cnt_{0};
+};
+
+/** Draws integers in [0, n) following a Zipfian distribution of skew theta, as in YCSB. theta = 0 is uniform. */
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(uint64_t n, double theta) : n_(n), theta_(theta) {
+    double zeta2 = Zeta(2, theta);
+    zetan_ = Zeta(n, theta);
+    alpha_ = 1.0 / (1.0 - theta);
+    eta_ = (1.0 - std::pow(2.0 / static_cast<double>(n), 1.0 - theta)) / (1.0 - zeta2 / zetan_);
+  }
+
+  template <class Gen>
+  auto operator()(Gen &gen) -> uint64_t {
+    double u = std::uniform_real_distribution<double>(0.0, 1.0)(gen);
+    double uz = u * zetan_;
+    if (uz < 1.0) {
+      return 0;
+    }
+    if (uz < 1.0 + std::pow(0.5, theta_)) {
+      return 1;
+    }
+    return std::min(n_ - 1, static_cast<uint64_t>(static_cast<double>(n_) * std::pow(eta_ * u - eta_ + 1.0, alpha_)));
+  }
+
+ private:
+  static auto Zeta(uint64_t n, double theta) -> double {
+    double sum = 0;
+    for (uint64_t i = 1; i <= n; i++) {
+      sum += 1.0 / std::pow(static_cast<double>(i), theta);
+    }
+    return sum;
+  }
+
+  uint64_t n_;
+  double theta_;
+  double zetan_;
+  double alpha_;
+  double eta_;
+};
+
+/**
+ * Measure short read-modify-write transactions on a table: every transaction increments a column of a few rows picked
+ * with Zipfian skew, either under two-phase locking (an IX table lock and X row locks, taken in RID order so that
+ * transactions never deadlock) or under optimistic concurrency control. The transactions work on the table heap
+ * directly, as the UPDATE executor is not implemented. With no rows per transaction, only Begin and Commit are
+ * measured. With a log latency, commits wait for their commit record to be written to a log device that takes that
+ * long per write, holding their locks meanwhile unless they are released early.
+ */
+auto main(int argc, char **argv) -> int {
+  argparse::ArgumentParser program("bustub-txn-bench");
+  program.add_argument("--threads").help("number of threads running transactions").default_value(std::string("8"));
+  program.add_argument("--duration").help("run for n milliseconds").default_value(std::string("3000"));
+  program.add_argument("--rows").help("number of rows in the table").default_value(std::string("10000"));
+  program.add_argument("--rows-per-txn")
+      .help("number of rows each transaction updates, 0 to only begin and commit")
+      .default_value(std::string("4"));
+  program.add_argument("--theta")
+      .help("Zipfian skew of the rows updated, 0 for uniform")
+      .default_value(std::string("0"));
+  program.add_argument("--occ").help("use optimistic concurrency control").default_value(false).implicit_value(true);
+  program.add_argument("--log-latency")
+      .help("enable logging, with a log device taking n microseconds per write")
+      .default_value(std::string("0"));
+  program.add_argument("--elr")
+      .help("release the locks before the commit record is persistent")
+      .default_value(false)
+      .implicit_value(true);
+
+  try {
+    program.parse_args(argc, argv);
+  } catch (const std::runtime_error &err) {
+    std::cerr << err.what() << std::endl;
+    std::cerr << program;
+    return 1;
+  }
+
+  const auto num_threads = std::stoul(program.get("--threads"));
+  const auto duration_ms = std::stoul(program.get("--duration"));
+  const auto num_rows = std::stoul(program.get("--rows"));
+  const auto rows_per_txn = std::stoul(program.get("--rows-per-txn"));
+  const auto theta = std::stod(program.get("--theta"));
+  const auto occ = program.get<bool>("--occ");
+  const auto concurrency_control = occ ? bustub::ConcurrencyControl::OPTIMISTIC : bustub::ConcurrencyControl::LOCKING;
+  const auto log_latency_us = std::stoul(program.get("--log-latency"));
+  const auto elr = program.get<bool>("--elr");
+
+  auto bustub = std::make_unique<bustub::BustubInstance>();
+  {
+    std::stringstream ss;
+    auto writer = bustub::SimpleStreamWriter(ss, true);
+    bustub->ExecuteSql("CREATE TABLE t (id int, value int);", writer);
+    std::string query = "INSERT INTO t VALUES ";
+    for (size_t i = 0; i < num_rows; i++) {
+      query += fmt::format("({}, 0){}", i, i + 1 == num_rows ? ";" : ", ");
+    }
+    bustub->ExecuteSql(query, writer);
+  }
+  auto *table_info = bustub->catalog_->GetTable("t");
+  auto *table = table_info->table_.get();
+  const auto &schema = table_info->schema_;
+  std::vector<bustub::RID> rids;
+  {
+    auto *txn = bustub->txn_manager_->Begin();
+    for (auto it = table->Begin(txn); it != table->End(); ++it) {
+      rids.push_back(it->GetRid());
+    }
+    bustub->txn_manager_->Commit(txn);
+    delete txn;
+  }
+  ZipfianGenerator zipf(rids.size(), theta);
+
+  // The logged transactions go through a transaction manager of their own, which writes to the simulated log device.
+  auto *txn_manager = bustub->txn_manager_;
+  std::unique_ptr<SimulatedLogDisk> log_disk;
+  std::unique_ptr<bustub::LogManager> log_manager;
+  std::unique_ptr<bustub::TransactionManager> logged_txn_manager;
+  if (log_latency_us != 0) {
+    log_disk = std::make_unique<SimulatedLogDisk>(std::chrono::microseconds(log_latency_us));
+    log_manager = std::make_unique<bustub::LogManager>(log_disk.get());
+    logged_txn_manager = std::make_unique<bustub::TransactionManager>(bustub->lock_manager_, log_manager.get());
+    logged_txn_manager->SetEarlyLockRelease(elr);
+    log_manager->RunFlushThread();
+    txn_manager = logged_txn_manager.get();
+  }
+
+  std::atomic<bool> stop{false};
+  std::atomic<uint64_t> committed{0};
+  std::atomic<uint64_t> aborted{0};
+  std::atomic<uint64_t> allocations{0};
+  std::vector<std::thread> threads;
+  threads.reserve(num_threads);
+  for (size_t thread_id = 0; thread_id < num_threads; thread_id++) {
+    threads.emplace_back([&, thread_id] {
+      std::mt19937_64 gen(thread_id);
+      std::vector<bustub::RID> txn_rids;
+      uint64_t committed_cnt = 0;
+      uint64_t aborted_cnt = 0;
+      const auto allocation_start = allocation_cnt;
+      while (!stop) {
+        txn_rids.clear();
+        for (size_t i = 0; i < rows_per_txn; i++) {
+          txn_rids.push_back(rids[zipf(gen)]);
+        }
+        std::sort(txn_rids.begin(), txn_rids.end(),
+                  [](const bustub::RID &a, const bustub::RID &b) { return a.Get() < b.Get(); });
+        txn_rids.erase(std::unique(txn_rids.begin(), txn_rids.end()), txn_rids.end());
+
+        auto *txn = txn_manager->Begin(nullptr, bustub::IsolationLevel::REPEATABLE_READ, concurrency_control);
+        bool ok = true;
+        try {
+          if (!txn_rids.empty()) {
+            ok = bustub->lock_manager_->LockTable(txn, bustub::LockManager::LockMode::INTENTION_EXCLUSIVE,
+                                                  table_info->oid_);
+          }
+          for (size_t i = 0; ok && i < txn_rids.size(); i++) {
+            const auto &rid = txn_rids[i];
+            bustub::Tuple tuple;
+            ok = bustub->lock_manager_->LockRow(txn, bustub::LockManager::LockMode::EXCLUSIVE, table_info->oid_, rid) &&
+                 table->GetTuple(rid, &tuple, txn);
+            if (ok) {
+              bustub::Tuple new_tuple({tuple.GetValue(&schema, 0),
+                                       bustub::ValueFactory::GetIntegerValue(
+                                           tuple.GetValue(&schema, 1).GetAs<int32_t>() + 1)},
+                                      &schema);
+              ok = table->UpdateTuple(new_tuple, rid, txn);
+            }
+          }
+        } catch (bustub::TransactionAbortException &e) {
+          ok = false;
+        }
+        if (ok && txn->GetState() != bustub::TransactionState::ABORTED) {
+          txn_manager->Commit(txn);
+        } else {
+          txn_manager->Abort(txn);
+        }
+        // An optimistic transaction may also be aborted by its commit, when it fails validation.
+        if (txn->GetState() == bustub::TransactionState::COMMITTED) {
+          committed_cnt++;
+        } else {
+          aborted_cnt++;
+        }
+        delete txn;
+      }
+      committed += committed_cnt;
+      aborted += aborted_cnt;
+      allocations += allocation_cnt - allocation_start;
+    });
+  }
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(duration_ms));
+  stop = true;
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  if (log_manager != nullptr) {
+    log_manager->StopFlushThread();
+  }
+  auto total = committed + aborted;
+  fmt::print("mode={} threads={} rows={} rows_per_txn={} theta={} committed_txn={} throughput={:.0f} txn/s "
+             "aborted_txn={} abort_rate={:.2f}% allocations_per_txn={:.1f} log_latency={}us elr={} log_writes={}\n",
+             occ ? "occ" : "2pl", num_threads, num_rows, rows_per_txn, theta, committed.load(),
+             committed / (duration_ms / 1000.0), aborted.load(), total == 0 ? 0.0 : 100.0 * aborted / total,
+             total == 0 ? 0.0 : static_cast<double>(allocations) / total, log_latency_us, elr,
+             log_disk == nullptr ? 0 : log_disk->GetFlushCount());
+  return 0;
+}